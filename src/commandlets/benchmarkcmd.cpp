@@ -0,0 +1,257 @@
+
+#include "benchmarkcmd.h"
+#include "g_levellocals.h"
+#include "g_game.h"
+#include "d_event.h"
+#include "doomstat.h"
+#include "i_time.h"
+#include "stats.h"
+#include "files.h"
+
+void G_SetMap(const char* mapname, int mode);
+void D_SingleTick();
+void R_BenchmarkTruecolorDrawers(int passes);
+
+extern cycle_t ThinkCycles;
+extern cycle_t SightCycles;
+extern cycle_t ParticleCycles;
+extern cycle_t ACSTime;
+extern cycle_t VMCycles[10];
+
+BenchmarkCmdletGroup::BenchmarkCmdletGroup()
+{
+	SetLongFormName("bench");
+	SetShortDescription("Benchmark commands");
+
+	AddCommand<BenchmarkTimedemoCmdlet>();
+	AddCommand<BenchmarkDrawersCmdlet>();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	// Think time includes everything that runs from inside a thinker (ACS, VM, sight checks from monster AI),
+	// so the columns overlap and are not supposed to add up to the total.
+	enum EBenchColumn
+	{
+		BENCH_Total,
+		BENCH_Think,
+		BENCH_Sight,
+		BENCH_Particles,
+		BENCH_ACS,
+		BENCH_VM,
+		NUM_BENCH_COLUMNS
+	};
+
+	const char* BenchColumnNames[NUM_BENCH_COLUMNS] = { "total", "think", "sight", "particles", "acs", "vm" };
+
+	struct BenchTic
+	{
+		double ms[NUM_BENCH_COLUMNS];
+	};
+
+	struct BenchSummary
+	{
+		double total = 0;
+		double peak = 0;
+	};
+
+	FString JsonEscape(const FString& str)
+	{
+		FString result;
+		for (const char* c = str.GetChars(); *c; c++)
+		{
+			if (*c == '"' || *c == '\\')
+				result.AppendCharacter('\\');
+			result.AppendCharacter(*c);
+		}
+		return result;
+	}
+}
+
+BenchmarkTimedemoCmdlet::BenchmarkTimedemoCmdlet()
+{
+	SetLongFormName("timedemo");
+	SetShortDescription("Play back a demo and measure playsim time per subsystem");
+}
+
+void BenchmarkTimedemoCmdlet::OnCommand(FArgs args)
+{
+	if (args.NumArgs() == 0 || args.GetArg(0)[0] == '-')
+	{
+		OnPrintHelp();
+		return;
+	}
+
+	FString demoname = args.GetArg(0);
+	FString mapname;
+	if (args.NumArgs() > 1 && args.GetArg(1)[0] != '-')
+		mapname = args.GetArg(1);
+
+	FString csvname = args.CheckValue("-csv");
+	FString jsonname = args.CheckValue("-json");
+
+	RunInGame([&]() {
+
+		// The demo may rely on a map that has already been loaded (i.e. it has no savegame of its own)
+		if (mapname.IsNotEmpty())
+		{
+			G_SetMap(mapname.GetChars(), 0);
+			for (int i = 0; i < 100; i++)
+			{
+				D_SingleTick();
+				if (gameaction == ga_nothing)
+					break;
+			}
+		}
+
+		nodrawers = true;
+		singletics = true;
+		singledemo = true;
+		G_DeferedPlayDemo(demoname.GetChars());
+
+		// Let the ticker pick up the demo and load its level before we start counting.
+		for (int i = 0; i < 100 && !demoplayback; i++)
+		{
+			D_SingleTick();
+		}
+
+		if (!demoplayback)
+		{
+			Printf("Unable to start playback of demo %s\n", demoname.GetChars());
+			return;
+		}
+
+		TArray<BenchTic> tics;
+		cycle_t tictime;
+		uint64_t startms = I_msTime();
+
+		while (demoplayback)
+		{
+			double vmstart = VMCycles[0].TimeMS();
+
+			tictime.Reset();
+			tictime.Clock();
+			D_SingleTick();
+			tictime.Unclock();
+
+			BenchTic& tic = tics[tics.Reserve(1)];
+			tic.ms[BENCH_Total] = tictime.TimeMS();
+			tic.ms[BENCH_Think] = ThinkCycles.TimeMS();
+			tic.ms[BENCH_Sight] = SightCycles.TimeMS();
+			tic.ms[BENCH_Particles] = ParticleCycles.TimeMS();
+			tic.ms[BENCH_ACS] = ACSTime.TimeMS();
+			tic.ms[BENCH_VM] = VMCycles[0].TimeMS() - vmstart;
+		}
+
+		double wallsec = (I_msTime() - startms) / 1000.0;
+		unsigned numtics = tics.Size();
+		if (numtics == 0)
+		{
+			Printf("Demo %s did not run any tics\n", demoname.GetChars());
+			return;
+		}
+
+		BenchSummary summary[NUM_BENCH_COLUMNS];
+		for (const BenchTic& tic : tics)
+		{
+			for (int c = 0; c < NUM_BENCH_COLUMNS; c++)
+			{
+				summary[c].total += tic.ms[c];
+				summary[c].peak = max(summary[c].peak, tic.ms[c]);
+			}
+		}
+
+		double playsimsec = summary[BENCH_Total].total / 1000.0;
+		double ticspersec = playsimsec > 0 ? numtics / playsimsec : 0;
+
+		Printf("Timed %u gametics in %.3f sec (%.1f tics/sec playsim only)\n", numtics, wallsec, ticspersec);
+		Printf(TEXTCOLOR_YELLOW "Subsystem    Total, ms   Averg, ms   Peak, ms   %% of tic\n");
+		Printf(TEXTCOLOR_YELLOW "----------  ----------  ----------  ---------  --------\n");
+		for (int c = 0; c < NUM_BENCH_COLUMNS; c++)
+		{
+			double share = summary[BENCH_Total].total > 0 ? summary[c].total / summary[BENCH_Total].total * 100.0 : 0;
+			Printf("%-10s  %10.3f  %10.4f  %9.4f  %7.2f%%\n", BenchColumnNames[c], summary[c].total, summary[c].total / numtics, summary[c].peak, share);
+		}
+
+		if (csvname.IsNotEmpty())
+		{
+			std::unique_ptr<FileWriter> writer(FileWriter::Open(csvname.GetChars()));
+			if (!writer)
+			{
+				Printf("Could not open %s for writing\n", csvname.GetChars());
+			}
+			else
+			{
+				writer->Printf("tic");
+				for (int c = 0; c < NUM_BENCH_COLUMNS; c++)
+					writer->Printf(",%s_ms", BenchColumnNames[c]);
+				writer->Printf("\n");
+
+				for (unsigned i = 0; i < numtics; i++)
+				{
+					writer->Printf("%u", i);
+					for (int c = 0; c < NUM_BENCH_COLUMNS; c++)
+						writer->Printf(",%.6f", tics[i].ms[c]);
+					writer->Printf("\n");
+				}
+			}
+		}
+
+		if (jsonname.IsNotEmpty())
+		{
+			std::unique_ptr<FileWriter> writer(FileWriter::Open(jsonname.GetChars()));
+			if (!writer)
+			{
+				Printf("Could not open %s for writing\n", jsonname.GetChars());
+			}
+			else
+			{
+				writer->Printf("{\n");
+				writer->Printf("\t\"demo\": \"%s\",\n", JsonEscape(demoname).GetChars());
+				writer->Printf("\t\"map\": \"%s\",\n", JsonEscape(primaryLevel->MapName).GetChars());
+				writer->Printf("\t\"tics\": %u,\n", numtics);
+				writer->Printf("\t\"wall_sec\": %.6f,\n", wallsec);
+				writer->Printf("\t\"tics_per_sec\": %.3f,\n", ticspersec);
+				writer->Printf("\t\"subsystems\": {\n");
+				for (int c = 0; c < NUM_BENCH_COLUMNS; c++)
+				{
+					writer->Printf("\t\t\"%s\": { \"total_ms\": %.6f, \"avg_ms\": %.6f, \"peak_ms\": %.6f }%s\n",
+						BenchColumnNames[c], summary[c].total, summary[c].total / numtics, summary[c].peak,
+						c + 1 < NUM_BENCH_COLUMNS ? "," : "");
+				}
+				writer->Printf("\t}\n");
+				writer->Printf("}\n");
+			}
+		}
+	});
+}
+
+void BenchmarkTimedemoCmdlet::OnPrintHelp()
+{
+	Printf(TEXTCOLOR_ORANGE "bench timedemo " TEXTCOLOR_CYAN "<demo> [map name] [-csv <file>] [-json <file>]" TEXTCOLOR_NORMAL " - Plays back a demo without drawing and reports playsim time per subsystem\n");
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+BenchmarkDrawersCmdlet::BenchmarkDrawersCmdlet()
+{
+	SetLongFormName("drawers");
+	SetShortDescription("Time the truecolor software renderer drawers");
+}
+
+void BenchmarkDrawersCmdlet::OnCommand(FArgs args)
+{
+	FString passesarg = args.CheckValue("-passes");
+	int passes = passesarg.IsNotEmpty() ? clamp((int)passesarg.ToLong(), 1, 100000) : 100;
+
+	RunInGame([&]() {
+		R_BenchmarkTruecolorDrawers(passes);
+	});
+}
+
+void BenchmarkDrawersCmdlet::OnPrintHelp()
+{
+	Printf(TEXTCOLOR_ORANGE "bench drawers " TEXTCOLOR_CYAN "[-passes <count>]" TEXTCOLOR_NORMAL " - Times the SSE2 and AVX2 wall, span and sprite drawers against each other\n");
+}
@@ -0,0 +1,26 @@
+
+#pragma once
+
+#include "commandlet.h"
+
+class BenchmarkCmdletGroup : public CommandletGroup
+{
+public:
+	BenchmarkCmdletGroup();
+};
+
+class BenchmarkTimedemoCmdlet : public Commandlet
+{
+public:
+	BenchmarkTimedemoCmdlet();
+	void OnCommand(FArgs args) override;
+	void OnPrintHelp() override;
+};
+
+class BenchmarkDrawersCmdlet : public Commandlet
+{
+public:
+	BenchmarkDrawersCmdlet();
+	void OnCommand(FArgs args) override;
+	void OnPrintHelp() override;
+};
@@ -1,6 +1,7 @@
 
 #include "commandlet.h"
 #include "lightmapcmd.h"
+#include "benchmarkcmd.h"
 #include "version.h"
 #include "v_draw.h"
 #include "v_video.h"
@@ -63,6 +64,7 @@ void CommandletGroup::AddCommand(std::unique_ptr<Commandlet> command)
 RootCommandlet::RootCommandlet()
 {
 	AddGroup<LightmapCmdletGroup>();
+	AddGroup<BenchmarkCmdletGroup>();
 }
 
 void RootCommandlet::RunEngineCommand()
@@ -48,6 +48,7 @@
 #include "zstring.h"
 #include "name.h"
 #include <inttypes.h>
+#include <mutex>
 #include "filesystem.h"
 
 // MACROS ------------------------------------------------------------------
@@ -1325,6 +1326,10 @@ void FScriptPosition::Message (int severity, const char *message, ...) const
 	const char *color;
 	int level = PRINT_HIGH;
 
+	// The code generator may report problems from several threads at once.
+	static std::mutex MessageMutex;
+	std::lock_guard<std::mutex> lock(MessageMutex);
+
 	switch (severity)
 	{
 	default:
@@ -118,6 +118,154 @@ const char *UnicodeToString(const char *cc)
 	return &out[0];
 }
 
+//==========================================================================
+//
+// Binary savegame reader
+//
+// Rebuilds the same document the JSON parser would have produced for the
+// data, so that everything else in here does not need to care.
+//
+//==========================================================================
+
+bool IsBinarySave(const char *buffer, size_t length)
+{
+	return length > sizeof(BinarySaveMagic) && !memcmp(buffer, BinarySaveMagic, sizeof(BinarySaveMagic));
+}
+
+class FBinaryReader
+{
+public:
+	FBinaryReader(rapidjson::Document &doc, TArray<FString> &keys, const uint8_t *data, size_t length)
+		: Allocator(doc.GetAllocator()), Keys(keys), Pos(data), End(data + length)
+	{
+	}
+
+	bool ReadValue(rapidjson::Value &value)
+	{
+		uint64_t v;
+
+		if (Pos >= End) return false;
+		switch (*Pos++)
+		{
+		case BT_Null:
+			value.SetNull();
+			return true;
+
+		case BT_False:
+			value.SetBool(false);
+			return true;
+
+		case BT_True:
+			value.SetBool(true);
+			return true;
+
+		case BT_Int:
+			if (!ReadVarint(v)) return false;
+			value.SetInt64(int64_t(v >> 1) ^ -int64_t(v & 1));
+			return true;
+
+		case BT_Uint:
+			if (!ReadVarint(v)) return false;
+			value.SetUint64(v);
+			return true;
+
+		case BT_Double:
+		{
+			if (End - Pos < 8) return false;
+			uint64_t bits = 0;
+			for (int i = 7; i >= 0; i--)
+			{
+				bits = (bits << 8) | Pos[i];
+			}
+			Pos += 8;
+			double d;
+			memcpy(&d, &bits, sizeof(d));
+			value.SetDouble(d);
+			return true;
+		}
+
+		case BT_String:
+			if (!ReadVarint(v) || uint64_t(End - Pos) < v) return false;
+			value.SetString((const char *)Pos, (rapidjson::SizeType)v, Allocator);
+			Pos += v;
+			return true;
+
+		case BT_Object:
+			value.SetObject();
+			while (true)
+			{
+				if (!ReadVarint(v)) return false;
+				if (v == 0) return true;
+				if (v == Keys.Size() + 1)
+				{
+					uint64_t len;
+					if (!ReadVarint(len) || uint64_t(End - Pos) < len) return false;
+					Keys.Push(FString((const char *)Pos, (size_t)len));
+					Pos += len;
+				}
+				else if (v > Keys.Size())
+				{
+					return false;
+				}
+
+				// The document only references the key, the reader owns it.
+				const FString &key = Keys[unsigned(v - 1)];
+				rapidjson::Value name(rapidjson::StringRef(key.GetChars(), (rapidjson::SizeType)key.Len()));
+				rapidjson::Value member;
+				if (!ReadValue(member)) return false;
+				value.AddMember(name, member, Allocator);
+			}
+
+		case BT_Array:
+			value.SetArray();
+			while (true)
+			{
+				if (Pos >= End) return false;
+				if (*Pos == BT_End)
+				{
+					Pos++;
+					return true;
+				}
+				rapidjson::Value element;
+				if (!ReadValue(element)) return false;
+				value.PushBack(element, Allocator);
+			}
+
+		default:
+			return false;
+		}
+	}
+
+private:
+	bool ReadVarint(uint64_t &v)
+	{
+		v = 0;
+		for (int shift = 0; shift < 64 && Pos < End; shift += 7)
+		{
+			uint8_t b = *Pos++;
+			v |= uint64_t(b & 0x7f) << shift;
+			if (!(b & 0x80)) return true;
+		}
+		return false;
+	}
+
+	rapidjson::Document::AllocatorType &Allocator;
+	TArray<FString> &Keys;
+	const uint8_t *Pos;
+	const uint8_t *End;
+};
+
+bool ReadBinarySave(rapidjson::Document &doc, TArray<FString> &keys, const char *buffer, size_t length)
+{
+	if (!IsBinarySave(buffer, length) || (uint8_t)buffer[sizeof(BinarySaveMagic)] != BinarySaveVersion)
+	{
+		return false;
+	}
+	size_t header = sizeof(BinarySaveMagic) + 1;
+	FBinaryReader reader(doc, keys, (const uint8_t *)buffer + header, length - header);
+	return reader.ReadValue(doc);
+}
+
 //==========================================================================
 //
 //
@@ -134,6 +282,23 @@ bool FSerializer::OpenWriter(bool pretty)
 	return true;
 }
 
+//==========================================================================
+//
+// Writes the compact binary format instead of JSON. Readers detect
+// which of the two they got.
+//
+//==========================================================================
+
+bool FSerializer::OpenBinaryWriter()
+{
+	if (w != nullptr || r != nullptr) return false;
+
+	mErrors = 0;
+	w = new FWriter(false, true);
+	BeginObject(nullptr);
+	return true;
+}
+
 //==========================================================================
 //
 //
@@ -774,9 +939,9 @@ const char *FSerializer::GetOutput(unsigned *len)
 	EndObject();
 	if (len != nullptr)
 	{
-		*len = (unsigned)w->mOutString.GetSize();
+		*len = (unsigned)w->GetOutputSize();
 	}
-	return w->mOutString.GetString();
+	return w->GetOutput();
 }
 
 //==========================================================================
@@ -792,15 +957,15 @@ FCompressedBuffer FSerializer::GetCompressedOutput()
 	WriteObjects();
 	EndObject();
 	buff.filename = nullptr;
-	buff.mSize = (unsigned)w->mOutString.GetSize();
-	buff.mCRC32 = crc32(0, (const Bytef*)w->mOutString.GetString(), buff.mSize);
+	buff.mSize = (unsigned)w->GetOutputSize();
+	buff.mCRC32 = crc32(0, (const Bytef*)w->GetOutput(), buff.mSize);
 
 	uint8_t *compressbuf = new uint8_t[buff.mSize+1];
 
 	z_stream stream;
 	int err;
 
-	stream.next_in = (Bytef *)w->mOutString.GetString();
+	stream.next_in = (Bytef *)w->GetOutput();
 	stream.avail_in = (unsigned)buff.mSize;
 	stream.next_out = (Bytef*)compressbuf;
 	stream.avail_out = (unsigned)buff.mSize;
@@ -834,7 +999,8 @@ FCompressedBuffer FSerializer::GetCompressedOutput()
 	}
 
 error:
-	memcpy(compressbuf, w->mOutString.GetString(), buff.mSize + 1);
+	memcpy(compressbuf, w->GetOutput(), buff.mSize);
+	compressbuf[buff.mSize] = 0;
 	buff.mCompressedSize = buff.mSize;
 	buff.mMethod = METHOD_STORED;
 	return buff;
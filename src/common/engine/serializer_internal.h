@@ -1,4 +1,7 @@
 #pragma once
+#include <string_view>
+#include <unordered_map>
+
 const char* UnicodeToString(const char* cc);
 const char* StringToUnicode(const char* cc, int size = -1);
 
@@ -25,6 +28,127 @@ struct FJSONObject
 	}
 };
 
+//==========================================================================
+//
+// Binary savegame format
+//
+// This stores the same tree of values a JSON savegame consists of, so that
+// the reader can work on both with the same code. Every value is a tag byte
+// followed by its data. Integers are stored as LEB128 varints, doubles as
+// their 8 raw bytes.
+//
+// An object's members are a varint key reference followed by the value and
+// a 0 ends the object. A reference of n refers to the (n-1)-th key that was
+// defined in the file. If it is one past the last defined key a new key
+// follows as a varint length and its characters. Arrays are a list of values
+// ended by BT_End.
+//
+//==========================================================================
+
+enum EBinaryTag : uint8_t
+{
+	BT_Null,
+	BT_False,
+	BT_True,
+	BT_Int,			// zigzag encoded varint
+	BT_Uint,		// varint
+	BT_Double,
+	BT_String,		// varint length, characters
+	BT_Object,
+	BT_Array,
+	BT_End
+};
+
+static const char BinarySaveMagic[4] = { 'Z', 'B', 'S', 'V' };
+static const uint8_t BinarySaveVersion = 1;
+
+bool IsBinarySave(const char *buffer, size_t length);
+bool ReadBinarySave(rapidjson::Document &doc, TArray<FString> &keys, const char *buffer, size_t length);
+
+struct FBinaryWriter
+{
+	TArray<uint8_t> mOut;
+	TArray<FString> mKeys;
+	std::unordered_map<std::string_view, uint32_t> mKeyMap;
+
+	FBinaryWriter()
+	{
+		Bytes(BinarySaveMagic, sizeof(BinarySaveMagic));
+		mOut.Push(BinarySaveVersion);
+	}
+
+	void Bytes(const void *data, size_t len)
+	{
+		unsigned pos = mOut.Reserve((unsigned)len);
+		memcpy(mOut.Data() + pos, data, len);
+	}
+
+	void Varint(uint64_t v)
+	{
+		while (v >= 0x80)
+		{
+			mOut.Push(uint8_t(v | 0x80));
+			v >>= 7;
+		}
+		mOut.Push(uint8_t(v));
+	}
+
+	void StartObject() { mOut.Push(BT_Object); }
+	void EndObject() { mOut.Push(0); }
+	void StartArray() { mOut.Push(BT_Array); }
+	void EndArray() { mOut.Push(BT_End); }
+	void Null() { mOut.Push(BT_Null); }
+	void Bool(bool k) { mOut.Push(k ? BT_True : BT_False); }
+
+	void Key(const char *k)
+	{
+		std::string_view key(k);
+		auto it = mKeyMap.find(key);
+		if (it != mKeyMap.end())
+		{
+			Varint(it->second + 1);
+			return;
+		}
+
+		// The map's keys must point to storage that lives as long as the writer.
+		uint32_t index = mKeys.Push(FString(k, key.size()));
+		mKeyMap.emplace(std::string_view(mKeys[index].GetChars(), key.size()), index);
+		Varint(index + 1);
+		Varint(key.size());
+		Bytes(k, key.size());
+	}
+
+	void String(const char *k, size_t len)
+	{
+		mOut.Push(BT_String);
+		Varint(len);
+		Bytes(k, len);
+	}
+
+	void Int64(int64_t k)
+	{
+		mOut.Push(BT_Int);
+		Varint((uint64_t(k) << 1) ^ uint64_t(k >> 63));
+	}
+
+	void Uint64(uint64_t k)
+	{
+		mOut.Push(BT_Uint);
+		Varint(k);
+	}
+
+	void Double(double k)
+	{
+		uint64_t bits;
+		memcpy(&bits, &k, sizeof(bits));
+		mOut.Push(BT_Double);
+		for (int i = 0; i < 8; i++, bits >>= 8)
+		{
+			mOut.Push(uint8_t(bits));
+		}
+	}
+};
+
 //==========================================================================
 //
 // some wrapper stuff to keep the RapidJSON dependencies out of the global headers.
@@ -39,21 +163,27 @@ struct FWriter
 
 	Writer *mWriter1;
 	PrettyWriter *mWriter2;
+	FBinaryWriter *mWriter3;
 	TArray<bool> mInObject;
 	rapidjson::StringBuffer mOutString;
 	TArray<DObject *> mDObjects;
 	TMap<DObject *, int> mObjectMap;
 
-	FWriter(bool pretty)
+	FWriter(bool pretty, bool binary = false)
 	{
-		if (!pretty)
+		mWriter1 = nullptr;
+		mWriter2 = nullptr;
+		mWriter3 = nullptr;
+		if (binary)
+		{
+			mWriter3 = new FBinaryWriter;
+		}
+		else if (!pretty)
 		{
 			mWriter1 = new Writer(mOutString);
-			mWriter2 = nullptr;
 		}
 		else
 		{
-			mWriter1 = nullptr;
 			mWriter2 = new PrettyWriter(mOutString);
 		}
 	}
@@ -62,6 +192,19 @@ struct FWriter
 	{
 		if (mWriter1) delete mWriter1;
 		if (mWriter2) delete mWriter2;
+		if (mWriter3) delete mWriter3;
+	}
+
+	const char *GetOutput() const
+	{
+		if (mWriter3) return (const char *)mWriter3->mOut.Data();
+		return mOutString.GetString();
+	}
+
+	size_t GetOutputSize() const
+	{
+		if (mWriter3) return mWriter3->mOut.Size();
+		return mOutString.GetSize();
 	}
 
 
@@ -74,36 +217,42 @@ struct FWriter
 	{
 		if (mWriter1) mWriter1->StartObject();
 		else if (mWriter2) mWriter2->StartObject();
+		else if (mWriter3) mWriter3->StartObject();
 	}
 
 	void EndObject()
 	{
 		if (mWriter1) mWriter1->EndObject();
 		else if (mWriter2) mWriter2->EndObject();
+		else if (mWriter3) mWriter3->EndObject();
 	}
 
 	void StartArray()
 	{
 		if (mWriter1) mWriter1->StartArray();
 		else if (mWriter2) mWriter2->StartArray();
+		else if (mWriter3) mWriter3->StartArray();
 	}
 
 	void EndArray()
 	{
 		if (mWriter1) mWriter1->EndArray();
 		else if (mWriter2) mWriter2->EndArray();
+		else if (mWriter3) mWriter3->EndArray();
 	}
 
 	void Key(const char *k)
 	{
 		if (mWriter1) mWriter1->Key(k);
 		else if (mWriter2) mWriter2->Key(k);
+		else if (mWriter3) mWriter3->Key(k);
 	}
 
 	void Null()
 	{
 		if (mWriter1) mWriter1->Null();
 		else if (mWriter2) mWriter2->Null();
+		else if (mWriter3) mWriter3->Null();
 	}
 
 	void StringU(const char *k, bool encode)
@@ -111,6 +260,7 @@ struct FWriter
 		if (encode) k = StringToUnicode(k);
 		if (mWriter1) mWriter1->String(k);
 		else if (mWriter2) mWriter2->String(k);
+		else if (mWriter3) mWriter3->String(k, strlen(k));
 	}
 
 	void String(const char *k)
@@ -118,6 +268,7 @@ struct FWriter
 		k = StringToUnicode(k);
 		if (mWriter1) mWriter1->String(k);
 		else if (mWriter2) mWriter2->String(k);
+		else if (mWriter3) mWriter3->String(k, strlen(k));
 	}
 
 	void String(const char *k, int size)
@@ -125,36 +276,42 @@ struct FWriter
 		k = StringToUnicode(k, size);
 		if (mWriter1) mWriter1->String(k);
 		else if (mWriter2) mWriter2->String(k);
+		else if (mWriter3) mWriter3->String(k, strlen(k));
 	}
 
 	void Bool(bool k)
 	{
 		if (mWriter1) mWriter1->Bool(k);
 		else if (mWriter2) mWriter2->Bool(k);
+		else if (mWriter3) mWriter3->Bool(k);
 	}
 
 	void Int(int32_t k)
 	{
 		if (mWriter1) mWriter1->Int(k);
 		else if (mWriter2) mWriter2->Int(k);
+		else if (mWriter3) mWriter3->Int64(k);
 	}
 
 	void Int64(int64_t k)
 	{
 		if (mWriter1) mWriter1->Int64(k);
 		else if (mWriter2) mWriter2->Int64(k);
+		else if (mWriter3) mWriter3->Int64(k);
 	}
 
 	void Uint(uint32_t k)
 	{
 		if (mWriter1) mWriter1->Uint(k);
 		else if (mWriter2) mWriter2->Uint(k);
+		else if (mWriter3) mWriter3->Uint64(k);
 	}
 
 	void Uint64(int64_t k)
 	{
 		if (mWriter1) mWriter1->Uint64(k);
 		else if (mWriter2) mWriter2->Uint64(k);
+		else if (mWriter3) mWriter3->Uint64(k);
 	}
 
 	void Double(double k)
@@ -167,6 +324,10 @@ struct FWriter
 		{
 			mWriter2->Double(k);
 		}
+		else if (mWriter3)
+		{
+			mWriter3->Double(k);
+		}
 	}
 
 };
@@ -180,6 +341,7 @@ struct FWriter
 struct FReader
 {
 	TArray<FJSONObject> mObjects;
+	TArray<FString> mKeys;		// member names of a binary savegame, referenced by mDoc
 	rapidjson::Document mDoc;
 	TArray<DObject *> mDObjects;
 	rapidjson::Value *mKeyValue = nullptr;
@@ -187,7 +349,17 @@ struct FReader
 
 	FReader(const char *buffer, size_t length)
 	{
-		mDoc.Parse(buffer, length);
+		if (IsBinarySave(buffer, length))
+		{
+			if (!ReadBinarySave(mDoc, mKeys, buffer, length))
+			{
+				mDoc.SetNull();
+			}
+		}
+		else
+		{
+			mDoc.Parse(buffer, length);
+		}
 		mObjects.Push(FJSONObject(&mDoc));
 	}
 
@@ -42,6 +42,7 @@
 #include <stdarg.h>
 #include <string.h>
 #include <functional>
+#include <memory>
 #include <vector>
 #include "fs_swap.h"
 
@@ -74,11 +75,13 @@ public:
 class FileReader;
 
 // an opaque memory buffer to the file's content. Can either own the memory or just point to an external buffer.
+// An external buffer can have an owner attached that keeps it alive for as long as the FileData references it, e.g. a file mapping.
 class FileData
 {
 	void* memory;
 	size_t length;
 	bool owned;
+	std::shared_ptr<void> keepalive;
 
 public:
 	using value_type = uint8_t;
@@ -99,6 +102,13 @@ public:
 			owned = false;
 		}
 	}
+	FileData(const void* memory_, size_t len, std::shared_ptr<void> owner)
+	{
+		memory = (void*)memory_;
+		length = len;
+		owned = false;
+		keepalive = std::move(owner);
+	}
 	uint8_t* writable() const { return owned? (uint8_t*)memory : nullptr; }
 	const void* data() const { return memory; }
 	size_t size() const { return length; }
@@ -110,6 +120,7 @@ public:
 		if (owned && memory) free(memory);
 		length = copy.length;
 		owned = copy.owned;
+		keepalive = copy.keepalive;
 		if (owned)
 		{
 			memory = malloc(length);
@@ -125,6 +136,7 @@ public:
 		length = copy.length;
 		owned = copy.owned;
 		memory = copy.memory;
+		keepalive = std::move(copy.keepalive);
 		copy.memory = nullptr;
 		copy.length = 0;
 		copy.owned = true;
@@ -134,6 +146,7 @@ public:
 	FileData(const FileData& copy)
 	{
 		memory = nullptr;
+		owned = false;
 		*this = copy;
 	}
 
@@ -145,6 +158,7 @@ public:
 	void* allocate(size_t len)
 	{
 		if (!owned) memory = nullptr;
+		keepalive.reset();
 		length = len;
 		owned = true;
 		memory = realloc(memory, length);
@@ -156,6 +170,7 @@ public:
 		memory = (void*)mem;
 		length = len;
 		owned = false;
+		keepalive.reset();
 	}
 
 	void clear()
@@ -164,6 +179,7 @@ public:
 		memory = nullptr;
 		length = 0;
 		owned = true;
+		keepalive.reset();
 	}
 
 };
@@ -179,6 +195,7 @@ public:
 	virtual ptrdiff_t Read (void *buffer, ptrdiff_t len) = 0;
 	virtual char *Gets(char *strbuf, ptrdiff_t len) = 0;
 	virtual const char *GetBuffer() const { return nullptr; }
+	virtual std::shared_ptr<void> GetBufferOwner() const { return nullptr; }
 	ptrdiff_t GetLength () const { return Length; }
 };
 
@@ -247,6 +264,7 @@ public:
 	}
 
 	bool OpenFile(const char *filename, Size start = 0, Size length = -1, bool buffered = false);
+	bool OpenFileMapped(const char *filename, Size start = 0, Size length = -1);	// maps the file into memory, fails if that is not possible
 	bool OpenFilePart(FileReader &parent, Size start, Size length);
 	bool OpenMemory(const void *mem, Size length);	// read directly from the buffer
 	bool OpenMemoryArray(FileData& data);	// take the given array
@@ -285,6 +303,12 @@ public:
 		return mReader->GetBuffer();
 	}
 
+	// For readers whose buffer is owned by something else than the reader, returns that owner.
+	std::shared_ptr<void> GetBufferOwner()
+	{
+		return mReader->GetBufferOwner();
+	}
+
 	Size GetLength() const
 	{
 		return mReader->GetLength();
@@ -10,6 +10,7 @@
 
 #include "fs_files.h"
 #include "resourcefile.h"
+#include <memory>
 #include <mutex>
 
 namespace FileSys {
@@ -29,6 +30,20 @@ struct FolderEntry
 	unsigned lumpnum;
 };
 
+struct FLumpCacheStats
+{
+	size_t Hits;
+	size_t Misses;
+	size_t Prefetched;	// lumps that were decompressed by the worker thread
+	size_t Evicted;
+	size_t Entries;
+	size_t Queued;
+	size_t Used;
+	size_t Budget;
+};
+
+class LumpCache;
+
 class FileSystem
 {
 public:
@@ -147,6 +162,12 @@ public:
 	FileReader* GetFileReader(int wadnum);	// Gets a FileReader object to the entire WAD
 	void InitHashChains();
 
+	// Cache for decompressed lumps. The cache is off until it gets a budget.
+	void SetCacheBudget(size_t bytes);
+	void PrefetchFile(int lump);	// decompresses the lump on a worker thread so that it is ready when needed.
+	FLumpCacheStats GetCacheStats();
+	void ResetCacheStats();
+
 private:
 
 	struct LumpRecord;
@@ -174,11 +195,17 @@ private:
 
 	int IwadIndex = -1;
 	int MaxIwadIndex = -1;
+	int NextSkinNamespace = ns_firstskin;
 
 	StringPool* stringpool = nullptr;
+	std::unique_ptr<LumpCache> Cache;
 
 	void DeleteAll();
 	void MoveLumpsInFolder(const char *);
+	static FResourceFile *OpenContainer(const char *filename, FileReader *filer, LumpFilterInfo* filter, FileSystemMessageFunc Printf, StringPool* sp);
+	void AddResourceFile(const char *filename, FResourceFile *resfile, double ms, LumpFilterInfo* filter, FileSystemMessageFunc Printf);
+	bool IsCacheable(int lump);
+	std::shared_ptr<FileData> ReadForCache(int lump);
 
 };
 
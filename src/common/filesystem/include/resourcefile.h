@@ -110,6 +110,18 @@ struct FResourceEntry
 
 void SetMainThread();
 
+// Bytes of lump data handed out by FResourceFile::Read so far, split by whether they
+// are a view into a file mapping or memory buffer, had to be copied, or had to be decompressed.
+struct FReadStats
+{
+	size_t Mapped;
+	size_t Copied;
+	size_t Decompressed;
+};
+
+FReadStats GetReadStats();
+void CountMappedRead(size_t length);
+
 class FResourceFile
 {
 public:
@@ -172,6 +184,14 @@ public:
 	// default is the safest reader type.
 	virtual FileReader GetEntryReader(uint32_t entry, int readertype = READER_NEW, int flags = READERFLAG_SEEKABLE);
 
+	// Reads the local header of entries whose data position is not known yet.
+	// This uses the shared reader, so it may only be called on the main thread.
+	void ResolveEntryAddress(uint32_t entry)
+	{
+		if (entry < NumLumps && (Entries[entry].Flags & RESFF_NEEDFILESTART))
+			SetEntryAddress(entry);
+	}
+
 	int GetEntryFlags(uint32_t entry)
 	{
 		return (entry < NumLumps) ? Entries[entry].Flags : 0;
@@ -63,8 +63,12 @@ public:
 	FDirectory(const char * dirname, StringPool* sp, bool nosubdirflag = false);
 	bool Open(LumpFilterInfo* filter, FileSystemMessageFunc Printf);
 	FileReader GetEntryReader(uint32_t entry, int, int) override;
+	FileData Read(uint32_t entry) override;
 };
 
+// Smaller files are read normally because mapping them costs more than copying.
+static const size_t MinMappedSize = 65536;
+
 
 
 //==========================================================================
@@ -187,6 +191,29 @@ FileReader FDirectory::GetEntryReader(uint32_t entry, int readertype, int)
 	return fr;
 }
 
+//==========================================================================
+//
+// Large files are returned as a view into a mapping of the file.
+//
+//==========================================================================
+
+FileData FDirectory::Read(uint32_t entry)
+{
+	if (entry < NumLumps && Entries[entry].Length >= MinMappedSize)
+	{
+		std::string fn = mBasePath;
+		fn += SystemFilePath[Entries[entry].Position];
+
+		FileReader fr;
+		if (fr.OpenFileMapped(fn.c_str()))
+		{
+			CountMappedRead(fr.GetLength());
+			return FileData(fr.GetBuffer(), fr.GetLength(), fr.GetBufferOwner());
+		}
+	}
+	return FResourceFile::Read(entry);
+}
+
 //==========================================================================
 //
 // File open
@@ -34,6 +34,7 @@
 */
 
 #include <ctype.h>
+#include <atomic>
 #include "resourcefile.h"
 #include "fs_filesystem.h"
 #include "fs_swap.h"
@@ -349,7 +350,8 @@ void FWadFile::SetNamespace(const char *startmarker, const char *endmarker, name
 void FWadFile::SkinHack (FileSystemMessageFunc Printf)
 {
 	// this being static is not a problem. The only relevant thing is that each skin gets a different number.
-	static int namespc = ns_firstskin;
+	// Wads may be opened on several threads at once, the file system renumbers these in load order.
+	static std::atomic<int> namespc = ns_firstskin;
 	bool skinned = false;
 	bool hasmap = false;
 	uint32_t i;
@@ -364,13 +366,13 @@ void FWadFile::SkinHack (FileSystemMessageFunc Printf)
 			if (!skinned)
 			{
 				skinned = true;
+				int skinnamespc = namespc++;
 				uint32_t j;
 
 				for (j = 0; j < NumLumps; j++)
 				{
-					Entries[j].Namespace = namespc;
+					Entries[j].Namespace = skinnamespc;
 				}
-				namespc++;
 			}
 		}
 		// needless to say, this check is entirely useless these days as map names can be more diverse..
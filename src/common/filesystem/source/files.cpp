@@ -40,6 +40,18 @@
 #include <string.h>
 #include "files_internal.h"
 
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace FileSys {
 	
 #ifdef _WIN32
@@ -171,6 +183,100 @@ private:
 	}
 };
 
+//==========================================================================
+//
+// FileMapping
+//
+// A read-only view of an entire file. The pages are mapped copy-on-write so
+// that code that modifies the buffer it was given cannot affect the file.
+//
+//==========================================================================
+
+class FileMapping
+{
+	const char* Memory = nullptr;
+	size_t Size = 0;
+
+	FileMapping(const char* memory, size_t size) : Memory(memory), Size(size) {}
+
+public:
+	FileMapping(const FileMapping&) = delete;
+	FileMapping& operator=(const FileMapping&) = delete;
+
+	~FileMapping()
+	{
+#ifdef _WIN32
+		UnmapViewOfFile(Memory);
+#else
+		munmap((void*)Memory, Size);
+#endif
+	}
+
+	const char* Data() const { return Memory; }
+	size_t GetSize() const { return Size; }
+
+	static std::shared_ptr<FileMapping> Open(const char* filename)
+	{
+#ifdef _WIN32
+		auto widename = toWide(filename);
+		HANDLE file = CreateFileW(widename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE) return nullptr;
+
+		LARGE_INTEGER size;
+		void* memory = nullptr;
+		if (GetFileSizeEx(file, &size) && size.QuadPart > 0 && (uint64_t)size.QuadPart <= SIZE_MAX)
+		{
+			HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+			if (mapping != nullptr)
+			{
+				memory = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+				CloseHandle(mapping);	// the view keeps the mapping alive.
+			}
+		}
+		CloseHandle(file);
+		if (memory == nullptr) return nullptr;
+		return std::shared_ptr<FileMapping>(new FileMapping((const char*)memory, (size_t)size.QuadPart));
+#else
+		int fd = open(filename, O_RDONLY);
+		if (fd < 0) return nullptr;
+
+		struct stat info;
+		void* memory = MAP_FAILED;
+		if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0 && (uint64_t)info.st_size <= SIZE_MAX)
+		{
+			memory = mmap(nullptr, (size_t)info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+		}
+		close(fd);	// the mapping stays valid after the descriptor is closed.
+		if (memory == MAP_FAILED) return nullptr;
+		return std::shared_ptr<FileMapping>(new FileMapping((const char*)memory, (size_t)info.st_size));
+#endif
+	}
+};
+
+//==========================================================================
+//
+// MappedFileReader
+//
+// reads data from a file mapping or part of it.
+//
+//==========================================================================
+
+class MappedFileReader : public MemoryReader
+{
+	std::shared_ptr<FileMapping> Mapping;
+
+public:
+	MappedFileReader(std::shared_ptr<FileMapping> mapping, ptrdiff_t start, ptrdiff_t length)
+		: MemoryReader(mapping->Data() + start, length), Mapping(std::move(mapping))
+	{
+	}
+
+	std::shared_ptr<void> GetBufferOwner() const override
+	{
+		return Mapping;
+	}
+};
+
 //==========================================================================
 //
 // FileReaderRedirect
@@ -380,6 +486,20 @@ bool FileReader::OpenFile(const char *filename, FileReader::Size start, FileRead
 	return true;
 }
 
+bool FileReader::OpenFileMapped(const char *filename, FileReader::Size start, FileReader::Size length)
+{
+	auto mapping = FileMapping::Open(filename);
+	if (mapping == nullptr) return false;
+
+	ptrdiff_t size = (ptrdiff_t)mapping->GetSize();
+	if (start < 0 || start > size) return false;
+	if (length < 0 || length > size - start) length = size - start;
+
+	Close();
+	mReader = new MappedFileReader(std::move(mapping), start, length);
+	return true;
+}
+
 bool FileReader::OpenFilePart(FileReader &parent, FileReader::Size start, FileReader::Size length)
 {
 	auto reader = new FileReaderRedirect(parent, start, length);
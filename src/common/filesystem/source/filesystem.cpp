@@ -41,12 +41,20 @@
 #include <ctype.h>
 #include <string.h>
 #include <inttypes.h>
+#include <stdarg.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <thread>
 
 #include "resourcefile.h"
 #include "fs_filesystem.h"
 #include "fs_findfile.h"
 #include "md5.hpp"
 #include "fs_stringpool.h"
+#include "fs_lumpcache.h"
 
 namespace FileSys {
 	
@@ -54,6 +62,9 @@ namespace FileSys {
 
 #define NULL_INDEX		(0xffffffff)
 
+// Below this many lumps the hash chains are set up faster on a single thread.
+static const uint32_t MinParallelHashEntries = 16384;
+
 static void UpperCopy(char* to, const char* from)
 {
 	int i;
@@ -193,12 +204,79 @@ struct FileSystem::LumpRecord
 
 static void PrintLastError (FileSystemMessageFunc Printf);
 
+// PRIVATE DATA DEFINITIONS ------------------------------------------------
+
+// Resource files are opened on worker threads at startup. Their messages are
+// collected here and printed in load order once the file gets added.
+struct FBufferedMessage
+{
+	FSMessageLevel Level;
+	std::string Text;
+};
+
+struct FOpenedFile
+{
+	FResourceFile* File = nullptr;
+	double MS = 0;
+	std::vector<FBufferedMessage> Messages;
+	std::exception_ptr Error;
+};
+
+static thread_local std::vector<FBufferedMessage>* MessageBuffer;
+
 // PUBLIC DATA DEFINITIONS -------------------------------------------------
 
 // CODE --------------------------------------------------------------------
 
+static double MSSince(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static int BufferedPrintf(FSMessageLevel level, const char* fmt, ...)
+{
+	va_list ap;
+	va_start(ap, fmt);
+	va_list ap2;
+	va_copy(ap2, ap);
+	int len = vsnprintf(nullptr, 0, fmt, ap);
+	va_end(ap);
+	if (len < 0)
+	{
+		va_end(ap2);
+		return len;
+	}
+	std::string text(len, 0);
+	vsnprintf(&text[0], len + 1, fmt, ap2);
+	va_end(ap2);
+	MessageBuffer->push_back({ level, std::move(text) });
+	return len;
+}
+
+//==========================================================================
+//
+// ParallelFor
+//
+// Calls the worker for consecutive ranges of [0, count) on all cores.
+//
+//==========================================================================
+
+static void ParallelFor(size_t count, const std::function<void(size_t start, size_t end)>& worker)
+{
+	size_t numthreads = std::clamp<size_t>(std::thread::hardware_concurrency(), 1, count);
+	size_t chunk = (count + numthreads - 1) / numthreads;
+	std::vector<std::thread> threads;
+	for (size_t start = chunk; start < count; start += chunk)
+	{
+		threads.emplace_back([=, &worker]() { worker(start, std::min(start + chunk, count)); });
+	}
+	worker(0, std::min(chunk, count));
+	for (auto& thread : threads) thread.join();
+}
+
 FileSystem::FileSystem()
 {
+	Cache.reset(new LumpCache([this](int lump) { return ReadForCache(lump); }));
 }
 
 FileSystem::~FileSystem ()
@@ -210,6 +288,7 @@ void FileSystem::DeleteAll ()
 {
 	std::unique_lock lock(Mutex);
 
+	Cache->Clear();
 	Hashes.clear();
 	NumEntries = 0;
 
@@ -271,9 +350,51 @@ bool FileSystem::InitMultipleFiles (std::vector<std::string>& filenames, LumpFil
 		}
 	}
 
+	NextSkinNamespace = ns_firstskin;
+
+	// Reading the archives' directories is done for all of them at once. They
+	// still get added in load order afterwards, so the result is the same as
+	// if they had been opened one after the other.
+	std::vector<FOpenedFile> opened(filenames.size());
+	std::atomic<size_t> nextfile = 0;
+	auto openfiles = [&](size_t, size_t)
+	{
+		size_t i;
+		while ((i = nextfile++) < filenames.size())
+		{
+			auto start = std::chrono::steady_clock::now();
+			MessageBuffer = &opened[i].Messages;
+			try
+			{
+				opened[i].File = OpenContainer(filenames[i].c_str(), nullptr, filter, Printf ? BufferedPrintf : nullptr, nullptr);
+			}
+			catch (...)
+			{
+				opened[i].Error = std::current_exception();
+			}
+			MessageBuffer = nullptr;
+			opened[i].MS = MSSince(start);
+		}
+	};
+	if (filenames.size() > 1) ParallelFor(filenames.size(), openfiles);
+	else openfiles(0, filenames.size());
+
 	for(size_t i=0;i<filenames.size(); i++)
 	{
-		AddFile(filenames[i].c_str(), nullptr, filter, Printf);
+		if (Printf)
+		{
+			for (auto& message : opened[i].Messages)
+				Printf(message.Level, "%s", message.Text.c_str());
+		}
+		if (opened[i].Error)
+		{
+			for (size_t j = i + 1; j < filenames.size(); j++) delete opened[j].File;
+			std::rethrow_exception(opened[i].Error);
+		}
+		if (opened[i].File != nullptr)
+		{
+			AddResourceFile(filenames[i].c_str(), opened[i].File, opened[i].MS, filter, Printf);
+		}
 
 		if (i == (unsigned)MaxIwadIndex) MoveLumpsInFolder("after_iwad/");
 		std::string path = "filter/%s";
@@ -335,7 +456,27 @@ int FileSystem::AddFromBuffer(const char* name, char* data, int size, int id, in
 void FileSystem::AddFile (const char *filename, FileReader *filer, LumpFilterInfo* filter, FileSystemMessageFunc Printf)
 {
 	std::unique_lock lock(Mutex);
-	int startlump;
+	auto start = std::chrono::steady_clock::now();
+
+	FResourceFile *resfile = OpenContainer(filename, filer, filter, Printf, stringpool);
+	if (resfile != nullptr)
+	{
+		AddResourceFile(filename, resfile, MSSince(start), filter, Printf);
+	}
+}
+
+//==========================================================================
+//
+// OpenContainer
+//
+// Opens a file or directory and reads its directory. This does not touch
+// the file system's state so it can be done for several files at once.
+// If no string pool is given, the resource file gets its own.
+//
+//==========================================================================
+
+FResourceFile *FileSystem::OpenContainer(const char *filename, FileReader *filer, LumpFilterInfo* filter, FileSystemMessageFunc Printf, StringPool* sp)
+{
 	bool isdir = false;
 	FileReader filereader;
 
@@ -349,64 +490,74 @@ void FileSystem::AddFile (const char *filename, FileReader *filer, LumpFilterInf
 				Printf(FSMessageLevel::Error, "%s: File or Directory not found\n", filename);
 				PrintLastError(Printf);
 			}
-			return;
+			return nullptr;
 		}
 
 		if (!isdir)
 		{
-			if (!filereader.OpenFile(filename))
+			// Prefer a mapping of the file so that uncompressed lumps can be used without copying them.
+			if (!filereader.OpenFileMapped(filename) && !filereader.OpenFile(filename))
 			{ // Didn't find file
 				if (Printf)
 				{
 					Printf(FSMessageLevel::Error, "%s: File not found\n", filename);
 					PrintLastError(Printf);
 				}
-				return;
+				return nullptr;
 			}
 		}
 	}
 	else filereader = std::move(*filer);
 
-	startlump = NumEntries;
+	if (!isdir)
+		return FResourceFile::OpenResourceFile(filename, filereader, false, filter, Printf, sp);
+	else
+		return FResourceFile::OpenDirectory(filename, filter, Printf, sp);
+}
 
-	FResourceFile *resfile;
+//==========================================================================
+//
+// AddResourceFile
+//
+// Adds the lumps of an opened resource file to the directory.
+//
+//==========================================================================
 
+void FileSystem::AddResourceFile(const char *filename, FResourceFile *resfile, double ms, LumpFilterInfo* filter, FileSystemMessageFunc Printf)
+{
+	if (Printf)
+		Printf(FSMessageLevel::Message, "adding %s, %d lumps (%.1f ms)\n", filename, resfile->EntryCount(), ms);
 
-	if (!isdir)
-		resfile = FResourceFile::OpenResourceFile(filename, filereader, false, filter, Printf, stringpool);
-	else
-		resfile = FResourceFile::OpenDirectory(filename, filter, Printf, stringpool);
+	uint32_t lumpstart = (uint32_t)FileInfo.size();
+	int skinnamespace = -1;
 
-	if (resfile != NULL)
+	resfile->SetFirstLump(lumpstart);
+	Files.push_back(resfile);
+	for (int i = 0; i < resfile->EntryCount(); i++)
 	{
-		if (Printf) 
-			Printf(FSMessageLevel::Message, "adding %s, %d lumps\n", filename, resfile->EntryCount());
+		FileInfo.resize(FileInfo.size() + 1);
+		FileSystem::LumpRecord* lump_p = &FileInfo.back();
+		lump_p->SetFromLump(resfile, i, (int)Files.size() - 1, stringpool);
 
-		uint32_t lumpstart = (uint32_t)FileInfo.size();
-
-		resfile->SetFirstLump(lumpstart);
-		Files.push_back(resfile);
-		for (int i = 0; i < resfile->EntryCount(); i++)
+		// Skin namespaces are numbered in load order, not in the order the files were opened.
+		if (lump_p->Namespace >= ns_firstskin)
 		{
-			FileInfo.resize(FileInfo.size() + 1);
-			FileSystem::LumpRecord* lump_p = &FileInfo.back();
-			lump_p->SetFromLump(resfile, i, (int)Files.size() - 1, stringpool);
+			if (skinnamespace < 0) skinnamespace = NextSkinNamespace++;
+			lump_p->Namespace = skinnamespace;
 		}
+	}
 
-		for (int i = 0; i < resfile->EntryCount(); i++)
+	for (int i = 0; i < resfile->EntryCount(); i++)
+	{
+		int flags = resfile->GetEntryFlags(i);
+		if (flags & RESFF_EMBEDDED)
 		{
-			int flags = resfile->GetEntryFlags(i);
-			if (flags & RESFF_EMBEDDED)
-			{
-				std::string path = filename;
-				path += ':';
-				path += resfile->getName(i);
-				auto embedded = resfile->GetEntryReader(i, READER_CACHED);
-				AddFile(path.c_str(), &embedded, filter, Printf);
-			}
+			std::string path = filename;
+			path += ':';
+			path += resfile->getName(i);
+			auto embedded = resfile->GetEntryReader(i, READER_CACHED);
+			AddFile(path.c_str(), &embedded, filter, Printf);
 		}
-
-		return;
 	}
 }
 
@@ -805,26 +956,47 @@ void FileSystem::InitHashChains (void)
 	NextLumpIndex_ResId = &Hashes[NumEntries * 7];
 
 
+	// Hashing the names is the expensive part, so that is done on all cores.
+	// The chains are linked afterwards in lump order, exactly as before.
+	std::vector<uint32_t> namehashes(NumEntries * 3);
+	auto hashnames = [&](size_t start, size_t end)
+	{
+		for (size_t i = start; i < end; i++)
+		{
+			uint32_t* h = &namehashes[i * 3];
+			h[0] = MakeHash(FileInfo[i].shortName.String, 8) % NumEntries;
+
+			const char* name = FileInfo[i].LongName;
+			if (name[0] != 0)
+			{
+				h[1] = MakeHash(name) % NumEntries;
+
+				// same as above without the extension
+				const char* dot = strrchr(name, '.');
+				const char* slash = strrchr(name, '/');
+				size_t length = (dot != nullptr && (slash == nullptr || dot > slash)) ? size_t(dot - name) : SIZE_MAX;
+				h[2] = MakeHash(name, length) % NumEntries;
+			}
+		}
+	};
+	if (NumEntries >= MinParallelHashEntries) ParallelFor(NumEntries, hashnames);
+	else hashnames(0, NumEntries);
+
 	// Now set up the chains
 	for (i = 0; i < (unsigned)NumEntries; i++)
 	{
-		j = MakeHash (FileInfo[i].shortName.String, 8) % NumEntries;
+		j = namehashes[i * 3];
 		NextLumpIndex[i] = FirstLumpIndex[j];
 		FirstLumpIndex[j] = i;
 
 		// Do the same for the full paths
 		if (FileInfo[i].LongName[0] != 0)
 		{
-			j = MakeHash(FileInfo[i].LongName) % NumEntries;
+			j = namehashes[i * 3 + 1];
 			NextLumpIndex_FullName[i] = FirstLumpIndex_FullName[j];
 			FirstLumpIndex_FullName[j] = i;
 
-			std::string nameNoExt = FileInfo[i].LongName;
-			auto dot = nameNoExt.find_last_of('.');
-			auto slash = nameNoExt.find_last_of('/');
-			if ((dot > slash || slash == std::string::npos) && dot != std::string::npos) nameNoExt.resize(dot);
-
-			j = MakeHash(nameNoExt.c_str()) % NumEntries;
+			j = namehashes[i * 3 + 2];
 			NextLumpIndex_NoExt[i] = FirstLumpIndex_NoExt[j];
 			FirstLumpIndex_NoExt[j] = i;
 
@@ -1290,6 +1462,16 @@ FileData FileSystem::ReadFile (int lump)
 	{
 		throw FileSystemException("ReadFile: %u >= NumEntries", lump);
 	}
+	if (IsCacheable(lump))
+	{
+		auto data = Cache->Find(lump);
+		if (data == nullptr)
+		{
+			data = std::make_shared<FileData>(FileInfo[lump].resfile->Read(FileInfo[lump].resindex));
+			Cache->Insert(lump, data);
+		}
+		return FileData(data->data(), data->size(), data);
+	}
 	return FileInfo[lump].resfile->Read(FileInfo[lump].resindex);
 }
 
@@ -1310,6 +1492,19 @@ FileReader FileSystem::OpenFileReader(int lump, int readertype, int readerflags)
 		throw FileSystemException("OpenFileReader: %u >= NumEntries", lump);
 	}
 
+	// Readers are often only opened to check a file's header, so a miss here does not put the lump in the cache.
+	if (IsCacheable(lump))
+	{
+		auto data = Cache->Find(lump, false);
+		if (data != nullptr)
+		{
+			FileReader fr;
+			FileData view(data->data(), data->size(), data);
+			fr.OpenMemoryArray(view);
+			return fr;
+		}
+	}
+
 	auto file = FileInfo[lump].resfile;
 	return file->GetEntryReader(FileInfo[lump].resindex, readertype, readerflags);
 }
@@ -1332,6 +1527,91 @@ FileReader FileSystem::ReopenFileReader(const char* name, bool alwayscache)
 	return fr;
 }
 
+//==========================================================================
+//
+// Decompressed lump cache
+//
+// Only compressed lumps are cached. Everything else is either a view into
+// a file mapping already or cheap enough to read.
+//
+//==========================================================================
+
+void FileSystem::SetCacheBudget(size_t bytes)
+{
+	Cache->SetBudget(bytes);
+}
+
+void FileSystem::PrefetchFile(int lump)
+{
+	std::unique_lock lock(Mutex);
+	if (IsCacheable(lump))
+	{
+		// The worker must not touch the archive's shared reader, so the entry's data position has to be known before it gets queued.
+		FileInfo[lump].resfile->ResolveEntryAddress(FileInfo[lump].resindex);
+		Cache->Prefetch(lump);
+	}
+}
+
+FLumpCacheStats FileSystem::GetCacheStats()
+{
+	return Cache->GetStats();
+}
+
+void FileSystem::ResetCacheStats()
+{
+	Cache->ResetStats();
+}
+
+bool FileSystem::IsCacheable(int lump)
+{
+	if ((unsigned)lump >= (unsigned)FileInfo.size())
+		return false;
+
+	auto& li = FileInfo[lump];
+	return (li.resfile->GetEntryFlags(li.resindex) & RESFF_COMPRESSED) && Cache->Accepts(li.resfile->Length(li.resindex));
+}
+
+//==========================================================================
+//
+// ReadForCache
+//
+// Called by the cache's worker thread. Only finding the lump needs the
+// lock, the decompression happens on the worker's own reader. Entries
+// whose position would first have to be read from the shared reader are
+// left to the main thread.
+//
+//==========================================================================
+
+std::shared_ptr<FileData> FileSystem::ReadForCache(int lump)
+{
+	FileReader fr;
+	size_t length;
+	{
+		std::unique_lock lock(Mutex);
+		if (!IsCacheable(lump))
+			return nullptr;
+
+		auto& li = FileInfo[lump];
+		// Archives that only exist in memory, like embedded ones, go away with their resource file, so they must not be read without the lock.
+		auto container = li.resfile->GetContainerReader();
+		if (container != nullptr && container->GetBuffer() != nullptr && container->GetBufferOwner() == nullptr)
+			return nullptr;
+
+		if (li.resfile->GetEntryFlags(li.resindex) & RESFF_NEEDFILESTART)
+			return nullptr;
+
+		length = li.resfile->Length(li.resindex);
+		fr = li.resfile->GetEntryReader(li.resindex, READER_NEW, 0);
+	}
+	if (!fr.isOpen())
+		return nullptr;
+
+	auto data = std::make_shared<FileData>(fr.Read(length));
+	if (data->size() != length)
+		return nullptr;
+	return data;
+}
+
 //==========================================================================
 //
 // GetFileReader
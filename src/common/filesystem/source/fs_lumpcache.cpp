@@ -0,0 +1,234 @@
+/*
+** fs_lumpcache.cpp
+** Cache for decompressed lump data
+**
+**---------------------------------------------------------------------------
+**
+** Compressed lumps from zips and other archives need to be inflated each
+** time they get read. Things like sounds, sprites and models are often only
+** loaded once they are first needed, so doing that in the middle of a level
+** causes noticeable hitches. This cache keeps the decompressed data around
+** and can have it prepared on a worker thread ahead of time.
+**
+*/
+
+#include "fs_lumpcache.h"
+
+namespace FileSys {
+
+// Single lumps larger than this fraction of the budget are not cached so that
+// one large music file cannot push everything else out.
+static const size_t MaxEntryFraction = 4;
+
+//==========================================================================
+//
+// ~LumpCache
+//
+//==========================================================================
+
+LumpCache::~LumpCache()
+{
+	{
+		std::unique_lock lock(Mutex);
+		StopWorker = true;
+		Queue.clear();
+	}
+	WorkAvailable.notify_all();
+	if (Worker.joinable()) Worker.join();
+}
+
+//==========================================================================
+//
+// SetBudget
+//
+// A budget of 0 disables the cache.
+//
+//==========================================================================
+
+void LumpCache::SetBudget(size_t bytes)
+{
+	std::unique_lock lock(Mutex);
+	Budget = bytes;
+	Trim();
+}
+
+bool LumpCache::Accepts(size_t size)
+{
+	std::unique_lock lock(Mutex);
+	return size > 0 && size <= Budget / MaxEntryFraction;
+}
+
+//==========================================================================
+//
+// Find
+//
+//==========================================================================
+
+LumpCache::Buffer LumpCache::Find(int lump, bool countmiss)
+{
+	std::unique_lock lock(Mutex);
+	auto it = Entries.find(lump);
+	if (it == Entries.end())
+	{
+		if (countmiss) Stats.Misses++;
+		return nullptr;
+	}
+	Stats.Hits++;
+	Ages.splice(Ages.begin(), Ages, it->second.Age);
+	return it->second.Data;
+}
+
+//==========================================================================
+//
+// Insert
+//
+//==========================================================================
+
+void LumpCache::Insert(int lump, Buffer data)
+{
+	std::unique_lock lock(Mutex);
+	InsertLocked(lump, std::move(data));
+}
+
+void LumpCache::InsertLocked(int lump, Buffer data)
+{
+	if (data == nullptr || data->size() > Budget / MaxEntryFraction || Entries.count(lump))
+		return;
+
+	Ages.push_front(lump);
+	Entries[lump] = { std::move(data), Ages.begin() };
+	Used += Entries[lump].Data->size();
+	Trim();
+}
+
+//==========================================================================
+//
+// Trim
+//
+// Drops the least recently used lumps until the cache fits its budget.
+// Anyone still holding a reference to the data keeps it alive.
+//
+//==========================================================================
+
+void LumpCache::Trim()
+{
+	while (Used > Budget && !Ages.empty())
+	{
+		auto it = Entries.find(Ages.back());
+		Used -= it->second.Data->size();
+		Entries.erase(it);
+		Ages.pop_back();
+		Stats.Evicted++;
+	}
+}
+
+//==========================================================================
+//
+// Prefetch
+//
+// Queues a lump for the worker thread.
+//
+//==========================================================================
+
+void LumpCache::Prefetch(int lump)
+{
+	{
+		std::unique_lock lock(Mutex);
+		if (Budget == 0 || StopWorker || Entries.count(lump) || !Queued.insert(lump).second)
+			return;
+
+		Queue.push_back(lump);
+		if (!Worker.joinable())
+		{
+			Worker = std::thread([this]() { WorkerMain(); });
+		}
+	}
+	WorkAvailable.notify_one();
+}
+
+//==========================================================================
+//
+// Clear
+//
+// Must be called whenever the lump numbers change. Anything the worker
+// is loading right now gets discarded when it is done.
+//
+//==========================================================================
+
+void LumpCache::Clear()
+{
+	std::unique_lock lock(Mutex);
+	Entries.clear();
+	Ages.clear();
+	Queue.clear();
+	Queued.clear();
+	Used = 0;
+	Generation++;
+}
+
+//==========================================================================
+//
+// WorkerMain
+//
+//==========================================================================
+
+void LumpCache::WorkerMain()
+{
+	std::unique_lock lock(Mutex);
+	while (true)
+	{
+		WorkAvailable.wait(lock, [this]() { return StopWorker || !Queue.empty(); });
+		if (StopWorker)
+			return;
+
+		int lump = Queue.front();
+		Queue.pop_front();
+		Queued.erase(lump);
+		if (Entries.count(lump))
+			continue;
+
+		unsigned generation = Generation;
+		lock.unlock();
+		Buffer data;
+		try
+		{
+			data = Loader(lump);
+		}
+		catch (...)
+		{
+			// Leave it to the main thread to report errors when the lump actually gets read.
+		}
+		lock.lock();
+
+		if (data != nullptr && generation == Generation)
+		{
+			InsertLocked(lump, std::move(data));
+			Stats.Prefetched++;
+		}
+	}
+}
+
+//==========================================================================
+//
+// Stats
+//
+//==========================================================================
+
+FLumpCacheStats LumpCache::GetStats()
+{
+	std::unique_lock lock(Mutex);
+	FLumpCacheStats stats = Stats;
+	stats.Entries = Entries.size();
+	stats.Queued = Queue.size();
+	stats.Used = Used;
+	stats.Budget = Budget;
+	return stats;
+}
+
+void LumpCache::ResetStats()
+{
+	std::unique_lock lock(Mutex);
+	Stats = {};
+}
+
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include "fs_files.h"
+#include "fs_filesystem.h"
+
+namespace FileSys {
+
+// Holds decompressed lump data so that compressed lumps do not have to be inflated again
+// each time they get read. The least recently used lumps are dropped once the budget is
+// exceeded. Lumps can also be queued for a worker thread that decompresses them ahead of time.
+class LumpCache
+{
+public:
+	using Buffer = std::shared_ptr<FileData>;
+	using LoadFunc = std::function<Buffer(int lump)>;
+
+	LumpCache(LoadFunc loader) : Loader(std::move(loader)) {}
+	~LumpCache();
+
+	void SetBudget(size_t bytes);
+	bool Accepts(size_t size);
+
+	Buffer Find(int lump, bool countmiss = true);
+	void Insert(int lump, Buffer data);
+	void Prefetch(int lump);
+	void Clear();
+
+	FLumpCacheStats GetStats();
+	void ResetStats();
+
+private:
+	struct Entry
+	{
+		Buffer Data;
+		std::list<int>::iterator Age;
+	};
+
+	void InsertLocked(int lump, Buffer data);
+	void Trim();
+	void WorkerMain();
+
+	LoadFunc Loader;
+
+	std::mutex Mutex;
+	std::condition_variable WorkAvailable;
+	std::thread Worker;
+	bool StopWorker = false;
+	unsigned Generation = 0;	// incremented by Clear so that the worker can discard stale results.
+
+	std::unordered_map<int, Entry> Entries;
+	std::list<int> Ages;	// front is the most recently used.
+	std::deque<int> Queue;
+	std::unordered_set<int> Queued;
+
+	size_t Budget = 0;
+	size_t Used = 0;
+	FLumpCacheStats Stats = {};
+};
+
+}
@@ -45,6 +45,7 @@
 #include "fs_decompress.h"
 #include <string_view>
 #include <algorithm>
+#include <atomic>
 
 namespace FileSys {
 
@@ -60,6 +61,19 @@ void SetMainThread()
 	}
 }
 
+// Statistics for how the lump data returned by Read got to the caller.
+static std::atomic<size_t> BytesMapped, BytesCopied, BytesDecompressed;
+
+FReadStats GetReadStats()
+{
+	return { BytesMapped, BytesCopied, BytesDecompressed };
+}
+
+void CountMappedRead(size_t length)
+{
+	BytesMapped += length;
+}
+
 std::string ExtractBaseName(const char* path, bool include_extension)
 {
 	const char* src, * dot;
@@ -757,16 +771,25 @@ FileData FResourceFile::Read(uint32_t entry)
 {
 	if (!(Entries[entry].Flags & RESFF_COMPRESSED) && Reader.isOpen())
 	{
+		if (Entries[entry].Flags & RESFF_NEEDFILESTART)
+		{
+			SetEntryAddress(entry);
+		}
 		auto buf = Reader.GetBuffer();
 		// if this is backed by a memory buffer, we can just return a reference to the backing store.
+		// If the buffer is a file mapping, the returned data keeps the mapping alive.
 		if (buf != nullptr)
 		{
-			return FileData(buf + Entries[entry].Position, Entries[entry].Length, false);
+			BytesMapped += Entries[entry].Length;
+			return FileData(buf + Entries[entry].Position, Entries[entry].Length, Reader.GetBufferOwner());
 		}
 	}
 
 	auto fr = GetEntryReader(entry, READER_SHARED, 0);
-	return fr.Read(entry < NumLumps ? Entries[entry].Length : 0);
+	auto data = fr.Read(entry < NumLumps ? Entries[entry].Length : 0);
+	if (entry < NumLumps && (Entries[entry].Flags & RESFF_COMPRESSED)) BytesDecompressed += data.size();
+	else BytesCopied += data.size();
+	return data;
 }
 
 
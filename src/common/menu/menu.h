@@ -67,6 +67,7 @@ public:
 	TArray<DMenuItemBase *> mItems;
 
 	size_t PropagateMark() override;
+	int GetConcurrentMarkSlots(DObject **slots[]) override { return -1; }
 };
 
 
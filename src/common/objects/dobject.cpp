@@ -278,6 +278,8 @@ void DObject::Release()
 {
 	DObject **probe;
 
+	GC::ForgetObject(this);
+
 	// Unlink this object from the GC list.
 	for (probe = &GC::Root; *probe != NULL; probe = &((*probe)->ObjNext))
 	{
@@ -411,6 +413,11 @@ size_t DObject::PropagateMark()
 	return 0;
 }
 
+int DObject::GetConcurrentMarkSlots(DObject **slots[])
+{
+	return 0;
+}
+
 //==========================================================================
 //
 //
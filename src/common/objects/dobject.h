@@ -330,10 +330,21 @@ public:
 		ObjectFlags |= OF_Black;
 	}
 
+	void MakeBlack()
+	{
+		ObjectFlags = (ObjectFlags & ~OF_MarkBits) | OF_Black;
+	}
+
 	// Marks all objects pointed to by this one. Returns the (approximate)
 	// amount of memory used by this object.
 	virtual size_t PropagateMark();
 
+	// Returns the pointers the concurrent marker has to follow in addition to the
+	// ones in the class's pointer table, or -1 if this object can only be marked by
+	// PropagateMark on the main thread. Anything overriding PropagateMark must
+	// override this, too. May be called from the marker thread.
+	virtual int GetConcurrentMarkSlots(DObject **slots[]);
+
 protected:
 	// This form of placement new and delete is for use *only* by PClass's
 	// CreateNew() method. Do not use them for some other purpose.
@@ -386,7 +397,8 @@ T* Create(Args&&... args)
 // already been processed by the GC.
 static inline void GC::WriteBarrier(DObject *pointing, DObject *pointed)
 {
-	if (pointed != NULL && pointed->IsWhite() && pointing->IsBlack())
+	// Nothing is black while the worker thread is marking, so every store must be looked at.
+	if (pointed != NULL && pointed->IsWhite() && (pointing->IsBlack() || State == GCS_ConcurrentMark))
 	{
 		Barrier(pointing, pointed);
 	}
@@ -394,7 +406,7 @@ static inline void GC::WriteBarrier(DObject *pointing, DObject *pointed)
 
 static inline void GC::WriteBarrier(DObject *pointed)
 {
-	if (pointed != NULL && State == GCS_Propagate && pointed->IsWhite())
+	if (pointed != NULL && (IsMarking() || Generational) && pointed->IsWhite())
 	{
 		Barrier(NULL, pointed);
 	}
@@ -59,11 +59,16 @@
 #include "dobject.h"
 
 #include "c_dispatch.h"
+#include "c_cvars.h"
 #include "menu.h"
 #include "stats.h"
 #include "printf.h"
 #include "cmdlib.h"
 
+#include <atomic>
+#include <thread>
+#include <vector>
+
 // MACROS ------------------------------------------------------------------
 
 /*
@@ -107,6 +112,15 @@
 // Cost of destroying an object
 #define GCDESTROYCOST		15
 
+/*
+@@ DEFAULT_GENMINORMUL and DEFAULT_GENMAJORMUL control generational mode.
+** A minor collection is done whenever memory grows by genminormul% of the
+** memory in use after the last major collection. Once memory has grown by
+** genmajormul%, a regular incremental cycle is run instead.
+*/
+#define DEFAULT_GENMINORMUL	20
+#define DEFAULT_GENMAJORMUL	100
+
 // TYPES -------------------------------------------------------------------
 
 class FAveragizer
@@ -125,13 +139,72 @@ public:
 	size_t GetAverage();
 };
 
+// Marks the objects that were alive at the start of a collection on a
+// background thread. The worker only reads the objects and keeps its marks
+// in a table of its own; the colors are changed on the main thread once it
+// is done. Objects whose pointers cannot be found without running their
+// PropagateMark are left to the main thread.
+class FConcurrentMarker
+{
+public:
+	~FConcurrentMarker();
+	void Start(DObject *snapshot, std::vector<DObject *> &&seeds);
+	bool IsRunning() const { return Thread.joinable(); }
+	bool IsDone() const { return Done.load(std::memory_order_acquire); }
+	void Sync();
+	void Abort();
+
+private:
+	static constexpr size_t NotFound = ~(size_t)0;
+
+	void Run(DObject *snapshot);
+	void Insert(DObject *obj);
+	size_t Find(DObject *obj) const;
+	void Scan(DObject *obj);
+	void Visit(DObject **slot);
+	void Clear();
+
+	std::thread Thread;
+	std::atomic<bool> Done { true };
+	std::vector<DObject *> Keys;		// open addressing hash of every object in the snapshot
+	std::vector<uint8_t> Marked;
+	size_t TableMask = 0;
+	std::vector<DObject *> Stack;
+	std::vector<DObject *> Deferred;	// objects that need to be marked on the main thread
+	std::vector<std::pair<DObject **, DObject *>> NullSlots;	// pointers to euthanized objects
+	size_t NumMarked = 0;
+	double WorkerMS = 0;
+};
+
+enum EGCGeneration
+{
+	GEN_Minor,
+	GEN_Major,
+
+	GEN_COUNT
+};
+
 struct FStepStats
 {
 	cycle_t Clock[GC::GCS_COUNT];
 	size_t BytesCovered[GC::GCS_COUNT];
 	int Count[GC::GCS_COUNT];
 
+	// Pause times per generation. A minor collection is a single pause, a major one is spread over many steps.
+	double GenTimeMS[GEN_COUNT];
+	double GenMaxMS[GEN_COUNT];
+	int GenCount[GEN_COUNT];
+	size_t MinorFreed;
+
+	// Work done by the concurrent marker.
+	double ConcurrentMS;
+	size_t ConcurrentMarked;
+	size_t ConcurrentDeferred;
+
+	void AddPause(EGCGeneration gen, double ms);
 	void Format(FString &out);
+	void FormatGenerations(FString &out);
+	void FormatConcurrent(FString &out);
 	void Reset();
 };
 
@@ -167,14 +240,166 @@ FStepStats StepStats;
 FStepStats PrevStepStats;
 bool FinalGC;
 bool HadToDestroy;
+bool Generational;
+int GenMinorMul = DEFAULT_GENMINORMUL;
+int GenMajorMul = DEFAULT_GENMAJORMUL;
 
 // PRIVATE DATA DEFINITIONS ------------------------------------------------
 
 static FAveragizer AllocHistory;// Tracks allocation rate over time
 static cycle_t GCTime;			// Track time spent in GC
 
+// Generational mode. Objects in the object list before OldHead are young,
+// everything else has survived a collection and is old. Old objects stay
+// black between collections, so marking stops at them.
+static DObject *OldHead;
+static TArray<DObject *> TouchedSet;	// Old objects that may point to young ones
+static size_t GenBase;					// Memory in use after the last major collection
+static bool WantGenerational;
+
+// Concurrent mark. Objects in the object list before SnapshotHead were
+// created after the worker started and have not been seen by it.
+static FConcurrentMarker ConcurrentMarker;
+static DObject *SnapshotHead;
+static bool WantConcurrentMark;
+
 // CODE --------------------------------------------------------------------
 
+//==========================================================================
+//
+// SetMinorThreshold
+//
+// Sets the threshold for the next minor collection in generational mode.
+//
+//==========================================================================
+
+static void SetMinorThreshold()
+{
+	Threshold = AllocBytes + std::max<size_t>(GCMINSTEPSIZE, GenBase / 100 * GenMinorMul);
+}
+
+//==========================================================================
+//
+// WhitenAll
+//
+// Turns every object white again and drops all generational bookkeeping.
+//
+//==========================================================================
+
+static void WhitenAll()
+{
+	for (DObject *obj = Root; obj != nullptr; obj = obj->ObjNext)
+	{
+		obj->MakeWhite();
+		obj->ObjectFlags &= ~(OF_Remembered | OF_Touched);
+	}
+	TouchedSet.Clear();
+}
+
+//==========================================================================
+//
+// SwitchGenerational
+//
+// Generational mode can only be turned on or off between collections.
+//
+//==========================================================================
+
+static void SwitchGenerational()
+{
+	assert(State == GCS_Pause);
+	if (WantGenerational)
+	{
+		// Everything is white after a regular cycle, i.e. young.
+		OldHead = nullptr;
+		TouchedSet.Clear();
+		GenBase = std::min(Estimate, AllocBytes);
+		Generational = true;
+		SetMinorThreshold();
+	}
+	else
+	{
+		WhitenAll();
+		OldHead = nullptr;
+		Generational = false;
+		Threshold = (std::min(Estimate, AllocBytes) / 100) * Pause;
+	}
+}
+
+void SetGenerational(bool on)
+{
+	WantGenerational = on;
+}
+
+void SetConcurrentMark(bool on)
+{
+	WantConcurrentMark = on;
+}
+
+//==========================================================================
+//
+// Remember
+//
+// Young objects that were stored somewhere the GC does not know about may
+// be referenced by old objects, so minor collections must treat them as
+// roots and must not free them even after they were destroyed.
+//
+//==========================================================================
+
+void Remember(DObject *pointed)
+{
+	if (pointed->IsWhite() && !(pointed->ObjectFlags & (OF_Remembered | OF_Released)))
+	{
+		pointed->ObjectFlags |= OF_Remembered;
+	}
+}
+
+//==========================================================================
+//
+// Touch
+//
+// Adds an old object that had a young one written into it to the
+// remembered set, so that the next minor collection scans it again.
+//
+//==========================================================================
+
+static void Touch(DObject *pointing)
+{
+	if (!(pointing->ObjectFlags & OF_Touched))
+	{
+		pointing->ObjectFlags |= OF_Touched;
+		TouchedSet.Push(pointing);
+	}
+}
+
+//==========================================================================
+//
+// ForgetObject
+//
+// Must be called before an object gets unlinked from the object list.
+//
+//==========================================================================
+
+void ForgetObject(DObject *obj)
+{
+	if (State == GCS_ConcurrentMark)
+	{
+		ConcurrentMarker.Sync();
+		if (obj == SnapshotHead)
+		{
+			SnapshotHead = obj->ObjNext;
+		}
+	}
+	if (obj == OldHead)
+	{
+		OldHead = obj->ObjNext;
+	}
+	if (obj->ObjectFlags & OF_Touched)
+	{
+		obj->ObjectFlags &= ~OF_Touched;
+		TouchedSet.Delete(TouchedSet.Find(obj));
+	}
+}
+
 //==========================================================================
 //
 // CheckGC
@@ -188,6 +413,10 @@ void CheckGC()
 {
 	AllocHistory.AddAlloc(RunningAllocBytes);
 	RunningAllocBytes = 0;
+	if (State == GCS_Pause && Generational != WantGenerational)
+	{
+		SwitchGenerational();
+	}
 	if (State > GCS_Pause || AllocBytes >= Threshold)
 	{
 		Step();
@@ -204,6 +433,12 @@ void CheckGC()
 
 void SetThreshold()
 {
+	if (Generational)
+	{
+		GenBase = std::min(Estimate, AllocBytes);
+		SetMinorThreshold();
+		return;
+	}
 	Threshold = (std::min(Estimate, AllocBytes) / 100) * Pause;
 }
 
@@ -247,7 +482,15 @@ static size_t SweepObjects(size_t count)
 		if ((curr->ObjectFlags ^ OF_WhiteBits) & deadmask)	// not dead?
 		{
 			assert(!curr->IsDead() || (curr->ObjectFlags & OF_Fixed));
-			curr->MakeWhite();	// make it white (for next cycle)
+			if (Generational)
+			{	// it is old now and stays black until the next major collection
+				curr->MakeBlack();
+				curr->ObjectFlags &= ~OF_Remembered;
+			}
+			else
+			{
+				curr->MakeWhite();	// make it white (for next cycle)
+			}
 			SweepPos = &curr->ObjNext;
 		}
 		else
@@ -261,6 +504,7 @@ static size_t SweepObjects(size_t count)
 			}
 			else
 			{	// must erase 'curr'
+				ForgetObject(curr);
 				*SweepPos = curr->ObjNext;
 				curr->ObjectFlags |= OF_Cleanup;
 				delete curr;
@@ -380,16 +624,8 @@ void AddMarkerFunc(GCMarkerFunc func)
 		markers.Push(func);
 }
 
-static void MarkRoot()
+static void MarkSoftRoots()
 {
-	PrevStepStats = StepStats;
-	StepStats.Reset();
-
-	Gray = nullptr;
-
-	for (auto func : markers) func();
-
-	// Mark soft roots.
 	if (SoftRoots != nullptr)
 	{
 		DObject **probe = &SoftRoots->ObjNext;
@@ -403,10 +639,92 @@ static void MarkRoot()
 			}
 		}
 	}
+}
+
+static void StartConcurrentMark()
+{
+	// The worker must not build any pointer tables itself, because it could see
+	// them half done. After the VM is up, this only needs to be done once.
+	for (auto cls : PClass::AllClasses)
+	{
+		if (cls->FlatPointers == nullptr) cls->BuildFlatPointers();
+		if (cls->ArrayPointers == nullptr) cls->BuildArrayPointers();
+		if (cls->MapPointers == nullptr) cls->BuildMapPointers();
+	}
+
+	// The roots are handed to the worker, which has its own idea of what is marked.
+	std::vector<DObject *> seeds;
+	while (Gray != nullptr)
+	{
+		DObject *obj = Gray;
+		Gray = obj->GCNext;
+		obj->GCNext = nullptr;
+		obj->MakeWhite();
+		seeds.push_back(obj);
+	}
+
+	SnapshotHead = Root;
+	ConcurrentMarker.Start(Root, std::move(seeds));
+	State = GCS_ConcurrentMark;
+}
+
+static void MarkRoot(bool concurrent = false)
+{
+	PrevStepStats = StepStats;
+	StepStats.Reset();
+
+	// Old objects are black in generational mode. A major collection needs to look at everything again.
+	if (Generational)
+	{
+		WhitenAll();
+	}
+
+	Gray = nullptr;
+
+	for (auto func : markers) func();
+	MarkSoftRoots();
+
+	if (concurrent && !Generational && !FinalGC && PClass::bVMOperational && !PClass::bShutdown)
+	{
+		StartConcurrentMark();
+		return;
+	}
+
 	// Time to propagate the marks.
 	State = GCS_Propagate;
 }
 
+//==========================================================================
+//
+// FinishConcurrentMark
+//
+// Takes over the results of the worker. Everything it could not handle,
+// objects created in the meantime and the roots, which are not covered by
+// the write barrier, are left for regular propagation steps.
+//
+//==========================================================================
+
+static void FinishConcurrentMark()
+{
+	ConcurrentMarker.Sync();
+
+	for (DObject *obj = Root; obj != SnapshotHead; obj = obj->ObjNext)
+	{
+		if (obj->IsWhite() && !(obj->ObjectFlags & (OF_EuthanizeMe | OF_Released)))
+		{
+			obj->White2Gray();
+			obj->GCNext = Gray;
+			Gray = obj;
+		}
+	}
+	SnapshotHead = nullptr;
+
+	for (auto func : markers) func();
+	MarkSoftRoots();
+
+	State = GCS_Propagate;
+}
+
 //==========================================================================
 //
 // Atomic
@@ -423,6 +741,8 @@ static void Atomic()
 	SweepPos = &Root;
 	State = GCS_Sweep;
 	Estimate = AllocBytes;
+	// Everything the sweep is going to cover becomes old.
+	OldHead = Root;
 }
 
 //==========================================================================
@@ -453,7 +773,11 @@ static size_t SingleStep()
 	switch (State)
 	{
 	case GCS_Pause:
-		MarkRoot();		// Start a new collection
+		MarkRoot(WantConcurrentMark);		// Start a new collection
+		return 0;
+
+	case GCS_ConcurrentMark:
+		FinishConcurrentMark();
 		return 0;
 
 	case GCS_Propagate:
@@ -500,6 +824,96 @@ static size_t SingleStep()
 	}
 }
 
+//==========================================================================
+//
+// MinorCollection
+//
+// Collects only the young objects in one go. Old objects are black, so
+// marking does not descend into them; the ones that had young objects
+// written into them since the last collection are scanned again instead.
+// Survivors become old.
+//
+//==========================================================================
+
+static void MinorCollection()
+{
+	static TArray<DObject *> toDestroy;
+	size_t freed = 0;
+
+	Gray = nullptr;
+
+	// Remembered young objects may be referenced from places that are not going to be scanned.
+	for (DObject *obj = Root; obj != OldHead; obj = obj->ObjNext)
+	{
+		if ((obj->ObjectFlags & (OF_Remembered | OF_EuthanizeMe)) == OF_Remembered && obj->IsWhite())
+		{
+			obj->White2Gray();
+			obj->GCNext = Gray;
+			Gray = obj;
+		}
+	}
+	for (auto obj : TouchedSet)
+	{
+		obj->ObjectFlags &= ~OF_Touched;
+		if (!(obj->ObjectFlags & OF_EuthanizeMe))
+		{
+			obj->PropagateMark();
+		}
+	}
+	TouchedSet.Clear();
+
+	for (auto func : markers) func();
+	MarkSoftRoots();
+
+	while (Gray != nullptr)
+	{
+		PropagateMark();
+	}
+
+	DObject **probe = &Root;
+	DObject *curr;
+	while ((curr = *probe) != OldHead)
+	{
+		if (curr->IsBlack() || (curr->ObjectFlags & OF_Fixed))
+		{	// survived, so it is old now
+			curr->MakeBlack();
+			curr->ObjectFlags &= ~OF_Remembered;
+			probe = &curr->ObjNext;
+		}
+		else if (!(curr->ObjectFlags & OF_EuthanizeMe))
+		{	// The object must be destroyed before it can be deleted.
+			toDestroy.Push(curr);
+			probe = &curr->ObjNext;
+		}
+		else if (curr->ObjectFlags & OF_Remembered)
+		{	// Something that was not scanned may still point to it, so only a major collection can free it.
+			probe = &curr->ObjNext;
+		}
+		else
+		{
+			*probe = curr->ObjNext;
+			curr->ObjectFlags |= OF_Cleanup;
+			delete curr;
+			freed++;
+		}
+	}
+
+	// Whatever is left of the young objects gets handled by the next major collection.
+	// Objects created while destroying the dead ones below are young again.
+	OldHead = Root;
+	for (auto obj : toDestroy)
+	{
+		if (!(obj->ObjectFlags & OF_EuthanizeMe))
+		{
+			obj->Destroy();
+		}
+	}
+	toDestroy.Clear();
+
+	StepStats.MinorFreed += freed;
+	SetMinorThreshold();
+}
+
 //==========================================================================
 //
 // Step
@@ -512,6 +926,20 @@ static size_t SingleStep()
 
 void Step()
 {
+	if (Generational && State == GCS_Pause && AllocBytes < GenBase / 100 * (100 + GenMajorMul))
+	{
+		GCTime.ResetAndClock();
+		MinorCollection();
+		GCTime.Unclock();
+		StepStats.AddPause(GEN_Minor, GCTime.TimeMS());
+		return;
+	}
+
+	if (State == GCS_ConcurrentMark && !ConcurrentMarker.IsDone())
+	{	// Nothing for the main thread to do until the worker is finished.
+		return;
+	}
+
 	GCTime.ResetAndClock();
 
 	auto enter_state = State;
@@ -550,6 +978,7 @@ void Step()
 	StepStats.Clock[enter_state].Unclock();
 	StepStats.BytesCovered[enter_state] += did;
 	GCTime.Unclock();
+	StepStats.AddPause(GEN_Major, GCTime.TimeMS());
 }
 
 //==========================================================================
@@ -566,6 +995,12 @@ void FullGC()
 	while (ContinueCheck)
 	{
 		ContinueCheck = false;
+		if (State == GCS_ConcurrentMark)
+		{
+			ConcurrentMarker.Abort();
+			SnapshotHead = nullptr;
+			State = GCS_Propagate;
+		}
 		if (State <= GCS_Propagate)
 		{
 			// Reset sweep mark to sweep all elements (returning them to white)
@@ -603,18 +1038,33 @@ void FullGC()
 
 void Barrier(DObject *pointing, DObject *pointed)
 {
-	assert(pointing == nullptr || (pointing->IsBlack() && !pointing->IsDead()));
+	assert(pointing == nullptr || ((pointing->IsBlack() || State == GCS_ConcurrentMark) && !pointing->IsDead()));
 	assert(pointed->IsWhite() && !pointed->IsDead());
-	assert(State != GCS_Destroy && State != GCS_Pause);
+	assert(Generational || (State != GCS_Destroy && State != GCS_Pause));
 	assert(!(pointed->ObjectFlags & OF_Released));	// if a released object gets here, something must be wrong.
 	if (pointed->ObjectFlags & OF_Released) return;	// don't do anything with non-GC'd objects.
-	// The invariant only needs to be maintained in the propagate state.
-	if (State == GCS_Propagate)
+	// The invariant only needs to be maintained while marking. The concurrent
+	// marker may already have passed the pointing object, so anything stored
+	// anywhere during that time is left for the main thread to scan.
+	if (IsMarking())
 	{
 		pointed->White2Gray();
 		pointed->GCNext = Gray;
 		Gray = pointed;
 	}
+	// In generational mode, the barrier feeds the remembered set for the next minor collection instead.
+	// Destroy() passes the object itself, which does not count as a reference.
+	else if (Generational)
+	{
+		if (pointing != nullptr)
+		{
+			Touch(pointing);
+		}
+		else if (!(pointed->ObjectFlags & OF_EuthanizeMe))
+		{
+			Remember(pointed);
+		}
+	}
 	// In other states, we can mark the pointing object white so this
 	// barrier won't be triggered again, saving a few cycles in the future.
 	else if (pointing != nullptr)
@@ -647,6 +1097,9 @@ void AddSoftRoot(DObject *obj)
 {
 	DObject **probe;
 
+	// The worker is walking the object list.
+	ConcurrentMarker.Sync();
+
 	// Are there any soft roots yet?
 	if (SoftRoots == nullptr)
 	{
@@ -665,6 +1118,14 @@ void AddSoftRoot(DObject *obj)
 		*probe = SoftRoots;
 	}
 	// Mark this object as rooted and move it after the SoftRoots marker.
+	if (obj == OldHead)
+	{
+		OldHead = obj->ObjNext;
+	}
+	if (obj == SnapshotHead)
+	{
+		SnapshotHead = obj->ObjNext;
+	}
 	probe = &Root;
 	while (*probe != nullptr && *probe != obj)
 	{
@@ -693,6 +1154,7 @@ void DelSoftRoot(DObject *obj)
 	{ // Not rooted, so nothing to do.
 		return;
 	}
+	ConcurrentMarker.Sync();
 	obj->ObjectFlags &= ~OF_Rooted;
 	// Move object out of the soft roots part of the list.
 	probe = &SoftRoots;
@@ -702,6 +1164,14 @@ void DelSoftRoot(DObject *obj)
 	}
 	if (*probe == obj)
 	{
+		if (obj == OldHead)
+		{
+			OldHead = obj->ObjNext;
+		}
+		if (obj == SnapshotHead)
+		{
+			SnapshotHead = obj->ObjNext;
+		}
 		*probe = obj->ObjNext;
 		obj->ObjNext = Root;
 		Root = obj;
@@ -710,6 +1180,286 @@ void DelSoftRoot(DObject *obj)
 
 }
 
+//==========================================================================
+//
+// FConcurrentMarker :: ~FConcurrentMarker
+//
+//==========================================================================
+
+FConcurrentMarker::~FConcurrentMarker()
+{
+	Abort();
+}
+
+//==========================================================================
+//
+// FConcurrentMarker :: Start
+//
+// Everything from snapshot to the end of the object list can be marked by
+// the worker. Only the main thread may change the links between those
+// objects again after calling Sync.
+//
+//==========================================================================
+
+void FConcurrentMarker::Start(DObject *snapshot, std::vector<DObject *> &&seeds)
+{
+	assert(!IsRunning());
+	Stack = std::move(seeds);
+	Done.store(false, std::memory_order_relaxed);
+	Thread = std::thread([this, snapshot]() { Run(snapshot); });
+}
+
+//==========================================================================
+//
+// FConcurrentMarker :: Run
+//
+// Worker thread. Nothing in here may allocate through M_Malloc or write to
+// an object, and object pointers may only be followed after they were
+// found in the table.
+//
+//==========================================================================
+
+void FConcurrentMarker::Run(DObject *snapshot)
+{
+	cycle_t clock;
+	clock.ResetAndClock();
+
+	size_t count = 0;
+	for (DObject *obj = snapshot; obj != nullptr; obj = obj->ObjNext)
+	{
+		count++;
+	}
+	size_t size = 64;
+	while (size < count * 2)
+	{
+		size <<= 1;
+	}
+	Keys.assign(size, nullptr);
+	Marked.assign(size, 0);
+	TableMask = size - 1;
+	for (DObject *obj = snapshot; obj != nullptr; obj = obj->ObjNext)
+	{
+		Insert(obj);
+	}
+
+	std::vector<DObject *> seeds;
+	seeds.swap(Stack);
+	for (DObject *obj : seeds)
+	{
+		size_t index = Find(obj);
+		if (index != NotFound && !Marked[index])
+		{
+			Marked[index] = 1;
+			Stack.push_back(obj);
+		}
+	}
+
+	while (!Stack.empty())
+	{
+		DObject *obj = Stack.back();
+		Stack.pop_back();
+		NumMarked++;
+		Scan(obj);
+	}
+
+	clock.Unclock();
+	WorkerMS = clock.TimeMS();
+	Done.store(true, std::memory_order_release);
+}
+
+//==========================================================================
+//
+// FConcurrentMarker :: Insert / Find
+//
+//==========================================================================
+
+static inline size_t HashObject(DObject *obj)
+{
+	uint64_t key = (uint64_t)(uintptr_t)obj >> 4;
+	return size_t((key * 0x9E3779B97F4A7C15ull) >> 20);
+}
+
+void FConcurrentMarker::Insert(DObject *obj)
+{
+	size_t index = HashObject(obj) & TableMask;
+	while (Keys[index] != nullptr)
+	{
+		index = (index + 1) & TableMask;
+	}
+	Keys[index] = obj;
+}
+
+size_t FConcurrentMarker::Find(DObject *obj) const
+{
+	size_t index = HashObject(obj) & TableMask;
+	for (DObject *key; (key = Keys[index]) != nullptr; index = (index + 1) & TableMask)
+	{
+		if (key == obj)
+		{
+			return index;
+		}
+	}
+	return NotFound;
+}
+
+//==========================================================================
+//
+// FConcurrentMarker :: Scan
+//
+// The worker's version of DObject::PropagateMark. Dynamic arrays and maps
+// can be reallocated by the main thread at any time, so objects that have
+// them are deferred along with those that mark natively.
+//
+//==========================================================================
+
+void FConcurrentMarker::Scan(DObject *obj)
+{
+	uint32_t flags = *(volatile uint32_t *)&obj->ObjectFlags;
+	if (flags & OF_EuthanizeMe)
+	{
+		return;
+	}
+
+	DObject **extra[4];
+	int numextra = obj->GetConcurrentMarkSlots(extra);
+	assert(numextra <= (int)countof(extra));
+	const PClass *info = obj->GetClass();
+	if (numextra < 0 || info->FlatPointers == nullptr || info->ArrayPointersSize != 0 || info->MapPointersSize != 0)
+	{
+		Deferred.push_back(obj);
+		return;
+	}
+
+	for (size_t i = 0; i < info->FlatPointersSize; i++)
+	{
+		Visit((DObject **)((uint8_t *)obj + info->FlatPointers[i].first));
+	}
+	for (int i = 0; i < numextra; i++)
+	{
+		Visit(extra[i]);
+	}
+}
+
+//==========================================================================
+//
+// FConcurrentMarker :: Visit
+//
+// Marks the object a slot points to. The slot can change at any time, but
+// whatever gets written into it is grayed by the write barrier.
+//
+//==========================================================================
+
+void FConcurrentMarker::Visit(DObject **slot)
+{
+	DObject *target = *(DObject * volatile *)slot;
+	if (target == nullptr)
+	{
+		return;
+	}
+	size_t index = Find(target);
+	if (index == NotFound || Marked[index])
+	{
+		return;
+	}
+	uint32_t flags = *(volatile uint32_t *)&target->ObjectFlags;
+	if (flags & OF_Released)
+	{
+		return;
+	}
+	if (flags & OF_EuthanizeMe)
+	{	// GC::Mark clears these, which has to wait for the main thread.
+		NullSlots.push_back({ slot, target });
+		return;
+	}
+	Marked[index] = 1;
+	Stack.push_back(target);
+}
+
+//==========================================================================
+//
+// FConcurrentMarker :: Sync
+//
+// Waits for the worker and applies its results: Marked objects become
+// black, deferred ones gray.
+//
+//==========================================================================
+
+void FConcurrentMarker::Sync()
+{
+	if (!IsRunning())
+	{
+		return;
+	}
+	Thread.join();
+
+	for (auto &nullslot : NullSlots)
+	{
+		if (*nullslot.first == nullslot.second)
+		{
+			*nullslot.first = nullptr;
+		}
+	}
+	// Deferred objects were marked in the table, too, so they must be grayed first.
+	for (DObject *obj : Deferred)
+	{
+		if (obj->IsWhite() && !(obj->ObjectFlags & OF_Released))
+		{
+			obj->White2Gray();
+			obj->GCNext = GC::Gray;
+			GC::Gray = obj;
+		}
+	}
+	for (size_t i = 0; i < Keys.size(); i++)
+	{
+		DObject *obj = Keys[i];
+		if (obj != nullptr && Marked[i] && obj->IsWhite() && !(obj->ObjectFlags & OF_Released))
+		{
+			obj->MakeBlack();
+		}
+	}
+
+	GC::StepStats.ConcurrentMS += WorkerMS;
+	GC::StepStats.ConcurrentMarked += NumMarked;
+	GC::StepStats.ConcurrentDeferred += Deferred.size();
+	Clear();
+}
+
+//==========================================================================
+//
+// FConcurrentMarker :: Abort
+//
+// Waits for the worker and throws away its results.
+//
+//==========================================================================
+
+void FConcurrentMarker::Abort()
+{
+	if (IsRunning())
+	{
+		Thread.join();
+		Clear();
+	}
+}
+
+//==========================================================================
+//
+// FConcurrentMarker :: Clear
+//
+//==========================================================================
+
+void FConcurrentMarker::Clear()
+{
+	// Give the memory back, the table can be quite large.
+	std::vector<DObject *>().swap(Keys);
+	std::vector<uint8_t>().swap(Marked);
+	std::vector<DObject *>().swap(Stack);
+	std::vector<DObject *>().swap(Deferred);
+	std::vector<std::pair<DObject **, DObject *>>().swap(NullSlots);
+	TableMask = 0;
+	NumMarked = 0;
+	WorkerMS = 0;
+}
+
 //==========================================================================
 //
 // FAveragizer - Constructor
@@ -771,7 +1521,8 @@ ADD_STAT(gc)
 		"Propagate",
 		"  Sweep  ",
 		" Destroy ",
-		"  Done   "
+		"  Done   ",
+		" Marking "
 	};
 	FString out;
 	double time = GC::State != GC::GCS_Pause ? GC::GCTime.TimeMS() : 0;
@@ -779,6 +1530,16 @@ ADD_STAT(gc)
 	GC::PrevStepStats.Format(out);
 	out << "\n";
 	GC::StepStats.Format(out);
+	if (GC::Generational)
+	{
+		out << "\n";
+		GC::StepStats.FormatGenerations(out);
+	}
+	if (GC::WantConcurrentMark)
+	{
+		out << "\n";
+		GC::PrevStepStats.FormatConcurrent(out);
+	}
 	out.AppendFormat("\n%.2fms [%s] Rate:%3zuK (%3zuK)  Alloc:%6zuK  Est:%6zuK  Thresh:%6zuK",
 		time,
 		StateStrings[GC::State],
@@ -804,6 +1565,29 @@ void FStepStats::Reset()
 		BytesCovered[i] = 0;
 		Clock[i].Reset();
 	}
+	for (unsigned i = 0; i < GEN_COUNT; ++i)
+	{
+		GenTimeMS[i] = 0;
+		GenMaxMS[i] = 0;
+		GenCount[i] = 0;
+	}
+	MinorFreed = 0;
+	ConcurrentMS = 0;
+	ConcurrentMarked = 0;
+	ConcurrentDeferred = 0;
+}
+
+//==========================================================================
+//
+// FStepStats :: AddPause
+//
+//==========================================================================
+
+void FStepStats::AddPause(EGCGeneration gen, double ms)
+{
+	GenTimeMS[gen] += ms;
+	GenMaxMS[gen] = std::max(GenMaxMS[gen], ms);
+	GenCount[gen]++;
 }
 
 //==========================================================================
@@ -830,6 +1614,38 @@ void FStepStats::Format(FString &out)
 	out << TEXTCOLOR_GREEN;
 }
 
+//==========================================================================
+//
+// FStepStats :: FormatGenerations
+//
+// Appends the pause times of minor collections and major steps.
+//
+//==========================================================================
+
+void FStepStats::FormatGenerations(FString &out)
+{
+	static const char *GenNames[] = { "Minor", "Major" };
+	for (int i = 0; i < GEN_COUNT; ++i)
+	{
+		int count = GenCount[i];
+		out.AppendFormat("%s: %4d*%.2fms (max %.2fms)  ", GenNames[i], count, count != 0 ? GenTimeMS[i] / count : 0., GenMaxMS[i]);
+	}
+	out.AppendFormat("Freed young: %zu", MinorFreed);
+}
+
+//==========================================================================
+//
+// FStepStats :: FormatConcurrent
+//
+// Appends what the concurrent marker did in a cycle.
+//
+//==========================================================================
+
+void FStepStats::FormatConcurrent(FString &out)
+{
+	out.AppendFormat("Worker: %.2fms  Marked: %zu  Deferred: %zu", ConcurrentMS, ConcurrentMarked, ConcurrentDeferred);
+}
+
 //==========================================================================
 //
 // CCMD gc
@@ -842,7 +1658,7 @@ CCMD(gc)
 {
 	if (argv.argc() == 1)
 	{
-		Printf ("Usage: gc stop|now|full|count|pause [size]|stepmul [size]\n");
+		Printf ("Usage: gc stop|now|full|count|pause [size]|stepmul [size]|minormul [size]|majormul [size]\n");
 		return;
 	}
 	if (stricmp(argv[1], "stop") == 0)
@@ -885,5 +1701,54 @@ CCMD(gc)
 			GC::StepMul = max(100, atoi(argv[2]));
 		}
 	}
+	else if (stricmp(argv[1], "minormul") == 0)
+	{
+		if (argv.argc() == 2)
+		{
+			Printf ("Current GC minormul is %d\n", GC::GenMinorMul);
+		}
+		else
+		{
+			GC::GenMinorMul = max(1, atoi(argv[2]));
+		}
+	}
+	else if (stricmp(argv[1], "majormul") == 0)
+	{
+		if (argv.argc() == 2)
+		{
+			Printf ("Current GC majormul is %d\n", GC::GenMajorMul);
+		}
+		else
+		{
+			GC::GenMajorMul = max(GC::GenMinorMul, atoi(argv[2]));
+		}
+	}
 }
 
+//==========================================================================
+//
+// CVAR gc_generational
+//
+// Collects young objects separately between full cycles. Takes effect
+// once the current cycle has finished.
+//
+//==========================================================================
+
+CUSTOM_CVAR(Bool, gc_generational, false, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+{
+	GC::SetGenerational(self);
+}
+
+//==========================================================================
+//
+// CVAR gc_concurrentmark
+//
+// Does the bulk of the mark phase on a background thread. Takes effect
+// with the next cycle. Not used in generational mode.
+//
+//==========================================================================
+
+CUSTOM_CVAR(Bool, gc_concurrentmark, false, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+{
+	GC::SetConcurrentMark(self);
+}
@@ -27,6 +27,11 @@ enum EObjectFlags
 	OF_Spawned			= 1 << 12,      // Thinker was spawned at all (some thinkers get deleted before spawning)
 	OF_Released			= 1 << 13,		// Object was released from the GC system and should not be processed by GC function
 	OF_Networked		= 1 << 14,		// Object has a unique network identifier that makes it synchronizable between all clients.
+	OF_ParallelTick		= 1 << 15,		// Native thinker whose Tick can be split into TickParallel/TickParallelFinish
+
+	// Generational GC flags
+	OF_Remembered		= 1 << 16,		// Young object that was stored somewhere through a write barrier
+	OF_Touched			= 1 << 17,		// Old object that had a young object written into it
 };
 
 template<class T> class TObjPtr;
@@ -40,6 +45,7 @@ namespace GC
 		GCS_Sweep,
 		GCS_Destroy,
 		GCS_Done,
+		GCS_ConcurrentMark,
 
 		GCS_COUNT
 	};
@@ -80,6 +86,15 @@ namespace GC
 	// Is this the final collection just before exit?
 	extern bool FinalGC;
 
+	// Are minor collections of only the young objects being done between full cycles?
+	extern bool Generational;
+
+	// Growth of memory since the last collection that triggers a minor collection, in percent of the memory in use after the last major collection.
+	extern int GenMinorMul;
+
+	// Growth of memory that triggers a major collection instead, in percent of the memory in use after the last major collection.
+	extern int GenMajorMul;
+
 	// Current white value for known-dead objects.
 	static inline uint32_t OtherWhite()
 	{
@@ -101,6 +116,24 @@ namespace GC
 	// Handles a write barrier for a pointer that isn't inside an object.
 	static inline void WriteBarrier(DObject *pointed);
 
+	// Adds a young object to the remembered set so that the next minor collection keeps it.
+	void Remember(DObject *pointed);
+
+	// Switches generational mode on or off at the next safe point.
+	void SetGenerational(bool on);
+
+	// Called when an object is taken out of the object list outside of a sweep.
+	void ForgetObject(DObject *obj);
+
+	// Switches marking on a background thread on or off for the next collection.
+	void SetConcurrentMark(bool on);
+
+	// Is the collector in one of the states where the write barrier must gray objects?
+	static inline bool IsMarking()
+	{
+		return State == GCS_Propagate || State == GCS_ConcurrentMark;
+	}
+
 	// Handles a read barrier.
 	template<class T> inline T *ReadBarrier(T *&obj)
 	{
@@ -205,7 +238,8 @@ namespace GC
 
 // A template class to help with handling read barriers. It does not
 // handle write barriers, because those can be handled more efficiently
-// with knowledge of the object that holds the pointer.
+// with knowledge of the object that holds the pointer. The only exception
+// is generational mode, where assigning a young object remembers it.
 template<class T>
 class TObjPtr
 {
@@ -219,6 +253,8 @@ public:
 	constexpr TObjPtr<T>& operator=(T q) noexcept
 	{
 		pp = q;
+		// Generational mode needs to know about young objects that got stored in possibly old ones.
+		if (GC::Generational && o != nullptr) GC::Remember(o);
 		return *this;
 	}
 
@@ -8084,7 +8084,11 @@ ExpEmit FxArrayElement::Emit(VMFunctionBuilder *build)
 		start = ExpEmit(build, REGT_POINTER);
 		build->Emit(OP_LP, start.RegNum, arrayvar.RegNum, build->GetConstantInt(0));
 
-		auto f = Create<PField>(NAME_None, TypeUInt32, ismeta? VARF_Meta : 0, SizeAddr);
+		PField *f;
+		{
+			std::lock_guard<std::mutex> lock(CodegenMutex);
+			f = Create<PField>(NAME_None, TypeUInt32, ismeta? VARF_Meta : 0, SizeAddr);
+		}
 		auto arraymemberbase = static_cast<FxMemberBase *>(Array);
 
 		auto origmembervar = arraymemberbase->membervar;
@@ -38,9 +38,17 @@
 #include "c_cvars.h"
 #include "jit.h"
 #include "filesystem.h"
+#include <atomic>
+#include <thread>
 
 CVAR(Bool, strictdecorate, false, CVAR_GLOBALCONFIG | CVAR_ARCHIVE)
 CVAR(Bool, warningstoerrors, false, CVAR_GLOBALCONFIG | CVAR_ARCHIVE)
+CVAR(Bool, vm_parallelcodegen, true, CVAR_GLOBALCONFIG | CVAR_ARCHIVE)
+
+// Starting a thread costs more than emitting a few small functions.
+static const unsigned MinFunctionsPerThread = 64;
+
+std::mutex CodegenMutex;
 
 EXTERN_CVAR(Bool, vm_jit)
 EXTERN_CVAR(Bool, vm_jit_aot)
@@ -116,7 +124,10 @@ void VMFunctionBuilder::EndStatement()
 
 void VMFunctionBuilder::MakeFunction(VMScriptFunction *func)
 {
-	func->Alloc(Code.Size(), IntConstantList.Size(), FloatConstantList.Size(), StringConstantList.Size(), AddressConstantList.Size(), LineNumbers.Size());
+	{
+		std::lock_guard<std::mutex> lock(CodegenMutex);
+		func->Alloc(Code.Size(), IntConstantList.Size(), FloatConstantList.Size(), StringConstantList.Size(), AddressConstantList.Size(), LineNumbers.Size());
+	}
 
 	// Copy code block.
 	memcpy(func->Code, &Code[0], Code.Size() * sizeof(VMOP));
@@ -836,10 +847,68 @@ VMFunction *FFunctionBuildList::AddFunction(PNamespace *gnspc, const VersionInfo
 }
 
 
+//==========================================================================
+//
+// EmitInParallel
+//
+// Runs the job for each index on all cores. The calling thread takes
+// part so nothing is started if there is not enough work.
+//
+//==========================================================================
+
+static void EmitInParallel(unsigned count, const std::function<void(unsigned)> &job)
+{
+	std::atomic<unsigned> next = 0;
+	auto worker = [&]()
+	{
+		for (unsigned i; (i = next++) < count; )
+		{
+			job(i);
+		}
+	};
+
+	unsigned threadcount = vm_parallelcodegen ? std::min(std::thread::hardware_concurrency(), count / MinFunctionsPerThread) : 0;
+	std::vector<std::thread> threads;
+	for (unsigned i = 1; i < threadcount; i++)
+	{
+		threads.emplace_back(worker);
+	}
+	worker();
+	for (auto &thread : threads)
+	{
+		thread.join();
+	}
+}
+
+//==========================================================================
+//
+// FFunctionBuildList::Build
+//
+// Resolving changes the type system and symbol tables, so that is done
+// one function at a time. Once resolved, each function is emitted with
+// its own builder in parallel. Everything that depends on the order in
+// which functions are processed (the disassembly dump, JIT compilation
+// and error reporting) is done afterward in list order, so the result is
+// the same as emitting them one by one.
+//
+//==========================================================================
+
 void FFunctionBuildList::Build()
 {
 	VMDisassemblyDumper disasmdump(VMDisassemblyDumper::Overwrite);
 
+	struct EmitJob
+	{
+		Item *item;
+		std::unique_ptr<FCompileContext> ctx;
+		std::unique_ptr<VMFunctionBuilder> buildit;
+		int NumArgs = 0;
+		bool Unsafe = false;
+		FString Error;
+		std::exception_ptr Exception;
+	};
+	std::vector<EmitJob> jobs;
+
 	for (auto &item : mItems)
 	{
 		// [Player701] Do not emit code for abstract functions
@@ -849,10 +918,13 @@ void FFunctionBuildList::Build()
 		assert(item.Code != NULL);
 
 		// We don't know the return type in advance for anonymous functions.
-		FCompileContext ctx(item.CurGlobals, item.Func, item.Func->SymbolName == NAME_None ? nullptr : item.Func->Variants[0].Proto, item.FromDecorate, item.StateIndex, item.StateCount, item.Lump, item.Version);
+		// The context holds the argument declarations that the code generator needs, so it has to live until the function is emitted.
+		auto ctxp = std::make_unique<FCompileContext>(item.CurGlobals, item.Func, item.Func->SymbolName == NAME_None ? nullptr : item.Func->Variants[0].Proto, item.FromDecorate, item.StateIndex, item.StateCount, item.Lump, item.Version);
+		auto &ctx = *ctxp;
 
 		// Allocate registers for the function's arguments and create local variable nodes before starting to resolve it.
-		VMFunctionBuilder buildit(item.Func->GetImplicitArgs());
+		auto builditp = std::make_unique<VMFunctionBuilder>(item.Func->GetImplicitArgs());
+		auto &buildit = *builditp;
 		for (unsigned i = 0; i < item.Func->Variants[0].Proto->ArgumentTypes.Size(); i++)
 		{
 			auto type = item.Func->Variants[0].Proto->ArgumentTypes[i];
@@ -910,49 +982,98 @@ void FFunctionBuildList::Build()
 				sfunc->ArgFlags = item.Func->Variants[0].ArgFlags;
 			}
 
-			// Emit code
-			try
+			// NumArgs for the VMFunction must be the amount of stack elements, which can differ from the amount of logical function arguments if vectors are in the list.
+			// For the VM a vector is 2 or 3 args, depending on size.
+			int numargs = 0;
+			auto funcVariant = item.Func->Variants[0];
+			for (unsigned int i = 0; i < funcVariant.Proto->ArgumentTypes.Size(); i++)
 			{
-				sfunc->SourceFileName = item.Code->ScriptPosition.FileName.GetChars();	// remember the file name for printing error messages if something goes wrong in the VM.
-				buildit.BeginStatement(item.Code);
-				item.Code->Emit(&buildit);
-				buildit.EndStatement();
-				buildit.MakeFunction(sfunc);
-				sfunc->NumArgs = 0;
-				// NumArgs for the VMFunction must be the amount of stack elements, which can differ from the amount of logical function arguments if vectors are in the list.
-				// For the VM a vector is 2 or 3 args, depending on size.
-				auto funcVariant = item.Func->Variants[0];
-				for (unsigned int i = 0; i < funcVariant.Proto->ArgumentTypes.Size(); i++)
+				auto argType = funcVariant.Proto->ArgumentTypes[i];
+				auto argFlags = funcVariant.ArgFlags[i];
+				if (argFlags & VARF_Out)
 				{
-					auto argType = funcVariant.Proto->ArgumentTypes[i];
-					auto argFlags = funcVariant.ArgFlags[i];
-					if (argFlags & VARF_Out)
-					{
-						auto argPointer = NewPointer(argType);
-						sfunc->NumArgs += argPointer->GetRegCount();
-					}
-					else
-					{
-						sfunc->NumArgs += argType->GetRegCount();
-					}
+					auto argPointer = NewPointer(argType);
+					numargs += argPointer->GetRegCount();
 				}
+				else
+				{
+					numargs += argType->GetRegCount();
+				}
+			}
 
-				disasmdump.Write(sfunc, item.PrintableName);
+			EmitJob job;
+			job.item = &item;
+			job.ctx = std::move(ctxp);
+			job.buildit = std::move(builditp);
+			job.NumArgs = numargs;
+			jobs.push_back(std::move(job));
+		}
+		else
+		{
+			disasmdump.Flush();
+		}
+	}
 
-				sfunc->Unsafe = ctx.Unsafe;
+	// Emit code
+	EmitInParallel((unsigned)jobs.size(), [&](unsigned index)
+	{
+		auto &job = jobs[index];
+		auto &item = *job.item;
+		auto &buildit = *job.buildit;
+		VMScriptFunction *sfunc = item.Function;
+		try
+		{
+			sfunc->SourceFileName = item.Code->ScriptPosition.FileName.GetChars();	// remember the file name for printing error messages if something goes wrong in the VM.
+			buildit.BeginStatement(item.Code);
+			item.Code->Emit(&buildit);
+			buildit.EndStatement();
+			buildit.MakeFunction(sfunc);
+			sfunc->NumArgs = job.NumArgs;
+		}
+		catch (CRecoverableError &err)
+		{
+			job.Error = err.GetMessage();
+		}
+		catch (...)
+		{
+			job.Exception = std::current_exception();
+		}
+		job.Unsafe = job.ctx->Unsafe;
+		job.buildit.reset();
+		job.ctx.reset();
+	});
 
-				#if HAVE_VM_JIT
-					if(vm_jit && vm_jit_aot)
-					{
-						sfunc->JitCompile();
-					}
-				#endif
-			}
-			catch (CRecoverableError &err)
+	for (auto &job : jobs)
+	{
+		auto &item = *job.item;
+		VMScriptFunction *sfunc = item.Function;
+		if (job.Exception)
+		{
+			std::rethrow_exception(job.Exception);
+		}
+		try
+		{
+			if (job.Error.IsNotEmpty())
 			{
-				// catch errors from the code generator and pring something meaningful.
-				item.Code->ScriptPosition.Message(MSG_ERROR, "%s in %s", err.GetMessage(), item.PrintableName.GetChars());
+				throw CRecoverableError(job.Error.GetChars());
 			}
+
+			disasmdump.Write(sfunc, item.PrintableName);
+
+			sfunc->Unsafe = job.Unsafe;
+
+			#if HAVE_VM_JIT
+				if(vm_jit && vm_jit_aot && JitCacheWantsAot(sfunc))
+				{
+					sfunc->JitCompile();
+					JitCacheWatchCalls(sfunc);
+				}
+			#endif
+		}
+		catch (CRecoverableError &err)
+		{
+			// catch errors from the code generator and pring something meaningful.
+			item.Code->ScriptPosition.Message(MSG_ERROR, "%s in %s", err.GetMessage(), item.PrintableName.GetChars());
 		}
 		delete item.Code;
 		disasmdump.Flush();
@@ -960,6 +1081,10 @@ void FFunctionBuildList::Build()
 	VMFunction::CreateRegUseInfo();
 	FScriptPosition::StrictErrors = strictdecorate;
 
+#if HAVE_VM_JIT
+	if (vm_jit && vm_jit_aot) JitCacheReport();
+#endif
+
 	if (FScriptPosition::ErrorCounter == 0)
 	{
 		if (Args->CheckParm("-dumpjit")) DumpJit(true);
@@ -1125,7 +1250,11 @@ ExpEmit FunctionCallEmitter::EmitCall(VMFunctionBuilder *build, TArray<ExpEmit>
 	{
 		// Pass a hidden type information parameter to vararg functions.
 		// It would really be nicer to actually pass real types but that'd require a far more complex interface on the compiler side than what we have.
-		uint8_t *regbuffer = (uint8_t*)ClassDataAllocator.Alloc(reginfo.Size());	// Allocate in the arena so that the pointer does not need to be maintained.
+		uint8_t *regbuffer;
+		{
+			std::lock_guard<std::mutex> lock(CodegenMutex);
+			regbuffer = (uint8_t*)ClassDataAllocator.Alloc(reginfo.Size());	// Allocate in the arena so that the pointer does not need to be maintained.
+		}
 		memcpy(regbuffer, reginfo.Data(), reginfo.Size());
 		build->Emit(OP_PARAM, REGT_POINTER | REGT_KONST, build->GetConstantAddress(regbuffer));
 		paramcount++;
@@ -5,6 +5,7 @@
 #include "vmintern.h"
 #include <vector>
 #include <functional>
+#include <mutex>
 
 class VMFunctionBuilder;
 class FxExpression;
@@ -169,6 +170,10 @@ public:
 
 extern FFunctionBuildList FunctionBuildList;
 
+// FFunctionBuildList::Build emits the code for many functions at once. Emitters must hold this
+// while doing anything that touches shared state, like allocating from ClassDataAllocator.
+extern std::mutex CodegenMutex;
+
 
 //==========================================================================
 //
@@ -0,0 +1,1097 @@
+/*
+** zcc_astcache.cpp
+**
+** Keeps the syntax trees of parsed scripts between sessions.
+**
+** The generated code cannot be kept because its constants point directly at
+** types, functions and states that only exist once the compiler has run, so
+** the compiler always needs to run. What can be skipped is tokenizing and
+** parsing the often several megabytes of script text, which takes the
+** larger part of the time for big mods.
+**
+** A cache file is only valid as long as the engine build and every script
+** lump that went into the tree are unchanged.
+**
+*/
+
+#include "dobject.h"
+#include "c_cvars.h"
+#include "cmdlib.h"
+#include "filesystem.h"
+#include "files.h"
+#include "i_specialpaths.h"
+#include "md5.h"
+#include "printf.h"
+#include "version.h"
+#include "zcc_parser.h"
+#include <algorithm>
+#include <memory>
+#include <type_traits>
+
+CVAR(Bool, zs_parse_cache, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+
+static const uint32_t ASTCacheVersion = 1;
+
+#define ZCC_AST_NODES(x) \
+	x(Identifier) x(Class) x(Struct) x(Enum) x(EnumTerminator) x(States) x(StatePart) x(StateLabel) \
+	x(StateStop) x(StateWait) x(StateFail) x(StateLoop) x(StateGoto) x(StateLine) x(VarName) x(VarInit) \
+	x(Type) x(BasicType) x(MapType) x(MapIteratorType) x(DynArrayType) x(FuncPtrParamDecl) x(FuncPtrType) \
+	x(ClassType) x(Expression) x(ExprID) x(ExprTypeRef) x(ExprConstant) x(ExprFuncCall) x(ExprMemberAccess) \
+	x(ExprUnary) x(ExprBinary) x(ExprTrinary) x(FuncParm) x(Statement) x(CompoundStmt) x(ContinueStmt) \
+	x(BreakStmt) x(ReturnStmt) x(ExpressionStmt) x(IterationStmt) x(IfStmt) x(SwitchStmt) x(CaseStmt) \
+	x(AssignStmt) x(AssignDeclStmt) x(LocalVarStmt) x(FuncParamDecl) x(ConstantDef) x(Declarator) \
+	x(VarDeclarator) x(FuncDeclarator) x(Default) x(FlagStmt) x(PropertyStmt) x(VectorValue) x(DeclFlags) \
+	x(ClassCast) x(FunctionPtrCast) x(StaticArrayStatement) x(Property) x(FlagDef) x(MixinDef) x(MixinStmt) \
+	x(ArrayIterationStmt) x(TwoArgIterationStmt) x(ThreeArgIterationStmt) x(TypedIterationStmt)
+
+static size_t NodeSize(EZCCTreeNodeType type)
+{
+	switch (type)
+	{
+#define xx(t) case AST_##t: return sizeof(ZCC_##t);
+		ZCC_AST_NODES(xx)
+#undef xx
+	default: return 0;
+	}
+}
+
+//==========================================================================
+//
+// The parser only ever references these types. A tree containing anything
+// else does not get cached.
+//
+//==========================================================================
+
+static PType *KnownType(unsigned index)
+{
+	PType *const types[] = { nullptr, TypeError, TypeAuto, TypeVoid, TypeSInt8, TypeUInt8, TypeSInt16, TypeUInt16,
+		TypeSInt32, TypeUInt32, TypeBool, TypeFloat32, TypeFloat64, TypeString, TypeName, TypeSound, TypeColor,
+		TypeVector2, TypeVector3, TypeVector4, TypeNullPtr };
+	return index < countof(types) ? types[index] : (PType *)-1;
+}
+
+static int KnownTypeIndex(PType *type)
+{
+	for (unsigned i = 0; KnownType(i) != (PType *)-1; i++)
+	{
+		if (KnownType(i) == type) return i;
+	}
+	return -1;
+}
+
+//==========================================================================
+//
+// SerializeNode
+//
+// Visits every field of a node that the parser fills in. Fields like
+// Symbol or Type in the named nodes only get set by the compiler.
+// This must be updated along with the node definitions in zcc_parser.h!
+//
+//==========================================================================
+
+template<class Arc> static void SerializeExpression(Arc &arc, ZCC_Expression *n)
+{
+	arc(n->Operation);
+	arc(n->Type);
+}
+
+template<class Arc> static void SerializeNode(Arc &arc, ZCC_TreeNode *node)
+{
+	arc(node->SiblingNext);
+	arc(node->SiblingPrev);
+	arc(node->SourceName);
+	arc.Lump(node->SourceLump);
+	arc(node->SourceLoc);
+
+	switch (node->NodeType)
+	{
+	case AST_Identifier:
+	{
+		auto n = static_cast<ZCC_Identifier *>(node);
+		arc(n->Id);
+		break;
+	}
+
+	case AST_Struct:
+	case AST_Class:
+	{
+		auto n = static_cast<ZCC_Struct *>(node);
+		arc(n->NodeName);
+		arc(n->Flags);
+		arc(n->Body);
+		arc(n->Version);
+		if (node->NodeType == AST_Class)
+		{
+			auto c = static_cast<ZCC_Class *>(node);
+			arc(c->ParentName);
+			arc(c->Replaces);
+			arc(c->Sealed);
+		}
+		break;
+	}
+
+	case AST_Property:
+	{
+		auto n = static_cast<ZCC_Property *>(node);
+		arc(n->NodeName);
+		arc(n->Body);
+		break;
+	}
+
+	case AST_FlagDef:
+	{
+		auto n = static_cast<ZCC_FlagDef *>(node);
+		arc(n->NodeName);
+		arc(n->RefName);
+		arc(n->BitValue);
+		break;
+	}
+
+	case AST_MixinDef:
+	{
+		auto n = static_cast<ZCC_MixinDef *>(node);
+		arc(n->NodeName);
+		arc(n->Body);
+		arc(n->MixinType);
+		break;
+	}
+
+	case AST_Enum:
+	{
+		auto n = static_cast<ZCC_Enum *>(node);
+		arc(n->NodeName);
+		arc(n->EnumType);
+		arc(n->Elements);
+		break;
+	}
+
+	case AST_ConstantDef:
+	{
+		auto n = static_cast<ZCC_ConstantDef *>(node);
+		arc(n->NodeName);
+		arc(n->Value);
+		break;
+	}
+
+	case AST_States:
+	{
+		auto n = static_cast<ZCC_States *>(node);
+		arc(n->Body);
+		arc(n->Flags);
+		break;
+	}
+
+	case AST_StateLabel:
+	{
+		auto n = static_cast<ZCC_StateLabel *>(node);
+		arc(n->Label);
+		break;
+	}
+
+	case AST_StateGoto:
+	{
+		auto n = static_cast<ZCC_StateGoto *>(node);
+		arc(n->Qualifier);
+		arc(n->Label);
+		arc(n->Offset);
+		break;
+	}
+
+	case AST_StateLine:
+	{
+		auto n = static_cast<ZCC_StateLine *>(node);
+		int bits = n->bBright | (n->bFast << 1) | (n->bSlow << 2) | (n->bNoDelay << 3) | (n->bCanRaise << 4);
+		arc(bits);
+		n->bBright = !!(bits & 1);
+		n->bFast = !!(bits & 2);
+		n->bSlow = !!(bits & 4);
+		n->bNoDelay = !!(bits & 8);
+		n->bCanRaise = !!(bits & 16);
+		arc(n->Sprite);
+		arc(n->Frames);
+		arc(n->Duration);
+		arc(n->Offset);
+		arc(n->Lights);
+		arc(n->Action);
+		break;
+	}
+
+	case AST_VarName:
+	case AST_VarInit:
+	{
+		auto n = static_cast<ZCC_VarName *>(node);
+		arc(n->Name);
+		arc(n->ArraySize);
+		if (node->NodeType == AST_VarInit)
+		{
+			auto v = static_cast<ZCC_VarInit *>(node);
+			arc(v->Init);
+			arc(v->InitIsArray);
+		}
+		break;
+	}
+
+	case AST_Type:
+	{
+		auto n = static_cast<ZCC_Type *>(node);
+		arc(n->ArraySize);
+		break;
+	}
+
+	case AST_BasicType:
+	{
+		auto n = static_cast<ZCC_BasicType *>(node);
+		arc(n->ArraySize);
+		arc(n->Type);
+		arc(n->UserType);
+		arc(n->isconst);
+		break;
+	}
+
+	case AST_MapType:
+	{
+		auto n = static_cast<ZCC_MapType *>(node);
+		arc(n->ArraySize);
+		arc(n->KeyType);
+		arc(n->ValueType);
+		break;
+	}
+
+	case AST_MapIteratorType:
+	{
+		auto n = static_cast<ZCC_MapIteratorType *>(node);
+		arc(n->ArraySize);
+		arc(n->KeyType);
+		arc(n->ValueType);
+		break;
+	}
+
+	case AST_DynArrayType:
+	{
+		auto n = static_cast<ZCC_DynArrayType *>(node);
+		arc(n->ArraySize);
+		arc(n->ElementType);
+		break;
+	}
+
+	case AST_FuncPtrParamDecl:
+	{
+		auto n = static_cast<ZCC_FuncPtrParamDecl *>(node);
+		arc(n->Type);
+		arc(n->Flags);
+		break;
+	}
+
+	case AST_FuncPtrType:
+	{
+		auto n = static_cast<ZCC_FuncPtrType *>(node);
+		arc(n->ArraySize);
+		arc(n->RetType);
+		arc(n->Params);
+		arc(n->Scope);
+		break;
+	}
+
+	case AST_ClassType:
+	{
+		auto n = static_cast<ZCC_ClassType *>(node);
+		arc(n->ArraySize);
+		arc(n->Restriction);
+		break;
+	}
+
+	case AST_Expression:
+		SerializeExpression(arc, static_cast<ZCC_Expression *>(node));
+		break;
+
+	case AST_ExprID:
+	{
+		auto n = static_cast<ZCC_ExprID *>(node);
+		SerializeExpression(arc, n);
+		arc(n->Identifier);
+		break;
+	}
+
+	case AST_ExprTypeRef:
+	{
+		auto n = static_cast<ZCC_ExprTypeRef *>(node);
+		SerializeExpression(arc, n);
+		arc(n->RefType);
+		break;
+	}
+
+	case AST_ExprConstant:
+	{
+		// Same rules for the union as in TreeNodeDeepCopy.
+		auto n = static_cast<ZCC_ExprConstant *>(node);
+		SerializeExpression(arc, n);
+		if (n->Type == TypeString)
+		{
+			arc(n->StringVal);
+		}
+		else if (n->Type == TypeFloat64 || n->Type == TypeFloat32)
+		{
+			arc(n->DoubleVal);
+		}
+		else if (n->Type == TypeName)
+		{
+			ENamedName name = ENamedName(n->IntVal);
+			arc(name);
+			n->IntVal = name;
+		}
+		else
+		{
+			arc(n->IntVal);
+		}
+		break;
+	}
+
+	case AST_ExprFuncCall:
+	{
+		auto n = static_cast<ZCC_ExprFuncCall *>(node);
+		SerializeExpression(arc, n);
+		arc(n->Function);
+		arc(n->Parameters);
+		break;
+	}
+
+	case AST_ClassCast:
+	{
+		auto n = static_cast<ZCC_ClassCast *>(node);
+		SerializeExpression(arc, n);
+		arc(n->ClassName);
+		arc(n->Parameters);
+		break;
+	}
+
+	case AST_FunctionPtrCast:
+	{
+		auto n = static_cast<ZCC_FunctionPtrCast *>(node);
+		SerializeExpression(arc, n);
+		arc(n->PtrType);
+		arc(n->Expr);
+		break;
+	}
+
+	case AST_ExprMemberAccess:
+	{
+		auto n = static_cast<ZCC_ExprMemberAccess *>(node);
+		SerializeExpression(arc, n);
+		arc(n->Left);
+		arc(n->Right);
+		break;
+	}
+
+	case AST_ExprUnary:
+	{
+		auto n = static_cast<ZCC_ExprUnary *>(node);
+		SerializeExpression(arc, n);
+		arc(n->Operand);
+		break;
+	}
+
+	case AST_ExprBinary:
+	{
+		auto n = static_cast<ZCC_ExprBinary *>(node);
+		SerializeExpression(arc, n);
+		arc(n->Left);
+		arc(n->Right);
+		break;
+	}
+
+	case AST_ExprTrinary:
+	{
+		auto n = static_cast<ZCC_ExprTrinary *>(node);
+		SerializeExpression(arc, n);
+		arc(n->Test);
+		arc(n->Left);
+		arc(n->Right);
+		break;
+	}
+
+	case AST_VectorValue:
+	{
+		auto n = static_cast<ZCC_VectorValue *>(node);
+		SerializeExpression(arc, n);
+		arc(n->X);
+		arc(n->Y);
+		arc(n->Z);
+		arc(n->W);
+		break;
+	}
+
+	case AST_FuncParm:
+	{
+		auto n = static_cast<ZCC_FuncParm *>(node);
+		arc(n->Value);
+		arc(n->Label);
+		break;
+	}
+
+	case AST_StaticArrayStatement:
+	{
+		auto n = static_cast<ZCC_StaticArrayStatement *>(node);
+		arc(n->Type);
+		arc(n->Id);
+		arc(n->Values);
+		break;
+	}
+
+	case AST_CompoundStmt:
+	case AST_Default:
+	{
+		auto n = static_cast<ZCC_CompoundStmt *>(node);
+		arc(n->Content);
+		break;
+	}
+
+	case AST_ReturnStmt:
+	{
+		auto n = static_cast<ZCC_ReturnStmt *>(node);
+		arc(n->Values);
+		break;
+	}
+
+	case AST_ExpressionStmt:
+	{
+		auto n = static_cast<ZCC_ExpressionStmt *>(node);
+		arc(n->Expression);
+		break;
+	}
+
+	case AST_IterationStmt:
+	{
+		auto n = static_cast<ZCC_IterationStmt *>(node);
+		arc(n->LoopCondition);
+		arc(n->LoopStatement);
+		arc(n->LoopBumper);
+		arc(n->CheckAt);
+		break;
+	}
+
+	case AST_ArrayIterationStmt:
+	{
+		auto n = static_cast<ZCC_ArrayIterationStmt *>(node);
+		arc(n->ItName);
+		arc(n->ItArray);
+		arc(n->LoopStatement);
+		break;
+	}
+
+	case AST_TwoArgIterationStmt:
+	{
+		auto n = static_cast<ZCC_TwoArgIterationStmt *>(node);
+		arc(n->ItKey);
+		arc(n->ItValue);
+		arc(n->ItMap);
+		arc(n->LoopStatement);
+		break;
+	}
+
+	case AST_ThreeArgIterationStmt:
+	{
+		auto n = static_cast<ZCC_ThreeArgIterationStmt *>(node);
+		arc(n->ItVar);
+		arc(n->ItPos);
+		arc(n->ItFlags);
+		arc(n->ItBlock);
+		arc(n->LoopStatement);
+		break;
+	}
+
+	case AST_TypedIterationStmt:
+	{
+		auto n = static_cast<ZCC_TypedIterationStmt *>(node);
+		arc(n->ItType);
+		arc(n->ItVar);
+		arc(n->ItExpr);
+		arc(n->LoopStatement);
+		break;
+	}
+
+	case AST_IfStmt:
+	{
+		auto n = static_cast<ZCC_IfStmt *>(node);
+		arc(n->Condition);
+		arc(n->TruePath);
+		arc(n->FalsePath);
+		break;
+	}
+
+	case AST_SwitchStmt:
+	{
+		auto n = static_cast<ZCC_SwitchStmt *>(node);
+		arc(n->Condition);
+		arc(n->Content);
+		break;
+	}
+
+	case AST_CaseStmt:
+	{
+		auto n = static_cast<ZCC_CaseStmt *>(node);
+		arc(n->Condition);
+		break;
+	}
+
+	case AST_AssignStmt:
+	{
+		auto n = static_cast<ZCC_AssignStmt *>(node);
+		arc(n->Dests);
+		arc(n->Sources);
+		arc(n->AssignOp);
+		break;
+	}
+
+	case AST_AssignDeclStmt:
+	{
+		auto n = static_cast<ZCC_AssignDeclStmt *>(node);
+		arc(n->Dests);
+		arc(n->Sources);
+		arc(n->AssignOp);
+		break;
+	}
+
+	case AST_LocalVarStmt:
+	{
+		auto n = static_cast<ZCC_LocalVarStmt *>(node);
+		arc(n->Type);
+		arc(n->Vars);
+		break;
+	}
+
+	case AST_FuncParamDecl:
+	{
+		auto n = static_cast<ZCC_FuncParamDecl *>(node);
+		arc(n->Type);
+		arc(n->Default);
+		arc(n->Name);
+		arc(n->Flags);
+		break;
+	}
+
+	case AST_DeclFlags:
+	{
+		auto n = static_cast<ZCC_DeclFlags *>(node);
+		arc(n->Id);
+		arc(n->DeprecationMessage);
+		arc(n->Version);
+		arc(n->Flags);
+		break;
+	}
+
+	case AST_Declarator:
+	case AST_VarDeclarator:
+	case AST_FuncDeclarator:
+	{
+		auto n = static_cast<ZCC_Declarator *>(node);
+		arc(n->Type);
+		arc(n->Flags);
+		arc(n->Version);
+		if (node->NodeType == AST_VarDeclarator)
+		{
+			auto v = static_cast<ZCC_VarDeclarator *>(node);
+			arc(v->Names);
+			arc(v->DeprecationMessage);
+		}
+		else if (node->NodeType == AST_FuncDeclarator)
+		{
+			auto f = static_cast<ZCC_FuncDeclarator *>(node);
+			arc(f->Params);
+			arc(f->Name);
+			arc(f->Body);
+			arc(f->UseFlags);
+			arc(f->DeprecationMessage);
+		}
+		break;
+	}
+
+	case AST_PropertyStmt:
+	{
+		auto n = static_cast<ZCC_PropertyStmt *>(node);
+		arc(n->Prop);
+		arc(n->Values);
+		break;
+	}
+
+	case AST_FlagStmt:
+	{
+		auto n = static_cast<ZCC_FlagStmt *>(node);
+		arc(n->name);
+		arc(n->set);
+		break;
+	}
+
+	case AST_MixinStmt:
+	{
+		auto n = static_cast<ZCC_MixinStmt *>(node);
+		arc(n->MixinName);
+		break;
+	}
+
+	default:
+		// Nodes without any fields of their own.
+		break;
+	}
+}
+
+//==========================================================================
+//
+// ASTCollector
+//
+// Finds everything reachable from the top node and assigns indices to
+// all nodes, names and strings. Index 0 is null for nodes and strings.
+//
+//==========================================================================
+
+struct ASTCollector
+{
+	TArray<ZCC_TreeNode *> Nodes;
+	TMap<ZCC_TreeNode *, uint32_t> NodeIndex;
+	TArray<FString *> Strings;
+	TMap<FString *, uint32_t> StringIndex;
+	TMap<int, uint32_t> NameIndex;
+	TArray<int> Names;
+	const TArray<int> &Lumps;
+	bool Failed = false;
+
+	ASTCollector(const TArray<int> &lumps) : Lumps(lumps)
+	{
+		Nodes.Push(nullptr);
+		Strings.Push(nullptr);
+	}
+
+	template<class T> void operator()(T *&node)
+	{
+		static_assert(std::is_base_of<ZCC_TreeNode, T>::value, "not a tree node");
+		if (node != nullptr && NodeIndex.CheckKey(node) == nullptr)
+		{
+			NodeIndex[node] = Nodes.Push(node);
+		}
+	}
+	void operator()(FString *&str)
+	{
+		if (str != nullptr && StringIndex.CheckKey(str) == nullptr)
+		{
+			StringIndex[str] = Strings.Push(str);
+		}
+	}
+	void operator()(ENamedName &name)
+	{
+		if (NameIndex.CheckKey(name) == nullptr)
+		{
+			NameIndex[name] = 0;
+			Names.Push(name);
+		}
+	}
+	void operator()(PType *&type)
+	{
+		if (KnownTypeIndex(type) < 0) Failed = true;
+	}
+	void Lump(int &lump)
+	{
+		if (Lumps.Find(lump) == Lumps.Size()) Failed = true;
+	}
+	template<class T> void operator()(T &) {}
+};
+
+//==========================================================================
+//
+// ASTWriter
+//
+//==========================================================================
+
+struct ASTWriter
+{
+	TArray<uint8_t> Data;
+	ASTCollector &Collector;
+
+	ASTWriter(ASTCollector &collector) : Collector(collector) {}
+
+	void Write(const void *data, size_t size)
+	{
+		auto pos = Data.Reserve((unsigned)size);
+		memcpy(&Data[pos], data, size);
+	}
+	void WriteUInt32(uint32_t v) { Write(&v, sizeof(v)); }
+	void WriteString(const char *str, size_t len)
+	{
+		WriteUInt32((uint32_t)len);
+		Write(str, len);
+	}
+
+	template<class T> void operator()(T *&node)
+	{
+		WriteUInt32(node == nullptr ? 0 : *Collector.NodeIndex.CheckKey(node));
+	}
+	void operator()(FString *&str)
+	{
+		WriteUInt32(str == nullptr ? 0 : *Collector.StringIndex.CheckKey(str));
+	}
+	void operator()(ENamedName &name)
+	{
+		WriteUInt32(*Collector.NameIndex.CheckKey(name));
+	}
+	void operator()(PType *&type)
+	{
+		WriteUInt32(KnownTypeIndex(type));
+	}
+	void operator()(VersionInfo &v)
+	{
+		uint32_t parts[] = { v.major, v.minor, v.revision };
+		Write(parts, sizeof(parts));
+	}
+	void operator()(bool &v)
+	{
+		uint8_t b = v;
+		Write(&b, 1);
+	}
+	void operator()(double &v)
+	{
+		Write(&v, sizeof(v));
+	}
+	template<class T> void operator()(T &v)
+	{
+		static_assert(std::is_integral<T>::value || std::is_enum<T>::value, "unsupported field type");
+		int32_t i = (int32_t)v;
+		Write(&i, sizeof(i));
+	}
+	void Lump(int &lump)
+	{
+		WriteUInt32(Collector.Lumps.Find(lump));
+	}
+};
+
+//==========================================================================
+//
+// ASTReader
+//
+// Any inconsistency in the data sets Failed and the result is discarded.
+//
+//==========================================================================
+
+struct ASTReader
+{
+	const uint8_t *Data;
+	size_t Size;
+	size_t Pos = 0;
+	bool Failed = false;
+
+	TArray<ZCC_TreeNode *> Nodes;
+	TArray<FString *> Strings;
+	TArray<int> Names;
+	TArray<int> Lumps;
+
+	ASTReader(const void *data, size_t size) : Data((const uint8_t *)data), Size(size) {}
+
+	void Read(void *data, size_t size)
+	{
+		if (Failed || Size - Pos < size)
+		{
+			Failed = true;
+			memset(data, 0, size);
+			return;
+		}
+		memcpy(data, Data + Pos, size);
+		Pos += size;
+	}
+	uint32_t ReadUInt32()
+	{
+		uint32_t v;
+		Read(&v, sizeof(v));
+		return v;
+	}
+	FString ReadString()
+	{
+		uint32_t len = ReadUInt32();
+		if (Failed || Size - Pos < len)
+		{
+			Failed = true;
+			return FString();
+		}
+		FString str((const char *)Data + Pos, len);
+		Pos += len;
+		return str;
+	}
+	uint32_t ReadIndex(unsigned count)
+	{
+		uint32_t index = ReadUInt32();
+		if (index >= count)
+		{
+			Failed = true;
+			return 0;
+		}
+		return index;
+	}
+
+	template<class T> void operator()(T *&node)
+	{
+		node = static_cast<T *>(Nodes[ReadIndex(Nodes.Size())]);
+	}
+	void operator()(FString *&str)
+	{
+		str = Strings[ReadIndex(Strings.Size())];
+	}
+	void operator()(ENamedName &name)
+	{
+		name = ENamedName(Names.Size() > 0 ? Names[ReadIndex(Names.Size())] : NAME_None);
+	}
+	void operator()(PType *&type)
+	{
+		type = KnownType(ReadUInt32());
+		if (type == (PType *)-1)
+		{
+			Failed = true;
+			type = nullptr;
+		}
+	}
+	void operator()(VersionInfo &v)
+	{
+		uint32_t parts[3];
+		Read(parts, sizeof(parts));
+		v.major = (uint16_t)parts[0];
+		v.minor = (uint16_t)parts[1];
+		v.revision = parts[2];
+	}
+	void operator()(bool &v)
+	{
+		uint8_t b;
+		Read(&b, 1);
+		v = !!b;
+	}
+	void operator()(double &v)
+	{
+		Read(&v, sizeof(v));
+	}
+	template<class T> void operator()(T &v)
+	{
+		int32_t i;
+		Read(&i, sizeof(i));
+		v = (T)i;
+	}
+	void Lump(int &lump)
+	{
+		lump = Lumps[ReadIndex(Lumps.Size())];
+	}
+};
+
+//==========================================================================
+//
+// Cache file header
+//
+// Lists every lump that went into the tree, so that any change to them
+// invalidates the cache. Includes are stored by name and looked up again,
+// because a newly loaded file may replace them.
+//
+//==========================================================================
+
+static FString CacheFileName(int baselump)
+{
+	MD5Context md5;
+	const char *build = GetGitHash();
+	md5.Update((const uint8_t *)build, (unsigned)strlen(build) + 1);
+	// The git hash does not change with uncommitted edits and is missing in
+	// plain source builds, so the build times of the parser and this
+	// serializer are part of the key as well.
+	const char *parsertime = ZCC_ParserBuildTime();
+	md5.Update((const uint8_t *)parsertime, (unsigned)strlen(parsertime) + 1);
+	const char *serializertime = __DATE__ " " __TIME__;
+	md5.Update((const uint8_t *)serializertime, (unsigned)strlen(serializertime) + 1);
+	auto path = fileSystem.GetFileFullPath(baselump);
+	md5.Update((const uint8_t *)path.c_str(), (unsigned)path.length());
+
+	uint8_t digest[16];
+	md5.Final(digest);
+
+	FString filename = M_GetCachePath(true);
+	filename << "/zscript";
+	CreatePath(filename.GetChars());
+	filename << '/';
+	for (auto b : digest) filename.AppendFormat("%02x", b);
+	filename << ".zdzc";
+	return filename;
+}
+
+static void HashLump(int lump, uint8_t digest[16])
+{
+	auto data = fileSystem.ReadFile(lump);
+	MD5Context md5;
+	md5.Update((const uint8_t *)data.data(), (unsigned)data.size());
+	md5.Final(digest);
+}
+
+//==========================================================================
+//
+// ZCC_ReadASTCache
+//
+// Returns false if there is no valid cache for this script, in which
+// case it needs to be parsed.
+//
+//==========================================================================
+
+bool ZCC_ReadASTCache(int baselump, ZCC_AST &ast)
+{
+	if (!zs_parse_cache)
+		return false;
+
+	FileReader fr;
+	if (!fr.OpenFile(CacheFileName(baselump).GetChars()))
+		return false;
+
+	auto buffer = fr.Read();
+	ASTReader arc(buffer.data(), buffer.size());
+
+	char magic[8];
+	arc.Read(magic, 8);
+	if (memcmp(magic, "zscache_", 8) != 0 || arc.ReadUInt32() != ASTCacheVersion)
+		return false;
+
+	auto basefile = fileSystem.GetFileContainer(baselump);
+	uint32_t numlumps = arc.ReadUInt32();
+	for (uint32_t i = 0; i < numlumps && !arc.Failed; i++)
+	{
+		FString name = arc.ReadString();
+		FString path = arc.ReadString();
+		uint8_t digest[16], newdigest[16];
+		arc.Read(digest, 16);
+
+		int lump = i == 0 ? baselump : fileSystem.CheckNumForFullName(name.GetChars(), true);
+		if (arc.Failed || lump < 0 || path.Compare(fileSystem.GetFileFullPath(lump).c_str()) != 0)
+			return false;
+
+		// Let the parser report core scripts being overridden.
+		if (basefile == 0 && fileSystem.GetFileContainer(lump) != 0)
+			return false;
+
+		HashLump(lump, newdigest);
+		if (memcmp(digest, newdigest, 16) != 0)
+			return false;
+
+		arc.Lumps.Push(lump);
+	}
+
+	arc(ast.ParseVersion);
+
+	uint32_t numnames = arc.ReadUInt32();
+	for (uint32_t i = 0; i < numnames && !arc.Failed; i++)
+	{
+		arc.Names.Push(FName(arc.ReadString().GetChars()).GetIndex());
+	}
+
+	uint32_t numstrings = arc.ReadUInt32();
+	arc.Strings.Push(nullptr);
+	for (uint32_t i = 1; i < numstrings && !arc.Failed; i++)
+	{
+		arc.Strings.Push(ast.Strings.Alloc(arc.ReadString()));
+	}
+
+	// All nodes need to exist before the pointers between them can be filled in.
+	uint32_t numnodes = arc.ReadUInt32();
+	if (arc.Failed || numnodes > arc.Size - arc.Pos)
+		return false;
+
+	arc.Nodes.Push(nullptr);
+	for (uint32_t i = 1; i < numnodes; i++)
+	{
+		uint8_t type;
+		arc.Read(&type, 1);
+		size_t size = NodeSize(EZCCTreeNodeType(type));
+		if (arc.Failed || size == 0)
+			return false;
+
+		auto node = ast.InitNode(size, EZCCTreeNodeType(type), nullptr);
+		memset((uint8_t *)node + sizeof(ZCC_TreeNode), 0, size - sizeof(ZCC_TreeNode));
+		arc.Nodes.Push(node);
+	}
+	for (uint32_t i = 1; i < numnodes && !arc.Failed; i++)
+	{
+		SerializeNode(arc, arc.Nodes[i]);
+	}
+
+	ZCC_TreeNode *top;
+	arc(top);
+	if (arc.Failed || top == nullptr)
+		return false;
+
+	ast.TopNode = top;
+	return true;
+}
+
+//==========================================================================
+//
+// ZCC_WriteASTCache
+//
+// lumps[0] must be the base lump, followed by all included lumps and
+// their names in 'includes'.
+//
+//==========================================================================
+
+void ZCC_WriteASTCache(const TArray<int> &lumps, const TArray<FString> &includes, ZCC_AST &ast)
+{
+	if (!zs_parse_cache || ast.TopNode == nullptr)
+		return;
+
+	ASTCollector collector(lumps);
+	collector(ast.TopNode);
+	for (unsigned i = 1; i < collector.Nodes.Size() && !collector.Failed; i++)
+	{
+		SerializeNode(collector, collector.Nodes[i]);
+	}
+	if (collector.Failed || collector.Nodes.Size() > 0x10000000)
+		return;
+
+	// Recreating the names in their original order keeps the name table the same as after a regular parse.
+	std::sort(collector.Names.begin(), collector.Names.end());
+	for (unsigned i = 0; i < collector.Names.Size(); i++)
+	{
+		collector.NameIndex[collector.Names[i]] = i;
+	}
+
+	ASTWriter arc(collector);
+	arc.Write("zscache_", 8);
+	arc.WriteUInt32(ASTCacheVersion);
+
+	arc.WriteUInt32(lumps.Size());
+	for (unsigned i = 0; i < lumps.Size(); i++)
+	{
+		const char *name = i == 0 ? "" : includes[i - 1].GetChars();
+		auto path = fileSystem.GetFileFullPath(lumps[i]);
+		uint8_t digest[16];
+		HashLump(lumps[i], digest);
+		arc.WriteString(name, strlen(name));
+		arc.WriteString(path.c_str(), path.length());
+		arc.Write(digest, 16);
+	}
+
+	arc(ast.ParseVersion);
+
+	arc.WriteUInt32(collector.Names.Size());
+	for (int name : collector.Names)
+	{
+		const char *chars = FName(ENamedName(name)).GetChars();
+		arc.WriteString(chars, strlen(chars));
+	}
+
+	arc.WriteUInt32(collector.Strings.Size());
+	for (unsigned i = 1; i < collector.Strings.Size(); i++)
+	{
+		arc.WriteString(collector.Strings[i]->GetChars(), collector.Strings[i]->Len());
+	}
+
+	arc.WriteUInt32(collector.Nodes.Size());
+	for (unsigned i = 1; i < collector.Nodes.Size(); i++)
+	{
+		uint8_t type = collector.Nodes[i]->NodeType;
+		arc.Write(&type, 1);
+	}
+	for (unsigned i = 1; i < collector.Nodes.Size(); i++)
+	{
+		SerializeNode(arc, collector.Nodes[i]);
+	}
+	arc(ast.TopNode);
+
+	std::unique_ptr<FileWriter> fw(FileWriter::Open(CacheFileName(lumps[0]).GetChars()));
+	if (fw)
+	{
+		fw->Write(arc.Data.Data(), arc.Data.Size());
+	}
+}
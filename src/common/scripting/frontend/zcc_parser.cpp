@@ -113,6 +113,21 @@ void AddInclude(ZCC_ExprConstant *node)
 #include "zcc-parse.h"
 #include "zcc-parse.c"
 
+//==========================================================================
+//
+// ZCC_ParserBuildTime
+//
+// When the parser and its grammar were compiled. Part of the key for
+// cached syntax trees, so a rebuilt parser never loads trees produced by
+// an older one.
+//
+//==========================================================================
+
+const char *ZCC_ParserBuildTime()
+{
+	return __DATE__ " " __TIME__;
+}
+
 struct TokenMapEntry
 {
 	int16_t TokenType;
@@ -405,19 +420,22 @@ parse_end:
 	value.Int = -1;
 	ZCCParse(parser, ZCC_EOF, value, &state);
 	state.sc = nullptr;
+	if (sc.ParseError) state.ScannerErrors = true;
 }
 
 //**--------------------------------------------------------------------------
 
-PNamespace *ParseOneScript(const int baselump, ZCCParseState &state)
+static void ParseScriptLumps(const int baselump, ZCCParseState &state)
 {
 	FScanner sc;
 	void *parser;
 	ZCCToken value;
 	int lumpnum = baselump;
-	auto fileno = fileSystem.GetFileContainer(lumpnum);
-
-	state.FileNo = fileno;
+	auto fileno = state.FileNo;
+	int warnings = FScriptPosition::WarnCounter;
+	TArray<int> lumps;
+	TArray<FString> includes;
+	lumps.Push(baselump);
 
 	if (TokenMap.CountUsed() == 0)
 	{
@@ -496,6 +514,8 @@ PNamespace *ParseOneScript(const int baselump, ZCCParseState &state)
 			}
 
 			ParseSingleFile(nullptr, nullptr, lumpnum, parser, state);
+			lumps.Push(lumpnum);
+			includes.Push(Includes[i]);
 		}
 	}
 	Includes.Clear();
@@ -521,6 +541,26 @@ PNamespace *ParseOneScript(const int baselump, ZCCParseState &state)
 	}
 #endif
 
+	// Scripts with warnings are parsed again each time so that the warnings don't get lost.
+	if (FScriptPosition::WarnCounter == warnings && !state.ScannerErrors)
+	{
+		ZCC_WriteASTCache(lumps, includes, state);
+	}
+}
+
+PNamespace *ParseOneScript(const int baselump, ZCCParseState &state)
+{
+	state.FileNo = fileSystem.GetFileContainer(baselump);
+
+	if (ZCC_ReadASTCache(baselump, state))
+	{
+		DPrintf(DMSG_NOTIFY, "Using cached syntax tree for %s\n", fileSystem.GetFileFullPath(baselump).c_str());
+	}
+	else
+	{
+		ParseScriptLumps(baselump, state);
+	}
+
 	// Make a dump of the AST before running the compiler for diagnostic purposes.
 	if (Args->CheckParm("-dumpast"))
 	{
@@ -690,12 +690,18 @@ struct ZCCParseState : public ZCC_AST
 	ZCC_TreeNode *InitNode(size_t size, EZCCTreeNodeType type);
 
 	FScanner *sc;
+	bool ScannerErrors = false;	// errors that the scanner printed directly, without going through FScriptPosition.
 };
 
 const char *GetMixinTypeString(EZCCMixinType type);
 
 ZCC_TreeNode *TreeNodeDeepCopy(ZCC_AST *ast, ZCC_TreeNode *orig, bool copySiblings);
 
+// Caching of parsed syntax trees between sessions (zcc_astcache.cpp)
+bool ZCC_ReadASTCache(int baselump, ZCC_AST &ast);
+void ZCC_WriteASTCache(const TArray<int> &lumps, const TArray<FString> &includes, ZCC_AST &ast);
+const char *ZCC_ParserBuildTime();
+
 // Main entry point for the parser. Returns some data needed by the compiler.
 PNamespace* ParseOneScript(const int baselump, ZCCParseState& state);
 
@@ -2,6 +2,7 @@
 #include "jit.h"
 #include "jitintern.h"
 #include "printf.h"
+#include "stats.h"
 
 extern PString *TypeString;
 extern PStruct *TypeVector2;
@@ -29,8 +30,13 @@ JitFuncPtr JitCompile(VMScriptFunction *sfunc)
 		code.setErrorHandler(&errorHandler);
 		code.setLogger(&logger);
 
+		cycle_t time;
+		time.ResetAndClock();
 		JitCompiler compiler(&code, sfunc);
-		return reinterpret_cast<JitFuncPtr>(AddJitFunction(&code, &compiler));
+		auto func = reinterpret_cast<JitFuncPtr>(AddJitFunction(&code, &compiler));
+		time.Unclock();
+		JitCacheNoteCompile(time.TimeMS());
+		return func;
 	}
 	catch (const CRecoverableError &e)
 	{
@@ -38,6 +44,11 @@ JitFuncPtr JitCompile(VMScriptFunction *sfunc)
 		Printf("%s: Unexpected JIT error: %s\n",sfunc->PrintableName, e.what());
 		return nullptr;
 	}
+	catch (const AsmJitException &e)
+	{
+		Printf(TEXTCOLOR_ORANGE "%s: JIT failed: %s. Function will not use native code.\n", sfunc->PrintableName, e.what());
+		return nullptr;
+	}
 }
 
 void JitDumpLog(FILE *file, VMScriptFunction *sfunc)
@@ -141,8 +152,11 @@ asmjit::CCFunc *JitCompiler::Codegen()
 		}
 
 		labels[i].cursor = cc.getCursor();
+		spillCursor = labels[i].cursor;
 		ResetTemp();
 		EmitOpcode();
+		if (spilling)
+			StoreSpilledRegisters();
 
 		pc++;
 	}
@@ -287,7 +301,8 @@ void JitCompiler::SetupFrame()
 	offsetD = offsetA + (int)(sfunc->NumRegA * sizeof(void*));
 	offsetExtra = (offsetD + (int)(sfunc->NumRegD * sizeof(int32_t)) + 15) & ~15;
 
-	if (sfunc->SpecialInits.Size() == 0 && sfunc->NumRegS == 0 && sfunc->ExtraSpace == 0)
+	// Spilled registers need the VM frame to live in.
+	if (!spilling && sfunc->SpecialInits.Size() == 0 && sfunc->NumRegS == 0 && sfunc->ExtraSpace == 0)
 	{
 		SetupSimpleFrame();
 	}
@@ -409,16 +424,20 @@ void JitCompiler::SetupFullVMFrame()
 	vmframeAllocated = true;
 
 	for (int i = 0; i < sfunc->NumRegD; i++)
-		cc.mov(regD[i], x86::dword_ptr(vmframe, offsetD + i * sizeof(int32_t)));
+		if (!regD.IsSpilled(i))
+			cc.mov(regD[i], x86::dword_ptr(vmframe, offsetD + i * sizeof(int32_t)));
 
 	for (int i = 0; i < sfunc->NumRegF; i++)
-		cc.movsd(regF[i], x86::qword_ptr(vmframe, offsetF + i * sizeof(double)));
+		if (!regF.IsSpilled(i))
+			cc.movsd(regF[i], x86::qword_ptr(vmframe, offsetF + i * sizeof(double)));
 
 	for (int i = 0; i < sfunc->NumRegS; i++)
-		cc.lea(regS[i], x86::ptr(vmframe, offsetS + i * sizeof(FString)));
+		if (!regS.IsSpilled(i))
+			cc.lea(regS[i], x86::ptr(vmframe, offsetS + i * sizeof(FString)));
 
 	for (int i = 0; i < sfunc->NumRegA; i++)
-		cc.mov(regA[i], x86::ptr(vmframe, offsetA + i * sizeof(void*)));
+		if (!regA.IsSpilled(i))
+			cc.mov(regA[i], x86::ptr(vmframe, offsetA + i * sizeof(void*)));
 }
 
 static void PopFullVMFrame(VMFrameStack *stack)
@@ -428,7 +447,7 @@ static void PopFullVMFrame(VMFrameStack *stack)
 
 void JitCompiler::EmitPopFrame()
 {
-	if (sfunc->SpecialInits.Size() != 0 || sfunc->NumRegS != 0 || sfunc->ExtraSpace != 0)
+	if (spilling || sfunc->SpecialInits.Size() != 0 || sfunc->NumRegS != 0 || sfunc->ExtraSpace != 0)
 	{
 		auto popFrame = CreateCall<void, VMFrameStack *>(PopFullVMFrame);
 		popFrame->setArg(0, stack);
@@ -453,31 +472,141 @@ void JitCompiler::CreateRegisters()
 	regA.Resize(sfunc->NumRegA);
 	regS.Resize(sfunc->NumRegS);
 
+	// If there are too many registers, each type keeps its share of the budget in asmjit registers.
+	// The code generator hands out the lowest free register first, so the low ones are used the most.
+	int numregs = sfunc->NumRegD + sfunc->NumRegF + sfunc->NumRegS + sfunc->NumRegA;
+	spilling = numregs >= MaxRegisters;
+	int residentD = spilling ? sfunc->NumRegD * MaxResidentRegisters / numregs : sfunc->NumRegD;
+	int residentF = spilling ? sfunc->NumRegF * MaxResidentRegisters / numregs : sfunc->NumRegF;
+	int residentS = spilling ? sfunc->NumRegS * MaxResidentRegisters / numregs : sfunc->NumRegS;
+	int residentA = spilling ? sfunc->NumRegA * MaxResidentRegisters / numregs : sfunc->NumRegA;
+
+	spillPosInt32 = spillPosIntPtr = spillPosXmmSd = 0;
+
 	for (int i = 0; i < sfunc->NumRegD; i++)
 	{
+		if (i >= residentD)
+		{
+			regD.Spill(i);
+			continue;
+		}
 		regname.Format("regD%d", i);
 		regD[i] = cc.newInt32(regname.GetChars());
 	}
 
 	for (int i = 0; i < sfunc->NumRegF; i++)
 	{
+		if (i >= residentF)
+		{
+			regF.Spill(i);
+			continue;
+		}
 		regname.Format("regF%d", i);
 		regF[i] = cc.newXmmSd(regname.GetChars());
 	}
 
 	for (int i = 0; i < sfunc->NumRegS; i++)
 	{
+		if (i >= residentS)
+		{
+			regS.Spill(i);
+			continue;
+		}
 		regname.Format("regS%d", i);
 		regS[i] = cc.newIntPtr(regname.GetChars());
 	}
 
 	for (int i = 0; i < sfunc->NumRegA; i++)
 	{
+		if (i >= residentA)
+		{
+			regA.Spill(i);
+			continue;
+		}
 		regname.Format("regA%d", i);
 		regA[i] = cc.newIntPtr(regname.GetChars());
 	}
 }
 
+// Loads a spilled register from the VM frame at the start of the current opcode,
+// so that it is valid on every path through the opcode's code.
+void JitCompiler::LoadSpilledRegister(int regtype, int index)
+{
+	using namespace asmjit;
+
+	auto cursor = cc.getCursor();
+	bool atStart = cursor == spillCursor;
+	cc.setCursor(spillCursor);
+
+	switch (regtype)
+	{
+	case REGT_INT:
+		regD.regs[index] = newTempRegister(regSpillInt32, spillPosInt32, "spillDword", [&](const char *name) { return cc.newInt32(name); });
+		cc.mov(regD.regs[index], x86::dword_ptr(vmframe, offsetD + index * sizeof(int32_t)));
+		regD.loaded[index] = true;
+		break;
+
+	case REGT_FLOAT:
+		regF.regs[index] = newTempRegister(regSpillXmmSd, spillPosXmmSd, "spillXmmSd", [&](const char *name) { return cc.newXmmSd(name); });
+		cc.movsd(regF.regs[index], x86::qword_ptr(vmframe, offsetF + index * sizeof(double)));
+		regF.loaded[index] = true;
+		break;
+
+	case REGT_STRING:
+		regS.regs[index] = newTempRegister(regSpillIntPtr, spillPosIntPtr, "spillPtr", [&](const char *name) { return cc.newIntPtr(name); });
+		cc.lea(regS.regs[index], x86::ptr(vmframe, offsetS + index * sizeof(FString)));
+		regS.loaded[index] = true;
+		break;
+
+	case REGT_POINTER:
+		regA.regs[index] = newTempRegister(regSpillIntPtr, spillPosIntPtr, "spillPtr", [&](const char *name) { return cc.newIntPtr(name); });
+		cc.mov(regA.regs[index], x86::ptr(vmframe, offsetA + index * sizeof(void*)));
+		regA.loaded[index] = true;
+		break;
+	}
+	loadedSpills.Push({ regtype, index });
+
+	spillCursor = cc.getCursor();
+	if (!atStart)
+		cc.setCursor(cursor);
+}
+
+// Writes the spilled registers the current opcode used back to the VM frame.
+// No opcode jumps to another one after changing a register, so this only needs to be done at the end.
+void JitCompiler::StoreSpilledRegisters()
+{
+	using namespace asmjit;
+
+	for (auto &spill : loadedSpills)
+	{
+		int index = spill.second;
+		switch (spill.first)
+		{
+		case REGT_INT:
+			cc.mov(x86::dword_ptr(vmframe, offsetD + index * sizeof(int32_t)), regD.regs[index]);
+			regD.loaded[index] = false;
+			break;
+
+		case REGT_FLOAT:
+			cc.movsd(x86::qword_ptr(vmframe, offsetF + index * sizeof(double)), regF.regs[index]);
+			regF.loaded[index] = false;
+			break;
+
+		case REGT_STRING:
+			// Points into the frame, there is nothing to write back.
+			regS.loaded[index] = false;
+			break;
+
+		case REGT_POINTER:
+			cc.mov(x86::ptr(vmframe, offsetA + index * sizeof(void*)), regA.regs[index]);
+			regA.loaded[index] = false;
+			break;
+		}
+	}
+	loadedSpills.Clear();
+	spillPosInt32 = spillPosIntPtr = spillPosXmmSd = 0;
+}
+
 void JitCompiler::EmitNullPointerThrow(int index, EVMAbortException reason)
 {
 	auto label = EmitThrowExceptionLabel(reason);
@@ -6,3 +6,15 @@
 JitFuncPtr JitCompile(VMScriptFunction *func);
 void JitDumpLog(FILE *file, VMScriptFunction *func);
 FString JitCaptureStackTrace(int framesToSkip, bool includeNativeFrames, int maxFrames = -1);
+
+bool JitCacheWantsAot(VMScriptFunction *func);
+void JitCacheWatchCalls(VMScriptFunction *func);
+void JitCacheNoteCall(VMScriptFunction *func);
+void JitCacheNoteCompile(double ms);
+void JitCacheReport();
+void JitCacheSave();
+
+extern int JitInlinedCalls;
+extern int JitCachedCalls;
+extern int JitCallCacheFills;
+extern int JitCallCacheMisses;
@@ -0,0 +1,298 @@
+/*
+** jit_cache.cpp
+**
+** Remembers which script functions were called in earlier sessions, so
+** that the ones known to go uncalled are not compiled ahead of time.
+** Everything else, including functions that are new or changed since the
+** last session, still is.
+**
+** The native code itself cannot be kept between sessions. It has the
+** addresses of the function, its constants and the engine's helpers baked
+** into it and all of those are different with every launch. What can be
+** avoided is compiling the large majority of functions that a mod defines
+** but never calls. Calls to functions compiled ahead of time are noticed
+** by a stand-in entry point that puts the real one back on first use.
+**
+*/
+
+#include "jit.h"
+#include "c_cvars.h"
+#include "cmdlib.h"
+#include "files.h"
+#include "i_specialpaths.h"
+#include "md5.h"
+#include "printf.h"
+#include "types.h"
+#include "version.h"
+#include <chrono>
+#include <memory>
+
+CVAR(Bool, vm_jit_cache, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+
+// Entries that were not used for this long are dropped.
+static const uint64_t JitCacheExpiry = 30 * 24 * 60 * 60;
+
+struct FJitCacheEntry
+{
+	uint64_t LastSeen = 0;		// launch time the function last existed
+	uint64_t LastCalled = 0;	// launch time it was last called, 0 for never
+};
+
+static FString CacheFilename;
+static TMap<uint64_t, FJitCacheEntry> CachedFunctions;	// function hash -> usage
+static uint64_t LaunchTime;
+static bool CacheLoaded;
+static bool CacheChanged;
+
+// Stats for JitCacheReport
+static int AotCalled;
+static int AotNew;
+static int AotSkipped;
+static int CompileCount;
+static double CompileMS;
+
+//==========================================================================
+//
+// HashFunction
+//
+// Everything the generated code depends on, except for the addresses of
+// pointer constants, which are different with every launch.
+//
+//==========================================================================
+
+static uint64_t HashFunction(VMScriptFunction *func)
+{
+	MD5Context md5;
+	auto add = [&](const void *data, size_t size)
+	{
+		if (size > 0) md5.Update((const uint8_t *)data, (unsigned)size);
+	};
+
+	const char *build = GetGitHash();
+	add(build, strlen(build) + 1);
+	if (func->PrintableName != nullptr)
+	{
+		add(func->PrintableName, strlen(func->PrintableName) + 1);
+	}
+
+	uint32_t layout[] = { func->NumRegD, func->NumRegF, func->NumRegS, func->NumRegA,
+		func->NumKonstD, func->NumKonstF, func->NumKonstS, func->NumKonstA,
+		func->MaxParam, func->NumArgs, (uint32_t)func->ExtraSpace, (uint32_t)func->CodeSize };
+	add(layout, sizeof(layout));
+	add(func->Code, func->CodeSize * sizeof(VMOP));
+	add(func->KonstD, func->NumKonstD * sizeof(int));
+	add(func->KonstF, func->NumKonstF * sizeof(double));
+	for (int i = 0; i < func->NumKonstS; i++)
+	{
+		add(func->KonstS[i].GetChars(), func->KonstS[i].Len() + 1);
+	}
+
+	uint8_t digest[16];
+	md5.Final(digest);
+	uint64_t hash;
+	memcpy(&hash, digest, sizeof(hash));
+	return hash;
+}
+
+//==========================================================================
+//
+// LoadJitCache
+//
+//==========================================================================
+
+static void LoadJitCache()
+{
+	CacheLoaded = true;
+
+	using namespace std::chrono;
+	LaunchTime = (uint64_t)(duration_cast<seconds>(system_clock::now().time_since_epoch()).count());
+
+	FString path = M_GetCachePath(true);
+	CreatePath(path.GetChars());
+	CacheFilename = path + "/jitcache.zdjc";
+
+	FileReader fr;
+	if (!fr.OpenFile(CacheFilename.GetChars()))
+		return;
+
+	char magic[8] = {};
+	fr.Read(magic, 8);
+	if (memcmp(magic, "jitcache", 8) != 0 || fr.ReadUInt32() != 2)
+		return;
+
+	uint32_t count = fr.ReadUInt32();
+	for (uint32_t i = 0; i < count; i++)
+	{
+		uint64_t entry[3];
+		if (fr.Read(entry, sizeof(entry)) != (FileReader::Size)sizeof(entry))
+			break;
+
+		if (entry[1] + JitCacheExpiry > LaunchTime)
+		{
+			CachedFunctions[entry[0]] = { entry[1], entry[2] };
+		}
+	}
+}
+
+//==========================================================================
+//
+// JitCacheWantsAot
+//
+// Decides whether a function should be compiled right after code
+// generation. Only functions that existed in an earlier session and were
+// not called in it for a while are left for their first call.
+//
+//==========================================================================
+
+bool JitCacheWantsAot(VMScriptFunction *func)
+{
+	if (!vm_jit_cache)
+		return true;
+
+	if (!CacheLoaded)
+		LoadJitCache();
+
+	auto &entry = CachedFunctions[HashFunction(func)];
+	bool known = entry.LastSeen != 0;
+	if (entry.LastSeen != LaunchTime)
+	{
+		entry.LastSeen = LaunchTime;
+		CacheChanged = true;
+	}
+
+	if (!known)
+	{
+		AotNew++;
+		return true;
+	}
+	if (entry.LastCalled != 0 && entry.LastCalled + JitCacheExpiry > LaunchTime)
+	{
+		AotCalled++;
+		return true;
+	}
+	AotSkipped++;
+	return false;
+}
+
+//==========================================================================
+//
+// WatchedScriptCall
+//
+// Entry point of a function compiled ahead of time until it gets called.
+//
+//==========================================================================
+
+static int WatchedScriptCall(VMFunction *func, VMValue *params, int numparams, VMReturn *ret, int numret)
+{
+	auto sfunc = static_cast<VMScriptFunction *>(func);
+	auto call = sfunc->UnwatchedCall;
+
+	// The profiler may have taken over ScriptCall in the meantime.
+	if (sfunc->UnprofiledCall == &WatchedScriptCall) sfunc->UnprofiledCall = call;
+	else sfunc->ScriptCall = call;
+	sfunc->UnwatchedCall = nullptr;
+
+	JitCacheNoteCall(sfunc);
+	return call(func, params, numparams, ret, numret);
+}
+
+//==========================================================================
+//
+// JitCacheWatchCalls
+//
+// Called after a function was compiled ahead of time, so that the cache
+// finds out if it gets called.
+//
+//==========================================================================
+
+void JitCacheWatchCalls(VMScriptFunction *func)
+{
+	if (!vm_jit_cache || !CacheLoaded || (func->VarFlags & VARF_Abstract))
+		return;
+
+	func->UnwatchedCall = func->ScriptCall;
+	func->ScriptCall = &WatchedScriptCall;
+}
+
+//==========================================================================
+//
+// JitCacheNoteCall
+//
+// Called when a function is called for the first time.
+//
+//==========================================================================
+
+void JitCacheNoteCall(VMScriptFunction *func)
+{
+	if (!vm_jit_cache || !CacheLoaded)
+		return;
+
+	auto &entry = CachedFunctions[HashFunction(func)];
+	entry.LastSeen = entry.LastCalled = LaunchTime;
+	CacheChanged = true;
+}
+
+//==========================================================================
+//
+// JitCacheNoteCompile
+//
+//==========================================================================
+
+void JitCacheNoteCompile(double ms)
+{
+	CompileCount++;
+	CompileMS += ms;
+}
+
+//==========================================================================
+//
+// JitCacheReport
+//
+// Prints the cache's hit rate for the functions that were just generated.
+//
+//==========================================================================
+
+void JitCacheReport()
+{
+	int total = AotCalled + AotNew + AotSkipped;
+	if (!vm_jit_cache || total == 0)
+		return;
+
+	double average = CompileCount > 0 ? CompileMS / CompileCount : 0;
+	Printf("JIT cache: compiled %d of %d functions ahead of time (%d new) in %.1f ms, skipped %d that went uncalled before, saving about %.1f ms\n",
+		AotCalled + AotNew, total, AotNew, CompileMS, AotSkipped, AotSkipped * average);
+	AotCalled = AotNew = AotSkipped = 0;
+	CompileCount = 0;
+	CompileMS = 0;
+}
+
+//==========================================================================
+//
+// JitCacheSave
+//
+//==========================================================================
+
+void JitCacheSave()
+{
+	if (!CacheChanged)
+		return;
+	CacheChanged = false;
+
+	std::unique_ptr<FileWriter> fw(FileWriter::Open(CacheFilename.GetChars()));
+	if (!fw)
+		return;
+
+	uint32_t version = 2;
+	uint32_t count = CachedFunctions.CountUsed();
+	fw->Write("jitcache", 8);
+	fw->Write(&version, sizeof(version));
+	fw->Write(&count, sizeof(count));
+
+	TMap<uint64_t, FJitCacheEntry>::Iterator it(CachedFunctions);
+	TMap<uint64_t, FJitCacheEntry>::Pair *pair;
+	while (it.NextPair(pair))
+	{
+		uint64_t entry[3] = { pair->Key, pair->Value.LastSeen, pair->Value.LastCalled };
+		fw->Write(entry, sizeof(entry));
+	}
+}
@@ -1,8 +1,18 @@
 
 #include "jitintern.h"
+#include "c_cvars.h"
 #include <map>
 #include <memory>
 
+CVAR(Bool, vm_jit_inline, true, 0)
+
+int JitInlinedCalls;
+int JitCachedCalls;
+int JitCallCacheFills;
+int JitCallCacheMisses;
+
+static FMemArena JitCallCacheArena(16384);
+
 void JitCompiler::EmitPARAM()
 {
 	ParamOpcodes.Push(pc);
@@ -25,9 +35,8 @@ void JitCompiler::EmitVTBL()
 	// This instruction is handled in the CALL/CALL_K instruction following it
 }
 
-void JitCompiler::EmitVtbl(const VMOP *op)
+void JitCompiler::EmitVtbl(const VMOP *op, asmjit::X86Gp vmfunc)
 {
-	int a = op->a;
 	int b = op->b;
 	int c = op->c;
 
@@ -35,14 +44,30 @@ void JitCompiler::EmitVtbl(const VMOP *op)
 	cc.test(regA[b], regA[b]);
 	cc.jz(label);
 
-	cc.mov(regA[a], asmjit::x86::qword_ptr(regA[b], myoffsetof(DObject, Class)));
-	cc.mov(regA[a], asmjit::x86::qword_ptr(regA[a], myoffsetof(PClass, Virtuals) + myoffsetof(FArray, Array)));
-	cc.mov(regA[a], asmjit::x86::qword_ptr(regA[a], c * (int)sizeof(void*)));
+	cc.mov(vmfunc, asmjit::x86::qword_ptr(regA[b], myoffsetof(DObject, Class)));
+	cc.mov(vmfunc, asmjit::x86::qword_ptr(vmfunc, myoffsetof(PClass, Virtuals) + myoffsetof(FArray, Array)));
+	cc.mov(vmfunc, asmjit::x86::qword_ptr(vmfunc, c * (int)sizeof(void*)));
 }
 
 void JitCompiler::EmitCALL()
 {
-	EmitVMCall(regA[A], nullptr);
+	// The function register of a virtual call may share its number with one of the
+	// parameters, so the vtable lookup must not write to it before the call is made.
+	asmjit::X86Gp vmfunc;
+	if (pc > sfunc->Code && (pc - 1)->op == OP_VTBL)
+	{
+		vmfunc = newTempIntPtr();
+		EmitVtbl(pc - 1, vmfunc);
+	}
+	else
+	{
+		vmfunc = regA[A];
+	}
+
+	if (vm_jit_inline)
+		EmitCachedCall(vmfunc);
+	else
+		EmitVMCall(vmfunc, nullptr);
 	pc += C; // Skip RESULTs
 }
 
@@ -58,6 +83,10 @@ void JitCompiler::EmitCALL_K()
 	{
 		EmitNativeCall(ntarget);
 	}
+	else if (vm_jit_inline && EmitInlineCall(target))
+	{
+		JitInlinedCalls++;
+	}
 	else
 	{
 		auto ptr = newTempIntPtr();
@@ -78,9 +107,6 @@ void JitCompiler::EmitVMCall(asmjit::X86Gp vmfunc, VMFunction *target)
 	if (numparams != B)
 		I_Error("OP_CALL parameter count does not match the number of preceding OP_PARAM instructions");
 
-	if (pc > sfunc->Code && (pc - 1)->op == OP_VTBL)
-		EmitVtbl(pc - 1);
-
 	FillReturns(pc + 1, C);
 
 	X86Gp paramsptr = newTempIntPtr();
@@ -105,6 +131,237 @@ void JitCompiler::EmitVMCall(asmjit::X86Gp vmfunc, VMFunction *target)
 	ParamOpcodes.Clear();
 }
 
+//==========================================================================
+//
+// Call site inlining
+//
+// Script functions that do nothing, only return an integer constant or
+// only return a field of self do not get called at all. A direct call gets
+// the function body emitted in its place. An indirect call (virtual or
+// through a function pointer) gets a cache that remembers the last target
+// it saw, so that a call site that always ends up in the same trivial
+// function only pays for a compare. A site that reaches a function that
+// is not trivial, or whose target keeps changing, stops caching and from
+// then on only checks for that before making the call.
+//
+//==========================================================================
+
+enum
+{
+	JCC_Call,
+	JCC_Empty,
+	JCC_ConstInt,
+	JCC_Unfilled,
+};
+
+// Target changes after which a call site stops caching.
+static const int JitCallCacheMaxMisses = 4;
+
+static int ClassifyTrivialFunction(VMFunction *func, int &value)
+{
+	if (func == nullptr || (func->VarFlags & (VARF_Native | VARF_Abstract)))
+		return JCC_Call;
+
+	auto sfunc = static_cast<VMScriptFunction *>(func);
+	const VMOP *code = sfunc->Code;
+	if (code == nullptr || sfunc->CodeSize < 1)
+		return JCC_Call;
+
+	if (code[0].op == OP_RET && code[0].b == REGT_NIL)
+	{
+		return JCC_Empty;
+	}
+	else if (code[0].op == OP_RET && code[0].a == RET_FINAL && code[0].b == (REGT_INT | REGT_KONST))
+	{
+		value = sfunc->KonstD[code[0].c];
+		return JCC_ConstInt;
+	}
+	else if (code[0].op == OP_RETI && code[0].a == RET_FINAL)
+	{
+		value = code[0].i16;
+		return JCC_ConstInt;
+	}
+	return JCC_Call;
+}
+
+static void UpdateCallCache(JitCallCache *cache, VMFunction *func)
+{
+	if (cache->Kind == JCC_Unfilled)
+	{
+		JitCallCacheFills++;
+	}
+	else
+	{
+		JitCallCacheMisses++;
+		cache->Misses++;
+	}
+
+	int value = 0;
+	int kind = ClassifyTrivialFunction(func, value);
+	if (kind == JCC_Call || cache->Misses >= JitCallCacheMaxMisses)
+	{
+		cache->Target = nullptr;
+		cache->Kind = JCC_Call;
+		cache->Value = 0;
+	}
+	else
+	{
+		cache->Target = func;
+		cache->Kind = kind;
+		cache->Value = value;
+	}
+}
+
+void JitReleaseCallCaches()
+{
+	JitCallCacheArena.FreeAll();
+}
+
+// Can the integer result of an inlined function be stored directly into the call's result register?
+static bool IsIntResult(const VMOP *retval, int numret)
+{
+	return numret > 0 && retval->op == OP_RESULT && retval->b == REGT_INT;
+}
+
+bool JitCompiler::EmitInlineCall(VMFunction *target)
+{
+	using namespace asmjit;
+
+	int value = 0;
+	switch (ClassifyTrivialFunction(target, value))
+	{
+	case JCC_Empty:
+		ParamOpcodes.Clear();
+		return true;
+
+	case JCC_ConstInt:
+		if (C > 0 && !IsIntResult(pc + 1, C))
+			return false;
+		if (C > 0)
+			cc.mov(regD[pc[1].c], value);
+		ParamOpcodes.Clear();
+		return true;
+
+	default:
+		break;
+	}
+
+	// Getters: a single load from self followed by returning the loaded value.
+	if (target == nullptr || (target->VarFlags & (VARF_Native | VARF_Abstract)) || target->ImplicitArgs == 0)
+		return false;
+
+	auto callee = static_cast<VMScriptFunction *>(target);
+	const VMOP *code = callee->Code;
+	if (code == nullptr || callee->CodeSize < 2 || code[0].b != 0)
+		return false;
+	if (code[1].op != OP_RET || code[1].a != RET_FINAL || code[1].c != code[0].a)
+		return false;
+	if (ParamOpcodes.Size() == 0 || ParamOpcodes[0]->op != OP_PARAM || ParamOpcodes[0]->a != REGT_POINTER)
+		return false;
+
+	int type;
+	switch (code[0].op)
+	{
+	case OP_LB: case OP_LH: case OP_LW: case OP_LBU: case OP_LHU:
+		type = REGT_INT;
+		break;
+	case OP_LSP: case OP_LDP:
+		type = REGT_FLOAT;
+		break;
+	case OP_LP:
+		type = REGT_POINTER;
+		break;
+	default:
+		return false;
+	}
+	if (code[1].b != type || C > 1 || (C == 1 && (pc[1].op != OP_RESULT || pc[1].b != type)))
+		return false;
+
+	int self = ParamOpcodes[0]->i16u;
+	int offset = callee->KonstD[code[0].c];
+	EmitNullPointerThrow(self, X_READ_NIL);
+
+	if (C == 1)
+	{
+		int dest = pc[1].c;
+		switch (code[0].op)
+		{
+		case OP_LB: cc.movsx(regD[dest], x86::byte_ptr(regA[self], offset)); break;
+		case OP_LH: cc.movsx(regD[dest], x86::word_ptr(regA[self], offset)); break;
+		case OP_LW: cc.mov(regD[dest], x86::dword_ptr(regA[self], offset)); break;
+		case OP_LBU: cc.movzx(regD[dest], x86::byte_ptr(regA[self], offset)); break;
+		case OP_LHU: cc.movzx(regD[dest], x86::word_ptr(regA[self], offset)); break;
+		case OP_LSP:
+			cc.xorpd(regF[dest], regF[dest]);
+			cc.cvtss2sd(regF[dest], x86::dword_ptr(regA[self], offset));
+			break;
+		case OP_LDP: cc.movsd(regF[dest], x86::qword_ptr(regA[self], offset)); break;
+		case OP_LP: cc.mov(regA[dest], x86::ptr(regA[self], offset)); break;
+		}
+	}
+	ParamOpcodes.Clear();
+	return true;
+}
+
+void JitCompiler::EmitCachedCall(asmjit::X86Gp vmfunc)
+{
+	using namespace asmjit;
+
+	auto cache = (JitCallCache *)JitCallCacheArena.Alloc(sizeof(JitCallCache));
+	cache->Target = nullptr;
+	cache->Kind = JCC_Unfilled;
+	cache->Value = 0;
+	cache->Misses = 0;
+	JitCachedCalls++;
+
+	auto cacheptr = newTempIntPtr();
+	auto check = cc.newLabel();
+	auto miss = cc.newLabel();
+	auto docall = cc.newLabel();
+	auto done = cc.newLabel();
+
+	cc.mov(cacheptr, imm_ptr(cache));
+	cc.bind(check);
+	cc.cmp(x86::dword_ptr(cacheptr, myoffsetof(JitCallCache, Kind)), JCC_Call);
+	cc.je(docall);
+	cc.cmp(vmfunc, x86::ptr(cacheptr, myoffsetof(JitCallCache, Target)));
+	cc.jne(miss);
+	// Only trivial targets are cached, but an unfilled cache can match a null function.
+	if (C == 0)
+	{
+		cc.cmp(x86::dword_ptr(cacheptr, myoffsetof(JitCallCache, Kind)), JCC_Unfilled);
+		cc.je(docall);
+		cc.jmp(done);
+	}
+	else if (IsIntResult(pc + 1, C))
+	{
+		cc.cmp(x86::dword_ptr(cacheptr, myoffsetof(JitCallCache, Kind)), JCC_Empty);
+		cc.je(done);
+		cc.cmp(x86::dword_ptr(cacheptr, myoffsetof(JitCallCache, Kind)), JCC_ConstInt);
+		cc.jne(docall);
+		cc.mov(regD[pc[1].c], x86::dword_ptr(cacheptr, myoffsetof(JitCallCache, Value)));
+		cc.jmp(done);
+	}
+	else
+	{
+		// Constant results only fit into an integer result register.
+		cc.cmp(x86::dword_ptr(cacheptr, myoffsetof(JitCallCache, Kind)), JCC_Empty);
+		cc.jne(docall);
+		cc.jmp(done);
+	}
+
+	cc.bind(miss);
+	auto call = CreateCall<void, JitCallCache *, VMFunction *>(UpdateCallCache);
+	call->setArg(0, cacheptr);
+	call->setArg(1, vmfunc);
+	cc.jmp(check);
+
+	cc.bind(docall);
+	EmitVMCall(vmfunc, nullptr);
+	cc.bind(done);
+	ParamOpcodes.Clear();
+}
+
 int JitCompiler::StoreCallParams()
 {
 	using namespace asmjit;
@@ -738,6 +738,7 @@ void *AddJitFunction(asmjit::CodeHolder* code, JitCompiler *compiler)
 
 void JitRelease()
 {
+	JitCacheSave();
 #ifdef _WIN64
 	for (auto p : JitFrames)
 	{
@@ -758,6 +759,7 @@ void JitRelease()
 	JitBlocks.Clear();
 	JitBlockPos = 0;
 	JitBlockSize = 0;
+	JitReleaseCallCaches();
 }
 
 static int CaptureStackTrace(int max_frames, void **out_frames)
@@ -25,6 +25,56 @@ extern int VMCalls[10];
 #define ABCs			(pc[0].i24)
 #define JMPOFS(x)		((x)->i24)
 
+class JitCompiler;
+
+// The VM registers of one type. Registers that did not fit into asmjit's
+// limit are spilled: they only live in the VM frame and get loaded into a
+// temporary the first time an opcode uses them.
+template<typename RegType>
+class JitRegisterFile
+{
+public:
+	JitRegisterFile(JitCompiler *compiler, int regtype) : compiler(compiler), regtype(regtype) { }
+
+	void Resize(unsigned int count)
+	{
+		regs.Resize(count);
+		spilled.Resize(count);
+		loaded.Resize(count);
+		for (unsigned int i = 0; i < count; i++)
+		{
+			spilled[i] = false;
+			loaded[i] = false;
+		}
+	}
+
+	unsigned int Size() const { return regs.Size(); }
+	bool IsSpilled(size_t index) const { return spilled[index]; }
+	void Spill(size_t index) { spilled[index] = true; }
+
+	inline RegType &operator[](size_t index);
+
+private:
+	JitCompiler *compiler;
+	int regtype;
+	TArray<RegType> regs;
+	TArray<bool> spilled;
+	TArray<bool> loaded;
+
+	friend class JitCompiler;
+};
+
+// Remembers the last target of an indirect call site. See EmitCachedCall.
+struct JitCallCache
+{
+	VMFunction *Target;
+	int Kind;
+	int Value;
+	int Misses;
+};
+
+void JitReleaseCallCaches();
+
 struct JitLineInfo
 {
 	ptrdiff_t InstructionIndex = 0;
@@ -42,6 +92,11 @@ public:
 
 	TArray<JitLineInfo> LineInfo;
 
+	// Functions with more registers than this spill some of them to the VM frame.
+	// Asmjit has a 256 register limit, and the JIT uses a few for temporaries as well.
+	static const int MaxRegisters = 200;
+	static const int MaxResidentRegisters = 150;
+
 private:
 	// Declare EmitXX functions for the opcodes:
 	#define xx(op, name, mode, alt, kreg, ktype)	void Emit##op();
@@ -52,6 +107,8 @@ private:
 
 	void Setup();
 	void CreateRegisters();
+	void LoadSpilledRegister(int regtype, int index);
+	void StoreSpilledRegisters();
 	void IncrementVMCalls();
 	void SetupFrame();
 	void SetupSimpleFrame();
@@ -62,7 +119,9 @@ private:
 
 	void EmitNativeCall(VMNativeFunction *target);
 	void EmitVMCall(asmjit::X86Gp ptr, VMFunction *target);
-	void EmitVtbl(const VMOP *op);
+	void EmitVtbl(const VMOP *op, asmjit::X86Gp vmfunc);
+	bool EmitInlineCall(VMFunction *target);
+	void EmitCachedCall(asmjit::X86Gp vmfunc);
 
 	int StoreCallParams();
 	void LoadInOuts();
@@ -234,6 +293,10 @@ private:
 	asmjit::X86Gp newResultIntPtr() { return newTempRegister(regResultIntPtr, resultPosIntPtr, "resultPtr", [&](const char *name) { return cc.newIntPtr(name); }); }
 	asmjit::X86Xmm newResultXmmSd() { return newTempRegister(regResultXmmSd, resultPosXmmSd, "resultXmmSd", [&](const char *name) { return cc.newXmmSd(name); }); }
 
+	size_t spillPosInt32, spillPosIntPtr, spillPosXmmSd;
+	std::vector<asmjit::X86Gp> regSpillInt32, regSpillIntPtr;
+	std::vector<asmjit::X86Xmm> regSpillXmmSd;
+
 	void EmitReadBarrier();
 
 	void EmitNullPointerThrow(int index, EVMAbortException reason);
@@ -286,10 +349,15 @@ private:
 	const FString *konsts;
 	const FVoidObj *konsta;
 
-	TArray<asmjit::X86Gp> regD;
-	TArray<asmjit::X86Xmm> regF;
-	TArray<asmjit::X86Gp> regA;
-	TArray<asmjit::X86Gp> regS;
+	JitRegisterFile<asmjit::X86Gp> regD { this, REGT_INT };
+	JitRegisterFile<asmjit::X86Xmm> regF { this, REGT_FLOAT };
+	JitRegisterFile<asmjit::X86Gp> regA { this, REGT_POINTER };
+	JitRegisterFile<asmjit::X86Gp> regS { this, REGT_STRING };
+
+	// Spilled registers that were loaded for the current opcode.
+	bool spilling = false;
+	asmjit::CBNode *spillCursor = nullptr;
+	TArray<std::pair<int, int>> loadedSpills;
 
 	struct OpcodeLabel
 	{
@@ -326,8 +394,20 @@ private:
 
 	const VMOP *pc;
 	VM_UBYTE op;
+
+	template<typename> friend class JitRegisterFile;
 };
 
+template<typename RegType>
+inline RegType &JitRegisterFile<RegType>::operator[](size_t index)
+{
+	if (spilled[index] && !loaded[index])
+	{
+		compiler->LoadSpilledRegister(regtype, (int)index);
+	}
+	return regs[index];
+}
+
 class AsmJitException : public std::exception
 {
 public:
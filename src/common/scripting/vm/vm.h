@@ -57,6 +57,11 @@ extern FMemArena ClassDataAllocator;
 #define MAX_TRY_DEPTH	8	// Maximum number of nested TRYs in a single function
 
 void JitRelease();
+void VMProfileRelease();
+void VMProfileStart();
+void VMProfileStop();
+extern bool VMProfiling;
+extern int VMProfileTics;
 
 extern void (*VM_CastSpriteIDToString)(FString* a, unsigned int b);
 
@@ -481,6 +486,7 @@ public:
 		AllFunctions.Clear();
 		// also release any JIT data
 		JitRelease();
+		VMProfileRelease();
 	}
 	static void CreateRegUseInfo()
 	{
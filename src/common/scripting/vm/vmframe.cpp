@@ -274,20 +274,18 @@ int VMScriptFunction::PCToLine(const VMOP *pc)
 	return -1;
 }
 
+// Number of script functions that run in the VM even though the JIT is enabled.
+int JitFallbacks;
+
 static bool CanJit(VMScriptFunction *func)
 {
-	// Asmjit has a 256 register limit. Stay safely away from it as the jit compiler uses a few for temporaries as well.
-	// Any function exceeding the limit will use the VM - a fair punishment to someone for writing a function so bloated ;)
-
-	if(func->blockJit) return false;
-
-	int maxregs = 200;
-	if (func->NumRegA + func->NumRegD + func->NumRegF + func->NumRegS < maxregs)
-		return true;
-
-	Printf(TEXTCOLOR_ORANGE "%s is using too many registers (%d of max %d)! Function will not use native code.\n", func->PrintableName, func->NumRegA + func->NumRegD + func->NumRegF + func->NumRegS, maxregs);
-
-	return false;
+	// Functions with too many registers for asmjit keep some of them in the VM frame. See JitCompiler::CreateRegisters.
+	if(func->blockJit)
+	{
+		JitFallbacks++;
+		return false;
+	}
+	return true;
 }
 
 void VMScriptFunction::JitCompile()
@@ -299,7 +297,10 @@ void VMScriptFunction::JitCompile()
 		{
 			ScriptCall = ::JitCompile(this);
 			if (!ScriptCall)
+			{
 				ScriptCall = VMExec;
+				JitFallbacks++;
+			}
 		}
 		else
 	#endif // HAVE_VM_JIT
@@ -319,7 +320,11 @@ int VMScriptFunction::FirstScriptCall(VMFunction *func, VMValue *params, int num
 		ThrowAbortException(X_OTHER, "attempt to call abstract function %s.", func->PrintableName);
 	}
 	
+#ifdef HAVE_VM_JIT
+	if (vm_jit) JitCacheNoteCall(static_cast<VMScriptFunction*>(func));
+#endif
 	static_cast<VMScriptFunction*>(func)->JitCompile();
+	if (VMProfiling) static_cast<VMScriptFunction*>(func)->SetProfiling(true);
 
 	return func->ScriptCall(func, params, numparams, ret, numret);
 }
@@ -836,7 +841,11 @@ ADD_STAT(VM)
 	memmove(&VMCalls[1], &VMCalls[0], 9 * sizeof(int));
 	VMCycles[0].Reset();
 	VMCalls[0] = 0;
-	return FStringf("VM time in last 10 tics: %f ms, %d calls, peak = %f ms", added, addedc, peak);
+	FString out = FStringf("VM time in last 10 tics: %f ms, %d calls, peak = %f ms", added, addedc, peak);
+#ifdef HAVE_VM_JIT
+	if (vm_jit) out.AppendFormat(", %d functions not jitted, %d calls inlined, %d cached calls (%d filled, %d misses)", JitFallbacks, JitInlinedCalls, JitCachedCalls, JitCallCacheFills, JitCallCacheMisses);
+#endif
+	return out;
 }
 
 //-----------------------------------------------------------------------------
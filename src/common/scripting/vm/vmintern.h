@@ -476,6 +476,13 @@ public:
 
 	bool blockJit = false; // function triggers Jit bugs, block compilation until bugs are fixed
 
+	// The real entry point while the profiler has taken over ScriptCall.
+	int(*UnprofiledCall)(VMFunction *func, VMValue *params, int numparams, VMReturn *ret, int numret) = nullptr;
+	void SetProfiling(bool on);
+
+	// The real entry point while the JIT cache waits for the first call.
+	int(*UnwatchedCall)(VMFunction *func, VMValue *params, int numparams, VMReturn *ret, int numret) = nullptr;
+
 	void InitExtra(void *addr);
 	void DestroyExtra(void *addr);
 	int AllocExtraStack(PType *type);
@@ -0,0 +1,378 @@
+/*
+** vmprofile.cpp
+**
+** Per-function profiler for script code.
+**
+** While the profiler runs, the ScriptCall pointer of every script function
+** is redirected to ProfiledScriptCall, which times the call and then
+** forwards it to the real entry point. All script-to-script calls go
+** through that pointer, no matter if they come from the interpreter, from
+** JIT compiled code or from native code through VMCall, so this catches
+** everything without touching either execution engine. Once the profiler
+** is stopped the original pointers are put back and nothing remains that
+** could cost time.
+**
+** The results are kept as a call tree. The flat report is built from the
+** same data, with inclusive times of recursive functions only counted for
+** the outermost call.
+**
+*/
+
+#include "vmintern.h"
+#include "types.h"
+#include "c_dispatch.h"
+#include "files.h"
+#include "printf.h"
+#include "stats.h"
+#include "i_time.h"
+#include <algorithm>
+#include <climits>
+#include <memory>
+
+bool VMProfiling;
+int VMProfileTics;
+
+struct FProfileFlat
+{
+	VMFunction *Func;
+	unsigned Calls = 0;
+	unsigned Active = 0;
+	double Inclusive = 0;
+	double Exclusive = 0;
+};
+
+struct FProfileNode
+{
+	VMFunction *Func;
+	FProfileNode *Parent;
+	FProfileFlat *Flat;
+	TArray<FProfileNode *> Children;
+	unsigned Calls = 0;
+	double Inclusive = 0;
+	double Exclusive = 0;
+};
+
+struct FProfileFrame
+{
+	FProfileNode *Node;
+	cycle_t Time;
+	double ChildTime;
+};
+
+static TDeletingArray<FProfileNode *> ProfileNodes;
+static TDeletingArray<FProfileFlat *> ProfileFlatList;
+static TMap<VMFunction *, FProfileFlat *> ProfileFlat;
+static TArray<FProfileFrame> ProfileStack;
+static FProfileNode ProfileRoot;
+static uint64_t ProfileStartTime;
+static uint64_t ProfileElapsed;
+
+//==========================================================================
+//
+// GetChildNode
+//
+//==========================================================================
+
+static FProfileNode *GetChildNode(FProfileNode *parent, VMFunction *func)
+{
+	for (auto child : parent->Children)
+	{
+		if (child->Func == func) return child;
+	}
+
+	auto &flat = ProfileFlat[func];
+	if (flat == nullptr)
+	{
+		flat = new FProfileFlat;
+		flat->Func = func;
+		ProfileFlatList.Push(flat);
+	}
+
+	auto node = new FProfileNode;
+	node->Func = func;
+	node->Parent = parent;
+	node->Flat = flat;
+	ProfileNodes.Push(node);
+	parent->Children.Push(node);
+	return node;
+}
+
+//==========================================================================
+//
+// EnterFunction / LeaveFunction
+//
+//==========================================================================
+
+static void EnterFunction(VMFunction *func)
+{
+	auto parent = ProfileStack.Size() > 0 ? ProfileStack.Last().Node : &ProfileRoot;
+	auto node = GetChildNode(parent, func);
+	node->Flat->Active++;
+
+	auto &frame = ProfileStack[ProfileStack.Reserve(1)];
+	frame.Node = node;
+	frame.ChildTime = 0;
+	frame.Time.ResetAndClock();
+}
+
+static void LeaveFunction()
+{
+	FProfileFrame frame = ProfileStack.Last();
+	ProfileStack.Pop();
+	frame.Time.Unclock();
+
+	double time = frame.Time.TimeMS();
+	auto node = frame.Node;
+	node->Calls++;
+	node->Inclusive += time;
+	node->Exclusive += time - frame.ChildTime;
+
+	auto flat = node->Flat;
+	flat->Calls++;
+	flat->Exclusive += time - frame.ChildTime;
+	if (--flat->Active == 0) flat->Inclusive += time;
+
+	if (ProfileStack.Size() > 0) ProfileStack.Last().ChildTime += time;
+}
+
+//==========================================================================
+//
+// ProfiledScriptCall
+//
+// Stand-in for the ScriptCall pointer while the profiler is running.
+//
+//==========================================================================
+
+static int ProfiledScriptCall(VMFunction *func, VMValue *params, int numparams, VMReturn *ret, int numret)
+{
+	auto sfunc = static_cast<VMScriptFunction *>(func);
+	auto call = sfunc->UnprofiledCall;
+	unsigned depth = ProfileStack.Size();
+
+	EnterFunction(func);
+	try
+	{
+		numret = call(func, params, numparams, ret, numret);
+	}
+	catch (...)
+	{
+		// the profiler may have been cleared from inside the call.
+		if (ProfileStack.Size() > depth) LeaveFunction();
+		throw;
+	}
+	if (ProfileStack.Size() > depth) LeaveFunction();
+	return numret;
+}
+
+//==========================================================================
+//
+// VMScriptFunction :: SetProfiling
+//
+// Functions that were never called yet are skipped. FirstScriptCall
+// hooks them after they got compiled.
+//
+//==========================================================================
+
+void VMScriptFunction::SetProfiling(bool on)
+{
+	if (on)
+	{
+		if (ScriptCall != &VMScriptFunction::FirstScriptCall && ScriptCall != &ProfiledScriptCall)
+		{
+			UnprofiledCall = ScriptCall;
+			ScriptCall = &ProfiledScriptCall;
+		}
+	}
+	else if (ScriptCall == &ProfiledScriptCall)
+	{
+		ScriptCall = UnprofiledCall;
+		UnprofiledCall = nullptr;
+	}
+}
+
+//==========================================================================
+//
+// VMProfileStart / VMProfileStop
+//
+//==========================================================================
+
+static void SetProfiling(bool on)
+{
+	for (auto func : VMFunction::AllFunctions)
+	{
+		if (!(func->VarFlags & VARF_Native))
+		{
+			static_cast<VMScriptFunction *>(func)->SetProfiling(on);
+		}
+	}
+}
+
+void VMProfileStart()
+{
+	if (VMProfiling) return;
+	VMProfiling = true;
+	ProfileStartTime = I_msTime();
+	SetProfiling(true);
+}
+
+void VMProfileStop()
+{
+	if (!VMProfiling) return;
+	SetProfiling(false);
+	VMProfiling = false;
+	ProfileElapsed += I_msTime() - ProfileStartTime;
+}
+
+//==========================================================================
+//
+// VMProfileClear
+//
+//==========================================================================
+
+static void VMProfileClear()
+{
+	ProfileStack.Clear();
+	ProfileRoot.Children.Clear();
+	ProfileNodes.DeleteAndClear();
+	ProfileFlatList.DeleteAndClear();
+	ProfileFlat.Clear();
+	VMProfileTics = 0;
+	ProfileElapsed = 0;
+	ProfileStartTime = I_msTime();
+}
+
+//==========================================================================
+//
+// VMProfileRelease
+//
+// Called when all functions get deleted.
+//
+//==========================================================================
+
+void VMProfileRelease()
+{
+	VMProfiling = false;
+	VMProfileClear();
+}
+
+//==========================================================================
+//
+// Reports
+//
+//==========================================================================
+
+static const char *ProfileName(VMFunction *func)
+{
+	return func->PrintableName != nullptr ? func->PrintableName : func->Name.GetChars();
+}
+
+static void ReportHeader(FString &out)
+{
+	uint64_t elapsed = ProfileElapsed + (VMProfiling ? I_msTime() - ProfileStartTime : 0);
+	out.AppendFormat("Script profile: %llu ms, %d tics, %u functions%s\n",
+		(unsigned long long)elapsed, VMProfileTics, ProfileFlatList.Size(), VMProfiling ? " (running)" : "");
+}
+
+static void ReportFlat(FString &out, unsigned limit)
+{
+	TArray<FProfileFlat *> list;
+	for (auto flat : ProfileFlatList)
+	{
+		if (flat->Calls > 0) list.Push(flat);
+	}
+	std::sort(list.begin(), list.end(), [](FProfileFlat *a, FProfileFlat *b) { return a->Exclusive > b->Exclusive; });
+
+	int tics = max(VMProfileTics, 1);
+	out.AppendFormat("%10s %12s %12s %10s %10s  %s\n", "Calls", "Excl (ms)", "Incl (ms)", "Excl/tic", "Incl/tic", "Function");
+	for (unsigned i = 0; i < list.Size() && i < limit; i++)
+	{
+		auto f = list[i];
+		out.AppendFormat("%10u %12.3f %12.3f %10.4f %10.4f  %s\n", f->Calls, f->Exclusive, f->Inclusive,
+			f->Exclusive / tics, f->Inclusive / tics, ProfileName(f->Func));
+	}
+}
+
+static void ReportTree(FString &out, FProfileNode *node, int depth, int maxdepth, double mintime)
+{
+	TArray<FProfileNode *> children = node->Children;
+	std::sort(children.begin(), children.end(), [](FProfileNode *a, FProfileNode *b) { return a->Inclusive > b->Inclusive; });
+
+	for (auto child : children)
+	{
+		if (child->Calls == 0 || child->Inclusive < mintime) continue;
+		out.AppendFormat("%10u %12.3f %12.3f  %*s%s\n", child->Calls, child->Exclusive, child->Inclusive,
+			depth * 2, "", ProfileName(child->Func));
+		if (depth + 1 < maxdepth) ReportTree(out, child, depth + 1, maxdepth, mintime);
+	}
+}
+
+static void ReportTree(FString &out, int maxdepth, double mintime)
+{
+	out.AppendFormat("%10s %12s %12s  %s\n", "Calls", "Excl (ms)", "Incl (ms)", "Function");
+	ReportTree(out, &ProfileRoot, 0, maxdepth, mintime);
+}
+
+//==========================================================================
+//
+// CCMD vmprofile
+//
+//==========================================================================
+
+CCMD(vmprofile)
+{
+	if (argv.argc() < 2)
+	{
+		Printf("Usage: vmprofile start | stop | clear | flat [count] | tree [depth] [min ms] | dump <filename>\n");
+		return;
+	}
+
+	if (!stricmp(argv[1], "start"))
+	{
+		VMProfileStart();
+		Printf("Script profiler started\n");
+	}
+	else if (!stricmp(argv[1], "stop"))
+	{
+		VMProfileStop();
+		Printf("Script profiler stopped\n");
+	}
+	else if (!stricmp(argv[1], "clear"))
+	{
+		VMProfileClear();
+	}
+	else if (!stricmp(argv[1], "flat"))
+	{
+		FString out;
+		ReportHeader(out);
+		ReportFlat(out, argv.argc() > 2 ? (unsigned)atoi(argv[2]) : 30);
+		Printf("%s", out.GetChars());
+	}
+	else if (!stricmp(argv[1], "tree"))
+	{
+		FString out;
+		ReportHeader(out);
+		ReportTree(out, argv.argc() > 2 ? atoi(argv[2]) : 8, argv.argc() > 3 ? atof(argv[3]) : 1.);
+		Printf("%s", out.GetChars());
+	}
+	else if (!stricmp(argv[1], "dump") && argv.argc() > 2)
+	{
+		std::unique_ptr<FileWriter> fw(FileWriter::Open(argv[2]));
+		if (fw == nullptr)
+		{
+			Printf(PRINT_HIGH, "Unable to write %s\n", argv[2]);
+			return;
+		}
+		FString out;
+		ReportHeader(out);
+		out += "\nFlat profile:\n";
+		ReportFlat(out, UINT_MAX);
+		out += "\nCall tree:\n";
+		ReportTree(out, INT_MAX, 0);
+		fw->Write(out.GetChars(), out.Len());
+		Printf("Script profile written to %s\n", argv[2]);
+	}
+	else
+	{
+		Printf("Unknown vmprofile command '%s'\n", argv[1]);
+	}
+}
@@ -356,4 +356,18 @@ void FMultiPatchTexture::CollectForPrecache(PrecacheInfo &info, bool requiretrue
 	}
 }
 
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+void FMultiPatchTexture::PrefetchLumps()
+{
+	for (int i = 0; i < NumParts; ++i)
+	{
+		Parts[i].Image->PrefetchLumps();
+	}
+}
+
 
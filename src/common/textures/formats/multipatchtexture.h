@@ -78,6 +78,7 @@ protected:
 	PalettedPixels CreatePalettedPixels(int conversion, int frame = 0) override;
 	void CopyToBlock(uint8_t *dest, int dwidth, int dheight, FImageSource *source, int xpos, int ypos, int rotate, const uint8_t *translation, int style);
 	void CollectForPrecache(PrecacheInfo &info, bool requiretruecolor) override;
+	void PrefetchLumps() override;
 
 };
 
@@ -293,6 +293,11 @@ void FImageSource::CollectForPrecache(PrecacheInfo &info, bool requiretruecolor)
 	}
 }
 
+void FImageSource::PrefetchLumps()
+{
+	if (SourceLump >= 0) fileSystem.PrefetchFile(SourceLump);
+}
+
 void FImageSource::BeginPrecaching()
 {
 	precacheInfo.Clear();
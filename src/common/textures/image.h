@@ -175,6 +175,7 @@ public:
 	}
 
 	virtual void CollectForPrecache(PrecacheInfo &info, bool requiretruecolor);
+	virtual void PrefetchLumps();	// lets the file system decompress the source data ahead of time.
 	static void BeginPrecaching();
 	static void EndPrecaching();
 	static void RegisterForPrecache(FImageSource *img, bool requiretruecolor);
@@ -160,6 +160,26 @@ void CheckCPUID(CPUInfo *cpu)
 		__cpuidex(foo, 7, 1);
 		cpu->FeatureFlags[7] = foo[0];
 	}
+
+	// The CPU may support AVX while the OS does not save the YMM state on context switches.
+	if (cpu->bAVX)
+	{
+		unsigned int xcr0 = 0;
+		if (cpu->bOSXSAVE)
+		{
+#ifdef _MSC_VER
+			xcr0 = (unsigned int)_xgetbv(0);
+#else
+			unsigned int edx;
+			__asm__ __volatile__("xgetbv" : "=a" (xcr0), "=d" (edx) : "c" (0));
+#endif
+		}
+		if ((xcr0 & 6) != 6)
+		{
+			cpu->bAVX = false;
+			cpu->bAVX2 = false;
+		}
+	}
 }
 
 FString DumpCPUInfo(const CPUInfo *cpu, bool brief)
@@ -315,6 +315,27 @@ CUSTOM_CVAR(Int, I_FriendlyWindowTitle, 1, CVAR_GLOBALCONFIG|CVAR_ARCHIVE|CVAR_N
 }
 CVAR(Bool, cl_nointros, false, CVAR_ARCHIVE)
 
+// Memory for keeping decompressed lumps from compressed archives around, in MB. 0 disables the cache.
+CUSTOM_CVAR(Int, fs_lumpcachesize, 128, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+{
+	if (self < 0) self = 0;
+	else fileSystem.SetCacheBudget(size_t(self) << 20);
+}
+
+CCMD(lumpcachestats)
+{
+	auto stats = fileSystem.GetCacheStats();
+	size_t lookups = stats.Hits + stats.Misses;
+	Printf("Lump cache: %zu of %zu KB used by %zu lumps\n", stats.Used >> 10, stats.Budget >> 10, stats.Entries);
+	Printf("%zu hits, %zu misses (%.1f%% hit rate), %zu prefetched, %zu queued, %zu evicted\n",
+		stats.Hits, stats.Misses, lookups > 0 ? stats.Hits * 100. / lookups : 0., stats.Prefetched, stats.Queued, stats.Evicted);
+
+	if (argv.argc() > 1 && !stricmp(argv[1], "reset"))
+	{
+		fileSystem.ResetCacheStats();
+	}
+}
+
 bool RunningAsTool = false;
 bool wantToRestart;
 bool DrawFSHUD;				// [RH] Draw fullscreen HUD?
@@ -3546,6 +3567,10 @@ static int D_InitGame(const FIWADInfo* iwad_info, std::vector<std::string>& allw
 
 		S_Sound (CHAN_BODY, 0, "misc/startupdone", 1, ATTN_NONE);
 
+		auto readstats = FileSys::GetReadStats();
+		DPrintf(DMSG_NOTIFY, "Lump data read during startup: %zu KB mapped, %zu KB copied, %zu KB decompressed\n",
+			readstats.Mapped >> 10, readstats.Copied >> 10, readstats.Decompressed >> 10);
+
 		if (Args->CheckParm("-norun") || batchrun)
 		{
 			return 1337; // special exit
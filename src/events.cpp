@@ -270,6 +270,8 @@ void DNetworkBuffer::Serialize(FSerializer& arc)
 
 void EventManager::CallOnRegister()
 {
+	// the handler list has just been read from a savegame.
+	InvalidateSubscribers();
 	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
 	{
 		handler->OnRegister();
@@ -342,6 +344,7 @@ bool EventManager::RegisterHandler(DStaticEventHandler* handler)
 		handler->ObjectFlags |= OF_Transient;
 	}
 
+	InvalidateSubscribers();
 	return true;
 }
 
@@ -375,6 +378,7 @@ bool EventManager::UnregisterHandler(DStaticEventHandler* handler)
 		LastEventHandler = handler->prev;
 		GC::WriteBarrier(handler->prev);
 	}
+	InvalidateSubscribers();
 	if (handler->IsStatic())
 	{
 		handler->ObjectFlags &= ~OF_Transient;
@@ -644,6 +648,94 @@ void EventManager::Shutdown()
 		handler->Destroy();
 	}
 	FirstEventHandler = LastEventHandler = nullptr;
+	InvalidateSubscribers();
+}
+
+//==========================================================================
+//
+// EventManager :: GetSubscribers
+//
+// Handlers that leave an event at its empty base implementation are not
+// subscribed to it.
+//
+//==========================================================================
+
+static const char *const EventSubscriptionNames[] =
+{
+	"WorldThingSpawned",
+	"WorldThingDied",
+	"WorldThingGround",
+	"WorldThingRevived",
+	"WorldThingDamaged",
+	"WorldThingDestroyed",
+	"WorldHitscanPreFired",
+	"WorldRailgunPreFired",
+	"WorldHitscanFired",
+	"WorldRailgunFired",
+	"WorldLinePreActivated",
+	"WorldLineActivated",
+	"WorldSectorDamaged",
+	"WorldLineDamaged",
+	"WorldTick",
+	"CheckReplacement",
+	"CheckReplacee",
+};
+static_assert(countof(EventSubscriptionNames) == EVS_Count, "event subscription names out of sync");
+
+static bool isEmpty(VMFunction *func);
+
+TArray<DStaticEventHandler*>& EventManager::GetSubscribers(EEventSubscription event)
+{
+	if (!SubscribersValid)
+	{
+		for (int i = 0; i < EVS_Count; i++)
+		{
+			// The index is not cached because it changes when the scripts are recompiled.
+			unsigned vindex = GetVirtualIndex(RUNTIME_CLASS(DStaticEventHandler), EventSubscriptionNames[i]);
+			Subscribers[i].Clear();
+			for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
+			{
+				auto& virtuals = handler->GetClass()->Virtuals;
+				VMFunction* func = vindex < virtuals.Size() ? virtuals[vindex] : nullptr;
+				if (func != nullptr && !isEmpty(func))
+					Subscribers[i].Push(handler);
+			}
+		}
+		SubscribersValid = true;
+	}
+	return Subscribers[event];
+}
+
+//==========================================================================
+//
+// EventManager :: CallSubscribers
+//
+// Calls all handlers subscribed to the event until one of the calls
+// returns true, and keeps track of the time spent in each of them.
+// A handler can register or unregister others while being called, so the
+// list is indexed afresh each time and destroyed handlers are skipped.
+//
+//==========================================================================
+
+template<class Func>
+void EventManager::CallSubscribers(EEventSubscription event, bool reverse, Func&& call)
+{
+	auto& subscribers = GetSubscribers(event);
+	for (unsigned i = 0; i < subscribers.Size(); i++)
+	{
+		DStaticEventHandler* handler = subscribers[reverse ? subscribers.Size() - 1 - i : i];
+		if (handler->ObjectFlags & OF_EuthanizeMe)
+			continue;
+
+		cycle_t clock;
+		clock.ResetAndClock();
+		bool stop = call(handler);
+		clock.Unclock();
+		handler->EventTime[event] += clock.TimeMS();
+		handler->EventCalls[event]++;
+		if (stop)
+			break;
+	}
 }
 
 #define DEFINE_EVENT_LOOPER(name, play) void EventManager::name() \
@@ -696,8 +788,7 @@ void EventManager::WorldThingSpawned(AActor* actor)
 
 	if (ShouldCallStatic(true)) staticEventManager.WorldThingSpawned(actor);
 
-	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
-		handler->WorldThingSpawned(actor);
+	CallSubscribers(EVS_WorldThingSpawned, false, [&](DStaticEventHandler* handler) { handler->WorldThingSpawned(actor); return false; });
 }
 
 void EventManager::WorldThingDied(AActor* actor, AActor* inflictor)
@@ -708,8 +799,7 @@ void EventManager::WorldThingDied(AActor* actor, AActor* inflictor)
 
 	if (ShouldCallStatic(true)) staticEventManager.WorldThingDied(actor, inflictor);
 
-	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
-		handler->WorldThingDied(actor, inflictor);
+	CallSubscribers(EVS_WorldThingDied, false, [&](DStaticEventHandler* handler) { handler->WorldThingDied(actor, inflictor); return false; });
 }
 
 bool EventManager::WorldHitscanPreFired(AActor* actor, DAngle angle, double distance, DAngle pitch, int damage, FName damageType, PClassActor *pufftype, int flags, double sz, double offsetforward, double offsetside)
@@ -723,8 +813,10 @@ bool EventManager::WorldHitscanPreFired(AActor* actor, DAngle angle, double dist
 
 	if (!ret)
 	{
-		for (DStaticEventHandler* handler = FirstEventHandler; handler && ret == false; handler = handler->next)
-			ret = handler->WorldHitscanPreFired(actor, angle, distance, pitch, damage, damageType, pufftype, flags, sz, offsetforward, offsetside);
+		CallSubscribers(EVS_WorldHitscanPreFired, false, [&](DStaticEventHandler* handler)
+		{
+			return ret = handler->WorldHitscanPreFired(actor, angle, distance, pitch, damage, damageType, pufftype, flags, sz, offsetforward, offsetside);
+		});
 	}
 	
 	return ret;
@@ -744,8 +836,7 @@ bool EventManager::WorldRailgunPreFired(FName damageType, PClassActor* pufftype,
 
 	if (!ret)
 	{
-		for (DStaticEventHandler* handler = FirstEventHandler; handler && ret == false; handler = handler->next)
-			ret = handler->WorldRailgunPreFired(damageType, pufftype, param);
+		CallSubscribers(EVS_WorldRailgunPreFired, false, [&](DStaticEventHandler* handler) { return ret = handler->WorldRailgunPreFired(damageType, pufftype, param); });
 	}
 
 	return ret;
@@ -759,8 +850,7 @@ void EventManager::WorldHitscanFired(AActor* actor, const DVector3& AttackPos, c
 
 	if (ShouldCallStatic(true)) staticEventManager.WorldHitscanFired(actor, AttackPos, DamagePosition, Inflictor, flags);
 
-	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
-		handler->WorldHitscanFired(actor, AttackPos, DamagePosition, Inflictor, flags);
+	CallSubscribers(EVS_WorldHitscanFired, false, [&](DStaticEventHandler* handler) { handler->WorldHitscanFired(actor, AttackPos, DamagePosition, Inflictor, flags); return false; });
 }
 
 void EventManager::WorldRailgunFired(AActor* actor, const DVector3& AttackPos, const DVector3& DamagePosition, AActor* Inflictor, int flags)
@@ -771,8 +861,7 @@ void EventManager::WorldRailgunFired(AActor* actor, const DVector3& AttackPos, c
 
 	if (ShouldCallStatic(true)) staticEventManager.WorldRailgunFired(actor, AttackPos, DamagePosition, Inflictor, flags);
 
-	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
-		handler->WorldRailgunFired(actor, AttackPos, DamagePosition, Inflictor, flags);
+	CallSubscribers(EVS_WorldRailgunFired, false, [&](DStaticEventHandler* handler) { handler->WorldRailgunFired(actor, AttackPos, DamagePosition, Inflictor, flags); return false; });
 }
 
 void EventManager::WorldThingGround(AActor* actor, FState* st)
@@ -783,8 +872,7 @@ void EventManager::WorldThingGround(AActor* actor, FState* st)
 
 	if (ShouldCallStatic(true)) staticEventManager.WorldThingGround(actor, st);
 
-	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
-		handler->WorldThingGround(actor, st);
+	CallSubscribers(EVS_WorldThingGround, false, [&](DStaticEventHandler* handler) { handler->WorldThingGround(actor, st); return false; });
 }
 
 void EventManager::WorldThingRevived(AActor* actor)
@@ -795,8 +883,7 @@ void EventManager::WorldThingRevived(AActor* actor)
 
 	if (ShouldCallStatic(true)) staticEventManager.WorldThingRevived(actor);
 
-	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
-		handler->WorldThingRevived(actor);
+	CallSubscribers(EVS_WorldThingRevived, false, [&](DStaticEventHandler* handler) { handler->WorldThingRevived(actor); return false; });
 }
 
 void EventManager::WorldThingDamaged(AActor* actor, AActor* inflictor, AActor* source, int damage, FName mod, int flags, DAngle angle)
@@ -807,8 +894,7 @@ void EventManager::WorldThingDamaged(AActor* actor, AActor* inflictor, AActor* s
 
 	if (ShouldCallStatic(true)) staticEventManager.WorldThingDamaged(actor, inflictor, source, damage, mod, flags, angle);
 
-	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
-		handler->WorldThingDamaged(actor, inflictor, source, damage, mod, flags, angle);
+	CallSubscribers(EVS_WorldThingDamaged, false, [&](DStaticEventHandler* handler) { handler->WorldThingDamaged(actor, inflictor, source, damage, mod, flags, angle); return false; });
 }
 
 void EventManager::WorldThingDestroyed(AActor* actor)
@@ -821,8 +907,7 @@ void EventManager::WorldThingDestroyed(AActor* actor)
 	if (!(actor->ObjectFlags & OF_Spawned))
 		return;
 
-	for (DStaticEventHandler* handler = LastEventHandler; handler; handler = handler->prev)
-		handler->WorldThingDestroyed(actor);
+	CallSubscribers(EVS_WorldThingDestroyed, true, [&](DStaticEventHandler* handler) { handler->WorldThingDestroyed(actor); return false; });
 
 	if (ShouldCallStatic(true)) staticEventManager.WorldThingDestroyed(actor);
 }
@@ -831,24 +916,25 @@ void EventManager::WorldLinePreActivated(line_t* line, AActor* actor, int activa
 {
 	if (ShouldCallStatic(true)) staticEventManager.WorldLinePreActivated(line, actor, activationType, shouldactivate);
 
-	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
-		handler->WorldLinePreActivated(line, actor, activationType, shouldactivate);
+	CallSubscribers(EVS_WorldLinePreActivated, false, [&](DStaticEventHandler* handler) { handler->WorldLinePreActivated(line, actor, activationType, shouldactivate); return false; });
 }
 
 void EventManager::WorldLineActivated(line_t* line, AActor* actor, int activationType)
 {
 	if (ShouldCallStatic(true)) staticEventManager.WorldLineActivated(line, actor, activationType);
 
-	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
-		handler->WorldLineActivated(line, actor, activationType);
+	CallSubscribers(EVS_WorldLineActivated, false, [&](DStaticEventHandler* handler) { handler->WorldLineActivated(line, actor, activationType); return false; });
 }
 
 int EventManager::WorldSectorDamaged(sector_t* sector, AActor* source, int damage, FName damagetype, int part, DVector3 position, bool isradius)
 {
 	if (ShouldCallStatic(true)) staticEventManager.WorldSectorDamaged(sector, source, damage, damagetype, part, position, isradius);
 
-	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
+	CallSubscribers(EVS_WorldSectorDamaged, false, [&](DStaticEventHandler* handler)
+	{
 		damage = handler->WorldSectorDamaged(sector, source, damage, damagetype, part, position, isradius);
+		return false;
+	});
 	return damage;
 }
 
@@ -856,8 +942,11 @@ int EventManager::WorldLineDamaged(line_t* line, AActor* source, int damage, FNa
 {
 	if (ShouldCallStatic(true)) staticEventManager.WorldLineDamaged(line, source, damage, damagetype, side, position, isradius);
 
-	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
+	CallSubscribers(EVS_WorldLineDamaged, false, [&](DStaticEventHandler* handler)
+	{
 		damage = handler->WorldLineDamaged(line, source, damage, damagetype, side, position, isradius);
+		return false;
+	});
 	return damage;
 }
 
@@ -1045,8 +1134,7 @@ bool EventManager::CheckReplacement( PClassActor *replacee, PClassActor **replac
 	// This is play scope but unlike in-game events needs to be handled like UI by static handlers.
 	if (ShouldCallStatic(false)) final = staticEventManager.CheckReplacement(replacee, replacement);
 
-	for (DStaticEventHandler *handler = FirstEventHandler; handler; handler = handler->next)
-		handler->CheckReplacement(replacee,replacement,&final);
+	CallSubscribers(EVS_CheckReplacement, false, [&](DStaticEventHandler* handler) { handler->CheckReplacement(replacee, replacement, &final); return false; });
 	return final;
 }
 
@@ -1055,8 +1143,7 @@ bool EventManager::CheckReplacee(PClassActor **replacee, PClassActor *replacemen
 	bool final = false;
 	if (ShouldCallStatic(false)) final = staticEventManager.CheckReplacee(replacee, replacement);
 
-	for (DStaticEventHandler *handler = FirstEventHandler; handler; handler = handler->next)
-		handler->CheckReplacee(replacee, replacement, &final);
+	CallSubscribers(EVS_CheckReplacee, false, [&](DStaticEventHandler* handler) { handler->CheckReplacee(replacee, replacement, &final); return false; });
 	return final;
 }
 
@@ -1072,10 +1159,15 @@ void EventManager::NewGame()
 // normal event loopers (non-special, argument-less)
 DEFINE_EVENT_LOOPER(RenderFrame, false)
 DEFINE_EVENT_LOOPER(WorldLightning, true)
-DEFINE_EVENT_LOOPER(WorldTick, true)
 DEFINE_EVENT_LOOPER(UiTick, false)
 DEFINE_EVENT_LOOPER(PostUiTick, false)
 
+void EventManager::WorldTick()
+{
+	if (ShouldCallStatic(true)) staticEventManager.WorldTick();
+	CallSubscribers(EVS_WorldTick, false, [](DStaticEventHandler* handler) { handler->WorldTick(); return false; });
+}
+
 // declarations
 IMPLEMENT_CLASS(DStaticEventHandler, false, true);
 
@@ -2465,3 +2557,71 @@ CCMD(netevent)
 		primaryLevel->localEventManager->SendNetworkEvent(argv[1], arg[0], arg[1], arg[2], true);
 	}
 }
+
+//==========================================================================
+//
+// CCMD eventprofile
+//
+// Lists the time spent in each handler's subscribed events, most expensive
+// first. Takes a limit on the number of lines, or "clear" to reset.
+//
+//==========================================================================
+
+CCMD(eventprofile)
+{
+	struct ProfileRow
+	{
+		DStaticEventHandler* Handler;
+		int Event;
+	};
+	TArray<ProfileRow> rows;
+	bool clear = argv.argc() > 1 && !stricmp(argv[1], "clear");
+	unsigned limit = argv.argc() > 1 && !clear ? (unsigned)atoi(argv[1]) : 0;
+
+	auto gather = [&](EventManager& manager)
+	{
+		for (DStaticEventHandler* handler = manager.FirstEventHandler; handler; handler = handler->next)
+		{
+			for (int i = 0; i < EVS_Count; i++)
+			{
+				if (clear)
+				{
+					handler->EventTime[i] = 0;
+					handler->EventCalls[i] = 0;
+				}
+				else if (handler->EventCalls[i] > 0)
+				{
+					rows.Push({ handler, i });
+				}
+			}
+		}
+	};
+	gather(staticEventManager);
+	for (auto Level : AllLevels())
+	{
+		gather(*Level->localEventManager);
+	}
+	if (clear || rows.Size() == 0)
+	{
+		return;
+	}
+
+	std::sort(rows.begin(), rows.end(), [](const ProfileRow& a, const ProfileRow& b)
+	{
+		return a.Handler->EventTime[a.Event] > b.Handler->EventTime[b.Event];
+	});
+	if (limit == 0 || limit > rows.Size())
+	{
+		limit = rows.Size();
+	}
+
+	Printf(TEXTCOLOR_YELLOW "Handler                        Event                       Calls  Time (ms)  Avg (ms)\n");
+	Printf(TEXTCOLOR_YELLOW "------------------------------ --------------------- ---------- ---------- ---------\n");
+	for (unsigned i = 0; i < limit; i++)
+	{
+		auto handler = rows[i].Handler;
+		int event = rows[i].Event;
+		Printf("%-30s %-21s %10u %10.3f %9.4f\n", handler->GetClass()->TypeName.GetChars(), EventSubscriptionNames[event],
+			handler->EventCalls[event], handler->EventTime[event], handler->EventTime[event] / handler->EventCalls[event]);
+	}
+}
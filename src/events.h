@@ -15,6 +15,32 @@ struct line_t;
 struct sector_t;
 struct FLevelLocals;
 
+// Events that can be sent many times per tic. Each of them has a list of
+// the handlers that actually override it, so dispatch doesn't have to ask
+// every registered handler.
+enum EEventSubscription
+{
+	EVS_WorldThingSpawned,
+	EVS_WorldThingDied,
+	EVS_WorldThingGround,
+	EVS_WorldThingRevived,
+	EVS_WorldThingDamaged,
+	EVS_WorldThingDestroyed,
+	EVS_WorldHitscanPreFired,
+	EVS_WorldRailgunPreFired,
+	EVS_WorldHitscanFired,
+	EVS_WorldRailgunFired,
+	EVS_WorldLinePreActivated,
+	EVS_WorldLineActivated,
+	EVS_WorldSectorDamaged,
+	EVS_WorldLineDamaged,
+	EVS_WorldTick,
+	EVS_CheckReplacement,
+	EVS_CheckReplacee,
+
+	EVS_Count
+};
+
 enum class EventHandlerType
 {
 	Global,
@@ -273,6 +299,10 @@ public:
 	bool IsUiProcessor;
 	bool RequireMouse;
 
+	// time spent in each subscribed event, for eventprofile. Not serialized.
+	double EventTime[EVS_Count] = {};
+	unsigned EventCalls[EVS_Count] = {};
+
 	// serialization handler. let's keep it here so that I don't get lost in serialized/not serialized fields
 	void Serialize(FSerializer& arc) override
 	{
@@ -453,6 +483,10 @@ struct EventManager
 	DStaticEventHandler* FirstEventHandler = nullptr;
 	DStaticEventHandler* LastEventHandler = nullptr;
 
+	// handlers subscribed to each EEventSubscription, in list order. Rebuilt on demand after the list changes.
+	TArray<DStaticEventHandler*> Subscribers[EVS_Count];
+	bool SubscribersValid = false;
+
 	EventManager() = default;
 	EventManager(FLevelLocals *l) { Level = l; }
 	~EventManager() { Shutdown(); }
@@ -472,6 +506,10 @@ struct EventManager
 	void InitStaticHandlers(FLevelLocals *l, bool map);
 	// shutdown handlers
 	void Shutdown();
+	// handler list has changed
+	void InvalidateSubscribers() { SubscribersValid = false; }
+	TArray<DStaticEventHandler*>& GetSubscribers(EEventSubscription event);
+	template<class Func> void CallSubscribers(EEventSubscription event, bool reverse, Func&& call);
 
 	// after the engine is done creating data
 	void OnEngineInitialize();
@@ -570,6 +608,7 @@ struct EventManager
 		{
 			existinghandler->owner = this;
 		}
+		InvalidateSubscribers();
 	}
 
 };
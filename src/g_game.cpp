@@ -118,6 +118,7 @@ void STAT_Serialize(FSerializer &file);
 
 CVARD_NAMED(Int, gameskill, skill, 2, CVAR_SERVERINFO|CVAR_LATCH, "sets the skill for the next newly started game")
 CVAR(Bool, save_formatted, false, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)	// use formatted JSON for saves (more readable but a larger files and a bit slower.
+CVAR(Bool, save_binary, false, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)	// use the binary format for saves and level snapshots (smaller and faster, but not human readable and not loadable by older versions.
 CVAR (Int, deathmatch, 0, CVAR_SERVERINFO|CVAR_LATCH);
 CVAR (Bool, chasedemo, false, 0);
 CVAR (Bool, storesavepic, true, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
@@ -1144,6 +1145,8 @@ void G_Ticker ()
 	int i;
 	gamestate_t	oldgamestate;
 
+	if (VMProfiling) VMProfileTics++;
+
 	// do player reborns if needed
 	for (i = 0; i < MAXPLAYERS; i++)
 	{
@@ -2028,6 +2031,7 @@ void G_DoLoadGame ()
 {
 	SetupLoadingCVars();
 	bool hidecon;
+	double startTime = I_msTimeF();
 
 	if (gameaction != ga_autoloadgame)
 	{
@@ -2187,6 +2191,7 @@ void G_DoLoadGame ()
 		level.info->Snapshot.Clean();
 
 	BackupSaveName = savename;
+	DPrintf(DMSG_NOTIFY, "Savegame loaded in %.1f ms\n", I_msTimeF() - startTime);
 
 	// At this point, the GC threshold is likely a lot higher than the
 	// amount of memory in use, so bring it down now by starting a
@@ -2388,6 +2393,7 @@ void G_DoSaveGame (bool okForQuicksave, bool forceQuicksave, FString filename, c
 	if (cl_waitforsave)
 		I_FreezeTime(true);
 
+	double startTime = I_msTimeF();
 	insave = true;
 	try
 	{
@@ -2418,7 +2424,8 @@ void G_DoSaveGame (bool okForQuicksave, bool forceQuicksave, FString filename, c
 	FSerializer savegameglobals;	// and this for non-level related info that must be saved.
 
 	savegameinfo.OpenWriter(true);
-	savegameglobals.OpenWriter(save_formatted);
+	if (save_binary) savegameglobals.OpenBinaryWriter();
+	else savegameglobals.OpenWriter(save_formatted);
 
 	SaveVersion = SAVEVER;
 	PutSavePic(&savepic, SAVEPICWIDTH, SAVEPICHEIGHT);
@@ -2496,6 +2503,7 @@ void G_DoSaveGame (bool okForQuicksave, bool forceQuicksave, FString filename, c
 
 	if (succeeded)
 	{
+		DPrintf(DMSG_NOTIFY, "Savegame written in %.1f ms (%s)\n", I_msTimeF() - startTime, save_binary ? "binary" : "JSON");
 		savegameManager.NotifyNewSave(filename, description, okForQuicksave, forceQuicksave);
 		BackupSaveName = filename;
 
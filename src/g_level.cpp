@@ -2167,6 +2167,7 @@ class DSectorMarker : public DObject
 public:
 	DSectorMarker(FLevelLocals *l) : Level(l), SecNum(0),PolyNum(0),SideNum(0) {}
 	size_t PropagateMark();
+	int GetConcurrentMarkSlots(DObject **slots[]) { return -1; }	// walks the level's arrays in steps
 	FLevelLocals *Level;
 	int SecNum;
 	int PolyNum;
@@ -15,6 +15,7 @@ struct FBlockNode
 	FBlockNode *NextActor;			// next actor in this block
 	FBlockNode **PrevBlock;			// previous block this actor is in
 	FBlockNode *NextBlock;			// next block this actor is in
+	int ThingIndex;					// index of this node's entry in blockthings[BlockIndex]
 
 	static FBlockNode *Create (AActor *who, int x, int y, int group = -1);
 	void Release ();
@@ -22,6 +23,17 @@ struct FBlockNode
 	static FBlockNode *FreeBlocks;
 };
 
+// Compact copy of an actor's position and radius, stored per block next to the thing chains.
+// This lets P_CheckPosition rule out the actors in the blocks it touches without
+// dereferencing each one.
+struct FBlockThing
+{
+	AActor *Me;
+	FBlockNode *Node;
+	double X, Y;
+	double Radius;
+};
+
 // BLOCKMAP
 // Created from axis aligned bounding box
 // of the map, a rectangular array of
@@ -40,6 +52,7 @@ struct FBlockmap
 	double				bmaporgx;
 	double				bmaporgy;		// origin of block map
 	FBlockNode**		blocklinks; 	// for thing chains
+	TArray<FBlockThing>* blockthings;	// same as blocklinks but as arrays
 
 	// mapblocks are used to check movement
 	// against lines and things
@@ -72,6 +85,10 @@ struct FBlockmap
 
 	bool VerifyBlockMap(int count, unsigned numlines);
 
+	void AddBlockThing(FBlockNode *node);
+	void RemoveBlockThing(FBlockNode *node);
+	void UpdateBlockThing(FBlockNode *node);
+
 	void Clear()
 	{
 		if (blockmaplump != nullptr)
@@ -84,6 +101,11 @@ struct FBlockmap
 			delete[] blocklinks;
 			blocklinks = nullptr;
 		}
+		if (blockthings != nullptr)
+		{
+			delete[] blockthings;
+			blockthings = nullptr;
+		}
 	}
 
 	~FBlockmap()
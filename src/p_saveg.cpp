@@ -63,8 +63,10 @@
 #include "s_music.h"
 #include "model.h"
 #include "d_net.h"
+#include "i_time.h"
 
 EXTERN_CVAR(Bool, save_formatted)
+EXTERN_CVAR(Bool, save_binary)
 
 //==========================================================================
 //
@@ -1087,12 +1089,15 @@ void FLevelLocals::SnapshotLevel()
 	if (info->isValid())
 	{
 		FDoomSerializer arc(this);
+		double startTime = I_msTimeF();
 
-		if (arc.OpenWriter(save_formatted))
+		if (save_binary ? arc.OpenBinaryWriter() : arc.OpenWriter(save_formatted))
 		{
 			SaveVersion = SAVEVER;
 			Serialize(arc, false);
 			info->Snapshot = arc.GetCompressedOutput();
+			DPrintf(DMSG_NOTIFY, "Snapshot of %s written in %.1f ms (%s, %zu bytes)\n", MapName.GetChars(),
+				I_msTimeF() - startTime, save_binary ? "binary" : "JSON", info->Snapshot.mSize);
 		}
 	}
 }
@@ -1112,6 +1117,7 @@ void FLevelLocals::UnSnapshotLevel(bool hubLoad)
 	if (info->isValid())
 	{
 		FDoomSerializer arc(this);
+		double startTime = I_msTimeF();
 		if (!arc.OpenReader(&info->Snapshot))
 		{
 			I_Error("Failed to load savegame");
@@ -1120,6 +1126,7 @@ void FLevelLocals::UnSnapshotLevel(bool hubLoad)
 
 		Serialize(arc, hubLoad);
 		FromSnapshot = true;
+		DPrintf(DMSG_NOTIFY, "Snapshot of %s read in %.1f ms\n", MapName.GetChars(), I_msTimeF() - startTime);
 
 		auto it = GetThinkerIterator<AActor>(NAME_PlayerPawn);
 		AActor *pawn, *next;
@@ -1418,6 +1418,7 @@ private:
 public:
 	void LinkToWorld (FLinkContext *ctx, bool spawningmapthing=false, sector_t *sector = NULL);
 	void UnlinkFromWorld(FLinkContext *ctx);
+	void UpdateBlockThings();
 	void AdjustFloorClip ();
 	bool IsMapActor();
 	bool SetState (FState *newstate, bool nofunction=false);
@@ -1573,14 +1574,17 @@ public:
 	{
 		__Pos.X = npos.X;
 		__Pos.Y = npos.Y;
+		if (BlockNode != nullptr) UpdateBlockThings();
 	}
 	void SetXYZ(double xx, double yy, double zz)
 	{
 		__Pos = { xx,yy,zz };
+		if (BlockNode != nullptr) UpdateBlockThings();
 	}
 	void SetXYZ(const DVector3 &npos)
 	{
 		__Pos = npos;
+		if (BlockNode != nullptr) UpdateBlockThings();
 	}
 
 	double VelXYToSpeed() const
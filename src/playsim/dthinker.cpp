@@ -45,11 +45,20 @@
 #include "v_video.h"
 #include "g_cvars.h"
 #include "d_main.h"
+#include "types.h"
 
 #include "p_visualthinker.h"
 
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+CVAR(Bool, cl_parallelthinkers, false, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+
 static int ThinkCount;
-static cycle_t ThinkCycles;
+static int ParallelThinkCount;
+cycle_t ThinkCycles;
 extern cycle_t BotSupportCycles;
 extern cycle_t ActionCycles;
 extern int BotWTG;
@@ -71,6 +80,140 @@ static TMap<FName, ProfileInfo> Profiles;
 static unsigned int profilethinkers, profilelimit;
 DThinker *NextToThink;
 
+//==========================================================================
+//
+// Worker threads for thinkers that are flagged with OF_ParallelTick.
+// These only ever run TickParallel, which is restricted to modifying
+// the thinker itself, so the order they get processed in is irrelevant.
+//
+//==========================================================================
+
+class FThinkerWorkers
+{
+public:
+	FThinkerWorkers();
+	~FThinkerWorkers();
+
+	void Run(TArray<DThinker*> &thinkers);
+
+private:
+	void WorkerMain();
+	void RunBatches();
+
+	enum
+	{
+		BatchSize = 64,
+		MinParallelThinkers = 2 * BatchSize
+	};
+
+	std::vector<std::thread> Threads;
+	std::mutex Mutex;
+	std::condition_variable WorkCondvar, DoneCondvar;
+	int Generation = 0;
+	int Busy = 0;
+	bool StopFlag = false;
+
+	DThinker **Items = nullptr;
+	unsigned NumItems = 0;
+	std::atomic<unsigned> NextItem;
+};
+
+FThinkerWorkers::FThinkerWorkers()
+{
+	size_t threadCount = std::max((int)std::thread::hardware_concurrency() - 1, 0);
+	while (Threads.size() < threadCount)
+	{
+		Threads.push_back(std::thread([=]() { WorkerMain(); }));
+	}
+}
+
+FThinkerWorkers::~FThinkerWorkers()
+{
+	std::unique_lock lock(Mutex);
+	StopFlag = true;
+	lock.unlock();
+	WorkCondvar.notify_all();
+	for (auto& thread : Threads)
+		thread.join();
+}
+
+void FThinkerWorkers::Run(TArray<DThinker*> &thinkers)
+{
+	if (thinkers.Size() < MinParallelThinkers || Threads.size() == 0)
+	{
+		for (auto thinker : thinkers)
+			thinker->TickParallel();
+		return;
+	}
+
+	Items = thinkers.Data();
+	NumItems = thinkers.Size();
+	NextItem = 0;
+
+	std::unique_lock lock(Mutex);
+	Generation++;
+	Busy = (int)Threads.size();
+	lock.unlock();
+	WorkCondvar.notify_all();
+
+	// Help out instead of just waiting
+	RunBatches();
+
+	lock.lock();
+	DoneCondvar.wait(lock, [this]() { return Busy == 0; });
+	Items = nullptr;
+	NumItems = 0;
+}
+
+void FThinkerWorkers::RunBatches()
+{
+	while (true)
+	{
+		unsigned start = NextItem.fetch_add(BatchSize);
+		if (start >= NumItems)
+			break;
+
+		unsigned end = std::min(start + (unsigned)BatchSize, NumItems);
+		for (unsigned i = start; i < end; i++)
+			Items[i]->TickParallel();
+	}
+}
+
+void FThinkerWorkers::WorkerMain()
+{
+	int seen = 0;
+	std::unique_lock lock(Mutex);
+	while (true)
+	{
+		WorkCondvar.wait(lock, [&]() { return StopFlag || Generation != seen; });
+		if (StopFlag)
+			break;
+		seen = Generation;
+
+		lock.unlock();
+		RunBatches();
+		lock.lock();
+
+		if (--Busy == 0)
+			DoneCondvar.notify_one();
+	}
+}
+
+static void TickParallelThinkers(TArray<DThinker*> &thinkers)
+{
+	static FThinkerWorkers workers;
+
+	workers.Run(thinkers);
+
+	// Anything with side effects outside the thinker (destruction, texture animations, ...) happens here.
+	for (auto thinker : thinkers)
+	{
+		thinker->TickParallelFinish();
+	}
+	ParallelThinkCount += thinkers.Size();
+	thinkers.Clear();
+}
+
 //==========================================================================
 //
 //
@@ -103,6 +246,7 @@ void FThinkerCollection::RunThinkers(FLevelLocals *Level)
 	int i, count;
 
 	ThinkCount = 0;
+	ParallelThinkCount = 0;
 	ThinkCycles.Reset();
 	BotSupportCycles.Reset();
 	ActionCycles.Reset();
@@ -143,10 +287,17 @@ void FThinkerCollection::RunThinkers(FLevelLocals *Level)
 
 	if (!profilethinkers)
 	{
+		// Thinkers that can tick in parallel are only collected during the regular pass and get
+		// processed after all other thinkers have finished, so gameplay order is not affected.
+		// Crossing line portals goes through FPathTraverse and validcount, which are shared
+		// by everything, so maps with line portals tick everything on the main thread.
+		static TArray<DThinker*> parallelThinkers;
+		TArray<DThinker*>* deferred = cl_parallelthinkers && !Level->PortalBlockmap.containsLines ? &parallelThinkers : nullptr;
+
 		// Tick every thinker left from last time
 		for (i = STAT_FIRST_THINKING; i <= MAX_STATNUM; ++i)
 		{
-			Thinkers[i].TickThinkers(nullptr);
+			Thinkers[i].TickThinkers(nullptr, deferred);
 		}
 
 		// Keep ticking the fresh thinkers until there are no new ones.
@@ -155,10 +306,15 @@ void FThinkerCollection::RunThinkers(FLevelLocals *Level)
 			count = 0;
 			for (i = STAT_FIRST_THINKING; i <= MAX_STATNUM; ++i)
 			{
-				count += FreshThinkers[i].TickThinkers(&Thinkers[i]);
+				count += FreshThinkers[i].TickThinkers(&Thinkers[i], deferred);
 			}
 		} while (count != 0);
 
+		if (deferred != nullptr && deferred->Size() > 0)
+		{
+			TickParallelThinkers(*deferred);
+		}
+
 		recreateLights();
 		if (dolights)
 		{
@@ -585,7 +741,7 @@ void FThinkerList::SaveList(FSerializer &arc)
 //
 //==========================================================================
 
-int FThinkerList::TickThinkers(FThinkerList *dest)
+int FThinkerList::TickThinkers(FThinkerList *dest, TArray<DThinker*> *deferred)
 {
 	int count = 0;
 	DThinker *node = GetHead();
@@ -617,7 +773,14 @@ int FThinkerList::TickThinkers(FThinkerList *dest)
 		if (!(node->ObjectFlags & OF_EuthanizeMe))
 		{ // Only tick thinkers not scheduled for destruction
 			ThinkCount++;
-			node->CallTick();
+			if (deferred != nullptr && node->CanTickParallel())
+			{
+				deferred->Push(node);
+			}
+			else
+			{
+				node->CallTick();
+			}
 			node->ObjectFlags &= ~OF_JustSpawned;
 		}
 		node = NextToThink;
@@ -908,6 +1071,35 @@ void DThinker::CallTick()
 	else Tick();
 }
 
+//==========================================================================
+//
+// Only native thinkers that explicitly opted in with OF_ParallelTick can be
+// split up, and only if no script class has overridden Tick.
+//
+//==========================================================================
+
+bool DThinker::CanTickParallel()
+{
+	if (!(ObjectFlags & OF_ParallelTick))
+	{
+		return false;
+	}
+	IFVIRTUAL(DThinker, Tick)
+	{
+		return !!(func->VarFlags & VARF_Native);
+	}
+	return true;
+}
+
+void DThinker::TickParallel()
+{
+}
+
+void DThinker::TickParallelFinish()
+{
+	Tick();
+}
+
 //==========================================================================
 //
 //
@@ -927,6 +1119,19 @@ size_t DThinker::PropagateMark()
 	return Super::PropagateMark();
 }
 
+//==========================================================================
+//
+// The thinker links are not in the pointer table.
+//
+//==========================================================================
+
+int DThinker::GetConcurrentMarkSlots(DObject **slots[])
+{
+	slots[0] = (DObject **)&NextThinker;
+	slots[1] = (DObject **)&PrevThinker;
+	return 2;
+}
+
 //==========================================================================
 //
 //
@@ -1060,6 +1265,6 @@ DThinker *FThinkerIterator::Next (bool exact)
 ADD_STAT (think)
 {
 	FString out;
-	out.Format ("Think time = %04.2f ms - %d thinkers, Action = %04.2f ms", ThinkCycles.TimeMS(), ThinkCount, ActionCycles.TimeMS());
+	out.Format ("Think time = %04.2f ms - %d thinkers (%d parallel), Action = %04.2f ms", ThinkCycles.TimeMS(), ThinkCount, ParallelThinkCount, ActionCycles.TimeMS());
 	return out;
 }
@@ -60,7 +60,7 @@ struct FThinkerList
 	bool IsEmpty() const;
 	void DestroyThinkers();
 	bool DoDestroyThinkers();
-	int TickThinkers(FThinkerList *dest);	// Returns: # of thinkers ticked
+	int TickThinkers(FThinkerList *dest, TArray<DThinker*> *deferred = nullptr);	// Returns: # of thinkers ticked
 	int ProfileThinkers(FThinkerList *dest);
 	void SaveList(FSerializer &arc);
 
@@ -101,12 +101,16 @@ public:
 	virtual ~DThinker ();
 	virtual void Tick ();
 	void CallTick();
+	bool CanTickParallel();
+	virtual void TickParallel();		// Must only modify the thinker itself. May run on a worker thread.
+	virtual void TickParallelFinish();	// Runs on the main thread after all TickParallel calls of this tic are done.
 	virtual void PostBeginPlay ();	// Called just before the first tick
 	virtual void CallPostBeginPlay(); // different in actor.
 	virtual void PostSerialize();
 	void CallPostSerialize();
 	void Serialize(FSerializer &arc) override;
 	size_t PropagateMark();
+	int GetConcurrentMarkSlots(DObject **slots[]);
 	
 	void ChangeStatNum (int statnum);
 
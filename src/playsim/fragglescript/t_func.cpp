@@ -2725,6 +2725,7 @@ void FParser::SF_MoveCamera(void)
 
 		cam->radius = 1 / 8192.;
 		cam->Height = 1 / 8192.;
+		cam->UpdateBlockThings();
 
 		if (campos != targpos)
 		{
@@ -3289,6 +3290,7 @@ void FParser::SF_Resurrect()
 		mo->SetState(state);
 		mo->Height = mo->GetDefault()->Height;
 		mo->radius = mo->GetDefault()->radius;
+		mo->UpdateBlockThings();
 		mo->Revive();
 		mo->target = nullptr;
 	}
@@ -3572,7 +3574,10 @@ void FParser::SF_MobjRadius(void)
 		if(t_argc > 1)
 		{
 			if(mo) 
+			{
 				mo->radius = floatvalue(t_argv[1]);
+				mo->UpdateBlockThings();
+			}
 		}
 		t_return.setDouble(mo ? mo->radius : 0.);
 	}
@@ -701,6 +701,7 @@ public:
 	void Tick();
 	void InitFunctions();
 	size_t PropagateMark();
+	int GetConcurrentMarkSlots(DObject **slots[]) { return -1; }
 	size_t PointerSubstitution (DObject *old, DObject *notOld, bool nullOnFail);
 	bool wait_finished(DRunningScript *script);
 	void AddRunningScript(DRunningScript *runscr);
@@ -159,6 +159,7 @@ EMoveResult sector_t::MoveFloor(double speed, double dest, int crush, int direct
 	double		move;
 	//double		destheight;	//jff 02/04/98 used to keep floors/ceilings
 							// from moving thru each other
+	P_InvalidateSightCache();
 	lastpos = floorplane.fD();
 	switch (direction)
 	{
@@ -295,6 +296,7 @@ EMoveResult sector_t::MoveCeiling(double speed, double dest, int crush, int dire
 	//double		destheight;	//jff 02/04/98 used to keep floors/ceilings
 	// from moving thru each other
 
+	P_InvalidateSightCache();
 	lastpos = ceilingplane.fD();
 	switch (direction)
 	{
@@ -78,399 +78,14 @@
 #include "s_music.h"
 #include "v_video.h"
 #include "texturemanager.h"
+#include "vmbuilder.h"
+#include "md5.h"
 
 	// P-codes for ACS scripts
 	enum
 	{
-/*  0*/	PCD_NOP,
-		PCD_TERMINATE,
-		PCD_SUSPEND,
-		PCD_PUSHNUMBER,
-		PCD_LSPEC1,
-		PCD_LSPEC2,
-		PCD_LSPEC3,
-		PCD_LSPEC4,
-		PCD_LSPEC5,
-		PCD_LSPEC1DIRECT,
-/* 10*/	PCD_LSPEC2DIRECT,
-		PCD_LSPEC3DIRECT,
-		PCD_LSPEC4DIRECT,
-		PCD_LSPEC5DIRECT,
-		PCD_ADD,
-		PCD_SUBTRACT,
-		PCD_MULTIPLY,
-		PCD_DIVIDE,
-		PCD_MODULUS,
-		PCD_EQ,
-/* 20*/ PCD_NE,
-		PCD_LT,
-		PCD_GT,
-		PCD_LE,
-		PCD_GE,
-		PCD_ASSIGNSCRIPTVAR,
-		PCD_ASSIGNMAPVAR,
-		PCD_ASSIGNWORLDVAR,
-		PCD_PUSHSCRIPTVAR,
-		PCD_PUSHMAPVAR,
-/* 30*/	PCD_PUSHWORLDVAR,
-		PCD_ADDSCRIPTVAR,
-		PCD_ADDMAPVAR,
-		PCD_ADDWORLDVAR,
-		PCD_SUBSCRIPTVAR,
-		PCD_SUBMAPVAR,
-		PCD_SUBWORLDVAR,
-		PCD_MULSCRIPTVAR,
-		PCD_MULMAPVAR,
-		PCD_MULWORLDVAR,
-/* 40*/	PCD_DIVSCRIPTVAR,
-		PCD_DIVMAPVAR,
-		PCD_DIVWORLDVAR,
-		PCD_MODSCRIPTVAR,
-		PCD_MODMAPVAR,
-		PCD_MODWORLDVAR,
-		PCD_INCSCRIPTVAR,
-		PCD_INCMAPVAR,
-		PCD_INCWORLDVAR,
-		PCD_DECSCRIPTVAR,
-/* 50*/	PCD_DECMAPVAR,
-		PCD_DECWORLDVAR,
-		PCD_GOTO,
-		PCD_IFGOTO,
-		PCD_DROP,
-		PCD_DELAY,
-		PCD_DELAYDIRECT,
-		PCD_RANDOM,
-		PCD_RANDOMDIRECT,
-		PCD_THINGCOUNT,
-/* 60*/	PCD_THINGCOUNTDIRECT,
-		PCD_TAGWAIT,
-		PCD_TAGWAITDIRECT,
-		PCD_POLYWAIT,
-		PCD_POLYWAITDIRECT,
-		PCD_CHANGEFLOOR,
-		PCD_CHANGEFLOORDIRECT,
-		PCD_CHANGECEILING,
-		PCD_CHANGECEILINGDIRECT,
-		PCD_RESTART,
-/* 70*/	PCD_ANDLOGICAL,
-		PCD_ORLOGICAL,
-		PCD_ANDBITWISE,
-		PCD_ORBITWISE,
-		PCD_EORBITWISE,
-		PCD_NEGATELOGICAL,
-		PCD_LSHIFT,
-		PCD_RSHIFT,
-		PCD_UNARYMINUS,
-		PCD_IFNOTGOTO,
-/* 80*/	PCD_LINESIDE,
-		PCD_SCRIPTWAIT,
-		PCD_SCRIPTWAITDIRECT,
-		PCD_CLEARLINESPECIAL,
-		PCD_CASEGOTO,
-		PCD_BEGINPRINT,
-		PCD_ENDPRINT,
-		PCD_PRINTSTRING,
-		PCD_PRINTNUMBER,
-		PCD_PRINTCHARACTER,
-/* 90*/	PCD_PLAYERCOUNT,
-		PCD_GAMETYPE,
-		PCD_GAMESKILL,
-		PCD_TIMER,
-		PCD_SECTORSOUND,
-		PCD_AMBIENTSOUND,
-		PCD_SOUNDSEQUENCE,
-		PCD_SETLINETEXTURE,
-		PCD_SETLINEBLOCKING,
-		PCD_SETLINESPECIAL,
-/*100*/	PCD_THINGSOUND,
-		PCD_ENDPRINTBOLD,		// [RH] End of Hexen p-codes
-		PCD_ACTIVATORSOUND,
-		PCD_LOCALAMBIENTSOUND,
-		PCD_SETLINEMONSTERBLOCKING,
-		PCD_PLAYERBLUESKULL,	// [BC] Start of new [Skull Tag] pcodes
-		PCD_PLAYERREDSKULL,
-		PCD_PLAYERYELLOWSKULL,
-		PCD_PLAYERMASTERSKULL,
-		PCD_PLAYERBLUECARD,
-/*110*/	PCD_PLAYERREDCARD,
-		PCD_PLAYERYELLOWCARD,
-		PCD_PLAYERMASTERCARD,
-		PCD_PLAYERBLACKSKULL,
-		PCD_PLAYERSILVERSKULL,
-		PCD_PLAYERGOLDSKULL,
-		PCD_PLAYERBLACKCARD,
-		PCD_PLAYERSILVERCARD,
-		PCD_ISNETWORKGAME,
-		PCD_PLAYERTEAM,
-/*120*/	PCD_PLAYERHEALTH,
-		PCD_PLAYERARMORPOINTS,
-		PCD_PLAYERFRAGS,
-		PCD_PLAYEREXPERT,
-		PCD_BLUETEAMCOUNT,
-		PCD_REDTEAMCOUNT,
-		PCD_BLUETEAMSCORE,
-		PCD_REDTEAMSCORE,
-		PCD_ISONEFLAGCTF,
-		PCD_LSPEC6,				// These are never used. They should probably
-/*130*/	PCD_LSPEC6DIRECT,		// be given names like PCD_DUMMY.
-		PCD_PRINTNAME,
-		PCD_MUSICCHANGE,
-		PCD_CONSOLECOMMANDDIRECT,
-		PCD_CONSOLECOMMAND,
-		PCD_SINGLEPLAYER,		// [RH] End of Skull Tag p-codes
-		PCD_FIXEDMUL,
-		PCD_FIXEDDIV,
-		PCD_SETGRAVITY,
-		PCD_SETGRAVITYDIRECT,
-/*140*/	PCD_SETAIRCONTROL,
-		PCD_SETAIRCONTROLDIRECT,
-		PCD_CLEARINVENTORY,
-		PCD_GIVEINVENTORY,
-		PCD_GIVEINVENTORYDIRECT,
-		PCD_TAKEINVENTORY,
-		PCD_TAKEINVENTORYDIRECT,
-		PCD_CHECKINVENTORY,
-		PCD_CHECKINVENTORYDIRECT,
-		PCD_SPAWN,
-/*150*/	PCD_SPAWNDIRECT,
-		PCD_SPAWNSPOT,
-		PCD_SPAWNSPOTDIRECT,
-		PCD_SETMUSIC,
-		PCD_SETMUSICDIRECT,
-		PCD_LOCALSETMUSIC,
-		PCD_LOCALSETMUSICDIRECT,
-		PCD_PRINTFIXED,
-		PCD_PRINTLOCALIZED,
-		PCD_MOREHUDMESSAGE,
-/*160*/	PCD_OPTHUDMESSAGE,
-		PCD_ENDHUDMESSAGE,
-		PCD_ENDHUDMESSAGEBOLD,
-		PCD_SETSTYLE,
-		PCD_SETSTYLEDIRECT,
-		PCD_SETFONT,
-		PCD_SETFONTDIRECT,
-		PCD_PUSHBYTE,
-		PCD_LSPEC1DIRECTB,
-		PCD_LSPEC2DIRECTB,
-/*170*/	PCD_LSPEC3DIRECTB,
-		PCD_LSPEC4DIRECTB,
-		PCD_LSPEC5DIRECTB,
-		PCD_DELAYDIRECTB,
-		PCD_RANDOMDIRECTB,
-		PCD_PUSHBYTES,
-		PCD_PUSH2BYTES,
-		PCD_PUSH3BYTES,
-		PCD_PUSH4BYTES,
-		PCD_PUSH5BYTES,
-/*180*/	PCD_SETTHINGSPECIAL,
-		PCD_ASSIGNGLOBALVAR,
-		PCD_PUSHGLOBALVAR,
-		PCD_ADDGLOBALVAR,
-		PCD_SUBGLOBALVAR,
-		PCD_MULGLOBALVAR,
-		PCD_DIVGLOBALVAR,
-		PCD_MODGLOBALVAR,
-		PCD_INCGLOBALVAR,
-		PCD_DECGLOBALVAR,
-/*190*/	PCD_FADETO,
-		PCD_FADERANGE,
-		PCD_CANCELFADE,
-		PCD_PLAYMOVIE,
-		PCD_SETFLOORTRIGGER,
-		PCD_SETCEILINGTRIGGER,
-		PCD_GETACTORX,
-		PCD_GETACTORY,
-		PCD_GETACTORZ,
-		PCD_STARTTRANSLATION,
-/*200*/	PCD_TRANSLATIONRANGE1,
-		PCD_TRANSLATIONRANGE2,
-		PCD_ENDTRANSLATION,
-		PCD_CALL,
-		PCD_CALLDISCARD,
-		PCD_RETURNVOID,
-		PCD_RETURNVAL,
-		PCD_PUSHMAPARRAY,
-		PCD_ASSIGNMAPARRAY,
-		PCD_ADDMAPARRAY,
-/*210*/	PCD_SUBMAPARRAY,
-		PCD_MULMAPARRAY,
-		PCD_DIVMAPARRAY,
-		PCD_MODMAPARRAY,
-		PCD_INCMAPARRAY,
-		PCD_DECMAPARRAY,
-		PCD_DUP,
-		PCD_SWAP,
-		PCD_WRITETOINI,
-		PCD_GETFROMINI,
-/*220*/ PCD_SIN,
-		PCD_COS,
-		PCD_VECTORANGLE,
-		PCD_CHECKWEAPON,
-		PCD_SETWEAPON,
-		PCD_TAGSTRING,
-		PCD_PUSHWORLDARRAY,
-		PCD_ASSIGNWORLDARRAY,
-		PCD_ADDWORLDARRAY,
-		PCD_SUBWORLDARRAY,
-/*230*/	PCD_MULWORLDARRAY,
-		PCD_DIVWORLDARRAY,
-		PCD_MODWORLDARRAY,
-		PCD_INCWORLDARRAY,
-		PCD_DECWORLDARRAY,
-		PCD_PUSHGLOBALARRAY,
-		PCD_ASSIGNGLOBALARRAY,
-		PCD_ADDGLOBALARRAY,
-		PCD_SUBGLOBALARRAY,
-		PCD_MULGLOBALARRAY,
-/*240*/	PCD_DIVGLOBALARRAY,
-		PCD_MODGLOBALARRAY,
-		PCD_INCGLOBALARRAY,
-		PCD_DECGLOBALARRAY,
-		PCD_SETMARINEWEAPON,
-		PCD_SETACTORPROPERTY,
-		PCD_GETACTORPROPERTY,
-		PCD_PLAYERNUMBER,
-		PCD_ACTIVATORTID,
-		PCD_SETMARINESPRITE,
-/*250*/	PCD_GETSCREENWIDTH,
-		PCD_GETSCREENHEIGHT,
-		PCD_THING_PROJECTILE2,
-		PCD_STRLEN,
-		PCD_SETHUDSIZE,
-		PCD_GETCVAR,
-		PCD_CASEGOTOSORTED,
-		PCD_SETRESULTVALUE,
-		PCD_GETLINEROWOFFSET,
-		PCD_GETACTORFLOORZ,
-/*260*/	PCD_GETACTORANGLE,
-		PCD_GETSECTORFLOORZ,
-		PCD_GETSECTORCEILINGZ,
-		PCD_LSPEC5RESULT,
-		PCD_GETSIGILPIECES,
-		PCD_GETLEVELINFO,
-		PCD_CHANGESKY,
-		PCD_PLAYERINGAME,
-		PCD_PLAYERISBOT,
-		PCD_SETCAMERATOTEXTURE,
-/*270*/	PCD_ENDLOG,
-		PCD_GETAMMOCAPACITY,
-		PCD_SETAMMOCAPACITY,
-		PCD_PRINTMAPCHARARRAY,		// [JB] start of new p-codes
-		PCD_PRINTWORLDCHARARRAY,
-		PCD_PRINTGLOBALCHARARRAY,	// [JB] end of new p-codes
-		PCD_SETACTORANGLE,			// [GRB]
-		PCD_GRABINPUT,				// Unused but acc defines them
-		PCD_SETMOUSEPOINTER,		// "
-		PCD_MOVEMOUSEPOINTER,		// "
-/*280*/	PCD_SPAWNPROJECTILE,
-		PCD_GETSECTORLIGHTLEVEL,
-		PCD_GETACTORCEILINGZ,
-		PCD_SETACTORPOSITION,
-		PCD_CLEARACTORINVENTORY,
-		PCD_GIVEACTORINVENTORY,
-		PCD_TAKEACTORINVENTORY,
-		PCD_CHECKACTORINVENTORY,
-		PCD_THINGCOUNTNAME,
-		PCD_SPAWNSPOTFACING,
-/*290*/	PCD_PLAYERCLASS,			// [GRB]
-		//[MW] start my p-codes
-		PCD_ANDSCRIPTVAR,
-		PCD_ANDMAPVAR, 
-		PCD_ANDWORLDVAR, 
-		PCD_ANDGLOBALVAR, 
-		PCD_ANDMAPARRAY, 
-		PCD_ANDWORLDARRAY, 
-		PCD_ANDGLOBALARRAY,
-		PCD_EORSCRIPTVAR, 
-		PCD_EORMAPVAR, 
-/*300*/	PCD_EORWORLDVAR, 
-		PCD_EORGLOBALVAR, 
-		PCD_EORMAPARRAY, 
-		PCD_EORWORLDARRAY, 
-		PCD_EORGLOBALARRAY,
-		PCD_ORSCRIPTVAR, 
-		PCD_ORMAPVAR, 
-		PCD_ORWORLDVAR, 
-		PCD_ORGLOBALVAR, 
-		PCD_ORMAPARRAY, 
-/*310*/	PCD_ORWORLDARRAY, 
-		PCD_ORGLOBALARRAY,
-		PCD_LSSCRIPTVAR, 
-		PCD_LSMAPVAR, 
-		PCD_LSWORLDVAR, 
-		PCD_LSGLOBALVAR, 
-		PCD_LSMAPARRAY, 
-		PCD_LSWORLDARRAY, 
-		PCD_LSGLOBALARRAY,
-		PCD_RSSCRIPTVAR, 
-/*320*/	PCD_RSMAPVAR, 
-		PCD_RSWORLDVAR, 
-		PCD_RSGLOBALVAR, 
-		PCD_RSMAPARRAY, 
-		PCD_RSWORLDARRAY, 
-		PCD_RSGLOBALARRAY, 
-		//[MW] end my p-codes
-		PCD_GETPLAYERINFO,			// [GRB]
-		PCD_CHANGELEVEL,
-		PCD_SECTORDAMAGE,
-		PCD_REPLACETEXTURES,
-/*330*/	PCD_NEGATEBINARY,
-		PCD_GETACTORPITCH,
-		PCD_SETACTORPITCH,
-		PCD_PRINTBIND,
-		PCD_SETACTORSTATE,
-		PCD_THINGDAMAGE2,
-		PCD_USEINVENTORY,
-		PCD_USEACTORINVENTORY,
-		PCD_CHECKACTORCEILINGTEXTURE,
-		PCD_CHECKACTORFLOORTEXTURE,
-/*340*/	PCD_GETACTORLIGHTLEVEL,
-		PCD_SETMUGSHOTSTATE,
-		PCD_THINGCOUNTSECTOR,
-		PCD_THINGCOUNTNAMESECTOR,
-		PCD_CHECKPLAYERCAMERA,		// [TN]
-		PCD_MORPHACTOR,				// [MH]
-		PCD_UNMORPHACTOR,			// [MH]
-		PCD_GETPLAYERINPUT,
-		PCD_CLASSIFYACTOR,
-		PCD_PRINTBINARY,
-/*350*/	PCD_PRINTHEX,
-		PCD_CALLFUNC,
-		PCD_SAVESTRING,			// [FDARI] create string (temporary)
-		PCD_PRINTMAPCHRANGE,	// [FDARI] output range (print part of array)
-		PCD_PRINTWORLDCHRANGE,
-		PCD_PRINTGLOBALCHRANGE,
-		PCD_STRCPYTOMAPCHRANGE,	// [FDARI] input range (copy string to all/part of array)
-		PCD_STRCPYTOWORLDCHRANGE,
-		PCD_STRCPYTOGLOBALCHRANGE,
-		PCD_PUSHFUNCTION,		// from Eternity
-/*360*/	PCD_CALLSTACK,			// from Eternity
-		PCD_SCRIPTWAITNAMED,
-		PCD_TRANSLATIONRANGE3,
-		PCD_GOTOSTACK,
-		PCD_ASSIGNSCRIPTARRAY,
-		PCD_PUSHSCRIPTARRAY,
-		PCD_ADDSCRIPTARRAY,
-		PCD_SUBSCRIPTARRAY,
-		PCD_MULSCRIPTARRAY,
-		PCD_DIVSCRIPTARRAY,
-/*370*/	PCD_MODSCRIPTARRAY,
-		PCD_INCSCRIPTARRAY,
-		PCD_DECSCRIPTARRAY,
-		PCD_ANDSCRIPTARRAY,
-		PCD_EORSCRIPTARRAY,
-		PCD_ORSCRIPTARRAY,
-		PCD_LSSCRIPTARRAY,
-		PCD_RSSCRIPTARRAY,
-		PCD_PRINTSCRIPTCHARARRAY,
-		PCD_PRINTSCRIPTCHRANGE,
-/*380*/	PCD_STRCPYTOSCRIPTCHRANGE,
-		PCD_LSPEC5EX,
-		PCD_LSPEC5EXRESULT,
-		PCD_TRANSLATIONRANGE4,
-		PCD_TRANSLATIONRANGE5,
-
-/*381*/	PCODE_COMMAND_COUNT
+#include "p_acspcodes.h"
+		PCODE_COMMAND_COUNT
 	};
 
 	// Some constants used by ACS scripts
@@ -639,7 +254,9 @@ struct CallReturn
 		  ReturnAddress(pc),
 		  bDiscardResult(discard),
 		  EntryInstrCount(runaway)
-	{}
+	{
+		RunTime.ResetAndClock();
+	}
 
 	ScriptFunction *ReturnFunction;
 	FBehavior *ReturnModule;
@@ -648,8 +265,10 @@ struct CallReturn
 	int ReturnAddress;
 	int bDiscardResult;
 	unsigned int EntryInstrCount;
+	cycle_t RunTime;
 };
 
+struct FACSStack;
 
 class DLevelScript : public DObject
 {
@@ -776,8 +395,10 @@ protected:
 
 private:
 	DLevelScript() = default;
+	void RunCompiled(FACSStack &stack, int *&pc, int *&resume, ScriptFunction *function, const int32_t *locals, unsigned int &runaway);
 
 	friend class DACSThinker;
+	friend struct FACSVMFrame;
 };
 
 static DLevelScript *P_GetScriptGoing (FLevelLocals *Level, AActor *who, line_t *where, int num, const ScriptPtr *code, FBehavior *module,
@@ -2242,7 +1863,9 @@ bool FBehavior::Init(FLevelLocals *Level, int lumpnum, FileReader * fr, int len,
 		return false;
 	}
 
-	object = new uint8_t[len];
+	// The padding lets the interpreter read a whole word at the very end.
+	object = new uint8_t[len + 4];
+	memset(object + len, 0, 4);
 	if (fr == NULL)
 	{
 		fileSystem.ReadFile (lumpnum, object);
@@ -6848,227 +6471,1846 @@ enum
 
 
 #define NEXTWORD	(LittleLong(*pc++))
-#define NEXTBYTE	(fmt==ACS_LittleEnhanced?getbyte(pc):NEXTWORD)
-#define NEXTSHORT	(fmt==ACS_LittleEnhanced?getshort(pc):NEXTWORD)
+#define NEXTBYTE	(getbyte(pc, enc))
+#define NEXTSHORT	(getshort(pc, enc))
 #define STACK(a)	(Stack[sp - (a)])
 #define PushToStack(a)	(Stack[sp++] = (a))
 // Direct instructions that take strings need to have the tag applied.
 #define TAGSTR(a)	(a|activeBehavior->GetLibraryID())
 
-inline int getbyte (int *&pc)
+//============================================================================
+//
+// FACSEncoding
+//
+// How a module encodes its p-codes and their byte and short operands.
+// ACS_LittleEnhanced uses one byte for p-codes below 240 and for byte
+// operands and two for everything else, the other formats use four for
+// all of them. The interpreter keeps the encoding of the active module,
+// so that fetching always reads a word and cuts it down with shifts
+// instead of branching on the format each time. Module data is padded,
+// so reading a whole word at the end of it is fine.
+//
+//============================================================================
+
+struct FACSEncoding
 {
-	int res = *(uint8_t *)pc;
-	pc = (int *)((uint8_t *)pc+1);
+	uint8_t Compact;
+	uint8_t PCodeShift, ByteShift, ShortShift;
+	uint8_t PCodeSize, ByteSize, ShortSize;
+
+	FACSEncoding(ACSFormat fmt)
+	{
+		Compact = fmt == ACS_LittleEnhanced;
+		PCodeShift = ByteShift = Compact ? 24 : 0;
+		ShortShift = Compact ? 16 : 0;
+		PCodeSize = ByteSize = Compact ? 1 : 4;
+		ShortSize = Compact ? 2 : 4;
+	}
+};
+
+inline int getbyte (int *&pc, const FACSEncoding &enc)
+{
+	int res = int(uint32_t(uallong(*pc)) << enc.ByteShift >> enc.ByteShift);
+	pc = (int *)((uint8_t *)pc + enc.ByteSize);
 	return res;
 }
 
-inline int getshort (int *&pc)
+inline int getshort (int *&pc, const FACSEncoding &enc)
 {
-	int res = LittleShort( *(int16_t *)pc);
-	pc = (int *)((uint8_t *)pc+2);
+	// Compact shorts are signed.
+	int res = int32_t(uint32_t(uallong(*pc)) << enc.ShortShift) >> enc.ShortShift;
+	pc = (int *)((uint8_t *)pc + enc.ShortSize);
 	return res;
 }
 
-static bool CharArrayParms(int &capacity, int &offset, int &a, FACSStackMemory& Stack, int &sp, bool ranged)
+inline int FetchPCode (int *&pc, const FACSEncoding &enc)
 {
-	if (ranged)
+	uint32_t word = uallong(*pc);
+	int pcd = int(word << enc.PCodeShift >> enc.PCodeShift);
+
+	// Compact p-codes from 240 on take a second byte.
+	int extended = enc.Compact & (pcd >= 256-16);
+	pcd += extended * ((pcd - (256-16)) * 255 + int((word >> 8) & 255));
+	pc = (int *)((uint8_t *)pc + enc.PCodeSize + extended);
+	return pcd;
+}
+
+// With GCC and Clang each p-code jumps directly to the next one's handler
+// through a table of label addresses instead of going back to the switch.
+// This gives every handler its own indirect branch, which the CPU predicts
+// far better than the single shared one of the switch.
+// Only handlers that end at switch level can do this, since a computed goto
+// does not run destructors. Everything else still breaks out of the switch.
+// So does reaching the point where a translated body takes over again.
+#if !defined(ACS_COMPGOTO) && defined(__GNUC__)
+#define ACS_COMPGOTO 1
+#endif
+
+#if ACS_COMPGOTO
+#define PCASE(x)	case x: op_##x
+#define NEXTPCODE	if (state == SCRIPT_Running && runaway < 2000000 && pc != jitresume) \
+					{ \
+						++runaway; \
+						pcd = FetchPCode(pc, enc); \
+						goto *((unsigned)pcd < PCODE_COMMAND_COUNT ? pcodes[pcd] : &&op_default); \
+					} \
+					break
+#else
+#define PCASE(x)	case x
+#define NEXTPCODE	break
+#endif
+
+//==========================================================================
+//
+// ACS translation
+//
+// With acs_jit on, ACS code is translated to VM bytecode the first time it
+// runs, so that it goes through the JIT like any other script function.
+// Each ACS stack slot and local variable gets its own register, which is
+// possible because the stack depth at every instruction is known in
+// advance.
+//
+// There are two kinds of translation:
+//
+// A function that only does arithmetic, variable access, flow control and
+// calls to other such functions is translated into something that can be
+// called directly. It takes the module's map variable table, the runaway
+// counter and the function's arguments and returns the function's result,
+// an ACSVM_* status and the updated runaway counter.
+//
+// Scripts and all other functions are translated into a resumable body.
+// Everything the translation does not do itself, like delays, specials,
+// printing or calls to functions that are not translated, is left to the
+// interpreter: the body stores the stack and the locals back to where the
+// interpreter keeps them and returns the offset of the instruction, which
+// the interpreter then runs. Afterwards the interpreter goes back into the
+// body, which starts with a dispatch on the resume offset. The same goes
+// for a script that continues after a delay. Built-in functions called
+// through PCD_CALLFUNC are run from inside the body.
+//
+//==========================================================================
+
+CVAR(Bool, acs_jit, false, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
+
+enum
+{
+	ACSVM_Ok,
+	ACSVM_Runaway,
+	ACSVM_DivideBy0,
+	ACSVM_ModulusBy0,
+	ACSVM_Interpret,	// continue in the interpreter
+	ACSVM_NoEntry,		// the body cannot be entered at this point
+
+	ACSVM_MaxArgs = 16,
+	ACSVM_MaxRegs = 240,	// leaves some room for the builder's own constant loads
+	ACSVM_MaxDepth = 64,	// the stack space a called function is guaranteed
+	ACSVM_RunawayLimit = 2000000,
+};
+
+enum EACSVMKind
+{
+	AVK_Function,
+	AVK_FunctionBody,
+	AVK_ScriptBody,
+};
+
+enum EACSVarOp
+{
+	AVO_Assign, AVO_Push, AVO_Add, AVO_Sub, AVO_Mul, AVO_Div, AVO_Mod,
+	AVO_Inc, AVO_Dec, AVO_And, AVO_Or, AVO_Eor, AVO_LShift, AVO_RShift,
+	AVO_Count
+};
+
+enum EACSVarScope
+{
+	AVS_Script, AVS_Map, AVS_World, AVS_Global,
+	AVS_Count
+};
+
+static const int ACSVarOps[AVO_Count][AVS_Count] =
+{
+	{ PCD_ASSIGNSCRIPTVAR,	PCD_ASSIGNMAPVAR,	PCD_ASSIGNWORLDVAR,	PCD_ASSIGNGLOBALVAR },
+	{ PCD_PUSHSCRIPTVAR,	PCD_PUSHMAPVAR,		PCD_PUSHWORLDVAR,	PCD_PUSHGLOBALVAR },
+	{ PCD_ADDSCRIPTVAR,		PCD_ADDMAPVAR,		PCD_ADDWORLDVAR,	PCD_ADDGLOBALVAR },
+	{ PCD_SUBSCRIPTVAR,		PCD_SUBMAPVAR,		PCD_SUBWORLDVAR,	PCD_SUBGLOBALVAR },
+	{ PCD_MULSCRIPTVAR,		PCD_MULMAPVAR,		PCD_MULWORLDVAR,	PCD_MULGLOBALVAR },
+	{ PCD_DIVSCRIPTVAR,		PCD_DIVMAPVAR,		PCD_DIVWORLDVAR,	PCD_DIVGLOBALVAR },
+	{ PCD_MODSCRIPTVAR,		PCD_MODMAPVAR,		PCD_MODWORLDVAR,	PCD_MODGLOBALVAR },
+	{ PCD_INCSCRIPTVAR,		PCD_INCMAPVAR,		PCD_INCWORLDVAR,	PCD_INCGLOBALVAR },
+	{ PCD_DECSCRIPTVAR,		PCD_DECMAPVAR,		PCD_DECWORLDVAR,	PCD_DECGLOBALVAR },
+	{ PCD_ANDSCRIPTVAR,		PCD_ANDMAPVAR,		PCD_ANDWORLDVAR,	PCD_ANDGLOBALVAR },
+	{ PCD_ORSCRIPTVAR,		PCD_ORMAPVAR,		PCD_ORWORLDVAR,		PCD_ORGLOBALVAR },
+	{ PCD_EORSCRIPTVAR,		PCD_EORMAPVAR,		PCD_EORWORLDVAR,	PCD_EORGLOBALVAR },
+	{ PCD_LSSCRIPTVAR,		PCD_LSMAPVAR,		PCD_LSWORLDVAR,		PCD_LSGLOBALVAR },
+	{ PCD_RSSCRIPTVAR,		PCD_RSMAPVAR,		PCD_RSWORLDVAR,		PCD_RSGLOBALVAR },
+};
+
+static bool FindACSVarOp(int pcd, int &op, int &scope)
+{
+	for (op = 0; op < AVO_Count; op++)
 	{
-		capacity = STACK(1);
-		offset = STACK(2);
-		if (capacity < 1 || offset < 0)
+		for (scope = 0; scope < AVS_Count; scope++)
 		{
-			sp -= 4;
-			return false;
+			if (ACSVarOps[op][scope] == pcd) return true;
 		}
-		sp -= 2;
 	}
-	else
-	{
-		capacity = INT_MAX;
-		offset = 0;
-	}
-	a = STACK(1);
-	offset += STACK(2);
-	sp -= 2;
-	return true;
+	return false;
 }
 
-PClass *DLevelScript::GetClassForIndex(int index) const
+// P-codes that a body leaves to the interpreter and then continues after.
+// Their operands are Bytes operands read with NEXTBYTE, followed by Words
+// four byte operands and RawBytes single bytes. Anything that is neither in
+// here nor translated ends the body's translation at that point, and the
+// interpreter keeps going from there.
+struct FACSCallout
 {
-	return PClass::FindActor(Level->Behaviors.LookupString(index));
+	int PCode;
+	uint8_t Bytes, Words, RawBytes;
+	uint8_t Pops, Pushes;
+};
+
+static const FACSCallout ACSCallouts[] =
+{
+	{ PCD_SUSPEND,				0, 0, 0,	0, 0 },
+	{ PCD_DELAY,				0, 0, 0,	1, 0 },
+	{ PCD_DELAYDIRECT,			0, 1, 0,	0, 0 },
+	{ PCD_DELAYDIRECTB,			0, 0, 1,	0, 0 },
+	{ PCD_TAGWAIT,				0, 0, 0,	1, 0 },
+	{ PCD_TAGWAITDIRECT,		0, 1, 0,	0, 0 },
+	{ PCD_POLYWAIT,				0, 0, 0,	1, 0 },
+	{ PCD_POLYWAITDIRECT,		0, 1, 0,	0, 0 },
+	{ PCD_SCRIPTWAIT,			0, 0, 0,	1, 0 },
+	{ PCD_SCRIPTWAITDIRECT,		0, 1, 0,	0, 0 },
+
+	{ PCD_LSPEC1,				1, 0, 0,	1, 0 },
+	{ PCD_LSPEC2,				1, 0, 0,	2, 0 },
+	{ PCD_LSPEC3,				1, 0, 0,	3, 0 },
+	{ PCD_LSPEC4,				1, 0, 0,	4, 0 },
+	{ PCD_LSPEC5,				1, 0, 0,	5, 0 },
+	{ PCD_LSPEC5RESULT,			1, 0, 0,	5, 1 },
+	{ PCD_LSPEC5EX,				0, 1, 0,	5, 0 },
+	{ PCD_LSPEC5EXRESULT,		0, 1, 0,	5, 1 },
+	{ PCD_LSPEC1DIRECT,			1, 1, 0,	0, 0 },
+	{ PCD_LSPEC2DIRECT,			1, 2, 0,	0, 0 },
+	{ PCD_LSPEC3DIRECT,			1, 3, 0,	0, 0 },
+	{ PCD_LSPEC4DIRECT,			1, 4, 0,	0, 0 },
+	{ PCD_LSPEC5DIRECT,			1, 5, 0,	0, 0 },
+	{ PCD_LSPEC1DIRECTB,		0, 0, 2,	0, 0 },
+	{ PCD_LSPEC2DIRECTB,		0, 0, 3,	0, 0 },
+	{ PCD_LSPEC3DIRECTB,		0, 0, 4,	0, 0 },
+	{ PCD_LSPEC4DIRECTB,		0, 0, 5,	0, 0 },
+	{ PCD_LSPEC5DIRECTB,		0, 0, 6,	0, 0 },
+
+	{ PCD_RANDOM,				0, 0, 0,	2, 1 },
+	{ PCD_RANDOMDIRECT,			0, 2, 0,	0, 1 },
+	{ PCD_RANDOMDIRECTB,		0, 0, 2,	0, 1 },
+	{ PCD_THINGCOUNT,			0, 0, 0,	2, 1 },
+	{ PCD_THINGCOUNTDIRECT,		0, 2, 0,	0, 1 },
+	{ PCD_THINGCOUNTNAME,		0, 0, 0,	2, 1 },
+	{ PCD_THINGCOUNTSECTOR,		0, 0, 0,	3, 1 },
+	{ PCD_THINGCOUNTNAMESECTOR,	0, 0, 0,	3, 1 },
+	{ PCD_CHANGEFLOOR,			0, 0, 0,	2, 0 },
+	{ PCD_CHANGECEILING,		0, 0, 0,	2, 0 },
+
+	{ PCD_TIMER,				0, 0, 0,	0, 1 },
+	{ PCD_LINESIDE,				0, 0, 0,	0, 1 },
+	{ PCD_PLAYERCOUNT,			0, 0, 0,	0, 1 },
+	{ PCD_GAMETYPE,				0, 0, 0,	0, 1 },
+	{ PCD_GAMESKILL,			0, 0, 0,	0, 1 },
+	{ PCD_SINGLEPLAYER,			0, 0, 0,	0, 1 },
+	{ PCD_ISNETWORKGAME,		0, 0, 0,	0, 1 },
+	{ PCD_PLAYERHEALTH,			0, 0, 0,	0, 1 },
+	{ PCD_PLAYERNUMBER,			0, 0, 0,	0, 1 },
+	{ PCD_ACTIVATORTID,			0, 0, 0,	0, 1 },
+	{ PCD_GETSCREENWIDTH,		0, 0, 0,	0, 1 },
+	{ PCD_GETSCREENHEIGHT,		0, 0, 0,	0, 1 },
+	{ PCD_PLAYERINGAME,			0, 0, 0,	1, 1 },
+	{ PCD_PLAYERCLASS,			0, 0, 0,	1, 1 },
+	{ PCD_GETPLAYERINPUT,		0, 0, 0,	2, 1 },
+
+	{ PCD_TAGSTRING,			0, 0, 0,	1, 1 },
+	{ PCD_STRLEN,				0, 0, 0,	1, 1 },
+	{ PCD_SETRESULTVALUE,		0, 0, 0,	1, 0 },
+	{ PCD_GETCVAR,				0, 0, 0,	1, 1 },
+	{ PCD_BEGINPRINT,			0, 0, 0,	0, 0 },
+	{ PCD_PRINTSTRING,			0, 0, 0,	1, 0 },
+	{ PCD_PRINTLOCALIZED,		0, 0, 0,	1, 0 },
+	{ PCD_PRINTNUMBER,			0, 0, 0,	1, 0 },
+	{ PCD_PRINTCHARACTER,		0, 0, 0,	1, 0 },
+	{ PCD_PRINTFIXED,			0, 0, 0,	1, 0 },
+	{ PCD_PRINTBINARY,			0, 0, 0,	1, 0 },
+	{ PCD_PRINTHEX,				0, 0, 0,	1, 0 },
+	{ PCD_ENDPRINT,				0, 0, 0,	0, 0 },
+	{ PCD_ENDPRINTBOLD,			0, 0, 0,	0, 0 },
+	{ PCD_ENDLOG,				0, 0, 0,	0, 0 },
+	{ PCD_MOREHUDMESSAGE,		0, 0, 0,	0, 0 },
+	{ PCD_OPTHUDMESSAGE,		0, 0, 0,	0, 0 },
+	{ PCD_SETFONT,				0, 0, 0,	1, 0 },
+	{ PCD_SETFONTDIRECT,		0, 1, 0,	0, 0 },
+	{ PCD_SETHUDSIZE,			0, 0, 0,	3, 0 },
+
+	{ PCD_CHECKINVENTORY,		0, 0, 0,	1, 1 },
+	{ PCD_GIVEINVENTORY,		0, 0, 0,	2, 0 },
+	{ PCD_TAKEINVENTORY,		0, 0, 0,	2, 0 },
+	{ PCD_CHECKACTORINVENTORY,	0, 0, 0,	2, 1 },
+	{ PCD_GIVEACTORINVENTORY,	0, 0, 0,	3, 0 },
+	{ PCD_TAKEACTORINVENTORY,	0, 0, 0,	3, 0 },
+	{ PCD_CHECKWEAPON,			0, 0, 0,	1, 1 },
+	{ PCD_SETWEAPON,			0, 0, 0,	1, 1 },
+	{ PCD_GETACTORX,			0, 0, 0,	1, 1 },
+	{ PCD_GETACTORY,			0, 0, 0,	1, 1 },
+	{ PCD_GETACTORZ,			0, 0, 0,	1, 1 },
+	{ PCD_GETACTORFLOORZ,		0, 0, 0,	1, 1 },
+	{ PCD_GETACTORCEILINGZ,		0, 0, 0,	1, 1 },
+	{ PCD_GETACTORANGLE,		0, 0, 0,	1, 1 },
+	{ PCD_GETACTORPITCH,		0, 0, 0,	1, 1 },
+	{ PCD_SETACTORANGLE,		0, 0, 0,	2, 0 },
+	{ PCD_SETACTORPOSITION,		0, 0, 0,	5, 1 },
+	{ PCD_GETACTORPROPERTY,		0, 0, 0,	2, 1 },
+	{ PCD_SETACTORPROPERTY,		0, 0, 0,	3, 0 },
+	{ PCD_CLASSIFYACTOR,		0, 0, 0,	1, 1 },
+
+	{ PCD_SIN,					0, 0, 0,	1, 1 },
+	{ PCD_COS,					0, 0, 0,	1, 1 },
+	{ PCD_VECTORANGLE,			0, 0, 0,	2, 1 },
+	{ PCD_FIXEDMUL,				0, 0, 0,	2, 1 },
+	{ PCD_FIXEDDIV,				0, 0, 0,	2, 1 },
+
+	{ PCD_PUSHSCRIPTARRAY,		1, 0, 0,	1, 1 },
+	{ PCD_PUSHMAPARRAY,			1, 0, 0,	1, 1 },
+	{ PCD_PUSHWORLDARRAY,		1, 0, 0,	1, 1 },
+	{ PCD_PUSHGLOBALARRAY,		1, 0, 0,	1, 1 },
+	{ PCD_ASSIGNSCRIPTARRAY,	1, 0, 0,	2, 0 },
+	{ PCD_ASSIGNMAPARRAY,		1, 0, 0,	2, 0 },
+	{ PCD_ASSIGNWORLDARRAY,		1, 0, 0,	2, 0 },
+	{ PCD_ASSIGNGLOBALARRAY,	1, 0, 0,	2, 0 },
+	{ PCD_ADDSCRIPTARRAY,		1, 0, 0,	2, 0 },
+	{ PCD_ADDMAPARRAY,			1, 0, 0,	2, 0 },
+	{ PCD_ADDWORLDARRAY,		1, 0, 0,	2, 0 },
+	{ PCD_ADDGLOBALARRAY,		1, 0, 0,	2, 0 },
+	{ PCD_SUBSCRIPTARRAY,		1, 0, 0,	2, 0 },
+	{ PCD_SUBMAPARRAY,			1, 0, 0,	2, 0 },
+	{ PCD_SUBWORLDARRAY,		1, 0, 0,	2, 0 },
+	{ PCD_SUBGLOBALARRAY,		1, 0, 0,	2, 0 },
+	{ PCD_MULSCRIPTARRAY,		1, 0, 0,	2, 0 },
+	{ PCD_MULMAPARRAY,			1, 0, 0,	2, 0 },
+	{ PCD_MULWORLDARRAY,		1, 0, 0,	2, 0 },
+	{ PCD_MULGLOBALARRAY,		1, 0, 0,	2, 0 },
+	{ PCD_DIVSCRIPTARRAY,		1, 0, 0,	2, 0 },
+	{ PCD_DIVMAPARRAY,			1, 0, 0,	2, 0 },
+	{ PCD_DIVWORLDARRAY,		1, 0, 0,	2, 0 },
+	{ PCD_DIVGLOBALARRAY,		1, 0, 0,	2, 0 },
+	{ PCD_MODSCRIPTARRAY,		1, 0, 0,	2, 0 },
+	{ PCD_MODMAPARRAY,			1, 0, 0,	2, 0 },
+	{ PCD_MODWORLDARRAY,		1, 0, 0,	2, 0 },
+	{ PCD_MODGLOBALARRAY,		1, 0, 0,	2, 0 },
+	{ PCD_INCSCRIPTARRAY,		1, 0, 0,	1, 0 },
+	{ PCD_INCMAPARRAY,			1, 0, 0,	1, 0 },
+	{ PCD_INCWORLDARRAY,		1, 0, 0,	1, 0 },
+	{ PCD_INCGLOBALARRAY,		1, 0, 0,	1, 0 },
+	{ PCD_DECSCRIPTARRAY,		1, 0, 0,	1, 0 },
+	{ PCD_DECMAPARRAY,			1, 0, 0,	1, 0 },
+	{ PCD_DECWORLDARRAY,		1, 0, 0,	1, 0 },
+	{ PCD_DECGLOBALARRAY,		1, 0, 0,	1, 0 },
+};
+
+static const FACSCallout *FindACSCallout(int pcd)
+{
+	for (auto &callout : ACSCallouts)
+	{
+		if (callout.PCode == pcd) return &callout;
+	}
+	return nullptr;
 }
 
-int DLevelScript::RunScript()
+// What a body passes to the natively called built-in functions.
+struct FACSVMFrame
 {
-	DACSThinker *controller = Level->ACSThinker;
-	ACSLocalVariables locals(Localvars);
-	ACSLocalArrays noarrays;
-	ACSLocalArrays *localarrays = &noarrays;
-	ScriptFunction *activeFunction = NULL;
-	FRemapTable *translation = 0;
-	int resultValue = 1;
-	int transi = -1;
+	DLevelScript *Script;
+	FACSStack *Stack;
+	int Base;		// where the body's stack starts
 
-	if (InModuleScriptNumber >= 0)
+	int CallFunction(int argcount, int funcindex, int depth, bool &running);
+};
+
+static VMFunction *ACSVM_CallFunc;
+
+class FACSTranslator
+{
+public:
+	FACSTranslator(FBehavior *module, uint32_t address, int numargs, int numlocals, EACSVMKind kind)
+		: Module(module), Address(address), NumArgs(numargs), NumLocals(numlocals), Kind(kind),
+		  Format(module->GetFormat()), DataSize(module->GetDataSize()), Build(0)
 	{
-		ScriptPtr *ptr = activeBehavior->GetScriptPtr(InModuleScriptNumber);
-		assert(ptr != NULL);
-		if (ptr != NULL)
-		{
-			localarrays = &ptr->LocalArrays;
-		}
 	}
 
-	// Hexen truncates all special arguments to bytes (only when using an old MAPINFO and old ACS format
-	const int specialargmask = ((Level->flags2 & LEVEL2_HEXENHACK) && activeBehavior->GetFormat() == ACS_Old) ? 255 : ~0;
+	VMScriptFunction *Translate();
 
-	switch (state)
+private:
+	struct Insn
+	{
+		uint32_t Ofs;
+		uint32_t Next;
+		int PCode;
+		int Depth;				// stack depth before the instruction runs
+		int Pops, Pushes;
+		int Arg, Arg2;
+		unsigned FirstOperand, NumOperands;
+		bool Fallthrough;
+		bool Callout;			// left to the interpreter
+		bool Entry;				// a body can be entered here
+		bool Leader, LoopHead;
+		int BlockLength;
+		VMFunction *Target;		// translated callee of PCD_CALL
+		size_t VMAddr;
+	};
+
+	FBehavior *Module;
+	uint32_t Address;
+	int NumArgs;
+	int NumLocals;
+	EACSVMKind Kind;
+	ACSFormat Format;
+	int DataSize;
+	VMFunctionBuilder Build;
+
+	TArray<Insn> Insns;
+	TMap<uint32_t, unsigned> InsnMap;
+	TArray<int> Operands;		// pushed bytes and case tables
+	int MaxDepth = 0;
+
+	// d0 is the runaway counter. A body gets its entry offset and stack depth
+	// in d1 and d2, which double as the offset, depth and resume offset it
+	// hands back to the interpreter in d1 to d3.
+	int CountReg = 0;
+	int LocalBase = 0;
+	int TempReg = 0;
+	int StackBase = 0;
+	enum { OfsReg = 1, DepthReg = 2, ResumeReg = 3 };
+
+	// a0 is the map variable table. A body gets its FACSVMFrame in a1, the
+	// locals in a2 and the stack in a3. The last one holds the address of
+	// the variable being worked on.
+	enum { MapVarsReg = 0, FrameReg = 1, LocalsReg = 2, StackReg = 3 };
+	int AddrReg = 1;
+
+	TArray<std::pair<size_t, uint32_t>> Jumps;
+	TArray<std::pair<size_t, unsigned>> EntryJumps;
+	TArray<size_t> RunawayJumps, DivJumps, ModJumps, StatusJumps, CalloutJumps, NoEntryJumps;
+
+	bool IsBody() const { return Kind != AVK_Function; }
+	bool DecodeCallout(Insn &insn, int *&pc);
+	bool DecodeInsn(Insn &insn);
+	void GetTargets(const Insn &insn, TArray<std::pair<uint32_t, int>> &targets);
+	bool Analyse();
+	void EmitInsn(const Insn &insn);
+	void EmitBool(int cmpop, int check, int b, int c, int dest);
+	void EmitVarOp(int op, int scope, int index, int depth);
+	void EmitZeroCheck(int reg, TArray<size_t> &exits);
+	void EmitJump(uint32_t target) { Jumps.Push(std::make_pair(Build.Emit(OP_JMP, 0), target)); }
+	void EmitExit(int status, int statusreg = -1);
+	void EmitSpill(int from, int to);
+	void EmitLocals(int opcode);
+	void EmitInterpret(uint32_t ofs, int depth, int resume);
+	void EmitCall(const Insn &insn);
+	void EmitCallFunc(const Insn &insn);
+	void EmitEntries();
+
+	int Slot(int depth) const { return StackBase + depth; }
+	int LocalReg(int index) const { return LocalBase + index; }
+	unsigned Konst(int val) { return Build.GetConstantInt(val); }
+};
+
+//==========================================================================
+//
+// FACSTranslator :: DecodeCallout
+//
+// Decodes an instruction that a body leaves to the interpreter. Functions
+// that are called directly cannot do that, so for them this fails.
+//
+//==========================================================================
+
+bool FACSTranslator::DecodeCallout(Insn &insn, int *&pc)
+{
+	if (!IsBody())
 	{
-	case SCRIPT_Delayed:
-		// Decrement the delay counter and enter state running
-		// if it hits 0
-		if (--statedata == 0)
-			state = SCRIPT_Running;
-		break;
+		return false;
+	}
+	insn.Callout = true;
 
-	case SCRIPT_TagWait:
-		// Wait for tagged sector(s) to go inactive, then enter
-		// state running
+	auto callout = FindACSCallout(insn.PCode);
+	if (callout == nullptr)
 	{
-		int secnum;
-		auto it = Level->GetSectorTagIterator(statedata);
-		while ((secnum = it.Next()) >= 0)
-		{
-			if (Level->sectors[secnum].floordata || Level->sectors[secnum].ceilingdata)
-				return resultValue;
-		}
+		// The interpreter takes over from here for good.
+		insn.Fallthrough = false;
+		pc = Module->Ofs2PC(insn.Ofs);
+		return true;
+	}
+	pc = (int *)((uint8_t *)pc + callout->Bytes * (Format == ACS_LittleEnhanced ? 1 : 4) + callout->Words * 4 + callout->RawBytes);
+	insn.Pops = callout->Pops;
+	insn.Pushes = callout->Pushes;
+	return true;
+}
 
-		// If we got here, none of the tagged sectors were busy
-		state = SCRIPT_Running;
+//==========================================================================
+//
+// FACSTranslator :: DecodeInsn
+//
+// Reads the instruction at insn.Ofs and works out what it does to the
+// stack, failing on anything that cannot be translated or that does not
+// fit inside the module.
+//
+//==========================================================================
+
+bool FACSTranslator::DecodeInsn(Insn &insn)
+{
+	// 12 bytes are enough for every fixed size instruction handled here.
+	if ((uint64_t)insn.Ofs + 12 > (uint64_t)DataSize)
+	{
+		return false;
 	}
-	break;
+	int *pc = Module->Ofs2PC(insn.Ofs);
+	FACSEncoding enc(Format);
+	int pcd = FetchPCode(pc, enc);
+	int count, op, scope;
 
-	case SCRIPT_PolyWait:
-		// Wait for polyobj(s) to stop moving, then enter state running
-		if (!PO_Busy (Level, statedata))
-		{
-			state = SCRIPT_Running;
-		}
+	insn.PCode = pcd;
+	insn.FirstOperand = Operands.Size();
+	insn.Fallthrough = true;
+	switch (pcd)
+	{
+	case PCD_NOP:
 		break;
 
-	case SCRIPT_ScriptWaitPre:
-		// Wait for a script to start running, then enter state scriptwait
-		if (controller->RunningScripts.CheckKey(statedata) != NULL)
-			state = SCRIPT_ScriptWait;
+	case PCD_DUP:
+		insn.Pops = 1; insn.Pushes = 2;
 		break;
 
-	case SCRIPT_ScriptWait:
-		// Wait for a script to stop running, then enter state running
-		if (controller->RunningScripts.CheckKey(statedata) != NULL)
-			return resultValue;
+	case PCD_SWAP:
+		insn.Pops = insn.Pushes = 2;
+		break;
 
-		state = SCRIPT_Running;
-		PutFirst ();
+	case PCD_DROP:
+		insn.Pops = 1;
 		break;
 
-	default:
+	case PCD_ADD:
+	case PCD_SUBTRACT:
+	case PCD_MULTIPLY:
+	case PCD_DIVIDE:
+	case PCD_MODULUS:
+	case PCD_EQ:
+	case PCD_NE:
+	case PCD_LT:
+	case PCD_GT:
+	case PCD_LE:
+	case PCD_GE:
+	case PCD_ANDLOGICAL:
+	case PCD_ORLOGICAL:
+	case PCD_ANDBITWISE:
+	case PCD_ORBITWISE:
+	case PCD_EORBITWISE:
+	case PCD_LSHIFT:
+	case PCD_RSHIFT:
+		insn.Pops = 2; insn.Pushes = 1;
 		break;
-	}
 
-	FACSStack stackobj;
-	FACSStackMemory& Stack = stackobj.buffer;
-	int &sp = stackobj.sp;
+	case PCD_NEGATELOGICAL:
+	case PCD_NEGATEBINARY:
+	case PCD_UNARYMINUS:
+		insn.Pops = insn.Pushes = 1;
+		break;
 
-	int *pc = this->pc;
-	ACSFormat fmt = activeBehavior->GetFormat();
-	FBehavior* const savedActiveBehavior = activeBehavior;
-	unsigned int runaway = 0;	// used to prevent infinite loops
-	int pcd;
-	FString work;
-	const char *lookup;
-	int optstart = -1;
-	int temp;
+	case PCD_RETURNVOID:
+	case PCD_RETURNVAL:
+		// A body leaves returning to the interpreter, which owns the call frame.
+		if (IsBody() && !DecodeCallout(insn, pc)) return false;
+		insn.Pops = pcd == PCD_RETURNVAL;
+		insn.Fallthrough = false;
+		break;
 
-	while (state == SCRIPT_Running)
-	{
-		if (++runaway > 2000000)
-		{
-			Printf ("Runaway %s terminated\n", ScriptPresentation(script).GetChars());
-			state = SCRIPT_PleaseRemove;
-			break;
-		}
+	case PCD_TERMINATE:
+		if (!DecodeCallout(insn, pc)) return false;
+		insn.Fallthrough = false;
+		break;
+
+	case PCD_RESTART:
+		// Restarting a script is just a jump to its start.
+		if (Kind != AVK_ScriptBody && !DecodeCallout(insn, pc)) return false;
+		insn.Fallthrough = false;
+		break;
+
+	case PCD_PUSHNUMBER:
+		insn.Arg = uallong(pc[0]);
+		insn.Pushes = 1;
+		pc++;
+		break;
 
-		if (fmt == ACS_LittleEnhanced)
+	case PCD_PUSHBYTE:
+		insn.Arg = *(uint8_t *)pc;
+		insn.Pushes = 1;
+		pc = (int *)((uint8_t *)pc + 1);
+		break;
+
+	case PCD_PUSH2BYTES:
+	case PCD_PUSH3BYTES:
+	case PCD_PUSH4BYTES:
+	case PCD_PUSH5BYTES:
+	case PCD_PUSHBYTES:
+		if (pcd == PCD_PUSHBYTES)
 		{
-			pcd = getbyte(pc);
-			if (pcd >= 256-16)
+			count = *(uint8_t *)pc;
+			pc = (int *)((uint8_t *)pc + 1);
+			if ((uint64_t)Module->PC2Ofs(pc) + count > (uint64_t)DataSize)
 			{
-				pcd = (256-16) + ((pcd - (256-16)) << 8) + getbyte(pc);
+				return false;
 			}
 		}
 		else
 		{
-			pcd = NEXTWORD;
+			count = pcd == PCD_PUSH2BYTES ? 2 : pcd == PCD_PUSH3BYTES ? 3 : pcd == PCD_PUSH4BYTES ? 4 : 5;
 		}
-
-		switch (pcd)
+		for (int i = 0; i < count; i++)
 		{
-		default:
-			Printf ("Unknown P-Code %d in %s\n", pcd, ScriptPresentation(script).GetChars());
-			activeBehavior = savedActiveBehavior;
-			// fall through
-		case PCD_TERMINATE:
-			DPrintf (DMSG_NOTIFY, "%s finished\n", ScriptPresentation(script).GetChars());
-			state = SCRIPT_PleaseRemove;
-			break;
-
-		case PCD_NOP:
-			break;
+			Operands.Push(((uint8_t *)pc)[i]);
+		}
+		insn.Pushes = count;
+		pc = (int *)((uint8_t *)pc + count);
+		break;
 
-		case PCD_SUSPEND:
-			state = SCRIPT_Suspended;
-			break;
+	case PCD_GOTO:
+	case PCD_IFGOTO:
+	case PCD_IFNOTGOTO:
+		insn.Arg = LittleLong(*pc);
+		insn.Pops = pcd != PCD_GOTO;
+		insn.Fallthrough = pcd != PCD_GOTO;
+		pc++;
+		break;
 
-		case PCD_TAGSTRING:
-			//Stack[sp-1] |= activeBehavior->GetLibraryID();
-			Stack[sp-1] = GlobalACSStrings.AddString(activeBehavior->LookupString(Stack[sp-1]));
-			break;
+	case PCD_CASEGOTO:
+		insn.Arg = uallong(pc[0]);
+		insn.Arg2 = uallong(pc[1]);
+		// Only the taken branch pops the value.
+		insn.Pops = insn.Pushes = 1;
+		pc += 2;
+		break;
 
-		case PCD_PUSHNUMBER:
-			PushToStack (uallong(pc[0]));
-			pc++;
-			break;
+	case PCD_CASEGOTOSORTED:
+		pc = (int *)(((size_t)pc + 3) & ~3);
+		count = LittleLong(*pc);
+		pc++;
+		if (count < 0 || (uint64_t)Module->PC2Ofs(pc) + (uint64_t)count * 8 > (uint64_t)DataSize)
+		{
+			return false;
+		}
+		for (int i = 0; i < count * 2; i++)
+		{
+			Operands.Push(LittleLong(pc[i]));
+		}
+		insn.Pops = insn.Pushes = 1;
+		pc += count * 2;
+		break;
 
-		case PCD_PUSHBYTE:
-			PushToStack (*(uint8_t *)pc);
-			pc = (int *)((uint8_t *)pc + 1);
+	case PCD_CALL:
+	case PCD_CALLDISCARD:
+	{
+		FBehavior *module = Module;
+		insn.Arg = NEXTBYTE;
+		ScriptFunction *func = Module->GetFunction(insn.Arg, module);
+		if (func == nullptr)
+		{
+			// The interpreter reports this.
+			if (!DecodeCallout(insn, pc)) return false;
+			insn.Fallthrough = false;
 			break;
+		}
+		// Calls into other modules would need their map variables.
+		if (module == Module && func->ArgCount <= ACSVM_MaxArgs)
+		{
+			insn.Target = Module->GetCompiledFunction(func);
+		}
+		if (insn.Target == nullptr)
+		{
+			if (!DecodeCallout(insn, pc)) return false;
+		}
+		insn.Arg2 = func->ArgCount;
+		insn.Pops = func->ArgCount;
+		insn.Pushes = pcd == PCD_CALL;
+		break;
+	}
 
-		case PCD_PUSH2BYTES:
-			Stack[sp] = ((uint8_t *)pc)[0];
-			Stack[sp+1] = ((uint8_t *)pc)[1];
-			sp += 2;
-			pc = (int *)((uint8_t *)pc + 2);
-			break;
+	case PCD_CALLFUNC:
+		if (!IsBody()) return false;
+		insn.Arg = NEXTBYTE;
+		insn.Arg2 = NEXTSHORT;
+		insn.Pops = insn.Arg;
+		insn.Pushes = 1;
+		break;
 
-		case PCD_PUSH3BYTES:
-			Stack[sp] = ((uint8_t *)pc)[0];
-			Stack[sp+1] = ((uint8_t *)pc)[1];
-			Stack[sp+2] = ((uint8_t *)pc)[2];
-			sp += 3;
-			pc = (int *)((uint8_t *)pc + 3);
+	default:
+		if (!FindACSVarOp(pcd, op, scope))
+		{
+			if (!DecodeCallout(insn, pc)) return false;
 			break;
+		}
+		insn.Arg = NEXTBYTE;
+		switch (scope)
+		{
+		case AVS_Script:	if ((unsigned)insn.Arg >= (unsigned)NumLocals) return false; break;
+		case AVS_Map:		if ((unsigned)insn.Arg >= NUM_MAPVARS) return false; break;
+		case AVS_World:		if ((unsigned)insn.Arg >= NUM_WORLDVARS) return false; break;
+		case AVS_Global:	if ((unsigned)insn.Arg >= NUM_GLOBALVARS) return false; break;
+		}
+		if (op == AVO_Push) insn.Pushes = 1;
+		else if (op != AVO_Inc && op != AVO_Dec) insn.Pops = 1;
+		break;
+	}
+	insn.NumOperands = Operands.Size() - insn.FirstOperand;
+	insn.Next = Module->PC2Ofs(pc);
+	return insn.Next <= (uint32_t)DataSize;
+}
 
-		case PCD_PUSH4BYTES:
-			Stack[sp] = ((uint8_t *)pc)[0];
+//==========================================================================
+//
+// FACSTranslator :: GetTargets
+//
+// Lists where an instruction can branch to and the stack depth there,
+// not counting the next instruction.
+//
+//==========================================================================
+
+void FACSTranslator::GetTargets(const Insn &insn, TArray<std::pair<uint32_t, int>> &targets)
+{
+	targets.Clear();
+	if (insn.Callout)
+	{
+		return;
+	}
+	switch (insn.PCode)
+	{
+	case PCD_GOTO:
+		targets.Push(std::make_pair((uint32_t)insn.Arg, insn.Depth));
+		break;
+
+	case PCD_RESTART:
+		targets.Push(std::make_pair(Address, insn.Depth));
+		break;
+
+	case PCD_IFGOTO:
+	case PCD_IFNOTGOTO:
+		targets.Push(std::make_pair((uint32_t)insn.Arg, insn.Depth - 1));
+		break;
+
+	case PCD_CASEGOTO:
+		targets.Push(std::make_pair((uint32_t)insn.Arg2, insn.Depth - 1));
+		break;
+
+	case PCD_CASEGOTOSORTED:
+		for (unsigned i = 1; i < insn.NumOperands; i += 2)
+		{
+			targets.Push(std::make_pair((uint32_t)Operands[insn.FirstOperand + i], insn.Depth - 1));
+		}
+		break;
+	}
+}
+
+//==========================================================================
+//
+// FACSTranslator :: Analyse
+//
+// Follows every path through the code to find its instructions and the
+// stack depth at each of them, then splits them into basic blocks.
+//
+//==========================================================================
+
+bool FACSTranslator::Analyse()
+{
+	TArray<std::pair<uint32_t, int>> work, targets;
+	TArray<uint32_t> entries;
+	std::pair<uint32_t, int> item;
+
+	work.Push(std::make_pair(Address, 0));
+	while (work.Pop(item))
+	{
+		auto found = InsnMap.CheckKey(item.first);
+		if (found != nullptr)
+		{
+			if (Insns[*found].Depth != item.second) return false;
+			continue;
+		}
+
+		Insn insn = {};
+		insn.Ofs = item.first;
+		insn.Depth = item.second;
+		if (!DecodeInsn(insn)) return false;
+		if (insn.Depth < insn.Pops) return false;
+
+		int newdepth = insn.Depth - insn.Pops + insn.Pushes;
+		MaxDepth = std::max(MaxDepth, std::max(insn.Depth, newdepth));
+		InsnMap[insn.Ofs] = Insns.Push(insn);
+
+		if (insn.Fallthrough)
+		{
+			work.Push(std::make_pair(insn.Next, newdepth));
+			// The interpreter comes back after a callout, and a built-in function
+			// can stop the script, which then resumes here.
+			if (insn.Callout || insn.PCode == PCD_CALLFUNC) entries.Push(insn.Next);
+		}
+		GetTargets(insn, targets);
+		for (auto &target : targets) work.Push(target);
+	}
+
+	// Emit in address order, so that fallthrough stays fallthrough.
+	std::sort(Insns.begin(), Insns.end(), [](const Insn &a, const Insn &b) { return a.Ofs < b.Ofs; });
+	if (Insns[0].Ofs != Address) return false;
+	for (unsigned i = 0; i < Insns.Size(); i++)
+	{
+		InsnMap[Insns[i].Ofs] = i;
+		if (i + 1 < Insns.Size() && Insns[i].Next > Insns[i + 1].Ofs) return false;	// overlapping instructions
+	}
+
+	// Every jump target, every entry and everything after a branch starts a new block.
+	Insns[0].Leader = true;
+	Insns[0].Entry = IsBody();
+	for (auto ofs : entries)
+	{
+		auto &entry = Insns[InsnMap[ofs]];
+		entry.Leader = entry.Entry = true;
+	}
+	for (unsigned i = 0; i < Insns.Size(); i++)
+	{
+		auto &insn = Insns[i];
+		GetTargets(insn, targets);
+		for (auto &target : targets)
+		{
+			auto &dest = Insns[InsnMap[target.first]];
+			dest.Leader = true;
+			if (dest.Ofs <= insn.Ofs) dest.LoopHead = true;
+		}
+		if (!insn.Fallthrough || insn.Callout || targets.Size() > 0)
+		{
+			if (i + 1 < Insns.Size()) Insns[i + 1].Leader = true;
+		}
+	}
+	for (int i = Insns.Size() - 1, length = 0; i >= 0; i--)
+	{
+		length++;
+		if (Insns[i].Leader)
+		{
+			Insns[i].BlockLength = length;
+			length = 0;
+		}
+	}
+	return true;
+}
+
+//==========================================================================
+//
+// FACSTranslator :: EmitBool
+//
+// Stores the result of a comparison as 0 or 1.
+//
+//==========================================================================
+
+void FACSTranslator::EmitBool(int cmpop, int check, int b, int c, int dest)
+{
+	Build.Emit(OP_LI, TempReg, 1);
+	Build.Emit(cmpop, check, b, c);
+	Build.Emit(OP_JMP, 1);
+	Build.Emit(OP_LI, TempReg, 0);
+	Build.Emit(OP_MOVE, dest, TempReg);
+}
+
+void FACSTranslator::EmitZeroCheck(int reg, TArray<size_t> &exits)
+{
+	Build.Emit(OP_EQ_K, 1, reg, Konst(0));
+	exits.Push(Build.Emit(OP_JMP, 0));
+}
+
+//==========================================================================
+//
+// FACSTranslator :: EmitExit
+//
+// Returns a status, either the given one or the one in statusreg.
+//
+//==========================================================================
+
+void FACSTranslator::EmitExit(int status, int statusreg)
+{
+	int statusret = IsBody() ? 0 : 1;
+
+	if (statusreg >= 0) Build.Emit(OP_RET, statusret, REGT_INT, statusreg);
+	else Build.Emit(OP_RETI, statusret, status);
+
+	if (IsBody())
+	{
+		Build.Emit(OP_RETI, 1, 0);
+		Build.Emit(OP_RETI, 2, 0);
+		Build.Emit(OP_RETI, 3, -1);
+		Build.Emit(OP_RET, 4 | RET_FINAL, REGT_INT, CountReg);
+	}
+	else
+	{
+		Build.Emit(OP_RETI, 0, 0);
+		Build.Emit(OP_RET, 2 | RET_FINAL, REGT_INT, CountReg);
+	}
+}
+
+//==========================================================================
+//
+// FACSTranslator :: EmitSpill / EmitLocals
+//
+// Copy the stack and the locals between the registers and the memory the
+// interpreter keeps them in.
+//
+//==========================================================================
+
+void FACSTranslator::EmitSpill(int from, int to)
+{
+	for (int i = from; i < to; i++)
+	{
+		Build.Emit(OP_SW, StackReg, Slot(i), Konst(i * (int)sizeof(int32_t)));
+	}
+}
+
+void FACSTranslator::EmitLocals(int opcode)
+{
+	for (int i = 0; i < NumLocals; i++)
+	{
+		if (opcode == OP_SW) Build.Emit(OP_SW, LocalsReg, LocalReg(i), Konst(i * (int)sizeof(int32_t)));
+		else Build.Emit(OP_LW, LocalReg(i), LocalsReg, Konst(i * (int)sizeof(int32_t)));
+	}
+}
+
+//==========================================================================
+//
+// FACSTranslator :: EmitInterpret
+//
+// Hands over to the interpreter at ofs with the stack, whose top depth
+// slots have already been stored. The interpreter comes back once it gets
+// to resume.
+//
+//==========================================================================
+
+void FACSTranslator::EmitInterpret(uint32_t ofs, int depth, int resume)
+{
+	Build.EmitLoadInt(OfsReg, ofs);
+	Build.EmitLoadInt(DepthReg, depth);
+	Build.EmitLoadInt(ResumeReg, resume);
+	CalloutJumps.Push(Build.Emit(OP_JMP, 0));
+}
+
+//==========================================================================
+//
+// FACSTranslator :: EmitVarOp
+//
+// Local variables live in registers. Everything else is reached through
+// AddrReg, which holds the variable's address.
+//
+//==========================================================================
+
+void FACSTranslator::EmitVarOp(int op, int scope, int index, int depth)
+{
+	int value = Slot(depth - 1);
+	int var;
+
+	if (scope == AVS_Script)
+	{
+		var = LocalReg(index);
+		if (op == AVO_Assign)
+		{
+			Build.Emit(OP_MOVE, var, value);
+			return;
+		}
+		if (op == AVO_Push)
+		{
+			Build.Emit(OP_MOVE, Slot(depth), var);
+			return;
+		}
+	}
+	else
+	{
+		if (scope == AVS_Map)
+		{
+			Build.Emit(OP_LP, AddrReg, MapVarsReg, Konst(index * (int)sizeof(int32_t *)));
+		}
+		else
+		{
+			int32_t *addr = scope == AVS_World ? &ACS_WorldVars[index] : &ACS_GlobalVars[index];
+			Build.Emit(OP_LKP, AddrReg, Build.GetConstantAddress(addr));
+		}
+		if (op == AVO_Assign)
+		{
+			Build.Emit(OP_SW, AddrReg, value, Konst(0));
+			return;
+		}
+		if (op == AVO_Push)
+		{
+			Build.Emit(OP_LW, Slot(depth), AddrReg, Konst(0));
+			return;
+		}
+		var = TempReg;
+		Build.Emit(OP_LW, var, AddrReg, Konst(0));
+	}
+
+	switch (op)
+	{
+	case AVO_Add:		Build.Emit(OP_ADD_RR, var, var, value); break;
+	case AVO_Sub:		Build.Emit(OP_SUB_RR, var, var, value); break;
+	case AVO_Mul:		Build.Emit(OP_MUL_RR, var, var, value); break;
+	case AVO_And:		Build.Emit(OP_AND_RR, var, var, value); break;
+	case AVO_Or:		Build.Emit(OP_OR_RR, var, var, value); break;
+	case AVO_Eor:		Build.Emit(OP_XOR_RR, var, var, value); break;
+	case AVO_LShift:	Build.Emit(OP_SLL_RR, var, var, value); break;
+	case AVO_RShift:	Build.Emit(OP_SRA_RR, var, var, value); break;
+	case AVO_Inc:		Build.Emit(OP_ADDI, var, var, 1); break;
+	case AVO_Dec:		Build.Emit(OP_ADDI, var, var, -1 & 0xff); break;
+
+	case AVO_Div:
+		EmitZeroCheck(value, DivJumps);
+		Build.Emit(OP_DIV_RR, var, var, value);
+		break;
+
+	case AVO_Mod:
+		EmitZeroCheck(value, ModJumps);
+		Build.Emit(OP_MOD_RR, var, var, value);
+		break;
+	}
+
+	if (scope != AVS_Script)
+	{
+		Build.Emit(OP_SW, AddrReg, var, Konst(0));
+	}
+}
+
+//==========================================================================
+//
+// FACSTranslator :: EmitCall
+//
+// Calls a translated function directly, passing on any status other than
+// ACSVM_Ok.
+//
+//==========================================================================
+
+void FACSTranslator::EmitCall(const Insn &insn)
+{
+	int first = insn.Depth - insn.Arg2;
+
+	Build.Emit(OP_PARAM, REGT_POINTER, MapVarsReg);
+	Build.Emit(OP_PARAM, REGT_INT, CountReg);
+	for (int i = 0; i < insn.Arg2; i++)
+	{
+		Build.Emit(OP_PARAM, REGT_INT, Slot(first + i));
+	}
+	Build.Emit(OP_CALL_K, Build.GetConstantAddress(insn.Target), insn.Arg2 + 2, 3);
+	Build.Emit(OP_RESULT, 0, REGT_INT, insn.PCode == PCD_CALL ? Slot(first) : TempReg);
+	Build.Emit(OP_RESULT, 0, REGT_INT, TempReg);
+	Build.Emit(OP_RESULT, 0, REGT_INT, CountReg);
+	Build.Emit(OP_EQ_K, 0, TempReg, Konst(ACSVM_Ok));
+	StatusJumps.Push(Build.Emit(OP_JMP, 0));
+}
+
+//==========================================================================
+//
+// FACSTranslator :: EmitCallFunc
+//
+// Runs a built-in function. Everything gets stored first so that the
+// string collector sees it. If the function stopped the script, the
+// interpreter takes over after it.
+//
+//==========================================================================
+
+void FACSTranslator::EmitCallFunc(const Insn &insn)
+{
+	int first = insn.Depth - insn.Arg;
+
+	EmitSpill(0, insn.Depth);
+	EmitLocals(OP_SW);
+	Build.Emit(OP_PARAM, REGT_POINTER, FrameReg);
+	Build.Emit(OP_PARAM, REGT_INT | REGT_KONST, Konst(insn.Arg));
+	Build.Emit(OP_PARAM, REGT_INT | REGT_KONST, Konst(insn.Arg2));
+	Build.Emit(OP_PARAM, REGT_INT | REGT_KONST, Konst(insn.Depth));
+	Build.Emit(OP_CALL_K, Build.GetConstantAddress(ACSVM_CallFunc), 4, 2);
+	Build.Emit(OP_RESULT, 0, REGT_INT, Slot(first));
+	Build.Emit(OP_RESULT, 0, REGT_INT, TempReg);
+
+	Build.Emit(OP_EQ_K, 0, TempReg, Konst(0));
+	auto running = Build.Emit(OP_JMP, 0);
+	EmitSpill(first, first + 1);
+	EmitInterpret(insn.Next, first + 1, -1);
+	Build.BackpatchToHere(running);
+}
+
+//==========================================================================
+//
+// FACSTranslator :: EmitInsn
+//
+//==========================================================================
+
+void FACSTranslator::EmitInsn(const Insn &insn)
+{
+	const int d = insn.Depth;
+	int op, scope;
+
+	if (insn.Callout)
+	{
+		EmitSpill(0, d);
+		EmitInterpret(insn.Ofs, d, insn.Fallthrough ? (int)insn.Next : -1);
+		return;
+	}
+
+	switch (insn.PCode)
+	{
+	case PCD_NOP:
+	case PCD_DROP:
+		break;
+
+	case PCD_PUSHNUMBER:
+	case PCD_PUSHBYTE:
+		Build.EmitLoadInt(Slot(d), insn.Arg);
+		break;
+
+	case PCD_PUSH2BYTES:
+	case PCD_PUSH3BYTES:
+	case PCD_PUSH4BYTES:
+	case PCD_PUSH5BYTES:
+	case PCD_PUSHBYTES:
+		for (unsigned i = 0; i < insn.NumOperands; i++)
+		{
+			Build.EmitLoadInt(Slot(d + i), Operands[insn.FirstOperand + i]);
+		}
+		break;
+
+	case PCD_DUP:
+		Build.Emit(OP_MOVE, Slot(d), Slot(d - 1));
+		break;
+
+	case PCD_SWAP:
+		Build.Emit(OP_MOVE, TempReg, Slot(d - 1));
+		Build.Emit(OP_MOVE, Slot(d - 1), Slot(d - 2));
+		Build.Emit(OP_MOVE, Slot(d - 2), TempReg);
+		break;
+
+	case PCD_ADD:			Build.Emit(OP_ADD_RR, Slot(d - 2), Slot(d - 2), Slot(d - 1)); break;
+	case PCD_SUBTRACT:		Build.Emit(OP_SUB_RR, Slot(d - 2), Slot(d - 2), Slot(d - 1)); break;
+	case PCD_MULTIPLY:		Build.Emit(OP_MUL_RR, Slot(d - 2), Slot(d - 2), Slot(d - 1)); break;
+	case PCD_ANDBITWISE:	Build.Emit(OP_AND_RR, Slot(d - 2), Slot(d - 2), Slot(d - 1)); break;
+	case PCD_ORBITWISE:		Build.Emit(OP_OR_RR, Slot(d - 2), Slot(d - 2), Slot(d - 1)); break;
+	case PCD_EORBITWISE:	Build.Emit(OP_XOR_RR, Slot(d - 2), Slot(d - 2), Slot(d - 1)); break;
+	case PCD_LSHIFT:		Build.Emit(OP_SLL_RR, Slot(d - 2), Slot(d - 2), Slot(d - 1)); break;
+	case PCD_RSHIFT:		Build.Emit(OP_SRA_RR, Slot(d - 2), Slot(d - 2), Slot(d - 1)); break;
+
+	case PCD_DIVIDE:
+		EmitZeroCheck(Slot(d - 1), DivJumps);
+		Build.Emit(OP_DIV_RR, Slot(d - 2), Slot(d - 2), Slot(d - 1));
+		break;
+
+	case PCD_MODULUS:
+		EmitZeroCheck(Slot(d - 1), ModJumps);
+		Build.Emit(OP_MOD_RR, Slot(d - 2), Slot(d - 2), Slot(d - 1));
+		break;
+
+	case PCD_EQ:	EmitBool(OP_EQ_R, 1, Slot(d - 2), Slot(d - 1), Slot(d - 2)); break;
+	case PCD_NE:	EmitBool(OP_EQ_R, 0, Slot(d - 2), Slot(d - 1), Slot(d - 2)); break;
+	case PCD_LT:	EmitBool(OP_LT_RR, 1, Slot(d - 2), Slot(d - 1), Slot(d - 2)); break;
+	case PCD_GT:	EmitBool(OP_LT_RR, 1, Slot(d - 1), Slot(d - 2), Slot(d - 2)); break;
+	case PCD_LE:	EmitBool(OP_LE_RR, 1, Slot(d - 2), Slot(d - 1), Slot(d - 2)); break;
+	case PCD_GE:	EmitBool(OP_LE_RR, 1, Slot(d - 1), Slot(d - 2), Slot(d - 2)); break;
+	case PCD_NEGATELOGICAL:	EmitBool(OP_EQ_K, 1, Slot(d - 1), Konst(0), Slot(d - 1)); break;
+
+	case PCD_ANDLOGICAL:
+	case PCD_ORLOGICAL:
+	{
+		// Both operands have already been evaluated, so this only needs to look at them.
+		int check = insn.PCode == PCD_ORLOGICAL;
+		Build.Emit(OP_LI, TempReg, check);
+		Build.Emit(OP_EQ_K, !check, Slot(d - 2), Konst(0));
+		auto skip1 = Build.Emit(OP_JMP, 0);
+		Build.Emit(OP_EQ_K, !check, Slot(d - 1), Konst(0));
+		auto skip2 = Build.Emit(OP_JMP, 0);
+		Build.Emit(OP_LI, TempReg, !check);
+		Build.BackpatchToHere(skip1);
+		Build.BackpatchToHere(skip2);
+		Build.Emit(OP_MOVE, Slot(d - 2), TempReg);
+		break;
+	}
+
+	case PCD_NEGATEBINARY:
+		Build.Emit(OP_NOT, Slot(d - 1), Slot(d - 1));
+		break;
+
+	case PCD_UNARYMINUS:
+		Build.Emit(OP_NEG, Slot(d - 1), Slot(d - 1));
+		break;
+
+	case PCD_GOTO:
+		EmitJump(insn.Arg);
+		break;
+
+	case PCD_RESTART:
+		EmitJump(Address);
+		break;
+
+	case PCD_IFGOTO:
+	case PCD_IFNOTGOTO:
+		Build.Emit(OP_EQ_K, insn.PCode == PCD_IFNOTGOTO, Slot(d - 1), Konst(0));
+		EmitJump(insn.Arg);
+		break;
+
+	case PCD_CASEGOTO:
+		Build.Emit(OP_EQ_K, 1, Slot(d - 1), Konst(insn.Arg));
+		EmitJump(insn.Arg2);
+		break;
+
+	case PCD_CASEGOTOSORTED:
+		for (unsigned i = 0; i < insn.NumOperands; i += 2)
+		{
+			Build.Emit(OP_EQ_K, 1, Slot(d - 1), Konst(Operands[insn.FirstOperand + i]));
+			EmitJump(Operands[insn.FirstOperand + i + 1]);
+		}
+		break;
+
+	case PCD_CALL:
+	case PCD_CALLDISCARD:
+		EmitCall(insn);
+		break;
+
+	case PCD_CALLFUNC:
+		EmitCallFunc(insn);
+		break;
+
+	case PCD_RETURNVOID:
+		Build.Emit(OP_RETI, 0, 0);
+		Build.Emit(OP_RETI, 1, ACSVM_Ok);
+		Build.Emit(OP_RET, 2 | RET_FINAL, REGT_INT, CountReg);
+		break;
+
+	case PCD_RETURNVAL:
+		Build.Emit(OP_RET, 0, REGT_INT, Slot(d - 1));
+		Build.Emit(OP_RETI, 1, ACSVM_Ok);
+		Build.Emit(OP_RET, 2 | RET_FINAL, REGT_INT, CountReg);
+		break;
+
+	default:
+		if (FindACSVarOp(insn.PCode, op, scope))
+		{
+			EmitVarOp(op, scope, insn.Arg, d);
+		}
+		break;
+	}
+}
+
+//==========================================================================
+//
+// FACSTranslator :: EmitEntries
+//
+// The dispatch at the start of a body jumps here. Each entry checks the
+// stack depth and loads the stack and the locals.
+//
+//==========================================================================
+
+void FACSTranslator::EmitEntries()
+{
+	for (auto &jump : EntryJumps)
+	{
+		auto &insn = Insns[jump.second];
+
+		Build.BackpatchToHere(jump.first);
+		Build.Emit(OP_EQ_K, 0, DepthReg, Konst(insn.Depth));
+		NoEntryJumps.Push(Build.Emit(OP_JMP, 0));
+		for (int i = 0; i < insn.Depth; i++)
+		{
+			Build.Emit(OP_LW, Slot(i), StackReg, Konst(i * (int)sizeof(int32_t)));
+		}
+		EmitLocals(OP_LW);
+		EmitJump(insn.Ofs);
+	}
+	Build.BackpatchListToHere(NoEntryJumps);
+	EmitExit(ACSVM_NoEntry);
+}
+
+//==========================================================================
+//
+// FACSTranslator :: Translate
+//
+// Returns nullptr if the code has to stay in the interpreter.
+//
+//==========================================================================
+
+VMScriptFunction *FACSTranslator::Translate()
+{
+	if (NumArgs > ACSVM_MaxArgs || !Analyse())
+	{
+		return nullptr;
+	}
+	if (Kind == AVK_FunctionBody && MaxDepth > ACSVM_MaxDepth)
+	{
+		return nullptr;
+	}
+
+	// d0 is the runaway counter, followed by a body's d1 to d3, the locals
+	// with the arguments first, a scratch register and the stack.
+	CountReg = 0;
+	LocalBase = IsBody() ? ResumeReg + 1 : 1;
+	TempReg = LocalReg(NumLocals);
+	StackBase = TempReg + 1;
+	AddrReg = IsBody() ? StackReg + 1 : 1;
+	if (Slot(MaxDepth) > ACSVM_MaxRegs)
+	{
+		return nullptr;
+	}
+	for (int i = 0; i < Slot(MaxDepth); i++)
+	{
+		Build.Registers[REGT_INT].Get(1);
+	}
+	Build.Registers[REGT_POINTER].Get(AddrReg + 1);
+
+	if (IsBody())
+	{
+		for (unsigned i = 0; i < Insns.Size(); i++)
+		{
+			if (Insns[i].Entry)
+			{
+				Build.Emit(OP_EQ_K, 1, OfsReg, Konst(Insns[i].Ofs));
+				EntryJumps.Push(std::make_pair(Build.Emit(OP_JMP, 0), i));
+			}
+		}
+		EmitExit(ACSVM_NoEntry);
+	}
+	else
+	{
+		for (int i = NumArgs; i < NumLocals; i++)
+		{
+			Build.Emit(OP_LI, LocalReg(i), 0);
+		}
+	}
+	for (auto &insn : Insns)
+	{
+		insn.VMAddr = Build.GetAddress();
+		if (insn.Leader)
+		{
+			if (insn.BlockLength <= 127) Build.Emit(OP_ADDI, CountReg, CountReg, insn.BlockLength);
+			else Build.Emit(OP_ADD_RK, CountReg, CountReg, Konst(insn.BlockLength));
+
+			if (insn.LoopHead)
+			{
+				Build.Emit(OP_LE_RK, 0, CountReg, Konst(ACSVM_RunawayLimit));
+				RunawayJumps.Push(Build.Emit(OP_JMP, 0));
+			}
+		}
+		EmitInsn(insn);
+	}
+
+	std::pair<TArray<size_t> *, int> exits[] = { { &RunawayJumps, ACSVM_Runaway }, { &DivJumps, ACSVM_DivideBy0 }, { &ModJumps, ACSVM_ModulusBy0 } };
+	for (auto &exit : exits)
+	{
+		if (exit.first->Size() > 0)
+		{
+			Build.BackpatchListToHere(*exit.first);
+			EmitExit(exit.second);
+		}
+	}
+	if (StatusJumps.Size() > 0)
+	{
+		Build.BackpatchListToHere(StatusJumps);
+		EmitExit(0, TempReg);
+	}
+	if (IsBody())
+	{
+		EmitEntries();
+		if (CalloutJumps.Size() > 0)
+		{
+			Build.BackpatchListToHere(CalloutJumps);
+			EmitLocals(OP_SW);
+			Build.Emit(OP_RETI, 0, ACSVM_Interpret);
+			Build.Emit(OP_RET, 1, REGT_INT, OfsReg);
+			Build.Emit(OP_RET, 2, REGT_INT, DepthReg);
+			Build.Emit(OP_RET, 3, REGT_INT, ResumeReg);
+			Build.Emit(OP_RET, 4 | RET_FINAL, REGT_INT, CountReg);
+		}
+	}
+	for (auto &jump : Jumps)
+	{
+		Build.Backpatch(jump.first, Insns[InsnMap[jump.second]].VMAddr);
+	}
+
+	TArray<PType *> rets, args;
+	uint8_t *regts;
+	int numargs;
+	if (IsBody())
+	{
+		// status, offset, depth, resume offset and runaway counter
+		for (int i = 0; i < 5; i++) rets.Push(TypeSInt32);
+		// map variables, frame, locals, stack, runaway counter, entry offset and depth
+		numargs = 7;
+		regts = (uint8_t *)ClassDataAllocator.Alloc(numargs);
+		for (int i = 0; i < numargs; i++)
+		{
+			args.Push(i < 4 ? (PType *)TypeVoidPtr : (PType *)TypeSInt32);
+			regts[i] = i < 4 ? REGT_POINTER : REGT_INT;
+		}
+	}
+	else
+	{
+		rets.Push(TypeSInt32);	// result
+		rets.Push(TypeSInt32);	// status
+		rets.Push(TypeSInt32);	// runaway counter
+		numargs = NumArgs + 2;
+		regts = (uint8_t *)ClassDataAllocator.Alloc(numargs);
+		args.Push(TypeVoidPtr);
+		regts[0] = REGT_POINTER;
+		for (int i = 1; i < numargs; i++)
+		{
+			args.Push(TypeSInt32);
+			regts[i] = REGT_INT;
+		}
+	}
+
+	VMScriptFunction *sfunc = new VMScriptFunction;
+	sfunc->Proto = NewPrototype(rets, args);
+	sfunc->RegTypes = regts;
+	Build.MakeFunction(sfunc);
+	sfunc->NumArgs = numargs;
+	sfunc->QualifiedName = sfunc->PrintableName = ClassDataAllocator.Strdup(FStringf("ACS.%s.%u%s", Module->GetModuleName(), Address,
+		Kind == AVK_ScriptBody ? ".script" : Kind == AVK_FunctionBody ? ".body" : "").GetChars());
+	return sfunc;
+}
+
+//==========================================================================
+//
+// FACSVMFrame :: CallFunction
+//
+// PCD_CALLFUNC for a body, whose stack has already been stored.
+//
+//==========================================================================
+
+int FACSVMFrame::CallFunction(int argcount, int funcindex, int depth, bool &running)
+{
+	int mincount = 0;
+
+	// The string collector only looks at the stack up to sp.
+	Stack->sp = Base + depth;
+	int result = Script->CallFunction(argcount, funcindex, &Stack->buffer[Base + depth - argcount], mincount);
+	if (mincount != 0)
+	{
+		Printf("Called ACS function index %d with too few args: %d (need %d)\n", funcindex, argcount, mincount);
+	}
+	running = Script->GetState() == DLevelScript::SCRIPT_Running;
+	return result;
+}
+
+static int ACSVM_CallFunction(VM_ARGS)
+{
+	auto frame = (FACSVMFrame *)param[0].a;
+	bool running;
+	int result = frame->CallFunction(param[1].i, param[2].i, param[3].i, running);
+
+	if (numret > 0) ret[0].SetInt(result);
+	if (numret > 1) ret[1].SetInt(running);
+	return min(numret, 2);
+}
+
+//==========================================================================
+//
+// FBehavior :: TranslateCode
+//
+// Translations are shared by all modules with the same code, so that
+// reloading a map does not translate its code again. They are dropped
+// when the VM goes away, which clears ACSVM_CallFunc.
+//
+//==========================================================================
+
+static TMap<FString, VMScriptFunction *> ACSVM_Functions;
+
+VMScriptFunction *FBehavior::TranslateCode(uint32_t address, int numargs, int numlocals, int kind)
+{
+	if (DataHash.IsEmpty())
+	{
+		MD5Context md5;
+		uint8_t digest[16];
+		md5.Update(Data, DataSize);
+		md5.Final(digest);
+		for (auto b : digest) DataHash.AppendFormat("%02x", b);
+	}
+	if (ACSVM_CallFunc == nullptr)
+	{
+		ACSVM_Functions.Clear();
+
+		TArray<PType *> rets, args;
+		rets.Push(TypeSInt32);	// result
+		rets.Push(TypeSInt32);	// still running
+		args.Push(TypeVoidPtr);
+		for (int i = 0; i < 3; i++) args.Push(TypeSInt32);
+		auto native = new VMNativeFunction(ACSVM_CallFunction, "ACSVM_CallFunction");
+		native->Proto = NewPrototype(rets, args);
+		native->QualifiedName = native->PrintableName = "ACS.CallFunction [Native]";
+		ACSVM_CallFunc = native;
+		PClass::FunctionPtrList.Push(&ACSVM_CallFunc);
+	}
+
+	FStringf key("%s:%u:%d", DataHash.GetChars(), address, kind);
+	auto cached = ACSVM_Functions.CheckKey(key);
+	if (cached != nullptr)
+	{
+		return *cached;
+	}
+	FACSTranslator translator(this, address, numargs, numlocals, (EACSVMKind)kind);
+	return ACSVM_Functions[key] = translator.Translate();
+}
+
+//==========================================================================
+//
+// FBehavior :: GetCompiledFunction / GetCompiledBody
+//
+//==========================================================================
+
+VMScriptFunction *FBehavior::GetCompiledFunction(ScriptFunction *func)
+{
+	if (!func->Translated)
+	{
+		func->Translated = true;
+		func->Compiled = TranslateCode(func->Address, func->ArgCount, func->ArgCount + func->LocalCount, AVK_Function);
+	}
+	return func->Compiled;
+}
+
+VMScriptFunction *FBehavior::GetCompiledBody(ScriptFunction *func)
+{
+	if (!func->BodyTranslated)
+	{
+		func->BodyTranslated = true;
+		func->CompiledBody = TranslateCode(func->Address, func->ArgCount, func->ArgCount + func->LocalCount, AVK_FunctionBody);
+	}
+	return func->CompiledBody;
+}
+
+VMScriptFunction *FBehavior::GetCompiledBody(ScriptPtr *script)
+{
+	if (!script->Translated)
+	{
+		script->Translated = true;
+		script->Compiled = TranslateCode(script->Address, script->ArgCount, script->VarCount, AVK_ScriptBody);
+	}
+	return script->Compiled;
+}
+
+//==========================================================================
+//
+// ACS_CallCompiled
+//
+// Runs a translated function on arguments taken from the ACS stack and
+// returns its ACSVM_* status.
+//
+//==========================================================================
+
+static int ACS_CallCompiled(VMScriptFunction *compiled, FBehavior *module, const int32_t *args, int argcount, unsigned int &runaway, int &result)
+{
+	VMValue params[ACSVM_MaxArgs + 2];
+	int status = ACSVM_Ok, count = runaway;
+
+	params[0] = VMValue((void *)module->MapVars.Pointer());
+	params[1] = count;
+	for (int i = 0; i < argcount; i++)
+	{
+		params[i + 2] = args[i];
+	}
+	VMReturn rets[] = { &result, &status, &count };
+	VMCall(compiled, params, argcount + 2, rets, 3);
+	runaway = count;
+	return status;
+}
+
+//==========================================================================
+//
+// DLevelScript :: RunCompiled
+//
+// Enters the body of the script or function that is running at pc. When
+// it hands back, the interpreter continues at the returned offset and
+// comes back here once it reaches resume.
+//
+//==========================================================================
+
+void DLevelScript::RunCompiled(FACSStack &stack, int *&pc, int *&resume, ScriptFunction *function, const int32_t *locals, unsigned int &runaway)
+{
+	VMScriptFunction *compiled;
+	int32_t *localvars;
+	int base = 0;
+
+	if (function == nullptr)
+	{
+		ScriptPtr *ptr = activeBehavior->GetScriptPtr(InModuleScriptNumber);
+		compiled = ptr != nullptr ? activeBehavior->GetCompiledBody(ptr) : nullptr;
+		localvars = Localvars.Data();
+	}
+	else
+	{
+		// The function's locals are on the stack, followed by its return information.
+		int localbase = int(locals - &stack.buffer[0]);
+		compiled = activeBehavior->GetCompiledBody(function);
+		localvars = &stack.buffer[localbase];
+		base = localbase + function->ArgCount + function->LocalCount + int((sizeof(CallReturn) + sizeof(int) - 1) / sizeof(int));
+	}
+	if (compiled == nullptr || stack.sp < base)
+	{
+		return;
+	}
+
+	FACSVMFrame frame = { this, &stack, base };
+	int status = ACSVM_NoEntry, ofs = 0, depth = 0, next = -1, count = runaway;
+	VMValue params[] =
+	{
+		(void *)activeBehavior->MapVars.Pointer(), (void *)&frame, (void *)localvars, (void *)&stack.buffer[base],
+		count, (int)activeBehavior->PC2Ofs(pc), stack.sp - base
+	};
+	VMReturn rets[] = { &status, &ofs, &depth, &next, &count };
+	VMCall(compiled, params, countof(params), rets, countof(rets));
+	runaway = count;
+
+	switch (status)
+	{
+	case ACSVM_Interpret:
+		pc = activeBehavior->Ofs2PC(ofs);
+		stack.sp = base + depth;
+		resume = next >= 0 ? activeBehavior->Ofs2PC(next) : nullptr;
+		break;
+
+	case ACSVM_Runaway:
+		Printf ("Runaway %s terminated\n", ScriptPresentation(script).GetChars());
+		state = SCRIPT_PleaseRemove;
+		break;
+
+	case ACSVM_DivideBy0:
+		state = SCRIPT_DivideBy0;
+		break;
+
+	case ACSVM_ModulusBy0:
+		state = SCRIPT_ModulusBy0;
+		break;
+	}
+}
+
+static bool CharArrayParms(int &capacity, int &offset, int &a, FACSStackMemory& Stack, int &sp, bool ranged)
+{
+	if (ranged)
+	{
+		capacity = STACK(1);
+		offset = STACK(2);
+		if (capacity < 1 || offset < 0)
+		{
+			sp -= 4;
+			return false;
+		}
+		sp -= 2;
+	}
+	else
+	{
+		capacity = INT_MAX;
+		offset = 0;
+	}
+	a = STACK(1);
+	offset += STACK(2);
+	sp -= 2;
+	return true;
+}
+
+PClass *DLevelScript::GetClassForIndex(int index) const
+{
+	return PClass::FindActor(Level->Behaviors.LookupString(index));
+}
+
+int DLevelScript::RunScript()
+{
+	DACSThinker *controller = Level->ACSThinker;
+	ACSLocalVariables locals(Localvars);
+	ACSLocalArrays noarrays;
+	ACSLocalArrays *localarrays = &noarrays;
+	ScriptFunction *activeFunction = NULL;
+	FRemapTable *translation = 0;
+	int resultValue = 1;
+	int transi = -1;
+
+	if (InModuleScriptNumber >= 0)
+	{
+		ScriptPtr *ptr = activeBehavior->GetScriptPtr(InModuleScriptNumber);
+		assert(ptr != NULL);
+		if (ptr != NULL)
+		{
+			localarrays = &ptr->LocalArrays;
+		}
+	}
+
+	// Hexen truncates all special arguments to bytes (only when using an old MAPINFO and old ACS format
+	const int specialargmask = ((Level->flags2 & LEVEL2_HEXENHACK) && activeBehavior->GetFormat() == ACS_Old) ? 255 : ~0;
+
+	switch (state)
+	{
+	case SCRIPT_Delayed:
+		// Decrement the delay counter and enter state running
+		// if it hits 0
+		if (--statedata == 0)
+			state = SCRIPT_Running;
+		break;
+
+	case SCRIPT_TagWait:
+		// Wait for tagged sector(s) to go inactive, then enter
+		// state running
+	{
+		int secnum;
+		auto it = Level->GetSectorTagIterator(statedata);
+		while ((secnum = it.Next()) >= 0)
+		{
+			if (Level->sectors[secnum].floordata || Level->sectors[secnum].ceilingdata)
+				return resultValue;
+		}
+
+		// If we got here, none of the tagged sectors were busy
+		state = SCRIPT_Running;
+	}
+	break;
+
+	case SCRIPT_PolyWait:
+		// Wait for polyobj(s) to stop moving, then enter state running
+		if (!PO_Busy (Level, statedata))
+		{
+			state = SCRIPT_Running;
+		}
+		break;
+
+	case SCRIPT_ScriptWaitPre:
+		// Wait for a script to start running, then enter state scriptwait
+		if (controller->RunningScripts.CheckKey(statedata) != NULL)
+			state = SCRIPT_ScriptWait;
+		break;
+
+	case SCRIPT_ScriptWait:
+		// Wait for a script to stop running, then enter state running
+		if (controller->RunningScripts.CheckKey(statedata) != NULL)
+			return resultValue;
+
+		state = SCRIPT_Running;
+		PutFirst ();
+		break;
+
+	default:
+		break;
+	}
+
+	FACSStack stackobj;
+	FACSStackMemory& Stack = stackobj.buffer;
+	int &sp = stackobj.sp;
+
+	int *pc = this->pc;
+	ACSFormat fmt = activeBehavior->GetFormat();
+	FACSEncoding enc(fmt);
+	FBehavior* const savedActiveBehavior = activeBehavior;
+	unsigned int runaway = 0;	// used to prevent infinite loops
+	cycle_t runtime;
+	int pcd;
+	FString work;
+	const char *lookup;
+	int optstart = -1;
+	int temp;
+	int *jitresume = acs_jit ? pc : nullptr;	// where to go back into the translated code
+
+#if ACS_COMPGOTO
+	static const void *const pcodes[] =
+	{
+#define xx(n) &&op_##n,
+#include "p_acspcodes.h"
+	};
+	static_assert(countof(pcodes) == PCODE_COMMAND_COUNT, "p-code table size mismatch");
+#endif
+
+	runtime.ResetAndClock();
+	while (state == SCRIPT_Running)
+	{
+		if (pc == jitresume)
+		{
+			jitresume = nullptr;
+			RunCompiled(stackobj, pc, jitresume, activeFunction, locals.GetPointer(), runaway);
+			continue;
+		}
+		if (++runaway > 2000000)
+		{
+			Printf ("Runaway %s terminated\n", ScriptPresentation(script).GetChars());
+			state = SCRIPT_PleaseRemove;
+			break;
+		}
+
+		pcd = FetchPCode(pc, enc);
+
+		switch (pcd)
+		{
+		// Defined by acc, but not implemented
+		PCASE(PCD_PLAYERBLUESKULL): PCASE(PCD_PLAYERREDSKULL): PCASE(PCD_PLAYERYELLOWSKULL):
+		PCASE(PCD_PLAYERMASTERSKULL): PCASE(PCD_PLAYERBLUECARD): PCASE(PCD_PLAYERREDCARD):
+		PCASE(PCD_PLAYERYELLOWCARD): PCASE(PCD_PLAYERMASTERCARD): PCASE(PCD_PLAYERBLACKSKULL):
+		PCASE(PCD_PLAYERSILVERSKULL): PCASE(PCD_PLAYERGOLDSKULL): PCASE(PCD_PLAYERBLACKCARD):
+		PCASE(PCD_PLAYERSILVERCARD): PCASE(PCD_PLAYEREXPERT): PCASE(PCD_BLUETEAMCOUNT):
+		PCASE(PCD_REDTEAMCOUNT): PCASE(PCD_BLUETEAMSCORE): PCASE(PCD_REDTEAMSCORE):
+		PCASE(PCD_ISONEFLAGCTF): PCASE(PCD_LSPEC6): PCASE(PCD_LSPEC6DIRECT):
+		PCASE(PCD_SETSTYLE): PCASE(PCD_SETSTYLEDIRECT): PCASE(PCD_WRITETOINI):
+		PCASE(PCD_GETFROMINI): PCASE(PCD_GRABINPUT): PCASE(PCD_SETMOUSEPOINTER):
+		PCASE(PCD_MOVEMOUSEPOINTER):
+#if ACS_COMPGOTO
+		op_default:
+#endif
+		default:
+			Printf ("Unknown P-Code %d in %s\n", pcd, ScriptPresentation(script).GetChars());
+			activeBehavior = savedActiveBehavior;
+			// fall through
+		PCASE(PCD_TERMINATE):
+			DPrintf (DMSG_NOTIFY, "%s finished\n", ScriptPresentation(script).GetChars());
+			state = SCRIPT_PleaseRemove;
+			NEXTPCODE;
+
+		PCASE(PCD_NOP):
+			NEXTPCODE;
+
+		PCASE(PCD_SUSPEND):
+			state = SCRIPT_Suspended;
+			NEXTPCODE;
+
+		PCASE(PCD_TAGSTRING):
+			//Stack[sp-1] |= activeBehavior->GetLibraryID();
+			Stack[sp-1] = GlobalACSStrings.AddString(activeBehavior->LookupString(Stack[sp-1]));
+			NEXTPCODE;
+
+		PCASE(PCD_PUSHNUMBER):
+			PushToStack (uallong(pc[0]));
+			pc++;
+			NEXTPCODE;
+
+		PCASE(PCD_PUSHBYTE):
+			PushToStack (*(uint8_t *)pc);
+			pc = (int *)((uint8_t *)pc + 1);
+			NEXTPCODE;
+
+		PCASE(PCD_PUSH2BYTES):
+			Stack[sp] = ((uint8_t *)pc)[0];
+			Stack[sp+1] = ((uint8_t *)pc)[1];
+			sp += 2;
+			pc = (int *)((uint8_t *)pc + 2);
+			NEXTPCODE;
+
+		PCASE(PCD_PUSH3BYTES):
+			Stack[sp] = ((uint8_t *)pc)[0];
+			Stack[sp+1] = ((uint8_t *)pc)[1];
+			Stack[sp+2] = ((uint8_t *)pc)[2];
+			sp += 3;
+			pc = (int *)((uint8_t *)pc + 3);
+			NEXTPCODE;
+
+		PCASE(PCD_PUSH4BYTES):
+			Stack[sp] = ((uint8_t *)pc)[0];
 			Stack[sp+1] = ((uint8_t *)pc)[1];
 			Stack[sp+2] = ((uint8_t *)pc)[2];
 			Stack[sp+3] = ((uint8_t *)pc)[3];
 			sp += 4;
 			pc = (int *)((uint8_t *)pc + 4);
-			break;
+			NEXTPCODE;
 
-		case PCD_PUSH5BYTES:
+		PCASE(PCD_PUSH5BYTES):
 			Stack[sp] = ((uint8_t *)pc)[0];
 			Stack[sp+1] = ((uint8_t *)pc)[1];
 			Stack[sp+2] = ((uint8_t *)pc)[2];
@@ -7076,57 +8318,57 @@ int DLevelScript::RunScript()
 			Stack[sp+4] = ((uint8_t *)pc)[4];
 			sp += 5;
 			pc = (int *)((uint8_t *)pc + 5);
-			break;
+			NEXTPCODE;
 
-		case PCD_PUSHBYTES:
+		PCASE(PCD_PUSHBYTES):
 			temp = *(uint8_t *)pc;
 			pc = (int *)((uint8_t *)pc + temp + 1);
 			for (temp = -temp; temp; temp++)
 			{
 				PushToStack (*((uint8_t *)pc + temp));
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_DUP:
+		PCASE(PCD_DUP):
 			Stack[sp] = Stack[sp-1];
 			sp++;
-			break;
+			NEXTPCODE;
 
-		case PCD_SWAP:
+		PCASE(PCD_SWAP):
 			std::swap(Stack[sp-2], Stack[sp-1]);
-			break;
+			NEXTPCODE;
 
-		case PCD_LSPEC1:
+		PCASE(PCD_LSPEC1):
 			P_ExecuteSpecial(Level, NEXTBYTE, activationline, activator, backSide,
 									STACK(1) & specialargmask, 0, 0, 0, 0);
 			sp -= 1;
-			break;
+			NEXTPCODE;
 
-		case PCD_LSPEC2:
+		PCASE(PCD_LSPEC2):
 			P_ExecuteSpecial(Level, NEXTBYTE, activationline, activator, backSide,
 									STACK(2) & specialargmask,
 									STACK(1) & specialargmask, 0, 0, 0);
 			sp -= 2;
-			break;
+			NEXTPCODE;
 
-		case PCD_LSPEC3:
+		PCASE(PCD_LSPEC3):
 			P_ExecuteSpecial(Level, NEXTBYTE, activationline, activator, backSide,
 									STACK(3) & specialargmask,
 									STACK(2) & specialargmask,
 									STACK(1) & specialargmask, 0, 0);
 			sp -= 3;
-			break;
+			NEXTPCODE;
 
-		case PCD_LSPEC4:
+		PCASE(PCD_LSPEC4):
 			P_ExecuteSpecial(Level, NEXTBYTE, activationline, activator, backSide,
 									STACK(4) & specialargmask,
 									STACK(3) & specialargmask,
 									STACK(2) & specialargmask,
 									STACK(1) & specialargmask, 0);
 			sp -= 4;
-			break;
+			NEXTPCODE;
 
-		case PCD_LSPEC5:
+		PCASE(PCD_LSPEC5):
 			P_ExecuteSpecial(Level, NEXTBYTE, activationline, activator, backSide,
 									STACK(5) & specialargmask,
 									STACK(4) & specialargmask,
@@ -7134,9 +8376,9 @@ int DLevelScript::RunScript()
 									STACK(2) & specialargmask,
 									STACK(1) & specialargmask);
 			sp -= 5;
-			break;
+			NEXTPCODE;
 
-		case PCD_LSPEC5RESULT:
+		PCASE(PCD_LSPEC5RESULT):
 			STACK(5) = P_ExecuteSpecial(Level, NEXTBYTE, activationline, activator, backSide,
 									STACK(5) & specialargmask,
 									STACK(4) & specialargmask,
@@ -7144,9 +8386,9 @@ int DLevelScript::RunScript()
 									STACK(2) & specialargmask,
 									STACK(1) & specialargmask);
 			sp -= 4;
-			break;
+			NEXTPCODE;
 
-		case PCD_LSPEC5EX:
+		PCASE(PCD_LSPEC5EX):
 			P_ExecuteSpecial(Level, NEXTWORD, activationline, activator, backSide,
 									STACK(5) & specialargmask,
 									STACK(4) & specialargmask,
@@ -7154,9 +8396,9 @@ int DLevelScript::RunScript()
 									STACK(2) & specialargmask,
 									STACK(1) & specialargmask);
 			sp -= 5;
-			break;
+			NEXTPCODE;
 
-		case PCD_LSPEC5EXRESULT:
+		PCASE(PCD_LSPEC5EXRESULT):
 			STACK(5) = P_ExecuteSpecial(Level, NEXTWORD, activationline, activator, backSide,
 									STACK(5) & specialargmask,
 									STACK(4) & specialargmask,
@@ -7164,33 +8406,33 @@ int DLevelScript::RunScript()
 									STACK(2) & specialargmask,
 									STACK(1) & specialargmask);
 			sp -= 4;
-			break;
+			NEXTPCODE;
 
-		case PCD_LSPEC1DIRECT:
+		PCASE(PCD_LSPEC1DIRECT):
 			temp = NEXTBYTE;
 			P_ExecuteSpecial(Level, temp, activationline, activator, backSide,
 								uallong(pc[0]) & specialargmask ,0, 0, 0, 0);
 			pc += 1;
-			break;
+			NEXTPCODE;
 
-		case PCD_LSPEC2DIRECT:
+		PCASE(PCD_LSPEC2DIRECT):
 			temp = NEXTBYTE;
 			P_ExecuteSpecial(Level, temp, activationline, activator, backSide,
 								uallong(pc[0]) & specialargmask,
 								uallong(pc[1]) & specialargmask, 0, 0, 0);
 			pc += 2;
-			break;
+			NEXTPCODE;
 
-		case PCD_LSPEC3DIRECT:
+		PCASE(PCD_LSPEC3DIRECT):
 			temp = NEXTBYTE;
 			P_ExecuteSpecial(Level, temp, activationline, activator, backSide,
 								uallong(pc[0]) & specialargmask,
 								uallong(pc[1]) & specialargmask,
 								uallong(pc[2]) & specialargmask, 0, 0);
 			pc += 3;
-			break;
+			NEXTPCODE;
 
-		case PCD_LSPEC4DIRECT:
+		PCASE(PCD_LSPEC4DIRECT):
 			temp = NEXTBYTE;
 			P_ExecuteSpecial(Level, temp, activationline, activator, backSide,
 								uallong(pc[0]) & specialargmask,
@@ -7198,9 +8440,9 @@ int DLevelScript::RunScript()
 								uallong(pc[2]) & specialargmask,
 								uallong(pc[3]) & specialargmask, 0);
 			pc += 4;
-			break;
+			NEXTPCODE;
 
-		case PCD_LSPEC5DIRECT:
+		PCASE(PCD_LSPEC5DIRECT):
 			temp = NEXTBYTE;
 			P_ExecuteSpecial(Level, temp, activationline, activator, backSide,
 								uallong(pc[0]) & specialargmask,
@@ -7209,42 +8451,42 @@ int DLevelScript::RunScript()
 								uallong(pc[3]) & specialargmask,
 								uallong(pc[4]) & specialargmask);
 			pc += 5;
-			break;
+			NEXTPCODE;
 
 		// Parameters for PCD_LSPEC?DIRECTB are by definition bytes so never need and-ing.
-		case PCD_LSPEC1DIRECTB:
+		PCASE(PCD_LSPEC1DIRECTB):
 			P_ExecuteSpecial(Level, ((uint8_t *)pc)[0], activationline, activator, backSide,
 				((uint8_t *)pc)[1], 0, 0, 0, 0);
 			pc = (int *)((uint8_t *)pc + 2);
-			break;
+			NEXTPCODE;
 
-		case PCD_LSPEC2DIRECTB:
+		PCASE(PCD_LSPEC2DIRECTB):
 			P_ExecuteSpecial(Level, ((uint8_t *)pc)[0], activationline, activator, backSide,
 				((uint8_t *)pc)[1], ((uint8_t *)pc)[2], 0, 0, 0);
 			pc = (int *)((uint8_t *)pc + 3);
-			break;
+			NEXTPCODE;
 
-		case PCD_LSPEC3DIRECTB:
+		PCASE(PCD_LSPEC3DIRECTB):
 			P_ExecuteSpecial(Level, ((uint8_t *)pc)[0], activationline, activator, backSide,
 				((uint8_t *)pc)[1], ((uint8_t *)pc)[2], ((uint8_t *)pc)[3], 0, 0);
 			pc = (int *)((uint8_t *)pc + 4);
-			break;
+			NEXTPCODE;
 
-		case PCD_LSPEC4DIRECTB:
+		PCASE(PCD_LSPEC4DIRECTB):
 			P_ExecuteSpecial(Level, ((uint8_t *)pc)[0], activationline, activator, backSide,
 				((uint8_t *)pc)[1], ((uint8_t *)pc)[2], ((uint8_t *)pc)[3],
 				((uint8_t *)pc)[4], 0);
 			pc = (int *)((uint8_t *)pc + 5);
-			break;
+			NEXTPCODE;
 
-		case PCD_LSPEC5DIRECTB:
+		PCASE(PCD_LSPEC5DIRECTB):
 			P_ExecuteSpecial(Level, ((uint8_t *)pc)[0], activationline, activator, backSide,
 				((uint8_t *)pc)[1], ((uint8_t *)pc)[2], ((uint8_t *)pc)[3],
 				((uint8_t *)pc)[4], ((uint8_t *)pc)[5]);
 			pc = (int *)((uint8_t *)pc + 6);
-			break;
+			NEXTPCODE;
 
-		case PCD_CALLFUNC:
+		PCASE(PCD_CALLFUNC):
 			{
 				int argCount = NEXTBYTE;
 				int funcIndex = NEXTSHORT;
@@ -7258,18 +8500,18 @@ int DLevelScript::RunScript()
 				sp -= argCount-1;
 				STACK(1) = retval;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_PUSHFUNCTION:
+		PCASE(PCD_PUSHFUNCTION):
 		{
 			int funcnum = NEXTBYTE;
 			// Not technically a string, but since we use the same tagging mechanism
 			PushToStack(TAGSTR(funcnum));
 			break;
 		}
-		case PCD_CALL:
-		case PCD_CALLDISCARD:
-		case PCD_CALLSTACK:
+		PCASE(PCD_CALL):
+		PCASE(PCD_CALLDISCARD):
+		PCASE(PCD_CALLSTACK):
 			{
 				int funcnum;
 				int i;
@@ -7297,6 +8539,41 @@ int DLevelScript::RunScript()
 					state = SCRIPT_PleaseRemove;
 					break;
 				}
+				if (acs_jit)
+				{
+					VMScriptFunction *compiled = module->GetCompiledFunction(func);
+					if (compiled != nullptr)
+					{
+						cycle_t calltime;
+						unsigned int entry = runaway;
+						int result = 0;
+
+						calltime.ResetAndClock();
+						int status = ACS_CallCompiled(compiled, module, &Stack[sp - func->ArgCount], func->ArgCount, runaway, result);
+						calltime.Unclock();
+						module->GetFunctionProfileData(func)->AddRun(runaway - entry, calltime.TimeMS());
+
+						sp -= func->ArgCount;
+						if (pcd != PCD_CALLDISCARD)
+						{
+							PushToStack(result);
+						}
+						if (status == ACSVM_Runaway)
+						{
+							Printf ("Runaway %s terminated\n", ScriptPresentation(script).GetChars());
+							state = SCRIPT_PleaseRemove;
+						}
+						else if (status == ACSVM_DivideBy0)
+						{
+							state = SCRIPT_DivideBy0;
+						}
+						else if (status == ACSVM_ModulusBy0)
+						{
+							state = SCRIPT_ModulusBy0;
+						}
+						break;
+					}
+				}
 				if (sp + func->LocalCount + 64 > STACK_SIZE)
 				{ // 64 is the margin for the function's working space
 					Printf ("Out of stack space in %s\n", ScriptPresentation(script).GetChars());
@@ -7320,11 +8597,13 @@ int DLevelScript::RunScript()
 				activeFunction = func;
 				activeBehavior = module;
 				fmt = module->GetFormat();
+				enc = FACSEncoding(fmt);
+				if (acs_jit) jitresume = pc;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_RETURNVOID:
-		case PCD_RETURNVAL:
+		PCASE(PCD_RETURNVOID):
+		PCASE(PCD_RETURNVAL):
 			{
 				int value;
 				union
@@ -7343,12 +8622,14 @@ int DLevelScript::RunScript()
 				}
 				sp -= sizeof(CallReturn)/sizeof(int);
 				retsp = &Stack[sp];
-				activeBehavior->GetFunctionProfileData(activeFunction)->AddRun(runaway - ret->EntryInstrCount);
+				ret->RunTime.Unclock();
+				activeBehavior->GetFunctionProfileData(activeFunction)->AddRun(runaway - ret->EntryInstrCount, ret->RunTime.TimeMS());
 				sp = int(locals.GetPointer() - &Stack[0]);
 				pc = ret->ReturnModule->Ofs2PC(ret->ReturnAddress);
 				activeFunction = ret->ReturnFunction;
 				activeBehavior = ret->ReturnModule;
 				fmt = activeBehavior->GetFormat();
+				enc = FACSEncoding(fmt);
 				locals = ret->ReturnLocals;
 				localarrays = ret->ReturnArrays;
 				if (!ret->bDiscardResult)
@@ -7356,25 +8637,26 @@ int DLevelScript::RunScript()
 					Stack[sp++] = value;
 				}
 				ret->~CallReturn();
+				if (acs_jit) jitresume = pc;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_ADD:
+		PCASE(PCD_ADD):
 			STACK(2) = STACK(2) + STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_SUBTRACT:
+		PCASE(PCD_SUBTRACT):
 			STACK(2) = STACK(2) - STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_MULTIPLY:
+		PCASE(PCD_MULTIPLY):
 			STACK(2) = STACK(2) * STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_DIVIDE:
+		PCASE(PCD_DIVIDE):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_DivideBy0;
@@ -7384,9 +8666,9 @@ int DLevelScript::RunScript()
 				STACK(2) = STACK(2) / STACK(1);
 				sp--;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_MODULUS:
+		PCASE(PCD_MODULUS):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_ModulusBy0;
@@ -7396,271 +8678,271 @@ int DLevelScript::RunScript()
 				STACK(2) = STACK(2) % STACK(1);
 				sp--;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_EQ:
+		PCASE(PCD_EQ):
 			STACK(2) = (STACK(2) == STACK(1));
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_NE:
+		PCASE(PCD_NE):
 			STACK(2) = (STACK(2) != STACK(1));
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_LT:
+		PCASE(PCD_LT):
 			STACK(2) = (STACK(2) < STACK(1));
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_GT:
+		PCASE(PCD_GT):
 			STACK(2) = (STACK(2) > STACK(1));
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_LE:
+		PCASE(PCD_LE):
 			STACK(2) = (STACK(2) <= STACK(1));
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_GE:
+		PCASE(PCD_GE):
 			STACK(2) = (STACK(2) >= STACK(1));
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_ASSIGNSCRIPTVAR:
+		PCASE(PCD_ASSIGNSCRIPTVAR):
 			locals[NEXTBYTE] = STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
 
-		case PCD_ASSIGNMAPVAR:
+		PCASE(PCD_ASSIGNMAPVAR):
 			*(activeBehavior->MapVars[NEXTBYTE]) = STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_ASSIGNWORLDVAR:
+		PCASE(PCD_ASSIGNWORLDVAR):
 			ACS_WorldVars[NEXTBYTE] = STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_ASSIGNGLOBALVAR:
+		PCASE(PCD_ASSIGNGLOBALVAR):
 			ACS_GlobalVars[NEXTBYTE] = STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_ASSIGNSCRIPTARRAY:
+		PCASE(PCD_ASSIGNSCRIPTARRAY):
 			localarrays->Set(locals, NEXTBYTE, STACK(2), STACK(1));
 			sp -= 2;
-			break;
+			NEXTPCODE;
 
-		case PCD_ASSIGNMAPARRAY:
+		PCASE(PCD_ASSIGNMAPARRAY):
 			activeBehavior->SetArrayVal (*(activeBehavior->MapVars[NEXTBYTE]), STACK(2), STACK(1));
 			sp -= 2;
-			break;
+			NEXTPCODE;
 
-		case PCD_ASSIGNWORLDARRAY:
+		PCASE(PCD_ASSIGNWORLDARRAY):
 			ACS_WorldArrays[NEXTBYTE][STACK(2)] = STACK(1);
 			sp -= 2;
-			break;
+			NEXTPCODE;
 
-		case PCD_ASSIGNGLOBALARRAY:
+		PCASE(PCD_ASSIGNGLOBALARRAY):
 			ACS_GlobalArrays[NEXTBYTE][STACK(2)] = STACK(1);
 			sp -= 2;
-			break;
+			NEXTPCODE;
 
-		case PCD_PUSHSCRIPTVAR:
+		PCASE(PCD_PUSHSCRIPTVAR):
 			PushToStack (locals[NEXTBYTE]);
-			break;
+			NEXTPCODE;
 
-		case PCD_PUSHMAPVAR:
+		PCASE(PCD_PUSHMAPVAR):
 			PushToStack (*(activeBehavior->MapVars[NEXTBYTE]));
-			break;
+			NEXTPCODE;
 
-		case PCD_PUSHWORLDVAR:
+		PCASE(PCD_PUSHWORLDVAR):
 			PushToStack (ACS_WorldVars[NEXTBYTE]);
-			break;
+			NEXTPCODE;
 
-		case PCD_PUSHGLOBALVAR:
+		PCASE(PCD_PUSHGLOBALVAR):
 			PushToStack (ACS_GlobalVars[NEXTBYTE]);
-			break;
+			NEXTPCODE;
 
-		case PCD_PUSHSCRIPTARRAY:
+		PCASE(PCD_PUSHSCRIPTARRAY):
 			STACK(1) = localarrays->Get(locals, NEXTBYTE, STACK(1));
-			break;
+			NEXTPCODE;
 
-		case PCD_PUSHMAPARRAY:
+		PCASE(PCD_PUSHMAPARRAY):
 			STACK(1) = activeBehavior->GetArrayVal (*(activeBehavior->MapVars[NEXTBYTE]), STACK(1));
-			break;
+			NEXTPCODE;
 
-		case PCD_PUSHWORLDARRAY:
+		PCASE(PCD_PUSHWORLDARRAY):
 			STACK(1) = ACS_WorldArrays[NEXTBYTE][STACK(1)];
-			break;
+			NEXTPCODE;
 
-		case PCD_PUSHGLOBALARRAY:
+		PCASE(PCD_PUSHGLOBALARRAY):
 			STACK(1) = ACS_GlobalArrays[NEXTBYTE][STACK(1)];
-			break;
+			NEXTPCODE;
 
-		case PCD_ADDSCRIPTVAR:
+		PCASE(PCD_ADDSCRIPTVAR):
 			locals[NEXTBYTE] += STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_ADDMAPVAR:
+		PCASE(PCD_ADDMAPVAR):
 			*(activeBehavior->MapVars[NEXTBYTE]) += STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_ADDWORLDVAR:
+		PCASE(PCD_ADDWORLDVAR):
 			ACS_WorldVars[NEXTBYTE] += STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_ADDGLOBALVAR:
+		PCASE(PCD_ADDGLOBALVAR):
 			ACS_GlobalVars[NEXTBYTE] += STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_ADDSCRIPTARRAY:
+		PCASE(PCD_ADDSCRIPTARRAY):
 			{
 				int a = NEXTBYTE, i = STACK(2);
 				localarrays->Set(locals, a, i, localarrays->Get(locals, a, i) + STACK(1));
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_ADDMAPARRAY:
+		PCASE(PCD_ADDMAPARRAY):
 			{
 				int a = *(activeBehavior->MapVars[NEXTBYTE]);
 				int i = STACK(2);
 				activeBehavior->SetArrayVal (a, i, activeBehavior->GetArrayVal (a, i) + STACK(1));
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_ADDWORLDARRAY:
+		PCASE(PCD_ADDWORLDARRAY):
 			{
 				int a = NEXTBYTE;
 				ACS_WorldArrays[a][STACK(2)] += STACK(1);
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_ADDGLOBALARRAY:
+		PCASE(PCD_ADDGLOBALARRAY):
 			{
 				int a = NEXTBYTE;
 				ACS_GlobalArrays[a][STACK(2)] += STACK(1);
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_SUBSCRIPTVAR:
+		PCASE(PCD_SUBSCRIPTVAR):
 			locals[NEXTBYTE] -= STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_SUBMAPVAR:
+		PCASE(PCD_SUBMAPVAR):
 			*(activeBehavior->MapVars[NEXTBYTE]) -= STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_SUBWORLDVAR:
+		PCASE(PCD_SUBWORLDVAR):
 			ACS_WorldVars[NEXTBYTE] -= STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_SUBGLOBALVAR:
+		PCASE(PCD_SUBGLOBALVAR):
 			ACS_GlobalVars[NEXTBYTE] -= STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_SUBSCRIPTARRAY:
+		PCASE(PCD_SUBSCRIPTARRAY):
 			{
 				int a = NEXTBYTE, i = STACK(2);
 				localarrays->Set(locals, a, i, localarrays->Get(locals, a, i) - STACK(1));
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_SUBMAPARRAY:
+		PCASE(PCD_SUBMAPARRAY):
 			{
 				int a = *(activeBehavior->MapVars[NEXTBYTE]);
 				int i = STACK(2);
 				activeBehavior->SetArrayVal (a, i, activeBehavior->GetArrayVal (a, i) - STACK(1));
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_SUBWORLDARRAY:
+		PCASE(PCD_SUBWORLDARRAY):
 			{
 				int a = NEXTBYTE;
 				ACS_WorldArrays[a][STACK(2)] -= STACK(1);
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_SUBGLOBALARRAY:
+		PCASE(PCD_SUBGLOBALARRAY):
 			{
 				int a = NEXTBYTE;
 				ACS_GlobalArrays[a][STACK(2)] -= STACK(1);
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_MULSCRIPTVAR:
+		PCASE(PCD_MULSCRIPTVAR):
 			locals[NEXTBYTE] *= STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_MULMAPVAR:
+		PCASE(PCD_MULMAPVAR):
 			*(activeBehavior->MapVars[NEXTBYTE]) *= STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_MULWORLDVAR:
+		PCASE(PCD_MULWORLDVAR):
 			ACS_WorldVars[NEXTBYTE] *= STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_MULGLOBALVAR:
+		PCASE(PCD_MULGLOBALVAR):
 			ACS_GlobalVars[NEXTBYTE] *= STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_MULSCRIPTARRAY:
+		PCASE(PCD_MULSCRIPTARRAY):
 			{
 				int a = NEXTBYTE, i = STACK(2);
 				localarrays->Set(locals, a, i, localarrays->Get(locals, a, i) * STACK(1));
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_MULMAPARRAY:
+		PCASE(PCD_MULMAPARRAY):
 			{
 				int a = *(activeBehavior->MapVars[NEXTBYTE]);
 				int i = STACK(2);
 				activeBehavior->SetArrayVal (a, i, activeBehavior->GetArrayVal (a, i) * STACK(1));
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_MULWORLDARRAY:
+		PCASE(PCD_MULWORLDARRAY):
 			{
 				int a = NEXTBYTE;
 				ACS_WorldArrays[a][STACK(2)] *= STACK(1);
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_MULGLOBALARRAY:
+		PCASE(PCD_MULGLOBALARRAY):
 			{
 				int a = NEXTBYTE;
 				ACS_GlobalArrays[a][STACK(2)] *= STACK(1);
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_DIVSCRIPTVAR:
+		PCASE(PCD_DIVSCRIPTVAR):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_DivideBy0;
@@ -7670,9 +8952,9 @@ int DLevelScript::RunScript()
 				locals[NEXTBYTE] /= STACK(1);
 				sp--;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_DIVMAPVAR:
+		PCASE(PCD_DIVMAPVAR):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_DivideBy0;
@@ -7682,9 +8964,9 @@ int DLevelScript::RunScript()
 				*(activeBehavior->MapVars[NEXTBYTE]) /= STACK(1);
 				sp--;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_DIVWORLDVAR:
+		PCASE(PCD_DIVWORLDVAR):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_DivideBy0;
@@ -7694,9 +8976,9 @@ int DLevelScript::RunScript()
 				ACS_WorldVars[NEXTBYTE] /= STACK(1);
 				sp--;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_DIVGLOBALVAR:
+		PCASE(PCD_DIVGLOBALVAR):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_DivideBy0;
@@ -7706,9 +8988,9 @@ int DLevelScript::RunScript()
 				ACS_GlobalVars[NEXTBYTE] /= STACK(1);
 				sp--;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_DIVSCRIPTARRAY:
+		PCASE(PCD_DIVSCRIPTARRAY):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_DivideBy0;
@@ -7719,9 +9001,9 @@ int DLevelScript::RunScript()
 				localarrays->Set(locals, a, i, localarrays->Get(locals, a, i) / STACK(1));
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_DIVMAPARRAY:
+		PCASE(PCD_DIVMAPARRAY):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_DivideBy0;
@@ -7733,9 +9015,9 @@ int DLevelScript::RunScript()
 				activeBehavior->SetArrayVal (a, i, activeBehavior->GetArrayVal (a, i) / STACK(1));
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_DIVWORLDARRAY:
+		PCASE(PCD_DIVWORLDARRAY):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_DivideBy0;
@@ -7746,9 +9028,9 @@ int DLevelScript::RunScript()
 				ACS_WorldArrays[a][STACK(2)] /= STACK(1);
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_DIVGLOBALARRAY:
+		PCASE(PCD_DIVGLOBALARRAY):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_DivideBy0;
@@ -7759,9 +9041,9 @@ int DLevelScript::RunScript()
 				ACS_GlobalArrays[a][STACK(2)] /= STACK(1);
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_MODSCRIPTVAR:
+		PCASE(PCD_MODSCRIPTVAR):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_ModulusBy0;
@@ -7771,9 +9053,9 @@ int DLevelScript::RunScript()
 				locals[NEXTBYTE] %= STACK(1);
 				sp--;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_MODMAPVAR:
+		PCASE(PCD_MODMAPVAR):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_ModulusBy0;
@@ -7783,9 +9065,9 @@ int DLevelScript::RunScript()
 				*(activeBehavior->MapVars[NEXTBYTE]) %= STACK(1);
 				sp--;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_MODWORLDVAR:
+		PCASE(PCD_MODWORLDVAR):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_ModulusBy0;
@@ -7795,9 +9077,9 @@ int DLevelScript::RunScript()
 				ACS_WorldVars[NEXTBYTE] %= STACK(1);
 				sp--;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_MODGLOBALVAR:
+		PCASE(PCD_MODGLOBALVAR):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_ModulusBy0;
@@ -7807,9 +9089,9 @@ int DLevelScript::RunScript()
 				ACS_GlobalVars[NEXTBYTE] %= STACK(1);
 				sp--;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_MODSCRIPTARRAY:
+		PCASE(PCD_MODSCRIPTARRAY):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_ModulusBy0;
@@ -7820,9 +9102,9 @@ int DLevelScript::RunScript()
 				localarrays->Set(locals, a, i, localarrays->Get(locals, a, i) % STACK(1));
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_MODMAPARRAY:
+		PCASE(PCD_MODMAPARRAY):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_ModulusBy0;
@@ -7834,9 +9116,9 @@ int DLevelScript::RunScript()
 				activeBehavior->SetArrayVal (a, i, activeBehavior->GetArrayVal (a, i) % STACK(1));
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_MODWORLDARRAY:
+		PCASE(PCD_MODWORLDARRAY):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_ModulusBy0;
@@ -7847,9 +9129,9 @@ int DLevelScript::RunScript()
 				ACS_WorldArrays[a][STACK(2)] %= STACK(1);
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_MODGLOBALARRAY:
+		PCASE(PCD_MODGLOBALARRAY):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_ModulusBy0;
@@ -7860,582 +9142,582 @@ int DLevelScript::RunScript()
 				ACS_GlobalArrays[a][STACK(2)] %= STACK(1);
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
 		//[MW] start
-		case PCD_ANDSCRIPTVAR:
+		PCASE(PCD_ANDSCRIPTVAR):
 			locals[NEXTBYTE] &= STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_ANDMAPVAR:
+		PCASE(PCD_ANDMAPVAR):
 			*(activeBehavior->MapVars[NEXTBYTE]) &= STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_ANDWORLDVAR:
+		PCASE(PCD_ANDWORLDVAR):
 			ACS_WorldVars[NEXTBYTE] &= STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_ANDGLOBALVAR:
+		PCASE(PCD_ANDGLOBALVAR):
 			ACS_GlobalVars[NEXTBYTE] &= STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_ANDSCRIPTARRAY:
+		PCASE(PCD_ANDSCRIPTARRAY):
 			{
 				int a = NEXTBYTE, i = STACK(2);
 				localarrays->Set(locals, a, i, localarrays->Get(locals, a, i) & STACK(1));
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_ANDMAPARRAY:
+		PCASE(PCD_ANDMAPARRAY):
 			{
 				int a = *(activeBehavior->MapVars[NEXTBYTE]);
 				int i = STACK(2);
 				activeBehavior->SetArrayVal (a, i, activeBehavior->GetArrayVal (a, i) & STACK(1));
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_ANDWORLDARRAY:
+		PCASE(PCD_ANDWORLDARRAY):
 			{
 				int a = NEXTBYTE;
 				ACS_WorldArrays[a][STACK(2)] &= STACK(1);
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_ANDGLOBALARRAY:
+		PCASE(PCD_ANDGLOBALARRAY):
 			{
 				int a = NEXTBYTE;
 				ACS_GlobalArrays[a][STACK(2)] &= STACK(1);
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_EORSCRIPTVAR:
+		PCASE(PCD_EORSCRIPTVAR):
 			locals[NEXTBYTE] ^= STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_EORMAPVAR:
+		PCASE(PCD_EORMAPVAR):
 			*(activeBehavior->MapVars[NEXTBYTE]) ^= STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_EORWORLDVAR:
+		PCASE(PCD_EORWORLDVAR):
 			ACS_WorldVars[NEXTBYTE] ^= STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_EORGLOBALVAR:
+		PCASE(PCD_EORGLOBALVAR):
 			ACS_GlobalVars[NEXTBYTE] ^= STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_EORSCRIPTARRAY:
+		PCASE(PCD_EORSCRIPTARRAY):
 			{
 				int a = NEXTBYTE, i = STACK(2);
 				localarrays->Set(locals, a, i, localarrays->Get(locals, a, i) ^ STACK(1));
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_EORMAPARRAY:
+		PCASE(PCD_EORMAPARRAY):
 			{
 				int a = *(activeBehavior->MapVars[NEXTBYTE]);
 				int i = STACK(2);
 				activeBehavior->SetArrayVal (a, i, activeBehavior->GetArrayVal (a, i) ^ STACK(1));
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_EORWORLDARRAY:
+		PCASE(PCD_EORWORLDARRAY):
 			{
 				int a = NEXTBYTE;
 				ACS_WorldArrays[a][STACK(2)] ^= STACK(1);
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_EORGLOBALARRAY:
+		PCASE(PCD_EORGLOBALARRAY):
 			{
 				int a = NEXTBYTE;
 				ACS_GlobalArrays[a][STACK(2)] ^= STACK(1);
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_ORSCRIPTVAR:
+		PCASE(PCD_ORSCRIPTVAR):
 			locals[NEXTBYTE] |= STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_ORMAPVAR:
+		PCASE(PCD_ORMAPVAR):
 			*(activeBehavior->MapVars[NEXTBYTE]) |= STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_ORWORLDVAR:
+		PCASE(PCD_ORWORLDVAR):
 			ACS_WorldVars[NEXTBYTE] |= STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_ORGLOBALVAR:
+		PCASE(PCD_ORGLOBALVAR):
 			ACS_GlobalVars[NEXTBYTE] |= STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_ORSCRIPTARRAY:
+		PCASE(PCD_ORSCRIPTARRAY):
 			{
 				int a = NEXTBYTE, i = STACK(2);
 				localarrays->Set(locals, a, i, localarrays->Get(locals, a, i) | STACK(1));
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_ORMAPARRAY:
+		PCASE(PCD_ORMAPARRAY):
 			{
 				int a = *(activeBehavior->MapVars[NEXTBYTE]);
 				int i = STACK(2);
 				activeBehavior->SetArrayVal (a, i, activeBehavior->GetArrayVal (a, i) | STACK(1));
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_ORWORLDARRAY:
+		PCASE(PCD_ORWORLDARRAY):
 			{
 				int a = NEXTBYTE;
 				ACS_WorldArrays[a][STACK(2)] |= STACK(1);
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_ORGLOBALARRAY:
+		PCASE(PCD_ORGLOBALARRAY):
 			{
 				int a = NEXTBYTE;
 				int i = STACK(2);
 				ACS_GlobalArrays[a][STACK(2)] |= STACK(1);
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_LSSCRIPTVAR:
+		PCASE(PCD_LSSCRIPTVAR):
 			locals[NEXTBYTE] <<= STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_LSMAPVAR:
+		PCASE(PCD_LSMAPVAR):
 			*(activeBehavior->MapVars[NEXTBYTE]) <<= STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_LSWORLDVAR:
+		PCASE(PCD_LSWORLDVAR):
 			ACS_WorldVars[NEXTBYTE] <<= STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_LSGLOBALVAR:
+		PCASE(PCD_LSGLOBALVAR):
 			ACS_GlobalVars[NEXTBYTE] <<= STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_LSSCRIPTARRAY:
+		PCASE(PCD_LSSCRIPTARRAY):
 			{
 				int a = NEXTBYTE, i = STACK(2);
 				localarrays->Set(locals, a, i, localarrays->Get(locals, a, i) << STACK(1));
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_LSMAPARRAY:
+		PCASE(PCD_LSMAPARRAY):
 			{
 				int a = *(activeBehavior->MapVars[NEXTBYTE]);
 				int i = STACK(2);
 				activeBehavior->SetArrayVal (a, i, activeBehavior->GetArrayVal (a, i) << STACK(1));
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_LSWORLDARRAY:
+		PCASE(PCD_LSWORLDARRAY):
 			{
 				int a = NEXTBYTE;
 				ACS_WorldArrays[a][STACK(2)] <<= STACK(1);
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_LSGLOBALARRAY:
+		PCASE(PCD_LSGLOBALARRAY):
 			{
 				int a = NEXTBYTE;
 				ACS_GlobalArrays[a][STACK(2)] <<= STACK(1);
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_RSSCRIPTVAR:
+		PCASE(PCD_RSSCRIPTVAR):
 			locals[NEXTBYTE] >>= STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_RSMAPVAR:
+		PCASE(PCD_RSMAPVAR):
 			*(activeBehavior->MapVars[NEXTBYTE]) >>= STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_RSWORLDVAR:
+		PCASE(PCD_RSWORLDVAR):
 			ACS_WorldVars[NEXTBYTE] >>= STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_RSGLOBALVAR:
+		PCASE(PCD_RSGLOBALVAR):
 			ACS_GlobalVars[NEXTBYTE] >>= STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_RSSCRIPTARRAY:
+		PCASE(PCD_RSSCRIPTARRAY):
 			{
 				int a = NEXTBYTE, i = STACK(2);
 				localarrays->Set(locals, a, i, localarrays->Get(locals, a, i) >> STACK(1));
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_RSMAPARRAY:
+		PCASE(PCD_RSMAPARRAY):
 			{
 				int a = *(activeBehavior->MapVars[NEXTBYTE]);
 				int i = STACK(2);
 				activeBehavior->SetArrayVal (a, i, activeBehavior->GetArrayVal (a, i) >> STACK(1));
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_RSWORLDARRAY:
+		PCASE(PCD_RSWORLDARRAY):
 			{
 				int a = NEXTBYTE;
 				ACS_WorldArrays[a][STACK(2)] >>= STACK(1);
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_RSGLOBALARRAY:
+		PCASE(PCD_RSGLOBALARRAY):
 			{
 				int a = NEXTBYTE;
 				ACS_GlobalArrays[a][STACK(2)] >>= STACK(1);
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 		//[MW] end
 
-		case PCD_INCSCRIPTVAR:
+		PCASE(PCD_INCSCRIPTVAR):
 			++locals[NEXTBYTE];
-			break;
+			NEXTPCODE;
 
-		case PCD_INCMAPVAR:
+		PCASE(PCD_INCMAPVAR):
 			*(activeBehavior->MapVars[NEXTBYTE]) += 1;
-			break;
+			NEXTPCODE;
 
-		case PCD_INCWORLDVAR:
+		PCASE(PCD_INCWORLDVAR):
 			++ACS_WorldVars[NEXTBYTE];
-			break;
+			NEXTPCODE;
 
-		case PCD_INCGLOBALVAR:
+		PCASE(PCD_INCGLOBALVAR):
 			++ACS_GlobalVars[NEXTBYTE];
-			break;
+			NEXTPCODE;
 
-		case PCD_INCSCRIPTARRAY:
+		PCASE(PCD_INCSCRIPTARRAY):
 			{
 				int a = NEXTBYTE, i = STACK(1);
 				localarrays->Set(locals, a, i, localarrays->Get(locals, a, i) + 1);
 				sp--;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_INCMAPARRAY:
+		PCASE(PCD_INCMAPARRAY):
 			{
 				int a = *(activeBehavior->MapVars[NEXTBYTE]);
 				int i = STACK(1);
 				activeBehavior->SetArrayVal (a, i, activeBehavior->GetArrayVal (a, i) + 1);
 				sp--;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_INCWORLDARRAY:
+		PCASE(PCD_INCWORLDARRAY):
 			{
 				int a = NEXTBYTE;
 				ACS_WorldArrays[a][STACK(1)] += 1;
 				sp--;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_INCGLOBALARRAY:
+		PCASE(PCD_INCGLOBALARRAY):
 			{
 				int a = NEXTBYTE;
 				ACS_GlobalArrays[a][STACK(1)] += 1;
 				sp--;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_DECSCRIPTVAR:
+		PCASE(PCD_DECSCRIPTVAR):
 			--locals[NEXTBYTE];
-			break;
+			NEXTPCODE;
 
-		case PCD_DECMAPVAR:
+		PCASE(PCD_DECMAPVAR):
 			*(activeBehavior->MapVars[NEXTBYTE]) -= 1;
-			break;
+			NEXTPCODE;
 
-		case PCD_DECWORLDVAR:
+		PCASE(PCD_DECWORLDVAR):
 			--ACS_WorldVars[NEXTBYTE];
-			break;
+			NEXTPCODE;
 
-		case PCD_DECGLOBALVAR:
+		PCASE(PCD_DECGLOBALVAR):
 			--ACS_GlobalVars[NEXTBYTE];
-			break;
+			NEXTPCODE;
 
-		case PCD_DECSCRIPTARRAY:
+		PCASE(PCD_DECSCRIPTARRAY):
 			{
 				int a = NEXTBYTE, i = STACK(1);
 				localarrays->Set(locals, a, i, localarrays->Get(locals, a, i) - 1);
 				sp--;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_DECMAPARRAY:
+		PCASE(PCD_DECMAPARRAY):
 			{
 				int a = *(activeBehavior->MapVars[NEXTBYTE]);
 				int i = STACK(1);
 				activeBehavior->SetArrayVal (a, i, activeBehavior->GetArrayVal (a, i) - 1);
 				sp--;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_DECWORLDARRAY:
+		PCASE(PCD_DECWORLDARRAY):
 			{
 				int a = NEXTBYTE;
 				ACS_WorldArrays[a][STACK(1)] -= 1;
 				sp--;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_DECGLOBALARRAY:
+		PCASE(PCD_DECGLOBALARRAY):
 			{
 				int a = NEXTBYTE;
 				int i = STACK(1);
 				ACS_GlobalArrays[a][STACK(1)] -= 1;
 				sp--;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_GOTO:
+		PCASE(PCD_GOTO):
 			pc = activeBehavior->Ofs2PC (LittleLong(*pc));
-			break;
+			NEXTPCODE;
 
-		case PCD_GOTOSTACK:
+		PCASE(PCD_GOTOSTACK):
 			pc = activeBehavior->Jump2PC (STACK(1));
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_IFGOTO:
+		PCASE(PCD_IFGOTO):
 			if (STACK(1))
 				pc = activeBehavior->Ofs2PC (LittleLong(*pc));
 			else
 				pc++;
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_SETRESULTVALUE:
+		PCASE(PCD_SETRESULTVALUE):
 			resultValue = STACK(1);
 			[[fallthrough]];
-		case PCD_DROP: //fall through.
+		PCASE(PCD_DROP): //fall through.
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_DELAY:
+		PCASE(PCD_DELAY):
 			statedata = STACK(1) + (fmt == ACS_Old && gameinfo.gametype == GAME_Hexen);
 			if (statedata > 0)
 			{
 				state = SCRIPT_Delayed;
 			}
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_DELAYDIRECT:
+		PCASE(PCD_DELAYDIRECT):
 			statedata = uallong(pc[0]) + (fmt == ACS_Old && gameinfo.gametype == GAME_Hexen);
 			pc++;
 			if (statedata > 0)
 			{
 				state = SCRIPT_Delayed;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_DELAYDIRECTB:
+		PCASE(PCD_DELAYDIRECTB):
 			statedata = *(uint8_t *)pc + (fmt == ACS_Old && gameinfo.gametype == GAME_Hexen);
 			if (statedata > 0)
 			{
 				state = SCRIPT_Delayed;
 			}
 			pc = (int *)((uint8_t *)pc + 1);
-			break;
+			NEXTPCODE;
 
-		case PCD_RANDOM:
+		PCASE(PCD_RANDOM):
 			STACK(2) = Random (STACK(2), STACK(1));
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_RANDOMDIRECT:
+		PCASE(PCD_RANDOMDIRECT):
 			PushToStack (Random (uallong(pc[0]), uallong(pc[1])));
 			pc += 2;
-			break;
+			NEXTPCODE;
 
-		case PCD_RANDOMDIRECTB:
+		PCASE(PCD_RANDOMDIRECTB):
 			PushToStack (Random (((uint8_t *)pc)[0], ((uint8_t *)pc)[1]));
 			pc = (int *)((uint8_t *)pc + 2);
-			break;
+			NEXTPCODE;
 
-		case PCD_THINGCOUNT:
+		PCASE(PCD_THINGCOUNT):
 			STACK(2) = ThingCount (STACK(2), -1, STACK(1), -1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_THINGCOUNTDIRECT:
+		PCASE(PCD_THINGCOUNTDIRECT):
 			PushToStack (ThingCount (uallong(pc[0]), -1, uallong(pc[1]), -1));
 			pc += 2;
-			break;
+			NEXTPCODE;
 
-		case PCD_THINGCOUNTNAME:
+		PCASE(PCD_THINGCOUNTNAME):
 			STACK(2) = ThingCount (-1, STACK(2), STACK(1), -1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_THINGCOUNTNAMESECTOR:
+		PCASE(PCD_THINGCOUNTNAMESECTOR):
 			STACK(3) = ThingCount (-1, STACK(3), STACK(2), STACK(1));
 			sp -= 2;
-			break;
+			NEXTPCODE;
 
-		case PCD_THINGCOUNTSECTOR:
+		PCASE(PCD_THINGCOUNTSECTOR):
 			STACK(3) = ThingCount (STACK(3), -1, STACK(2), STACK(1));
 			sp -= 2;
-			break;
+			NEXTPCODE;
 
-		case PCD_TAGWAIT:
+		PCASE(PCD_TAGWAIT):
 			state = SCRIPT_TagWait;
 			statedata = STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_TAGWAITDIRECT:
+		PCASE(PCD_TAGWAITDIRECT):
 			state = SCRIPT_TagWait;
 			statedata = uallong(pc[0]);
 			pc++;
-			break;
+			NEXTPCODE;
 
-		case PCD_POLYWAIT:
+		PCASE(PCD_POLYWAIT):
 			state = SCRIPT_PolyWait;
 			statedata = STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_POLYWAITDIRECT:
+		PCASE(PCD_POLYWAITDIRECT):
 			state = SCRIPT_PolyWait;
 			statedata = uallong(pc[0]);
 			pc++;
-			break;
+			NEXTPCODE;
 
-		case PCD_CHANGEFLOOR:
+		PCASE(PCD_CHANGEFLOOR):
 			ChangeFlat (STACK(2), STACK(1), 0);
 			sp -= 2;
-			break;
+			NEXTPCODE;
 
-		case PCD_CHANGEFLOORDIRECT:
+		PCASE(PCD_CHANGEFLOORDIRECT):
 			ChangeFlat (uallong(pc[0]), TAGSTR(uallong(pc[1])), 0);
 			pc += 2;
-			break;
+			NEXTPCODE;
 
-		case PCD_CHANGECEILING:
+		PCASE(PCD_CHANGECEILING):
 			ChangeFlat (STACK(2), STACK(1), 1);
 			sp -= 2;
-			break;
+			NEXTPCODE;
 
-		case PCD_CHANGECEILINGDIRECT:
+		PCASE(PCD_CHANGECEILINGDIRECT):
 			ChangeFlat (uallong(pc[0]), TAGSTR(uallong(pc[1])), 1);
 			pc += 2;
-			break;
+			NEXTPCODE;
 
-		case PCD_RESTART:
+		PCASE(PCD_RESTART):
 			{
 				const ScriptPtr *scriptp;
 
 				scriptp = activeBehavior->FindScript (script);
 				pc = activeBehavior->GetScriptAddress (scriptp);
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_ANDLOGICAL:
+		PCASE(PCD_ANDLOGICAL):
 			STACK(2) = (STACK(2) && STACK(1));
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_ORLOGICAL:
+		PCASE(PCD_ORLOGICAL):
 			STACK(2) = (STACK(2) || STACK(1));
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_ANDBITWISE:
+		PCASE(PCD_ANDBITWISE):
 			STACK(2) = (STACK(2) & STACK(1));
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_ORBITWISE:
+		PCASE(PCD_ORBITWISE):
 			STACK(2) = (STACK(2) | STACK(1));
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_EORBITWISE:
+		PCASE(PCD_EORBITWISE):
 			STACK(2) = (STACK(2) ^ STACK(1));
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_NEGATELOGICAL:
+		PCASE(PCD_NEGATELOGICAL):
 			STACK(1) = !STACK(1);
-			break;
+			NEXTPCODE;
 
 
 
 
-		case PCD_NEGATEBINARY:
+		PCASE(PCD_NEGATEBINARY):
 			STACK(1) = ~STACK(1);
-			break;
+			NEXTPCODE;
 
-		case PCD_LSHIFT:
+		PCASE(PCD_LSHIFT):
 			STACK(2) = (STACK(2) << STACK(1));
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_RSHIFT:
+		PCASE(PCD_RSHIFT):
 			STACK(2) = (STACK(2) >> STACK(1));
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_UNARYMINUS:
+		PCASE(PCD_UNARYMINUS):
 			STACK(1) = -STACK(1);
-			break;
+			NEXTPCODE;
 
-		case PCD_IFNOTGOTO:
+		PCASE(PCD_IFNOTGOTO):
 			if (!STACK(1))
 				pc = activeBehavior->Ofs2PC (LittleLong(*pc));
 			else
 				pc++;
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_LINESIDE:
+		PCASE(PCD_LINESIDE):
 			PushToStack (backSide);
-			break;
+			NEXTPCODE;
 
-		case PCD_SCRIPTWAIT:
+		PCASE(PCD_SCRIPTWAIT):
 			statedata = STACK(1);
 			sp--;
 scriptwait:
@@ -8444,9 +9726,9 @@ scriptwait:
 			else
 				state = SCRIPT_ScriptWaitPre;
 			PutLast ();
-			break;
+			NEXTPCODE;
 
-		case PCD_SCRIPTWAITDIRECT:
+		PCASE(PCD_SCRIPTWAITDIRECT):
 			if (!(Level->i_compatflags2 & COMPATF2_SCRIPTWAIT))
 			{
 				statedata = uallong(pc[0]);
@@ -8463,20 +9745,20 @@ scriptwait:
 				break;
 			}
 
-		case PCD_SCRIPTWAITNAMED:
+		PCASE(PCD_SCRIPTWAITNAMED):
 			statedata = -FName(Level->Behaviors.LookupString(STACK(1))).GetIndex();
 			sp--;
 			goto scriptwait;
 
-		case PCD_CLEARLINESPECIAL:
+		PCASE(PCD_CLEARLINESPECIAL):
 			if (activationline != NULL)
 			{
 				activationline->special = 0;
 				DPrintf(DMSG_SPAMMY, "Cleared line special on line %d\n", activationline->Index());
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_CASEGOTO:
+		PCASE(PCD_CASEGOTO):
 			if (STACK(1) == uallong(pc[0]))
 			{
 				pc = activeBehavior->Ofs2PC (uallong(pc[1]));
@@ -8486,9 +9768,9 @@ scriptwait:
 			{
 				pc += 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_CASEGOTOSORTED:
+		PCASE(PCD_CASEGOTOSORTED):
 			// The count and jump table are 4-byte aligned
 			pc = (int *)(((size_t)pc + 3) & ~3);
 			{
@@ -8519,14 +9801,14 @@ scriptwait:
 					pc += numcases * 2;
 				}
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_BEGINPRINT:
+		PCASE(PCD_BEGINPRINT):
 			STRINGBUILDER_START(work);
-			break;
+			NEXTPCODE;
 
-		case PCD_PRINTSTRING:
-		case PCD_PRINTLOCALIZED:
+		PCASE(PCD_PRINTSTRING):
+		PCASE(PCD_PRINTLOCALIZED):
 			lookup = Level->Behaviors.LookupString (STACK(1), true);
 			if (pcd == PCD_PRINTLOCALIZED)
 			{
@@ -8537,38 +9819,38 @@ scriptwait:
 				work += lookup;
 			}
 			--sp;
-			break;
+			NEXTPCODE;
 
-		case PCD_PRINTNUMBER:
+		PCASE(PCD_PRINTNUMBER):
 			work.AppendFormat ("%d", STACK(1));
 			--sp;
-			break;
+			NEXTPCODE;
 
-		case PCD_PRINTBINARY:
+		PCASE(PCD_PRINTBINARY):
 			IGNORE_FORMAT_PRE
 			work.AppendFormat ("%B", STACK(1));
 			IGNORE_FORMAT_POST
 			--sp;
-			break;
+			NEXTPCODE;
 
-		case PCD_PRINTHEX:
+		PCASE(PCD_PRINTHEX):
 			work.AppendFormat ("%X", STACK(1));
 			--sp;
-			break;
+			NEXTPCODE;
 
-		case PCD_PRINTCHARACTER:
+		PCASE(PCD_PRINTCHARACTER):
 			work += (char)STACK(1);
 			--sp;
-			break;
+			NEXTPCODE;
 
-		case PCD_PRINTFIXED:
+		PCASE(PCD_PRINTFIXED):
 			work.AppendFormat ("%g", ACSToDouble(STACK(1)));
 			--sp;
-			break;
+			NEXTPCODE;
 
 		// [BC] Print activator's name
 		// [RH] Fancied up a bit
-		case PCD_PRINTNAME:
+		PCASE(PCD_PRINTNAME):
 			{
 				player_t *player = NULL;
 
@@ -8647,11 +9929,11 @@ scriptwait:
 				}
 				sp--;
 			}
-			break;
+			NEXTPCODE;
 
 		// Print script character array
-		case PCD_PRINTSCRIPTCHARARRAY:
-		case PCD_PRINTSCRIPTCHRANGE:
+		PCASE(PCD_PRINTSCRIPTCHARARRAY):
+		PCASE(PCD_PRINTSCRIPTCHRANGE):
 			{
 				int capacity, offset, a, c;
 				if (CharArrayParms(capacity, offset, a, Stack, sp, pcd == PCD_PRINTSCRIPTCHRANGE))
@@ -8663,11 +9945,11 @@ scriptwait:
 					}
 				}
 			}
-			break;
+			NEXTPCODE;
 
 		// [JB] Print map character array
-		case PCD_PRINTMAPCHARARRAY:
-		case PCD_PRINTMAPCHRANGE:
+		PCASE(PCD_PRINTMAPCHARARRAY):
+		PCASE(PCD_PRINTMAPCHRANGE):
 			{
 				int capacity, offset, a, c;
 				if (CharArrayParms(capacity, offset, a, Stack, sp, pcd == PCD_PRINTMAPCHRANGE))
@@ -8679,11 +9961,11 @@ scriptwait:
 					}
 				}
 			}
-			break;
+			NEXTPCODE;
 
 		// [JB] Print world character array
-		case PCD_PRINTWORLDCHARARRAY:
-		case PCD_PRINTWORLDCHRANGE:
+		PCASE(PCD_PRINTWORLDCHARARRAY):
+		PCASE(PCD_PRINTWORLDCHRANGE):
 			{
 				int capacity, offset, a, c;
 				if (CharArrayParms(capacity, offset, a, Stack, sp, pcd == PCD_PRINTWORLDCHRANGE))
@@ -8695,11 +9977,11 @@ scriptwait:
 					}
 				}
 			}
-			break;
+			NEXTPCODE;
 
 		// [JB] Print global character array
-		case PCD_PRINTGLOBALCHARARRAY:
-		case PCD_PRINTGLOBALCHRANGE:
+		PCASE(PCD_PRINTGLOBALCHARARRAY):
+		PCASE(PCD_PRINTGLOBALCHRANGE):
 			{
 				int capacity, offset, a, c;
 				if (CharArrayParms(capacity, offset, a, Stack, sp, pcd == PCD_PRINTGLOBALCHRANGE))
@@ -8711,10 +9993,10 @@ scriptwait:
 					}
 				}
 			}
-			break;
+			NEXTPCODE;
 
 		// [GRB] Print key name(s) for a command
-		case PCD_PRINTBIND:
+		PCASE(PCD_PRINTBIND):
 			lookup = Level->Behaviors.LookupString (STACK(1));
 			if (lookup != NULL)
 			{
@@ -8730,12 +10012,12 @@ scriptwait:
 					work << "??? (" << (char *)lookup << ')';
 			}
 			--sp;
-			break;
+			NEXTPCODE;
 
-		case PCD_ENDPRINT:
-		case PCD_ENDPRINTBOLD:
-		case PCD_MOREHUDMESSAGE:
-		case PCD_ENDLOG:
+		PCASE(PCD_ENDPRINT):
+		PCASE(PCD_ENDPRINTBOLD):
+		PCASE(PCD_MOREHUDMESSAGE):
+		PCASE(PCD_ENDLOG):
 			if (pcd == PCD_ENDLOG)
 			{
 				Printf ("%s\n", work.GetChars());
@@ -8764,14 +10046,14 @@ scriptwait:
 			{
 				optstart = -1;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_OPTHUDMESSAGE:
+		PCASE(PCD_OPTHUDMESSAGE):
 			optstart = sp;
-			break;
+			NEXTPCODE;
 
-		case PCD_ENDHUDMESSAGE:
-		case PCD_ENDHUDMESSAGEBOLD:
+		PCASE(PCD_ENDHUDMESSAGE):
+		PCASE(PCD_ENDHUDMESSAGEBOLD):
 			if (optstart == -1)
 			{
 				optstart = sp;
@@ -8866,23 +10148,23 @@ scriptwait:
 			}
 			STRINGBUILDER_FINISH(work);
 			sp = optstart-6;
-			break;
+			NEXTPCODE;
 
-		case PCD_SETFONT:
+		PCASE(PCD_SETFONT):
 			DoSetFont (STACK(1));
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_SETFONTDIRECT:
+		PCASE(PCD_SETFONTDIRECT):
 			DoSetFont (TAGSTR(uallong(pc[0])));
 			pc++;
-			break;
+			NEXTPCODE;
 
-		case PCD_PLAYERCOUNT:
+		PCASE(PCD_PLAYERCOUNT):
 			PushToStack (CountPlayers ());
-			break;
+			NEXTPCODE;
 
-		case PCD_GAMETYPE:
+		PCASE(PCD_GAMETYPE):
 			if (gamestate == GS_TITLELEVEL)
 				PushToStack (GAME_TITLE_MAP);
 			else if (deathmatch)
@@ -8891,32 +10173,32 @@ scriptwait:
 				PushToStack (GAME_NET_COOPERATIVE);
 			else
 				PushToStack (GAME_SINGLE_PLAYER);
-			break;
+			NEXTPCODE;
 
-		case PCD_GAMESKILL:
+		PCASE(PCD_GAMESKILL):
 			PushToStack (G_SkillProperty(SKILLP_ACSReturn));
-			break;
+			NEXTPCODE;
 
 // [BC] Start ST PCD's
-		case PCD_ISNETWORKGAME:
+		PCASE(PCD_ISNETWORKGAME):
 			PushToStack(netgame);
-			break;
+			NEXTPCODE;
 
-		case PCD_PLAYERTEAM:
+		PCASE(PCD_PLAYERTEAM):
 			if ( activator && activator->player )
 				PushToStack( activator->player->userinfo.GetTeam() );
 			else
 				PushToStack( 0 );
-			break;
+			NEXTPCODE;
 
-		case PCD_PLAYERHEALTH:
+		PCASE(PCD_PLAYERHEALTH):
 			if (activator)
 				PushToStack (activator->health);
 			else
 				PushToStack (0);
-			break;
+			NEXTPCODE;
 
-		case PCD_PLAYERARMORPOINTS:
+		PCASE(PCD_PLAYERARMORPOINTS):
 			if (activator)
 			{
 				auto armor = activator->FindInventory(NAME_BasicArmor, true);
@@ -8926,34 +10208,34 @@ scriptwait:
 			{
 				PushToStack (0);
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_PLAYERFRAGS:
+		PCASE(PCD_PLAYERFRAGS):
 			if (activator && activator->player)
 				PushToStack (activator->player->fragcount);
 			else
 				PushToStack (0);
-			break;
+			NEXTPCODE;
 
-		case PCD_MUSICCHANGE:
+		PCASE(PCD_MUSICCHANGE):
 			lookup = Level->Behaviors.LookupString (STACK(2));
 			if (lookup != NULL)
 			{
 				S_ChangeMusic (lookup, STACK(1));
 			}
 			sp -= 2;
-			break;
+			NEXTPCODE;
 
-		case PCD_SINGLEPLAYER:
+		PCASE(PCD_SINGLEPLAYER):
 			PushToStack (!multiplayer);
-			break;
+			NEXTPCODE;
 // [BC] End ST PCD's
 
-		case PCD_TIMER:
+		PCASE(PCD_TIMER):
 			PushToStack (Level->time);
-			break;
+			NEXTPCODE;
 
-		case PCD_SECTORSOUND:
+		PCASE(PCD_SECTORSOUND):
 			lookup = Level->Behaviors.LookupString (STACK(2));
 			if (lookup != NULL)
 			{
@@ -8976,9 +10258,9 @@ scriptwait:
 				}
 			}
 			sp -= 2;
-			break;
+			NEXTPCODE;
 
-		case PCD_AMBIENTSOUND:
+		PCASE(PCD_AMBIENTSOUND):
 			lookup = Level->Behaviors.LookupString (STACK(2));
 			if (lookup != NULL)
 			{
@@ -8987,9 +10269,9 @@ scriptwait:
 						 (float)(STACK(1)) / 127.f, ATTN_NONE);
 			}
 			sp -= 2;
-			break;
+			NEXTPCODE;
 
-		case PCD_LOCALAMBIENTSOUND:
+		PCASE(PCD_LOCALAMBIENTSOUND):
 			lookup = Level->Behaviors.LookupString (STACK(2));
 			if (lookup != NULL && activator && activator->CheckLocalView())
 			{
@@ -8998,9 +10280,9 @@ scriptwait:
 						 (float)(STACK(1)) / 127.f, ATTN_NONE);
 			}
 			sp -= 2;
-			break;
+			NEXTPCODE;
 
-		case PCD_ACTIVATORSOUND:
+		PCASE(PCD_ACTIVATORSOUND):
 			lookup = Level->Behaviors.LookupString (STACK(2));
 			if (lookup != NULL)
 			{
@@ -9018,9 +10300,9 @@ scriptwait:
 				}
 			}
 			sp -= 2;
-			break;
+			NEXTPCODE;
 
-		case PCD_SOUNDSEQUENCE:
+		PCASE(PCD_SOUNDSEQUENCE):
 			lookup = Level->Behaviors.LookupString (STACK(1));
 			if (lookup != NULL)
 			{
@@ -9030,14 +10312,14 @@ scriptwait:
 				}
 			}
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_SETLINETEXTURE:
+		PCASE(PCD_SETLINETEXTURE):
 			SetLineTexture (STACK(4), STACK(3), STACK(2), STACK(1));
 			sp -= 4;
-			break;
+			NEXTPCODE;
 
-		case PCD_REPLACETEXTURES:
+		PCASE(PCD_REPLACETEXTURES):
 		{
 			const char *fromname = Level->Behaviors.LookupString(STACK(3));
 			const char *toname = Level->Behaviors.LookupString(STACK(2));
@@ -9047,7 +10329,7 @@ scriptwait:
 			break;
 		}
 
-		case PCD_SETLINEBLOCKING:
+		PCASE(PCD_SETLINEBLOCKING):
 			{
 				int lineno;
 
@@ -9082,9 +10364,9 @@ scriptwait:
 
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_SETLINEMONSTERBLOCKING:
+		PCASE(PCD_SETLINEMONSTERBLOCKING):
 			{
 				int line;
 
@@ -9099,9 +10381,9 @@ scriptwait:
 
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_SETLINESPECIAL:
+		PCASE(PCD_SETLINESPECIAL):
 			{
 				int linenum = -1;
 				int specnum = STACK(6);
@@ -9129,9 +10411,9 @@ scriptwait:
 				}
 				sp -= 7;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_SETTHINGSPECIAL:
+		PCASE(PCD_SETTHINGSPECIAL):
 			{
 				int specnum = STACK(6);
 				int arg0 = STACK(5);
@@ -9169,9 +10451,9 @@ scriptwait:
 				}
 				sp -= 7;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_THINGSOUND:
+		PCASE(PCD_THINGSOUND):
 			lookup = Level->Behaviors.LookupString (STACK(2));
 			if (lookup != NULL)
 			{
@@ -9186,14 +10468,14 @@ scriptwait:
 				}
 			}
 			sp -= 3;
-			break;
+			NEXTPCODE;
 
-		case PCD_FIXEDMUL:
+		PCASE(PCD_FIXEDMUL):
 			STACK(2) = MulScale(STACK(2), STACK(1), 16);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_FIXEDDIV:
+		PCASE(PCD_FIXEDDIV):
 		{
 			int a = STACK(2), b = STACK(1);
 			// Overflow check.
@@ -9202,58 +10484,58 @@ scriptwait:
 			sp--;
 			break;
 		}
-		case PCD_SETGRAVITY:
+		PCASE(PCD_SETGRAVITY):
 			Level->gravity = ACSToDouble(STACK(1));
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_SETGRAVITYDIRECT:
+		PCASE(PCD_SETGRAVITYDIRECT):
 			Level->gravity = ACSToDouble(uallong(pc[0]));
 			pc++;
-			break;
+			NEXTPCODE;
 
-		case PCD_SETAIRCONTROL:
+		PCASE(PCD_SETAIRCONTROL):
 			Level->aircontrol = ACSToDouble(STACK(1));
 			sp--;
 			Level->AirControlChanged ();
-			break;
+			NEXTPCODE;
 
-		case PCD_SETAIRCONTROLDIRECT:
+		PCASE(PCD_SETAIRCONTROLDIRECT):
 			Level->aircontrol = ACSToDouble(uallong(pc[0]));
 			pc++;
 			Level->AirControlChanged ();
-			break;
+			NEXTPCODE;
 
-		case PCD_SPAWN:
+		PCASE(PCD_SPAWN):
 			STACK(6) = DoSpawn (STACK(6), STACK(5), STACK(4), STACK(3), STACK(2), STACK(1), false);
 			sp -= 5;
-			break;
+			NEXTPCODE;
 
-		case PCD_SPAWNDIRECT:
+		PCASE(PCD_SPAWNDIRECT):
 			PushToStack (DoSpawn (TAGSTR(uallong(pc[0])), uallong(pc[1]), uallong(pc[2]), uallong(pc[3]), uallong(pc[4]), uallong(pc[5]), false));
 			pc += 6;
-			break;
+			NEXTPCODE;
 
-		case PCD_SPAWNSPOT:
+		PCASE(PCD_SPAWNSPOT):
 			STACK(4) = DoSpawnSpot (STACK(4), STACK(3), STACK(2), STACK(1), false);
 			sp -= 3;
-			break;
+			NEXTPCODE;
 
-		case PCD_SPAWNSPOTDIRECT:
+		PCASE(PCD_SPAWNSPOTDIRECT):
 			PushToStack (DoSpawnSpot (TAGSTR(uallong(pc[0])), uallong(pc[1]), uallong(pc[2]), uallong(pc[3]), false));
 			pc += 4;
-			break;
+			NEXTPCODE;
 
-		case PCD_SPAWNSPOTFACING:
+		PCASE(PCD_SPAWNSPOTFACING):
 			STACK(3) = DoSpawnSpotFacing (STACK(3), STACK(2), STACK(1), false);
 			sp -= 2;
-			break;
+			NEXTPCODE;
 
-		case PCD_CLEARINVENTORY:
+		PCASE(PCD_CLEARINVENTORY):
 			ScriptUtil::Exec(NAME_ClearInventory, ScriptUtil::Pointer, activator.Get(), ScriptUtil::End);
-			break;
+			NEXTPCODE;
 
-		case PCD_CLEARACTORINVENTORY:
+		PCASE(PCD_CLEARACTORINVENTORY):
 			if (STACK(1) == 0)
 			{
 				ScriptUtil::Exec(NAME_ClearInventory, ScriptUtil::Pointer, nullptr, ScriptUtil::End);
@@ -9268,9 +10550,9 @@ scriptwait:
 				}
 			}
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_GIVEINVENTORY:
+		PCASE(PCD_GIVEINVENTORY):
 		{
 			int typeindex = FName(Level->Behaviors.LookupString(STACK(2))).GetIndex();
 			ScriptUtil::Exec(NAME_GiveInventory, ScriptUtil::Pointer, activator.Get(), ScriptUtil::Int, typeindex, ScriptUtil::Int, STACK(1), ScriptUtil::End);
@@ -9278,7 +10560,7 @@ scriptwait:
 			break;
 		}
 
-		case PCD_GIVEACTORINVENTORY:
+		PCASE(PCD_GIVEACTORINVENTORY):
 		{
 			int typeindex = FName(Level->Behaviors.LookupString(STACK(2))).GetIndex();
 			FName type = FName(Level->Behaviors.LookupString(STACK(2)));
@@ -9299,7 +10581,7 @@ scriptwait:
 			break;
 		}
 
-		case PCD_GIVEINVENTORYDIRECT:
+		PCASE(PCD_GIVEINVENTORYDIRECT):
 		{
 			int typeindex = FName(Level->Behaviors.LookupString(TAGSTR(uallong(pc[0])))).GetIndex();
 			ScriptUtil::Exec(NAME_GiveInventory, ScriptUtil::Pointer, activator.Get(), ScriptUtil::Int, typeindex, ScriptUtil::Int, uallong(pc[1]), ScriptUtil::End);
@@ -9307,7 +10589,7 @@ scriptwait:
 			break;
 		}
 
-		case PCD_TAKEINVENTORY:
+		PCASE(PCD_TAKEINVENTORY):
 		{
 			int typeindex = FName(Level->Behaviors.LookupString(STACK(2))).GetIndex();
 			ScriptUtil::Exec(NAME_TakeInventory, ScriptUtil::Pointer, activator.Get(), ScriptUtil::Int, typeindex, ScriptUtil::Int, STACK(1), ScriptUtil::End);
@@ -9315,7 +10597,7 @@ scriptwait:
 			break;
 		}
 
-		case PCD_TAKEACTORINVENTORY:
+		PCASE(PCD_TAKEACTORINVENTORY):
 		{
 			int typeindex = FName(Level->Behaviors.LookupString(STACK(2))).GetIndex();
 			FName type = FName(Level->Behaviors.LookupString(STACK(2)));
@@ -9336,7 +10618,7 @@ scriptwait:
 			break;
 		}
 
-		case PCD_TAKEINVENTORYDIRECT:
+		PCASE(PCD_TAKEINVENTORYDIRECT):
 		{
 			int typeindex = FName(Level->Behaviors.LookupString(TAGSTR(uallong(pc[0])))).GetIndex();
 			ScriptUtil::Exec(NAME_TakeInventory, ScriptUtil::Pointer, activator.Get(), ScriptUtil::Int, typeindex, ScriptUtil::Int, uallong(pc[1]), ScriptUtil::End);
@@ -9344,26 +10626,26 @@ scriptwait:
 			break;
 		}
 
-		case PCD_CHECKINVENTORY:
+		PCASE(PCD_CHECKINVENTORY):
 			STACK(1) = CheckInventory (activator, Level->Behaviors.LookupString (STACK(1)), false);
-			break;
+			NEXTPCODE;
 
-		case PCD_CHECKACTORINVENTORY:
+		PCASE(PCD_CHECKACTORINVENTORY):
 			STACK(2) = CheckInventory (Level->SingleActorFromTID(STACK(2), NULL),
 										Level->Behaviors.LookupString (STACK(1)), false);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_CHECKINVENTORYDIRECT:
+		PCASE(PCD_CHECKINVENTORYDIRECT):
 			PushToStack (CheckInventory (activator, Level->Behaviors.LookupString (TAGSTR(uallong(pc[0]))), false));
 			pc += 1;
-			break;
+			NEXTPCODE;
 
-		case PCD_USEINVENTORY:
+		PCASE(PCD_USEINVENTORY):
 			STACK(1) = UseInventory (Level, activator, Level->Behaviors.LookupString (STACK(1)));
-			break;
+			NEXTPCODE;
 
-		case PCD_USEACTORINVENTORY:
+		PCASE(PCD_USEACTORINVENTORY):
 			{
 				int ret = 0;
 				const char *type = Level->Behaviors.LookupString(STACK(1));
@@ -9383,9 +10665,9 @@ scriptwait:
 				STACK(2) = ret;
 				sp--;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_GETSIGILPIECES:
+		PCASE(PCD_GETSIGILPIECES):
 			{
 				AActor *sigil;
 
@@ -9398,9 +10680,9 @@ scriptwait:
 					PushToStack (sigil->health);
 				}
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_GETAMMOCAPACITY:
+		PCASE(PCD_GETAMMOCAPACITY):
 			if (activator != NULL)
 			{
 				PClass *type = PClass::FindClass (Level->Behaviors.LookupString (STACK(1)));
@@ -9426,9 +10708,9 @@ scriptwait:
 			{
 				STACK(1) = 0;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_SETAMMOCAPACITY:
+		PCASE(PCD_SETAMMOCAPACITY):
 			if (activator != NULL)
 			{
 				PClassActor *type = PClass::FindActor (Level->Behaviors.LookupString (STACK(2)));
@@ -9452,46 +10734,46 @@ scriptwait:
 				}
 			}
 			sp -= 2;
-			break;
+			NEXTPCODE;
 
-		case PCD_SETMUSIC:
+		PCASE(PCD_SETMUSIC):
 			S_ChangeMusic (Level->Behaviors.LookupString (STACK(3)), STACK(2));
 			sp -= 3;
-			break;
+			NEXTPCODE;
 
-		case PCD_SETMUSICDIRECT:
+		PCASE(PCD_SETMUSICDIRECT):
 			S_ChangeMusic (Level->Behaviors.LookupString (TAGSTR(uallong(pc[0]))), uallong(pc[1]));
 			pc += 3;
-			break;
+			NEXTPCODE;
 
-		case PCD_LOCALSETMUSIC:
+		PCASE(PCD_LOCALSETMUSIC):
 			if (Level->isConsolePlayer(activator))
 			{
 				S_ChangeMusic (Level->Behaviors.LookupString (STACK(3)), STACK(2));
 			}
 			sp -= 3;
-			break;
+			NEXTPCODE;
 
-		case PCD_LOCALSETMUSICDIRECT:
+		PCASE(PCD_LOCALSETMUSICDIRECT):
 			if (Level->isConsolePlayer(activator))
 			{
 				S_ChangeMusic (Level->Behaviors.LookupString (TAGSTR(uallong(pc[0]))), uallong(pc[1]));
 			}
 			pc += 3;
-			break;
+			NEXTPCODE;
 
-		case PCD_FADETO:
+		PCASE(PCD_FADETO):
 			DoFadeTo (STACK(5), STACK(4), STACK(3), STACK(2), STACK(1));
 			sp -= 5;
-			break;
+			NEXTPCODE;
 
-		case PCD_FADERANGE:
+		PCASE(PCD_FADERANGE):
 			DoFadeRange (STACK(9), STACK(8), STACK(7), STACK(6),
 						 STACK(5), STACK(4), STACK(3), STACK(2), STACK(1));
 			sp -= 9;
-			break;
+			NEXTPCODE;
 
-		case PCD_CANCELFADE:
+		PCASE(PCD_CANCELFADE):
 			{
 				auto iterator = Level->GetThinkerIterator<DFlashFader>();
 				DFlashFader *fader;
@@ -9504,13 +10786,13 @@ scriptwait:
 					}
 				}
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_PLAYMOVIE:
+		PCASE(PCD_PLAYMOVIE):
 			STACK(1) = -1;
-			break;
+			NEXTPCODE;
 
-		case PCD_SETACTORPOSITION:
+		PCASE(PCD_SETACTORPOSITION):
 			{
 				bool result = false;
 				AActor *actor = Level->SingleActorFromTID (STACK(5), activator);
@@ -9519,11 +10801,11 @@ scriptwait:
 				sp -= 4;
 				STACK(1) = result;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_GETACTORX:
-		case PCD_GETACTORY:
-		case PCD_GETACTORZ:
+		PCASE(PCD_GETACTORX):
+		PCASE(PCD_GETACTORY):
+		PCASE(PCD_GETACTORZ):
 			{
 				AActor *actor = Level->SingleActorFromTID(STACK(1), activator);
 				if (actor == NULL)
@@ -9539,37 +10821,37 @@ scriptwait:
 					STACK(1) = DoubleToACS(pcd == PCD_GETACTORX ? actor->X() : actor->Y());
 				}
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_GETACTORFLOORZ:
+		PCASE(PCD_GETACTORFLOORZ):
 			{
 				AActor *actor = Level->SingleActorFromTID(STACK(1), activator);
 				STACK(1) = actor == NULL ? 0 : DoubleToACS(actor->floorz);
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_GETACTORCEILINGZ:
+		PCASE(PCD_GETACTORCEILINGZ):
 			{
 				AActor *actor = Level->SingleActorFromTID(STACK(1), activator);
 				STACK(1) = actor == NULL ? 0 : DoubleToACS(actor->ceilingz);
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_GETACTORANGLE:
+		PCASE(PCD_GETACTORANGLE):
 			{
 				AActor *actor = Level->SingleActorFromTID(STACK(1), activator);
 				STACK(1) = actor == NULL ? 0 : AngleToACS(actor->Angles.Yaw);
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_GETACTORPITCH:
+		PCASE(PCD_GETACTORPITCH):
 			{
 				AActor *actor = Level->SingleActorFromTID(STACK(1), activator);
 				STACK(1) = actor == NULL ? 0 : PitchToACS(actor->Angles.Pitch);
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_GETLINEROWOFFSET:
+		PCASE(PCD_GETLINEROWOFFSET):
 			if (activationline != NULL)
 			{
 				PushToStack (int(activationline->sidedef[0]->GetTextureYOffset(side_t::mid)));
@@ -9578,10 +10860,10 @@ scriptwait:
 			{
 				PushToStack (0);
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_GETSECTORFLOORZ:
-		case PCD_GETSECTORCEILINGZ:
+		PCASE(PCD_GETSECTORFLOORZ):
+		PCASE(PCD_GETSECTORCEILINGZ):
 			// Arguments are (tag, x, y). If you don't use slopes, then (x, y) don't
 			// really matter and can be left as (0, 0) if you like.
 			// [Dusk] If tag = 0, then this returns the z height at whatever sector
@@ -9612,9 +10894,9 @@ scriptwait:
 				sp -= 2;
 				STACK(1) = DoubleToACS(z);
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_GETSECTORLIGHTLEVEL:
+		PCASE(PCD_GETSECTORLIGHTLEVEL):
 			{
 				int secnum = Level->FindFirstSectorFromTag (STACK(1));
 				int z = -1;
@@ -9625,10 +10907,10 @@ scriptwait:
 				}
 				STACK(1) = z;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_SETFLOORTRIGGER:
-		case PCD_SETCEILINGTRIGGER:
+		PCASE(PCD_SETFLOORTRIGGER):
+		PCASE(PCD_SETCEILINGTRIGGER):
 		{
 			int secnum = Level->FindFirstSectorFromTag(STACK(8));
 			if (secnum >= 0)
@@ -9641,7 +10923,7 @@ scriptwait:
 			break;
 		}
 
-		case PCD_STARTTRANSLATION:
+		PCASE(PCD_STARTTRANSLATION):
 			{
 				int i = STACK(1);
 				sp--;
@@ -9652,9 +10934,9 @@ scriptwait:
 					transi = i - 1;
 				}
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_TRANSLATIONRANGE1:
+		PCASE(PCD_TRANSLATIONRANGE1):
 			{ // translation using palette shifting
 				int start = STACK(4);
 				int end = STACK(3);
@@ -9665,9 +10947,9 @@ scriptwait:
 				if (translation != NULL)
 					translation->AddIndexRange(start, end, pal1, pal2);
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_TRANSLATIONRANGE2:
+		PCASE(PCD_TRANSLATIONRANGE2):
 			{ // translation using RGB values
 			  // (would HSV be a good idea too?)
 				int start = STACK(8);
@@ -9683,9 +10965,9 @@ scriptwait:
 				if (translation != NULL)
 					translation->AddColorRange(start, end, r1, g1, b1, r2, g2, b2);
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_TRANSLATIONRANGE3:
+		PCASE(PCD_TRANSLATIONRANGE3):
 			{ // translation using desaturation
 				int start = STACK(8);
 				int end = STACK(7);
@@ -9702,9 +10984,9 @@ scriptwait:
 						ACSToDouble(r1), ACSToDouble(g1), ACSToDouble(b1),
 						ACSToDouble(r2), ACSToDouble(g2), ACSToDouble(b2));
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_TRANSLATIONRANGE4:
+		PCASE(PCD_TRANSLATIONRANGE4):
 			{ // Colourise translation
 				int start = STACK(5);
 				int end = STACK(4);
@@ -9716,9 +10998,9 @@ scriptwait:
 				if (translation != NULL)
 					translation->AddColourisation(start, end, r, g, b);
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_TRANSLATIONRANGE5:
+		PCASE(PCD_TRANSLATIONRANGE5):
 			{ // Tint translation
 				int start = STACK(6);
 				int end = STACK(5);
@@ -9731,31 +11013,31 @@ scriptwait:
 				if (translation != NULL)
 					translation->AddTint(start, end, r, g, b, a);
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_ENDTRANSLATION:
+		PCASE(PCD_ENDTRANSLATION):
 			if (translation != NULL)
 			{
 				GPalette.UpdateTranslation(TRANSLATION(TRANSLATION_LevelScripted, transi), translation);
 				delete translation;
 				translation = NULL;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_SIN:
+		PCASE(PCD_SIN):
 			STACK(1) = DoubleToACS(ACSToAngle(STACK(1)).Sin());
-			break;
+			NEXTPCODE;
 
-		case PCD_COS:
+		PCASE(PCD_COS):
 			STACK(1) = DoubleToACS(ACSToAngle(STACK(1)).Cos());
-			break;
+			NEXTPCODE;
 
-		case PCD_VECTORANGLE:
+		PCASE(PCD_VECTORANGLE):
 			STACK(2) = AngleToACS(VecToAngle(STACK(2), STACK(1)));
 			sp--;
-			break;
+			NEXTPCODE;
 
-        case PCD_CHECKWEAPON:
+        PCASE(PCD_CHECKWEAPON):
             if (activator == NULL || activator->player == NULL || // Non-players do not have weapons
                 activator->player->ReadyWeapon == NULL)
             {
@@ -9765,38 +11047,38 @@ scriptwait:
             {
 				STACK(1) = activator->player->ReadyWeapon->GetClass()->TypeName == FName(Level->Behaviors.LookupString (STACK(1)), true);
             }
-            break;
+            NEXTPCODE;
 
-		case PCD_SETWEAPON:
+		PCASE(PCD_SETWEAPON):
 			STACK(1) = ScriptUtil::Exec(NAME_SetWeapon, ScriptUtil::Pointer, activator.Get(), ScriptUtil::Class, GetClassForIndex(STACK(1)), ScriptUtil::End);
-			break;
+			NEXTPCODE;
 
-		case PCD_SETMARINEWEAPON:
+		PCASE(PCD_SETMARINEWEAPON):
 			ScriptUtil::Exec(NAME_SetMarineWeapon, ScriptUtil::Pointer, Level, ScriptUtil::Pointer, activator.Get(), ScriptUtil::Int, STACK(2), ScriptUtil::Int, STACK(1), ScriptUtil::End);
 			sp -= 2;
-			break;
+			NEXTPCODE;
 
-		case PCD_SETMARINESPRITE:
+		PCASE(PCD_SETMARINESPRITE):
 			ScriptUtil::Exec(NAME_SetMarineSprite, ScriptUtil::Pointer, Level, ScriptUtil::Pointer, activator.Get(), ScriptUtil::Int, STACK(2), ScriptUtil::Class, GetClassForIndex(STACK(1)), ScriptUtil::End);
 			sp -= 2;
-			break;
+			NEXTPCODE;
 
-		case PCD_SETACTORPROPERTY:
+		PCASE(PCD_SETACTORPROPERTY):
 			SetActorProperty (STACK(3), STACK(2), STACK(1));
 			sp -= 3;
-			break;
+			NEXTPCODE;
 
-		case PCD_GETACTORPROPERTY:
+		PCASE(PCD_GETACTORPROPERTY):
 			STACK(2) = GetActorProperty (STACK(2), STACK(1));
 			sp -= 1;
-			break;
+			NEXTPCODE;
 
-		case PCD_GETPLAYERINPUT:
+		PCASE(PCD_GETPLAYERINPUT):
 			STACK(2) = GetPlayerInput (STACK(2), STACK(1));
 			sp -= 1;
-			break;
+			NEXTPCODE;
 
-		case PCD_PLAYERNUMBER:
+		PCASE(PCD_PLAYERNUMBER):
 			if (activator == NULL || activator->player == NULL)
 			{
 				PushToStack (-1);
@@ -9805,9 +11087,9 @@ scriptwait:
 			{
 				PushToStack (Level->PlayerNum(activator->player));
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_PLAYERINGAME:
+		PCASE(PCD_PLAYERINGAME):
 			if (STACK(1) < 0 || STACK(1) >= MAXPLAYERS)
 			{
 				STACK(1) = false;
@@ -9816,9 +11098,9 @@ scriptwait:
 			{
 				STACK(1) = Level->PlayerInGame(STACK(1));
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_PLAYERISBOT:
+		PCASE(PCD_PLAYERISBOT):
 			if (STACK(1) < 0 || STACK(1) >= MAXPLAYERS || !Level->PlayerInGame(STACK(1)))
 			{
 				STACK(1) = false;
@@ -9827,9 +11109,9 @@ scriptwait:
 			{
 				STACK(1) = (Level->Players[STACK(1)]->Bot != nullptr);
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_ACTIVATORTID:
+		PCASE(PCD_ACTIVATORTID):
 			if (activator == NULL)
 			{
 				PushToStack (0);
@@ -9838,33 +11120,33 @@ scriptwait:
 			{
 				PushToStack (activator->tid);
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_GETSCREENWIDTH:
+		PCASE(PCD_GETSCREENWIDTH):
 			PushToStack (SCREENWIDTH);
-			break;
+			NEXTPCODE;
 
-		case PCD_GETSCREENHEIGHT:
+		PCASE(PCD_GETSCREENHEIGHT):
 			PushToStack (SCREENHEIGHT);
-			break;
+			NEXTPCODE;
 
-		case PCD_THING_PROJECTILE2:
+		PCASE(PCD_THING_PROJECTILE2):
 			// Like Thing_Projectile(Gravity) specials, but you can give the
 			// projectile a TID.
 			// Thing_Projectile2 (tid, type, angle, speed, vspeed, gravity, newtid);
 			Level->EV_Thing_Projectile(STACK(7), activator, STACK(6), NULL, DAngle::fromDeg(STACK(5) * (360. / 256.)),
 				STACK(4) / 8., STACK(3) / 8., 0, NULL, STACK(2), STACK(1), false);
 			sp -= 7;
-			break;
+			NEXTPCODE;
 
-		case PCD_SPAWNPROJECTILE:
+		PCASE(PCD_SPAWNPROJECTILE):
 			// Same, but takes an actor name instead of a spawn ID.
 			Level->EV_Thing_Projectile(STACK(7), activator, 0, Level->Behaviors.LookupString(STACK(6)), DAngle::fromDeg(STACK(5) * (360. / 256.)),
 				STACK(4) / 8., STACK(3) / 8., 0, NULL, STACK(2), STACK(1), false);
 			sp -= 7;
-			break;
+			NEXTPCODE;
 
-		case PCD_STRLEN:
+		PCASE(PCD_STRLEN):
 			{
 				const char *str = Level->Behaviors.LookupString(STACK(1));
 				if (str != NULL)
@@ -9881,14 +11163,14 @@ scriptwait:
 				}
 				STACK(1) = 0;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_GETCVAR:
+		PCASE(PCD_GETCVAR):
 			// This should not use Level->PlayerNum!
 			STACK(1) = DoGetCVar(GetCVar(activator && activator->player? int(activator->player - players) : -1, Level->Behaviors.LookupString(STACK(1))), false);
-			break;
+			NEXTPCODE;
 
-		case PCD_SETHUDSIZE:
+		PCASE(PCD_SETHUDSIZE):
 			hudwidth = abs (STACK(3));
 			hudheight = abs (STACK(2));
 			if (STACK(1) != 0)
@@ -9896,9 +11178,9 @@ scriptwait:
 				hudheight = -hudheight;
 			}
 			sp -= 3;
-			break;
+			NEXTPCODE;
 
-		case PCD_GETLEVELINFO:
+		PCASE(PCD_GETLEVELINFO):
 			switch (STACK(1))
 			{
 			case LEVELINFO_PAR_TIME:		STACK(1) = Level->partime;			break;
@@ -9913,9 +11195,9 @@ scriptwait:
 			case LEVELINFO_KILLED_MONSTERS:	STACK(1) = Level->killed_monsters;	break;
 			default:						STACK(1) = 0;						break;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_CHANGESKY:
+		PCASE(PCD_CHANGESKY):
 			{
 				const char *sky1name, *sky2name;
 
@@ -9932,9 +11214,9 @@ scriptwait:
 				InitSkyMap (Level);
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_SETCAMERATOTEXTURE:
+		PCASE(PCD_SETCAMERATOTEXTURE):
 			{
 				const char *picname = Level->Behaviors.LookupString (STACK(2));
 				AActor *camera;
@@ -9963,19 +11245,19 @@ scriptwait:
 				}
 				sp -= 3;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_SETACTORANGLE:		// [GRB]
+		PCASE(PCD_SETACTORANGLE):		// [GRB]
 			SetActorAngle(activator, STACK(2), STACK(1), false);
 			sp -= 2;
-			break;
+			NEXTPCODE;
 
-		case PCD_SETACTORPITCH:
+		PCASE(PCD_SETACTORPITCH):
 			SetActorPitch(activator, STACK(2), STACK(1), false);
 			sp -= 2;
-			break;
+			NEXTPCODE;
 
-		case PCD_SETACTORSTATE:
+		PCASE(PCD_SETACTORSTATE):
 			{
 				const char *statename = Level->Behaviors.LookupString (STACK(2));
 				FState *state;
@@ -10015,9 +11297,9 @@ scriptwait:
 				}
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_PLAYERCLASS:		// [GRB]
+		PCASE(PCD_PLAYERCLASS):		// [GRB]
 			if (STACK(1) < 0 || STACK(1) >= MAXPLAYERS || !Level->PlayerInGame(STACK(1)))
 			{
 				STACK(1) = -1;
@@ -10026,9 +11308,9 @@ scriptwait:
 			{
 				STACK(1) = Level->Players[STACK(1)]->CurrentPlayerClass;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_GETPLAYERINFO:		// [GRB]
+		PCASE(PCD_GETPLAYERINFO):		// [GRB]
 			if (STACK(2) < 0 || STACK(2) >= MAXPLAYERS || !Level->PlayerInGame(STACK(2)))
 			{
 				STACK(2) = -1;
@@ -10054,16 +11336,16 @@ scriptwait:
 				}
 			}
 			sp -= 1;
-			break;
+			NEXTPCODE;
 
-		case PCD_CHANGELEVEL:
+		PCASE(PCD_CHANGELEVEL):
 			{
 				Level->ChangeLevel(Level->Behaviors.LookupString(STACK(4)), STACK(3), STACK(2), STACK(1));
 				sp -= 4;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_SECTORDAMAGE:
+		PCASE(PCD_SECTORDAMAGE):
 			{
 				int tag = STACK(5);
 				int amount = STACK(4);
@@ -10075,24 +11357,24 @@ scriptwait:
 
 				P_SectorDamage(Level, tag, amount, type, protectClass, flags);
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_THINGDAMAGE2:
+		PCASE(PCD_THINGDAMAGE2):
 			STACK(3) = Level->EV_Thing_Damage (STACK(3), activator, STACK(2), FName(Level->Behaviors.LookupString(STACK(1))));
 			sp -= 2;
-			break;
+			NEXTPCODE;
 
-		case PCD_CHECKACTORCEILINGTEXTURE:
+		PCASE(PCD_CHECKACTORCEILINGTEXTURE):
 			STACK(2) = DoCheckActorTexture(STACK(2), activator, STACK(1), false);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_CHECKACTORFLOORTEXTURE:
+		PCASE(PCD_CHECKACTORFLOORTEXTURE):
 			STACK(2) = DoCheckActorTexture(STACK(2), activator, STACK(1), true);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_GETACTORLIGHTLEVEL:
+		PCASE(PCD_GETACTORLIGHTLEVEL):
 		{
 			AActor *actor = Level->SingleActorFromTID(STACK(1), activator);
 			if (actor != NULL)
@@ -10122,15 +11404,15 @@ scriptwait:
 			break;
 		}
 
-		case PCD_SETMUGSHOTSTATE:
+		PCASE(PCD_SETMUGSHOTSTATE):
 			if (!multiplayer || (activator != nullptr && activator->CheckLocalView()))
 			{
 				StatusBar->SetMugShotState(Level->Behaviors.LookupString(STACK(1)));
 			}
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_CHECKPLAYERCAMERA:
+		PCASE(PCD_CHECKPLAYERCAMERA):
 			{
 				int playernum = STACK(1);
 
@@ -10144,13 +11426,13 @@ scriptwait:
 					STACK(1) = Level->Players[playernum]->camera->tid;
 				}
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_CLASSIFYACTOR:
+		PCASE(PCD_CLASSIFYACTOR):
 			STACK(1) = DoClassifyActor(STACK(1));
-			break;
+			NEXTPCODE;
 
-		case PCD_MORPHACTOR:
+		PCASE(PCD_MORPHACTOR):
 			{
 				int tag = STACK(7);
 				FName playerclass_name = Level->Behaviors.LookupString(STACK(6));
@@ -10188,9 +11470,9 @@ scriptwait:
 				STACK(7) = changes;
 				sp -= 6;
 			}	
-			break;
+			NEXTPCODE;
 
-		case PCD_UNMORPHACTOR:
+		PCASE(PCD_UNMORPHACTOR):
 			{
 				int tag = STACK(2);
 				bool force = !!STACK(1);
@@ -10219,21 +11501,21 @@ scriptwait:
 				STACK(2) = changes;
 				sp -= 1;
 			}	
-			break;
+			NEXTPCODE;
 
-		case PCD_SAVESTRING:
+		PCASE(PCD_SAVESTRING):
 			// Saves the string
 			{
 				const int str = GlobalACSStrings.AddString(work);
 				PushToStack(str);
 				STRINGBUILDER_FINISH(work);
 			}		
-			break;
+			NEXTPCODE;
 
-		case PCD_STRCPYTOSCRIPTCHRANGE:
-		case PCD_STRCPYTOMAPCHRANGE:
-		case PCD_STRCPYTOWORLDCHRANGE:
-		case PCD_STRCPYTOGLOBALCHRANGE:
+		PCASE(PCD_STRCPYTOSCRIPTCHRANGE):
+		PCASE(PCD_STRCPYTOMAPCHRANGE):
+		PCASE(PCD_STRCPYTOWORLDCHRANGE):
+		PCASE(PCD_STRCPYTOGLOBALCHRANGE):
 			// source: stringid(2); stringoffset(1)
 			// destination: capacity (3); stringoffset(4); arrayid (5); offset(6)
 
@@ -10324,16 +11606,16 @@ scriptwait:
 				}
 				sp -= 5;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_CONSOLECOMMAND:
-		case PCD_CONSOLECOMMANDDIRECT:
+		PCASE(PCD_CONSOLECOMMAND):
+		PCASE(PCD_CONSOLECOMMANDDIRECT):
 			Printf (TEXTCOLOR_RED GAMENAME " doesn't support execution of console commands from scripts\n");
 			if (pcd == PCD_CONSOLECOMMAND)
 				sp -= 3;
 			else
 				pc += 3;
-			break;
+			NEXTPCODE;
  		}
  	}
 
@@ -10347,7 +11629,8 @@ scriptwait:
 		auto scriptptr = activeBehavior->GetScriptPtr(InModuleScriptNumber);
 		if (scriptptr != nullptr)
 		{
-			scriptptr->ProfileData.AddRun(runaway);
+			runtime.Unclock();
+			scriptptr->ProfileData.AddRun(runaway, runtime.TimeMS());
 		}
 		else
 		{
@@ -10669,11 +11952,13 @@ void ACSProfileInfo::Reset()
 	NumRuns = 0;
 	MinInstrPerRun = UINT_MAX;
 	MaxInstrPerRun = 0;
+	TotalTime = 0;
 }
 
-void ACSProfileInfo::AddRun(unsigned int num_instr)
+void ACSProfileInfo::AddRun(unsigned int num_instr, double ms)
 {
 	TotalInstr += num_instr;
+	TotalTime += ms;
 	NumRuns++;
 	if (num_instr < MinInstrPerRun)
 	{
@@ -10773,6 +12058,14 @@ static int sort_by_runs(const void *a_, const void *b_)
 	return b->ProfileData->NumRuns - a->ProfileData->NumRuns;
 }
 
+static int sort_by_time(const void *a_, const void *b_)
+{
+	const ProfileCollector *a = (const ProfileCollector *)a_;
+	const ProfileCollector *b = (const ProfileCollector *)b_;
+
+	return (b->ProfileData->TotalTime > a->ProfileData->TotalTime) - (b->ProfileData->TotalTime < a->ProfileData->TotalTime);
+}
+
 static void ShowProfileData(TArray<ProfileCollector> &profiles, int ilimit,
 	int (*sorter)(const void *, const void *), bool functions)
 {
@@ -10800,8 +12093,8 @@ static void ShowProfileData(TArray<ProfileCollector> &profiles, int ilimit,
 		limit = UINT_MAX;
 	}
 
-	Printf(TEXTCOLOR_YELLOW "Module       %-20s      Total    Runs     Avg     Min     Max\n", typelabels[functions]);
-	Printf(TEXTCOLOR_YELLOW "------------ -------------------- ---------- ------- ------- ------- -------\n");
+	Printf(TEXTCOLOR_YELLOW "Module       %-20s      Total    Runs     Avg     Min     Max  Time (ms)  Avg (ms)\n", typelabels[functions]);
+	Printf(TEXTCOLOR_YELLOW "------------ -------------------- ---------- ------- ------- ------- ------- ---------- ---------\n");
 	for (unsigned int i = 0; i < limit && i < profiles.Size(); ++i)
 	{
 		ProfileCollector *prof = &profiles[i];
@@ -10832,13 +12125,15 @@ static void ShowProfileData(TArray<ProfileCollector> &profiles, int ilimit,
 			mysnprintf(scriptname, sizeof(scriptname), "%s",
 				ScriptPresentation(prof->Module->GetScriptPtr(prof->Index)->Number).GetChars() + 7);
 		}
-		Printf("%-12s %-20s%11llu%8u%8u%8u%8u\n",
+		Printf("%-12s %-20s%11llu%8u%8u%8u%8u%11.3f%10.4f\n",
 			modname, scriptname,
 			prof->ProfileData->TotalInstr,
 			prof->ProfileData->NumRuns,
 			unsigned(prof->ProfileData->TotalInstr / prof->ProfileData->NumRuns),
 			prof->ProfileData->MinInstrPerRun,
-			prof->ProfileData->MaxInstrPerRun
+			prof->ProfileData->MaxInstrPerRun,
+			prof->ProfileData->TotalTime,
+			prof->ProfileData->TotalTime / prof->ProfileData->NumRuns
 			);
 	}
 }
@@ -10851,10 +12146,11 @@ void ACSProfile(FLevelLocals *Level, FCommandLine &argv)
 		sort_by_min,
 		sort_by_max,
 		sort_by_avg,
-		sort_by_runs
+		sort_by_runs,
+		sort_by_time
 	};
-	static const char *sort_names[] = { "total", "min", "max", "avg", "runs" };
-	static const uint8_t sort_match_len[] = {   1,     2,     2,     1,      1 };
+	static const char *sort_names[] = { "total", "min", "max", "avg", "runs", "time" };
+	static const uint8_t sort_match_len[] = {   1,     2,     2,     1,      1,      2 };
 
 		TArray<ProfileCollector> ScriptProfiles, FuncProfiles;
 		int limit = 10;
@@ -10905,7 +12201,7 @@ void ACSProfile(FLevelLocals *Level, FCommandLine &argv)
 			{
 				Printf("Unknown option '%s'\n", argv[i]);
 				Printf("acsprofile clear : Reset profiling information\n");
-				Printf("acsprofile [total|min|max|avg|runs] [<limit>]\n");
+				Printf("acsprofile [total|min|max|avg|runs|time] [<limit>]\n");
 				return;
 			}
 		}
@@ -46,6 +46,7 @@
 class FFont;
 struct line_t;
 class FSerializer;
+class VMScriptFunction;
 
 
 enum
@@ -154,9 +155,10 @@ struct ACSProfileInfo
 	unsigned int NumRuns;
 	unsigned int MinInstrPerRun;
 	unsigned int MaxInstrPerRun;
+	double TotalTime;	// in ms, including called functions
 
 	ACSProfileInfo();
-	void AddRun(unsigned int num_instr);
+	void AddRun(unsigned int num_instr, double ms);
 	void Reset();
 };
 
@@ -260,6 +262,8 @@ struct ScriptPtr
 	uint16_t VarCount;
 	uint16_t Flags;
 	ACSLocalArrays LocalArrays;
+	VMScriptFunction *Compiled = nullptr;	// VM translation of the script body, if acs_jit is on and it could be translated
+	bool Translated = false;
 
 	ACSProfileInfo ProfileData;
 };
@@ -313,6 +317,10 @@ struct ScriptFunction
 	int  LocalCount;
 	uint32_t Address;
 	ACSLocalArrays LocalArrays;
+	VMScriptFunction *Compiled = nullptr;	// VM translation, if acs_jit is on and the function could be translated
+	bool Translated = false;
+	VMScriptFunction *CompiledBody = nullptr;	// resumable translation for running the function in a script
+	bool BodyTranslated = false;
 };
 
 // Script types
@@ -378,6 +386,9 @@ public:
 	const char *GetModuleName() const { return ModuleName; }
 	ACSProfileInfo *GetFunctionProfileData(int index) { return index >= 0 && index < NumFunctions ? &FunctionProfileData[index] : NULL; }
 	ACSProfileInfo *GetFunctionProfileData(ScriptFunction *func) { return GetFunctionProfileData((int)(func - (ScriptFunction *)Functions)); }
+	VMScriptFunction *GetCompiledFunction(ScriptFunction *func);
+	VMScriptFunction *GetCompiledBody(ScriptFunction *func);
+	VMScriptFunction *GetCompiledBody(ScriptPtr *script);
 	const char *LookupString (uint32_t index, bool forprint = false) const;
 
 	BoundsCheckingArray<int32_t *, NUM_MAPVARS> MapVars;
@@ -409,9 +420,11 @@ private:
 	int32_t MapVarStore[NUM_MAPVARS];
 	TArray<FBehavior *> Imports;
 	char ModuleName[9];
+	FString DataHash;
 	TArray<int> JumpPoints;
 
 	void LoadScriptsDirectory ();
+	VMScriptFunction *TranslateCode(uint32_t address, int numargs, int numlocals, int kind);
 
 	static int SortScripts (const void *a, const void *b);
 	void UnencryptStrings ();
@@ -0,0 +1,396 @@
+// P-codes for ACS scripts, in the order in which they are numbered.
+// Include with xx defined to get a list of them.
+
+#ifndef xx
+#define xx(n) n,
+#endif
+
+/*  0*/	xx(PCD_NOP)
+		xx(PCD_TERMINATE)
+		xx(PCD_SUSPEND)
+		xx(PCD_PUSHNUMBER)
+		xx(PCD_LSPEC1)
+		xx(PCD_LSPEC2)
+		xx(PCD_LSPEC3)
+		xx(PCD_LSPEC4)
+		xx(PCD_LSPEC5)
+		xx(PCD_LSPEC1DIRECT)
+/* 10*/	xx(PCD_LSPEC2DIRECT)
+		xx(PCD_LSPEC3DIRECT)
+		xx(PCD_LSPEC4DIRECT)
+		xx(PCD_LSPEC5DIRECT)
+		xx(PCD_ADD)
+		xx(PCD_SUBTRACT)
+		xx(PCD_MULTIPLY)
+		xx(PCD_DIVIDE)
+		xx(PCD_MODULUS)
+		xx(PCD_EQ)
+/* 20*/ xx(PCD_NE)
+		xx(PCD_LT)
+		xx(PCD_GT)
+		xx(PCD_LE)
+		xx(PCD_GE)
+		xx(PCD_ASSIGNSCRIPTVAR)
+		xx(PCD_ASSIGNMAPVAR)
+		xx(PCD_ASSIGNWORLDVAR)
+		xx(PCD_PUSHSCRIPTVAR)
+		xx(PCD_PUSHMAPVAR)
+/* 30*/	xx(PCD_PUSHWORLDVAR)
+		xx(PCD_ADDSCRIPTVAR)
+		xx(PCD_ADDMAPVAR)
+		xx(PCD_ADDWORLDVAR)
+		xx(PCD_SUBSCRIPTVAR)
+		xx(PCD_SUBMAPVAR)
+		xx(PCD_SUBWORLDVAR)
+		xx(PCD_MULSCRIPTVAR)
+		xx(PCD_MULMAPVAR)
+		xx(PCD_MULWORLDVAR)
+/* 40*/	xx(PCD_DIVSCRIPTVAR)
+		xx(PCD_DIVMAPVAR)
+		xx(PCD_DIVWORLDVAR)
+		xx(PCD_MODSCRIPTVAR)
+		xx(PCD_MODMAPVAR)
+		xx(PCD_MODWORLDVAR)
+		xx(PCD_INCSCRIPTVAR)
+		xx(PCD_INCMAPVAR)
+		xx(PCD_INCWORLDVAR)
+		xx(PCD_DECSCRIPTVAR)
+/* 50*/	xx(PCD_DECMAPVAR)
+		xx(PCD_DECWORLDVAR)
+		xx(PCD_GOTO)
+		xx(PCD_IFGOTO)
+		xx(PCD_DROP)
+		xx(PCD_DELAY)
+		xx(PCD_DELAYDIRECT)
+		xx(PCD_RANDOM)
+		xx(PCD_RANDOMDIRECT)
+		xx(PCD_THINGCOUNT)
+/* 60*/	xx(PCD_THINGCOUNTDIRECT)
+		xx(PCD_TAGWAIT)
+		xx(PCD_TAGWAITDIRECT)
+		xx(PCD_POLYWAIT)
+		xx(PCD_POLYWAITDIRECT)
+		xx(PCD_CHANGEFLOOR)
+		xx(PCD_CHANGEFLOORDIRECT)
+		xx(PCD_CHANGECEILING)
+		xx(PCD_CHANGECEILINGDIRECT)
+		xx(PCD_RESTART)
+/* 70*/	xx(PCD_ANDLOGICAL)
+		xx(PCD_ORLOGICAL)
+		xx(PCD_ANDBITWISE)
+		xx(PCD_ORBITWISE)
+		xx(PCD_EORBITWISE)
+		xx(PCD_NEGATELOGICAL)
+		xx(PCD_LSHIFT)
+		xx(PCD_RSHIFT)
+		xx(PCD_UNARYMINUS)
+		xx(PCD_IFNOTGOTO)
+/* 80*/	xx(PCD_LINESIDE)
+		xx(PCD_SCRIPTWAIT)
+		xx(PCD_SCRIPTWAITDIRECT)
+		xx(PCD_CLEARLINESPECIAL)
+		xx(PCD_CASEGOTO)
+		xx(PCD_BEGINPRINT)
+		xx(PCD_ENDPRINT)
+		xx(PCD_PRINTSTRING)
+		xx(PCD_PRINTNUMBER)
+		xx(PCD_PRINTCHARACTER)
+/* 90*/	xx(PCD_PLAYERCOUNT)
+		xx(PCD_GAMETYPE)
+		xx(PCD_GAMESKILL)
+		xx(PCD_TIMER)
+		xx(PCD_SECTORSOUND)
+		xx(PCD_AMBIENTSOUND)
+		xx(PCD_SOUNDSEQUENCE)
+		xx(PCD_SETLINETEXTURE)
+		xx(PCD_SETLINEBLOCKING)
+		xx(PCD_SETLINESPECIAL)
+/*100*/	xx(PCD_THINGSOUND)
+		xx(PCD_ENDPRINTBOLD)		// [RH] End of Hexen p-codes
+		xx(PCD_ACTIVATORSOUND)
+		xx(PCD_LOCALAMBIENTSOUND)
+		xx(PCD_SETLINEMONSTERBLOCKING)
+		xx(PCD_PLAYERBLUESKULL)	// [BC] Start of new [Skull Tag] pcodes
+		xx(PCD_PLAYERREDSKULL)
+		xx(PCD_PLAYERYELLOWSKULL)
+		xx(PCD_PLAYERMASTERSKULL)
+		xx(PCD_PLAYERBLUECARD)
+/*110*/	xx(PCD_PLAYERREDCARD)
+		xx(PCD_PLAYERYELLOWCARD)
+		xx(PCD_PLAYERMASTERCARD)
+		xx(PCD_PLAYERBLACKSKULL)
+		xx(PCD_PLAYERSILVERSKULL)
+		xx(PCD_PLAYERGOLDSKULL)
+		xx(PCD_PLAYERBLACKCARD)
+		xx(PCD_PLAYERSILVERCARD)
+		xx(PCD_ISNETWORKGAME)
+		xx(PCD_PLAYERTEAM)
+/*120*/	xx(PCD_PLAYERHEALTH)
+		xx(PCD_PLAYERARMORPOINTS)
+		xx(PCD_PLAYERFRAGS)
+		xx(PCD_PLAYEREXPERT)
+		xx(PCD_BLUETEAMCOUNT)
+		xx(PCD_REDTEAMCOUNT)
+		xx(PCD_BLUETEAMSCORE)
+		xx(PCD_REDTEAMSCORE)
+		xx(PCD_ISONEFLAGCTF)
+		xx(PCD_LSPEC6)				// These are never used. They should probably
+/*130*/	xx(PCD_LSPEC6DIRECT)		// be given names like PCD_DUMMY.
+		xx(PCD_PRINTNAME)
+		xx(PCD_MUSICCHANGE)
+		xx(PCD_CONSOLECOMMANDDIRECT)
+		xx(PCD_CONSOLECOMMAND)
+		xx(PCD_SINGLEPLAYER)		// [RH] End of Skull Tag p-codes
+		xx(PCD_FIXEDMUL)
+		xx(PCD_FIXEDDIV)
+		xx(PCD_SETGRAVITY)
+		xx(PCD_SETGRAVITYDIRECT)
+/*140*/	xx(PCD_SETAIRCONTROL)
+		xx(PCD_SETAIRCONTROLDIRECT)
+		xx(PCD_CLEARINVENTORY)
+		xx(PCD_GIVEINVENTORY)
+		xx(PCD_GIVEINVENTORYDIRECT)
+		xx(PCD_TAKEINVENTORY)
+		xx(PCD_TAKEINVENTORYDIRECT)
+		xx(PCD_CHECKINVENTORY)
+		xx(PCD_CHECKINVENTORYDIRECT)
+		xx(PCD_SPAWN)
+/*150*/	xx(PCD_SPAWNDIRECT)
+		xx(PCD_SPAWNSPOT)
+		xx(PCD_SPAWNSPOTDIRECT)
+		xx(PCD_SETMUSIC)
+		xx(PCD_SETMUSICDIRECT)
+		xx(PCD_LOCALSETMUSIC)
+		xx(PCD_LOCALSETMUSICDIRECT)
+		xx(PCD_PRINTFIXED)
+		xx(PCD_PRINTLOCALIZED)
+		xx(PCD_MOREHUDMESSAGE)
+/*160*/	xx(PCD_OPTHUDMESSAGE)
+		xx(PCD_ENDHUDMESSAGE)
+		xx(PCD_ENDHUDMESSAGEBOLD)
+		xx(PCD_SETSTYLE)
+		xx(PCD_SETSTYLEDIRECT)
+		xx(PCD_SETFONT)
+		xx(PCD_SETFONTDIRECT)
+		xx(PCD_PUSHBYTE)
+		xx(PCD_LSPEC1DIRECTB)
+		xx(PCD_LSPEC2DIRECTB)
+/*170*/	xx(PCD_LSPEC3DIRECTB)
+		xx(PCD_LSPEC4DIRECTB)
+		xx(PCD_LSPEC5DIRECTB)
+		xx(PCD_DELAYDIRECTB)
+		xx(PCD_RANDOMDIRECTB)
+		xx(PCD_PUSHBYTES)
+		xx(PCD_PUSH2BYTES)
+		xx(PCD_PUSH3BYTES)
+		xx(PCD_PUSH4BYTES)
+		xx(PCD_PUSH5BYTES)
+/*180*/	xx(PCD_SETTHINGSPECIAL)
+		xx(PCD_ASSIGNGLOBALVAR)
+		xx(PCD_PUSHGLOBALVAR)
+		xx(PCD_ADDGLOBALVAR)
+		xx(PCD_SUBGLOBALVAR)
+		xx(PCD_MULGLOBALVAR)
+		xx(PCD_DIVGLOBALVAR)
+		xx(PCD_MODGLOBALVAR)
+		xx(PCD_INCGLOBALVAR)
+		xx(PCD_DECGLOBALVAR)
+/*190*/	xx(PCD_FADETO)
+		xx(PCD_FADERANGE)
+		xx(PCD_CANCELFADE)
+		xx(PCD_PLAYMOVIE)
+		xx(PCD_SETFLOORTRIGGER)
+		xx(PCD_SETCEILINGTRIGGER)
+		xx(PCD_GETACTORX)
+		xx(PCD_GETACTORY)
+		xx(PCD_GETACTORZ)
+		xx(PCD_STARTTRANSLATION)
+/*200*/	xx(PCD_TRANSLATIONRANGE1)
+		xx(PCD_TRANSLATIONRANGE2)
+		xx(PCD_ENDTRANSLATION)
+		xx(PCD_CALL)
+		xx(PCD_CALLDISCARD)
+		xx(PCD_RETURNVOID)
+		xx(PCD_RETURNVAL)
+		xx(PCD_PUSHMAPARRAY)
+		xx(PCD_ASSIGNMAPARRAY)
+		xx(PCD_ADDMAPARRAY)
+/*210*/	xx(PCD_SUBMAPARRAY)
+		xx(PCD_MULMAPARRAY)
+		xx(PCD_DIVMAPARRAY)
+		xx(PCD_MODMAPARRAY)
+		xx(PCD_INCMAPARRAY)
+		xx(PCD_DECMAPARRAY)
+		xx(PCD_DUP)
+		xx(PCD_SWAP)
+		xx(PCD_WRITETOINI)
+		xx(PCD_GETFROMINI)
+/*220*/ xx(PCD_SIN)
+		xx(PCD_COS)
+		xx(PCD_VECTORANGLE)
+		xx(PCD_CHECKWEAPON)
+		xx(PCD_SETWEAPON)
+		xx(PCD_TAGSTRING)
+		xx(PCD_PUSHWORLDARRAY)
+		xx(PCD_ASSIGNWORLDARRAY)
+		xx(PCD_ADDWORLDARRAY)
+		xx(PCD_SUBWORLDARRAY)
+/*230*/	xx(PCD_MULWORLDARRAY)
+		xx(PCD_DIVWORLDARRAY)
+		xx(PCD_MODWORLDARRAY)
+		xx(PCD_INCWORLDARRAY)
+		xx(PCD_DECWORLDARRAY)
+		xx(PCD_PUSHGLOBALARRAY)
+		xx(PCD_ASSIGNGLOBALARRAY)
+		xx(PCD_ADDGLOBALARRAY)
+		xx(PCD_SUBGLOBALARRAY)
+		xx(PCD_MULGLOBALARRAY)
+/*240*/	xx(PCD_DIVGLOBALARRAY)
+		xx(PCD_MODGLOBALARRAY)
+		xx(PCD_INCGLOBALARRAY)
+		xx(PCD_DECGLOBALARRAY)
+		xx(PCD_SETMARINEWEAPON)
+		xx(PCD_SETACTORPROPERTY)
+		xx(PCD_GETACTORPROPERTY)
+		xx(PCD_PLAYERNUMBER)
+		xx(PCD_ACTIVATORTID)
+		xx(PCD_SETMARINESPRITE)
+/*250*/	xx(PCD_GETSCREENWIDTH)
+		xx(PCD_GETSCREENHEIGHT)
+		xx(PCD_THING_PROJECTILE2)
+		xx(PCD_STRLEN)
+		xx(PCD_SETHUDSIZE)
+		xx(PCD_GETCVAR)
+		xx(PCD_CASEGOTOSORTED)
+		xx(PCD_SETRESULTVALUE)
+		xx(PCD_GETLINEROWOFFSET)
+		xx(PCD_GETACTORFLOORZ)
+/*260*/	xx(PCD_GETACTORANGLE)
+		xx(PCD_GETSECTORFLOORZ)
+		xx(PCD_GETSECTORCEILINGZ)
+		xx(PCD_LSPEC5RESULT)
+		xx(PCD_GETSIGILPIECES)
+		xx(PCD_GETLEVELINFO)
+		xx(PCD_CHANGESKY)
+		xx(PCD_PLAYERINGAME)
+		xx(PCD_PLAYERISBOT)
+		xx(PCD_SETCAMERATOTEXTURE)
+/*270*/	xx(PCD_ENDLOG)
+		xx(PCD_GETAMMOCAPACITY)
+		xx(PCD_SETAMMOCAPACITY)
+		xx(PCD_PRINTMAPCHARARRAY)		// [JB] start of new p-codes
+		xx(PCD_PRINTWORLDCHARARRAY)
+		xx(PCD_PRINTGLOBALCHARARRAY)	// [JB] end of new p-codes
+		xx(PCD_SETACTORANGLE)			// [GRB]
+		xx(PCD_GRABINPUT)				// Unused but acc defines them
+		xx(PCD_SETMOUSEPOINTER)		// "
+		xx(PCD_MOVEMOUSEPOINTER)		// "
+/*280*/	xx(PCD_SPAWNPROJECTILE)
+		xx(PCD_GETSECTORLIGHTLEVEL)
+		xx(PCD_GETACTORCEILINGZ)
+		xx(PCD_SETACTORPOSITION)
+		xx(PCD_CLEARACTORINVENTORY)
+		xx(PCD_GIVEACTORINVENTORY)
+		xx(PCD_TAKEACTORINVENTORY)
+		xx(PCD_CHECKACTORINVENTORY)
+		xx(PCD_THINGCOUNTNAME)
+		xx(PCD_SPAWNSPOTFACING)
+/*290*/	xx(PCD_PLAYERCLASS)			// [GRB]
+		//[MW] start my p-codes
+		xx(PCD_ANDSCRIPTVAR)
+		xx(PCD_ANDMAPVAR) 
+		xx(PCD_ANDWORLDVAR) 
+		xx(PCD_ANDGLOBALVAR) 
+		xx(PCD_ANDMAPARRAY) 
+		xx(PCD_ANDWORLDARRAY) 
+		xx(PCD_ANDGLOBALARRAY)
+		xx(PCD_EORSCRIPTVAR) 
+		xx(PCD_EORMAPVAR) 
+/*300*/	xx(PCD_EORWORLDVAR) 
+		xx(PCD_EORGLOBALVAR) 
+		xx(PCD_EORMAPARRAY) 
+		xx(PCD_EORWORLDARRAY) 
+		xx(PCD_EORGLOBALARRAY)
+		xx(PCD_ORSCRIPTVAR) 
+		xx(PCD_ORMAPVAR) 
+		xx(PCD_ORWORLDVAR) 
+		xx(PCD_ORGLOBALVAR) 
+		xx(PCD_ORMAPARRAY) 
+/*310*/	xx(PCD_ORWORLDARRAY) 
+		xx(PCD_ORGLOBALARRAY)
+		xx(PCD_LSSCRIPTVAR) 
+		xx(PCD_LSMAPVAR) 
+		xx(PCD_LSWORLDVAR) 
+		xx(PCD_LSGLOBALVAR) 
+		xx(PCD_LSMAPARRAY) 
+		xx(PCD_LSWORLDARRAY) 
+		xx(PCD_LSGLOBALARRAY)
+		xx(PCD_RSSCRIPTVAR) 
+/*320*/	xx(PCD_RSMAPVAR) 
+		xx(PCD_RSWORLDVAR) 
+		xx(PCD_RSGLOBALVAR) 
+		xx(PCD_RSMAPARRAY) 
+		xx(PCD_RSWORLDARRAY) 
+		xx(PCD_RSGLOBALARRAY) 
+		//[MW] end my p-codes
+		xx(PCD_GETPLAYERINFO)			// [GRB]
+		xx(PCD_CHANGELEVEL)
+		xx(PCD_SECTORDAMAGE)
+		xx(PCD_REPLACETEXTURES)
+/*330*/	xx(PCD_NEGATEBINARY)
+		xx(PCD_GETACTORPITCH)
+		xx(PCD_SETACTORPITCH)
+		xx(PCD_PRINTBIND)
+		xx(PCD_SETACTORSTATE)
+		xx(PCD_THINGDAMAGE2)
+		xx(PCD_USEINVENTORY)
+		xx(PCD_USEACTORINVENTORY)
+		xx(PCD_CHECKACTORCEILINGTEXTURE)
+		xx(PCD_CHECKACTORFLOORTEXTURE)
+/*340*/	xx(PCD_GETACTORLIGHTLEVEL)
+		xx(PCD_SETMUGSHOTSTATE)
+		xx(PCD_THINGCOUNTSECTOR)
+		xx(PCD_THINGCOUNTNAMESECTOR)
+		xx(PCD_CHECKPLAYERCAMERA)		// [TN]
+		xx(PCD_MORPHACTOR)				// [MH]
+		xx(PCD_UNMORPHACTOR)			// [MH]
+		xx(PCD_GETPLAYERINPUT)
+		xx(PCD_CLASSIFYACTOR)
+		xx(PCD_PRINTBINARY)
+/*350*/	xx(PCD_PRINTHEX)
+		xx(PCD_CALLFUNC)
+		xx(PCD_SAVESTRING)			// [FDARI] create string (temporary)
+		xx(PCD_PRINTMAPCHRANGE)	// [FDARI] output range (print part of array)
+		xx(PCD_PRINTWORLDCHRANGE)
+		xx(PCD_PRINTGLOBALCHRANGE)
+		xx(PCD_STRCPYTOMAPCHRANGE)	// [FDARI] input range (copy string to all/part of array)
+		xx(PCD_STRCPYTOWORLDCHRANGE)
+		xx(PCD_STRCPYTOGLOBALCHRANGE)
+		xx(PCD_PUSHFUNCTION)		// from Eternity
+/*360*/	xx(PCD_CALLSTACK)			// from Eternity
+		xx(PCD_SCRIPTWAITNAMED)
+		xx(PCD_TRANSLATIONRANGE3)
+		xx(PCD_GOTOSTACK)
+		xx(PCD_ASSIGNSCRIPTARRAY)
+		xx(PCD_PUSHSCRIPTARRAY)
+		xx(PCD_ADDSCRIPTARRAY)
+		xx(PCD_SUBSCRIPTARRAY)
+		xx(PCD_MULSCRIPTARRAY)
+		xx(PCD_DIVSCRIPTARRAY)
+/*370*/	xx(PCD_MODSCRIPTARRAY)
+		xx(PCD_INCSCRIPTARRAY)
+		xx(PCD_DECSCRIPTARRAY)
+		xx(PCD_ANDSCRIPTARRAY)
+		xx(PCD_EORSCRIPTARRAY)
+		xx(PCD_ORSCRIPTARRAY)
+		xx(PCD_LSSCRIPTARRAY)
+		xx(PCD_RSSCRIPTARRAY)
+		xx(PCD_PRINTSCRIPTCHARARRAY)
+		xx(PCD_PRINTSCRIPTCHRANGE)
+/*380*/	xx(PCD_STRCPYTOSCRIPTCHRANGE)
+		xx(PCD_LSPEC5EX)
+		xx(PCD_LSPEC5EXRESULT)
+		xx(PCD_TRANSLATIONRANGE4)
+		xx(PCD_TRANSLATIONRANGE5)
+
+#undef xx
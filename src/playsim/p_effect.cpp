@@ -54,6 +54,10 @@
 
 #include "hwrenderer/scene/hw_drawstructs.h"
 
+#ifndef NO_SSE
+#include <immintrin.h>
+#endif
+
 #ifdef _MSC_VER
 #pragma warning(disable: 6011) // dereference null pointer in thinker iterator
 #endif
@@ -67,6 +71,8 @@ EXTERN_CVAR(Int, r_maxparticles);
 
 FCRandom pr_railtrail("RailTrail");
 
+cycle_t ParticleCycles;
+
 #define FADEFROMTTL(a)	(1.f/(a))
 
 static int grey1, grey2, grey3, grey4, red, green, blue, yellow, black,
@@ -107,59 +113,131 @@ static const struct ColorList {
 	{NULL, 0, 0, 0 }
 };
 
-static void FreeParticle(FLevelLocals* Level, particle_t* particle)
+//==========================================================================
+//
+// Particle storage helpers
+//
+//==========================================================================
+
+static void ResizeParticleStorage(FParticleStorage &pd, unsigned slots)
 {
-	auto prev = particle->tprev == NO_PARTICLE? nullptr : &Level->Particles[particle->tprev];
-	int pindex = (int)(particle - Level->Particles.Data());
-	auto tnext = particle->tnext;
-	assert(!prev || (prev->tnext == pindex));
-	if (prev)
-		prev->tnext = tnext;
-	else
-		Level->ActiveParticles = tnext;
+	pd.PosX.Resize(slots);
+	pd.PosY.Resize(slots);
+	pd.PosZ.Resize(slots);
+	pd.VelX.Resize(slots);
+	pd.VelY.Resize(slots);
+	pd.VelZ.Resize(slots);
+	pd.AccX.Resize(slots);
+	pd.AccY.Resize(slots);
+	pd.AccZ.Resize(slots);
+	pd.Alpha.Resize(slots);
+	pd.FadeStep.Resize(slots);
+	pd.Size.Resize(slots);
+	pd.SizeStep.Resize(slots);
+	pd.Roll.Resize(slots);
+	pd.RollVel.Resize(slots);
+	pd.RollAcc.Resize(slots);
+	pd.Ttl.Resize(slots);
+	pd.Subsector.Resize(slots);
+	pd.Attribs.Resize(slots);
+}
 
-	if (tnext != NO_PARTICLE)
+// Fresh particles get set up through their particle_t record by the spawning code,
+// so their state needs to be copied into the simulation arrays before it can be used.
+static void SyncNewParticles(FParticleStorage &pd)
+{
+	for (unsigned i = pd.FirstNew; i < pd.Count; i++)
 	{
-		particle_t* next = &Level->Particles[tnext];
-		assert(next->tprev == pindex);
-		next->tprev = particle->tprev;
+		const particle_t &p = pd.Attribs[i];
+		pd.PosX[i] = p.Pos.X;
+		pd.PosY[i] = p.Pos.Y;
+		pd.PosZ[i] = p.Pos.Z;
+		pd.VelX[i] = p.Vel.X;
+		pd.VelY[i] = p.Vel.Y;
+		pd.VelZ[i] = p.Vel.Z;
+		pd.AccX[i] = p.Acc.X;
+		pd.AccY[i] = p.Acc.Y;
+		pd.AccZ[i] = p.Acc.Z;
+		pd.Alpha[i] = p.alpha;
+		pd.FadeStep[i] = p.fadestep;
+		pd.Size[i] = p.size;
+		pd.SizeStep[i] = p.sizestep;
+		pd.Roll[i] = p.Roll;
+		pd.RollVel[i] = p.RollVel;
+		pd.RollAcc[i] = p.RollAcc;
+		pd.Ttl[i] = p.ttl;
+		pd.Subsector[i] = p.subsector;
 	}
-	if (Level->OldestParticle == pindex)
+	pd.FirstNew = pd.Count;
+}
+
+static void MoveParticle(FParticleStorage &pd, unsigned from, unsigned to)
+{
+	pd.PosX[to] = pd.PosX[from];
+	pd.PosY[to] = pd.PosY[from];
+	pd.PosZ[to] = pd.PosZ[from];
+	pd.VelX[to] = pd.VelX[from];
+	pd.VelY[to] = pd.VelY[from];
+	pd.VelZ[to] = pd.VelZ[from];
+	pd.AccX[to] = pd.AccX[from];
+	pd.AccY[to] = pd.AccY[from];
+	pd.AccZ[to] = pd.AccZ[from];
+	pd.Alpha[to] = pd.Alpha[from];
+	pd.FadeStep[to] = pd.FadeStep[from];
+	pd.Size[to] = pd.Size[from];
+	pd.SizeStep[to] = pd.SizeStep[from];
+	pd.Roll[to] = pd.Roll[from];
+	pd.RollVel[to] = pd.RollVel[from];
+	pd.RollAcc[to] = pd.RollAcc[from];
+	pd.Ttl[to] = pd.Ttl[from];
+	pd.Subsector[to] = pd.Subsector[from];
+	pd.Attribs[to] = pd.Attribs[from];
+}
+
+// Removes all dead particles while keeping the spawn order intact.
+static void CompactParticles(FParticleStorage &pd)
+{
+	SyncNewParticles(pd);
+
+	unsigned dest = 0;
+	for (unsigned i = 0; i < pd.Count; i++)
 	{
-		assert(tnext == NO_PARTICLE);
-		Level->OldestParticle = particle->tprev;
+		if (pd.Ttl[i] > 0)
+		{
+			if (dest != i) MoveParticle(pd, i, dest);
+			dest++;
+		}
 	}
-	memset(particle, 0, sizeof(particle_t));
-	particle->tnext = Level->InactiveParticles;
-	Level->InactiveParticles = pindex;
+	pd.Count = pd.FirstNew = dest;
+	pd.ReplaceCursor = 0;
+	pd.RenderDirty = true;
 }
 
 static particle_t *NewParticle (FLevelLocals *Level, bool replace = false)
 {
+	auto &pd = Level->ParticleData;
+	if (pd.Capacity == 0)
+		return nullptr;
+
 	// Array's filled up
-	if (Level->InactiveParticles == NO_PARTICLE && Level->OldestParticle != NO_PARTICLE)
+	if (pd.LiveCount() >= pd.Capacity)
 	{
 		if (!replace) return nullptr;
-		FreeParticle(Level, &Level->Particles[Level->OldestParticle]);
-	}
-	
-	// Array isn't full.
-	uint32_t current = Level->ActiveParticles;
-	auto result = &Level->Particles[Level->InactiveParticles];
-	Level->InactiveParticles = result->tnext;
-	result->tnext = current;
-	result->tprev = NO_PARTICLE;
-	Level->ActiveParticles = uint32_t(result - Level->Particles.Data());
-
-	if (current != NO_PARTICLE) // More than one active particles
-	{
-		particle_t* next = &Level->Particles[current];
-		next->tprev = Level->ActiveParticles;
+
+		// Kill the oldest particle. Its slot gets reclaimed by the next compaction.
+		if (pd.ReplaceCursor >= pd.FirstNew) SyncNewParticles(pd);
+		pd.Ttl[pd.ReplaceCursor++] = 0;
 	}
-	else // Just one active particle
+
+	// Out of free slots because of too many replacements since the last tic
+	if (pd.Count == pd.Slots())
 	{
-		Level->OldestParticle = Level->ActiveParticles;
+		CompactParticles(pd);
 	}
+
+	auto result = &pd.Attribs[pd.Count++];
+	*result = {};
+	pd.RenderDirty = true;
 	return result;
 }
 
@@ -180,31 +258,33 @@ void P_InitParticles (FLevelLocals *Level)
 		num = r_maxparticles;
 
 	// This should be good, but eh...
-	int NumParticles = clamp<int>(num, 100, 65535);
+	int NumParticles = clamp<int>(num, 100, MAX_PARTICLES);
 
+	// Leave some room for SPF_REPLACE so that it does not have to compact the storage on every spawn.
+	auto &pd = Level->ParticleData;
+	pd.Capacity = NumParticles;
+	ResizeParticleStorage(pd, NumParticles + NumParticles / 4 + 64);
 	Level->Particles.Resize(NumParticles);
 	P_ClearParticles (Level);
 }
 
 void P_ClearParticles (FLevelLocals *Level)
 {
-	int i = 0;
-	Level->OldestParticle = NO_PARTICLE;
-	Level->ActiveParticles = NO_PARTICLE;
-	Level->InactiveParticles = 0;
-	for (auto &p : Level->Particles)
+	auto &pd = Level->ParticleData;
+	pd.Count = 0;
+	pd.FirstNew = 0;
+	pd.ReplaceCursor = 0;
+	pd.RenderDirty = true;
+	if (Level->ParticlesInSubsec.Size() > 0)
 	{
-		p = {};
-		p.tprev = i - 1;
-		p.tnext = ++i;
+		memset(Level->ParticlesInSubsec.Data(), 0xff, Level->ParticlesInSubsec.Size() * sizeof(uint32_t));
 	}
-	Level->Particles.Last().tnext = NO_PARTICLE;
-	Level->Particles.Data()->tprev = NO_PARTICLE;
 }
 
 // Group particles by subsectors. Because particles are always
 // in motion, there is little benefit to caching this information
-// from one frame to the next.
+// from one frame to the next. The particles only change once per
+// tic though, so the render copy is only rebuilt when needed.
 // [MC] VisualThinkers hitches a ride here
 
 void P_FindParticleSubsectors (FLevelLocals *Level)
@@ -223,24 +303,82 @@ void P_FindParticleSubsectors (FLevelLocals *Level)
 		sp = sp->GetNext();
 	}
 	// End VisualThinker hitching. Now onto the particles. 
-	if (Level->ParticlesInSubsec.Size() < Level->subsectors.Size())
+	unsigned numss = Level->subsectors.Size();
+	if (Level->ParticlesInSubsec.Size() < numss)
 	{
-		Level->ParticlesInSubsec.Reserve (Level->subsectors.Size() - Level->ParticlesInSubsec.Size());
+		Level->ParticlesInSubsec.Reserve (numss - Level->ParticlesInSubsec.Size());
+		Level->ParticleData.RenderDirty = true;
 	}
 
-	fillshort (&Level->ParticlesInSubsec[0], Level->subsectors.Size(), NO_PARTICLE);
-
+	auto &pd = Level->ParticleData;
 	if (!r_particles)
+	{
+		memset(Level->ParticlesInSubsec.Data(), 0xff, numss * sizeof(uint32_t));
+		pd.RenderDirty = true;
+		return;
+	}
+	if (!pd.RenderDirty)
 	{
 		return;
 	}
-	for (uint16_t i = Level->ActiveParticles; i != NO_PARTICLE; i = Level->Particles[i].tnext)
+	pd.RenderDirty = false;
+	SyncNewParticles(pd);
+
+	// Counting sort by subsector, so that each subsector's particles end up next to each other in the render copy.
+	static TArray<uint32_t> SubsecCursor;
+	SubsecCursor.Resize(numss);
+	memset(SubsecCursor.Data(), 0, numss * sizeof(uint32_t));
+
+	for (unsigned i = pd.ReplaceCursor; i < pd.Count; i++)
 	{
-		 // Try to reuse the subsector from the last portal check, if still valid.
-		if (Level->Particles[i].subsector == nullptr) Level->Particles[i].subsector = Level->PointInRenderSubsector(Level->Particles[i].Pos);
-		int ssnum = Level->Particles[i].subsector->Index();
-		Level->Particles[i].snext = Level->ParticlesInSubsec[ssnum];
-		Level->ParticlesInSubsec[ssnum] = i;
+		// Try to reuse the subsector from the last portal check, if still valid.
+		if (pd.Subsector[i] == nullptr) pd.Subsector[i] = Level->PointInRenderSubsector(FloatToFixed(pd.PosX[i]), FloatToFixed(pd.PosY[i]));
+		SubsecCursor[pd.Subsector[i]->Index()]++;
+	}
+
+	uint32_t start = 0;
+	for (unsigned ss = 0; ss < numss; ss++)
+	{
+		uint32_t count = SubsecCursor[ss];
+		Level->ParticlesInSubsec[ss] = count > 0 ? start : NO_PARTICLE;
+		SubsecCursor[ss] = start;
+		start += count;
+	}
+
+	if (Level->Particles.Size() < start)
+	{
+		Level->Particles.Resize(start);
+	}
+
+	for (unsigned i = pd.ReplaceCursor; i < pd.Count; i++)
+	{
+		int ssnum = pd.Subsector[i]->Index();
+		uint32_t dest = SubsecCursor[ssnum]++;
+
+		particle_t &p = Level->Particles[dest];
+		p = pd.Attribs[i];
+		p.subsector = pd.Subsector[i];
+		p.Pos = { pd.PosX[i], pd.PosY[i], pd.PosZ[i] };
+		p.Vel = { pd.VelX[i], pd.VelY[i], pd.VelZ[i] };
+		p.Acc = { pd.AccX[i], pd.AccY[i], pd.AccZ[i] };
+		p.alpha = pd.Alpha[i];
+		p.fadestep = pd.FadeStep[i];
+		p.size = pd.Size[i];
+		p.sizestep = pd.SizeStep[i];
+		p.Roll = pd.Roll[i];
+		p.RollVel = pd.RollVel[i];
+		p.RollAcc = pd.RollAcc[i];
+		p.ttl = pd.Ttl[i];
+		p.snext = dest + 1;
+	}
+
+	// Terminate each subsector's run. The cursors now point one past the last entry.
+	for (unsigned ss = 0; ss < numss; ss++)
+	{
+		if (Level->ParticlesInSubsec[ss] != NO_PARTICLE)
+		{
+			Level->Particles[SubsecCursor[ss] - 1].snext = NO_PARTICLE;
+		}
 	}
 }
 
@@ -281,67 +419,174 @@ void P_InitEffects ()
 	blood2 = ParticleColor(RPART(kind)/3, GPART(kind)/3, BPART(kind)/3);
 }
 
-void P_ThinkParticles (FLevelLocals *Level)
+//==========================================================================
+//
+// Particle update kernel
+//
+// Everything that does not need to look at the map is done here in bulk.
+// XY movement is only included if there are no line portals that could
+// redirect a particle, otherwise it is done per particle afterward.
+//
+//==========================================================================
+
+static void ThinkParticle(FParticleStorage &pd, unsigned i, bool movexy)
 {
-	int i = Level->ActiveParticles;
-	particle_t *particle = nullptr, *prev = nullptr;
-	while (i != NO_PARTICLE)
+	pd.Alpha[i] -= pd.FadeStep[i];
+	pd.Size[i] += pd.SizeStep[i];
+	if (--pd.Ttl[i] < 1 || pd.Alpha[i] <= 0 || pd.Size[i] <= 0)
 	{
-		particle = &Level->Particles[i];
-		i = particle->tnext;
-		if (Level->isFrozen() && !(particle->flags &SPF_NOTIMEFREEZE))
-		{
-			if(particle->flags & SPF_LOCAL_ANIM)
-			{
-				particle->animData.SwitchTic++;
-			}
+		pd.Ttl[i] = 0;
+	}
 
-			prev = particle;
-			continue;
-		}
-		
-		particle->alpha -= particle->fadestep;
-		particle->size += particle->sizestep;
-		if (particle->alpha <= 0 || --particle->ttl <= 0 || (particle->size <= 0))
-		{ // The particle has expired, so free it
-			FreeParticle(Level, particle);
-			continue;
+	pd.PosZ[i] += pd.VelZ[i];
+	pd.VelZ[i] += pd.AccZ[i];
+	if (movexy)
+	{
+		pd.PosX[i] += pd.VelX[i];
+		pd.PosY[i] += pd.VelY[i];
+		pd.VelX[i] += pd.AccX[i];
+		pd.VelY[i] += pd.AccY[i];
+	}
+	pd.Roll[i] += pd.RollVel[i];
+	pd.RollVel[i] += pd.RollAcc[i];
+}
+
+#ifndef NO_SSE
+static inline void AddVelocitySSE(double *pos, float *vel, float *acc)
+{
+	__m128 v = _mm_loadu_ps(vel);
+	_mm_storeu_pd(pos, _mm_add_pd(_mm_loadu_pd(pos), _mm_cvtps_pd(v)));
+	_mm_storeu_pd(pos + 2, _mm_add_pd(_mm_loadu_pd(pos + 2), _mm_cvtps_pd(_mm_movehl_ps(v, v))));
+	_mm_storeu_ps(vel, _mm_add_ps(v, _mm_loadu_ps(acc)));
+}
+#endif
+
+static void ThinkParticleRange(FParticleStorage &pd, unsigned start, unsigned end, bool movexy)
+{
+	unsigned i = start;
+#ifndef NO_SSE
+	const __m128 zero = _mm_setzero_ps();
+	const __m128i one = _mm_set1_epi32(1);
+	for (; i + 4 <= end; i += 4)
+	{
+		__m128 alpha = _mm_sub_ps(_mm_loadu_ps(&pd.Alpha[i]), _mm_loadu_ps(&pd.FadeStep[i]));
+		__m128 size = _mm_add_ps(_mm_loadu_ps(&pd.Size[i]), _mm_loadu_ps(&pd.SizeStep[i]));
+		__m128i ttl = _mm_sub_epi32(_mm_loadu_si128((__m128i*)&pd.Ttl[i]), one);
+		__m128 dead = _mm_or_ps(_mm_or_ps(_mm_cmple_ps(alpha, zero), _mm_cmple_ps(size, zero)), _mm_castsi128_ps(_mm_cmplt_epi32(ttl, one)));
+		_mm_storeu_ps(&pd.Alpha[i], alpha);
+		_mm_storeu_ps(&pd.Size[i], size);
+		_mm_storeu_si128((__m128i*)&pd.Ttl[i], _mm_andnot_si128(_mm_castps_si128(dead), ttl));
+
+		AddVelocitySSE(&pd.PosZ[i], &pd.VelZ[i], &pd.AccZ[i]);
+		if (movexy)
+		{
+			AddVelocitySSE(&pd.PosX[i], &pd.VelX[i], &pd.AccX[i]);
+			AddVelocitySSE(&pd.PosY[i], &pd.VelY[i], &pd.AccY[i]);
 		}
 
+		__m128 rollvel = _mm_loadu_ps(&pd.RollVel[i]);
+		_mm_storeu_ps(&pd.Roll[i], _mm_add_ps(_mm_loadu_ps(&pd.Roll[i]), rollvel));
+		_mm_storeu_ps(&pd.RollVel[i], _mm_add_ps(rollvel, _mm_loadu_ps(&pd.RollAcc[i])));
+	}
+#endif
+	for (; i < end; i++)
+	{
+		ThinkParticle(pd, i, movexy);
+	}
+}
+
+// The map dependent part of a particle's movement.
+static void MoveParticleThroughPortals(FLevelLocals *Level, FParticleStorage &pd, unsigned i, bool movexy, bool linkedportals)
+{
+	if (!movexy)
+	{
 		// Handle crossing a line portal
-		DVector2 newxy = Level->GetPortalOffsetPosition(particle->Pos.X, particle->Pos.Y, particle->Vel.X, particle->Vel.Y);
-		particle->Pos.X = newxy.X;
-		particle->Pos.Y = newxy.Y;
-		particle->Pos.Z += particle->Vel.Z;
-		particle->Vel += particle->Acc;
+		DVector2 newxy = Level->GetPortalOffsetPosition(pd.PosX[i], pd.PosY[i], pd.VelX[i], pd.VelY[i]);
+		pd.PosX[i] = newxy.X;
+		pd.PosY[i] = newxy.Y;
+		pd.VelX[i] += pd.AccX[i];
+		pd.VelY[i] += pd.AccY[i];
+	}
 
-		if(particle->flags & SPF_ROLL)
+	if (!linkedportals)
+	{
+		// Without linked portals the subsector is only needed for rendering, so let the renderer look it up.
+		pd.Subsector[i] = nullptr;
+		return;
+	}
+
+	subsector_t *ss = Level->PointInRenderSubsector(FloatToFixed(pd.PosX[i]), FloatToFixed(pd.PosY[i]));
+	pd.Subsector[i] = ss;
+	sector_t *s = ss->sector;
+	// Handle crossing a sector portal.
+	if (!s->PortalBlocksMovement(sector_t::ceiling))
+	{
+		if (pd.PosZ[i] > s->GetPortalPlaneZ(sector_t::ceiling))
 		{
-			particle->Roll += particle->RollVel;
-			particle->RollVel += particle->RollAcc;
+			DVector2 disp = s->GetPortalDisplacement(sector_t::ceiling);
+			pd.PosX[i] += disp.X;
+			pd.PosY[i] += disp.Y;
+			pd.Subsector[i] = nullptr;
 		}
-		
-		particle->subsector = Level->PointInRenderSubsector(particle->Pos);
-		sector_t *s = particle->subsector->sector;
-		// Handle crossing a sector portal.
-		if (!s->PortalBlocksMovement(sector_t::ceiling))
+	}
+	else if (!s->PortalBlocksMovement(sector_t::floor))
+	{
+		if (pd.PosZ[i] < s->GetPortalPlaneZ(sector_t::floor))
+		{
+			DVector2 disp = s->GetPortalDisplacement(sector_t::floor);
+			pd.PosX[i] += disp.X;
+			pd.PosY[i] += disp.Y;
+			pd.Subsector[i] = nullptr;
+		}
+	}
+}
+
+void P_ThinkParticles (FLevelLocals *Level)
+{
+	ParticleCycles.Reset();
+	ParticleCycles.Clock();
+
+	auto &pd = Level->ParticleData;
+	SyncNewParticles(pd);
+
+	const bool movexy = !Level->PortalBlockmap.containsLines;
+	const bool linkedportals = Level->Displacements.size > 1;
+
+	if (Level->isFrozen())
+	{
+		for (unsigned i = pd.ReplaceCursor; i < pd.Count; i++)
 		{
-			if (particle->Pos.Z > s->GetPortalPlaneZ(sector_t::ceiling))
+			auto flags = pd.Attribs[i].flags;
+			if (flags & SPF_NOTIMEFREEZE)
+			{
+				ThinkParticle(pd, i, movexy);
+				if (pd.Ttl[i] > 0) MoveParticleThroughPortals(Level, pd, i, movexy, linkedportals);
+			}
+			else if (flags & SPF_LOCAL_ANIM)
 			{
-				particle->Pos += s->GetPortalDisplacement(sector_t::ceiling);
-				particle->subsector = NULL;
+				pd.Attribs[i].animData.SwitchTic++;
 			}
 		}
-		else if (!s->PortalBlocksMovement(sector_t::floor))
+	}
+	else
+	{
+		ThinkParticleRange(pd, pd.ReplaceCursor, pd.Count, movexy);
+		if (!movexy || linkedportals)
 		{
-			if (particle->Pos.Z < s->GetPortalPlaneZ(sector_t::floor))
+			for (unsigned i = pd.ReplaceCursor; i < pd.Count; i++)
 			{
-				particle->Pos += s->GetPortalDisplacement(sector_t::floor);
-				particle->subsector = NULL;
+				if (pd.Ttl[i] > 0) MoveParticleThroughPortals(Level, pd, i, movexy, linkedportals);
 			}
 		}
-		prev = particle;
+		else
+		{
+			memset(&pd.Subsector[pd.ReplaceCursor], 0, (pd.Count - pd.ReplaceCursor) * sizeof(subsector_t*));
+		}
 	}
+
+	CompactParticles(pd);
+
+	ParticleCycles.Unclock();
 }
 
 void P_SpawnParticle(FLevelLocals *Level, const DVector3 &pos, const DVector3 &vel, const DVector3 &accel, PalEntry color, double startalpha, int lifetime, double size,
@@ -1006,6 +1251,8 @@ void DVisualThinker::Construct()
 	PT.color = 0xffffff;
 	AnimatedTexture.SetNull();
 
+	ObjectFlags |= OF_ParallelTick;
+
 	_prev = _next = nullptr;
 	if (Level->VisualThinkerHead != nullptr)
 	{
@@ -1139,17 +1386,22 @@ void DVisualThinker::Tick()
 	if (ObjectFlags & OF_EuthanizeMe)
 		return;
 
-	if (!ValidTexture())
-	{
-		Destroy();
+	TickParallel();
+	TickParallelFinish();
+}
+
+// Movement and subsector lookup only touch this thinker, so with cl_parallelthinkers
+// this part runs on the worker threads. GetPortalOffsetPosition is not thread safe,
+// which is why maps with line portals never get here from a worker.
+void DVisualThinker::TickParallel()
+{
+	if ((ObjectFlags & OF_EuthanizeMe) || !ValidTexture())
 		return;
-	}
 
 	if (isFrozen())
 	{	// needed here because it won't retroactively update like actors do.
 		PT.subsector = Level->PointInRenderSubsector(PT.Pos);
 		cursector = PT.subsector->sector;
-		UpdateSpriteInfo(); 
 		return;
 	}
 	Prev = PT.Pos;
@@ -1180,6 +1432,18 @@ void DVisualThinker::Tick()
 	}
     
 	UpdateSector(ss);
+}
+
+void DVisualThinker::TickParallelFinish()
+{
+	if (ObjectFlags & OF_EuthanizeMe)
+		return;
+
+	if (!ValidTexture())
+	{
+		Destroy();
+		return;
+	}
 	UpdateSpriteInfo();
 }
 
@@ -1370,6 +1634,7 @@ void DVisualThinker::Serialize(FSerializer& arc)
     
     if(arc.isReading())
     {
+        ObjectFlags |= OF_ParallelTick;
         UpdateSector();
     }
 }
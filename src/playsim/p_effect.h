@@ -95,15 +95,44 @@ struct particle_t
     FTextureID texture; // +4 = 84
     ERenderStyle style; //+4 = 88
     float Roll, RollVel, RollAcc; //+12 = 100
-    uint16_t    tnext, snext, tprev; //+6 = 106
-	uint16_t flags; //+2 = 108
-	// uint32_t padding; //+4 = 112
+    uint32_t    snext; //+4 = 104
+	uint16_t flags; //+2 = 106
+	// uint16_t padding; //+6 = 112
 	FStandaloneAnimation animData; //+16 = 128
 };
 
 static_assert(sizeof(particle_t) == 128, "Only LP64/LLP64 is supported");
 
-const uint16_t NO_PARTICLE = 0xffff;
+const uint32_t NO_PARTICLE = 0xffffffff;
+const int MAX_PARTICLES = 1000000;
+
+// The simulation state of all particles of a level, stored as structure of arrays
+// so that P_ThinkParticles can update them in bulk. Slots are kept in spawn order
+// (index 0 is the oldest) and get compacted after each tic instead of being linked
+// into free lists. The particle_t records in Attribs hold everything the simulation
+// itself does not need; their simulated fields are only valid for fresh particles
+// that have not been synced yet.
+struct FParticleStorage
+{
+	TArray<double>		PosX, PosY, PosZ;
+	TArray<float>		VelX, VelY, VelZ;
+	TArray<float>		AccX, AccY, AccZ;
+	TArray<float>		Alpha, FadeStep;
+	TArray<float>		Size, SizeStep;
+	TArray<float>		Roll, RollVel, RollAcc;
+	TArray<int32_t>		Ttl;
+	TArray<subsector_t*> Subsector;
+	TArray<particle_t>	Attribs;
+
+	unsigned Capacity = 0;		// Max. number of live particles
+	unsigned Count = 0;			// Used slots, including ones killed by SPF_REPLACE that have not been compacted yet
+	unsigned FirstNew = 0;		// Particles from here on were spawned since the last sync
+	unsigned ReplaceCursor = 0;	// Slots before this one were killed by SPF_REPLACE
+	bool RenderDirty = true;	// The render copy in FLevelLocals::Particles needs to be rebuilt
+
+	unsigned LiveCount() const { return Count - ReplaceCursor; }
+	unsigned Slots() const { return Ttl.Size(); }
+};
 
 void P_InitParticles(FLevelLocals *);
 void P_ClearParticles (FLevelLocals *Level);
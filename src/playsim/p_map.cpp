@@ -1881,7 +1881,10 @@ bool P_CheckPosition(AActor *thing, const DVector2 &pos, FCheckPosition &tm, boo
 
 	FPortalGroupArray pcheck;
 
-	if (!(thing->flags2 & MF2_THRUACTORS))
+	// Without portals the blockmap's own copy of the actors' positions is enough to tell
+	// that nothing around is close enough to make PIT_CheckThing do anything.
+	if (!(thing->flags2 & MF2_THRUACTORS) &&
+		(thing->Level->Displacements.size > 1 || P_BlockThingsOverlap(thing->Level, pos, thing->radius, thing)))
 	{
 		FMultiBlockThingsIterator it2(pcheck, thing->Level, pos.X, pos.Y, thing->Z(), thing->Height, thing->radius, false, newsec);
 		FMultiBlockThingsIterator::CheckResult tcres;
@@ -4863,6 +4866,7 @@ AActor *P_LineAttack(AActor *t1, DAngle angle, double distance,
 				puff = P_SpawnPuff(t1, pufftype, puffpos, trace.SrcAngleFromTarget,
 					trace.SrcAngleFromTarget - DAngle::fromDeg(90), 0, puffFlags);
 				puff->radius = 1/65536.;
+				puff->UpdateBlockThings();
 
 				if (nointeract)
 				{
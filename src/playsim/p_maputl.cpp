@@ -340,6 +340,7 @@ void AActor::UnlinkFromWorld (FLinkContext *ctx)
 				block->NextActor->PrevActor = block->PrevActor;
 			}
 			*(block->PrevActor) = block->NextActor;
+			Level->blockmap.RemoveBlockThing(block);
 			FBlockNode *next = block->NextBlock;
 			block->Release ();
 			block = next;
@@ -545,6 +546,7 @@ void AActor::LinkToWorld(FLinkContext *ctx, bool spawningmapthing, sector_t *sec
 						}
 						node->PrevActor = link;
 						*link = node;
+						Level->blockmap.AddBlockThing(node);
 
 						// Link in to actor
 						node->PrevBlock = alink;
@@ -560,6 +562,21 @@ void AActor::LinkToWorld(FLinkContext *ctx, bool spawningmapthing, sector_t *sec
 	if (!spawningmapthing) UpdateRenderSectorList();
 }
 
+//==========================================================================
+//
+// Refreshes the blockmap's copy of the position and radius after they
+// were changed without relinking the actor.
+//
+//==========================================================================
+
+void AActor::UpdateBlockThings()
+{
+	for (FBlockNode *block = BlockNode; block != nullptr; block = block->NextBlock)
+	{
+		Level->blockmap.UpdateBlockThing(block);
+	}
+}
+
 void AActor::SetOrigin(double x, double y, double z, bool moving)
 {
 	FLinkContext ctx;
@@ -1156,6 +1173,155 @@ void FMultiBlockThingsIterator::Reset()
 	blockIterator.ClearHash();
 }
 
+//===========================================================================
+//
+// P_BlockThingsOverlap
+//
+// Checks if any actor linked into the blocks around pos is closer than the
+// sum of both radii on both axes, which is the first thing PIT_CheckThing
+// tests. Only looks at the blockmap's per-block copies, so if this returns
+// false the things don't need to be iterated at all.
+// Portal displacements are not considered.
+//
+//===========================================================================
+
+bool P_BlockThingsOverlap(FLevelLocals *Level, const DVector2 &pos, double radius, AActor *ignore)
+{
+	FBoundingBox box(pos.X, pos.Y, radius);
+	auto &blockmap = Level->blockmap;
+
+	int minx = max(blockmap.GetBlockX(box.Left()), 0);
+	int maxx = min(blockmap.GetBlockX(box.Right()), blockmap.bmapwidth - 1);
+	int miny = max(blockmap.GetBlockY(box.Bottom()), 0);
+	int maxy = min(blockmap.GetBlockY(box.Top()), blockmap.bmapheight - 1);
+
+	for (int y = miny; y <= maxy; y++)
+	{
+		for (int x = minx; x <= maxx; x++)
+		{
+			for (const FBlockThing &thing : blockmap.blockthings[y * blockmap.bmapwidth + x])
+			{
+				double blockdist = thing.Radius + radius;
+				if (thing.Me != ignore && fabs(thing.X - pos.X) < blockdist && fabs(thing.Y - pos.Y) < blockdist)
+					return true;
+			}
+		}
+	}
+	return false;
+}
+
+//===========================================================================
+//
+// P_FindThings*
+//
+// Collect all actors in a radius, box or cone into one array so that
+// callers don't have to drive the blockmap iterator themselves. The cheap
+// flag and shape tests run while iterating, the sight checks only on what
+// is left over afterward.
+// Positions are portal aware, the returned order is blockmap order unless
+// TQF_SORT is given.
+//
+//===========================================================================
+
+struct FThingQueryHit
+{
+	AActor *thing;
+	double dist;
+};
+
+static bool P_ThingQueryFilter(AActor *thing, int flags, AActor *origin, PClassActor *type)
+{
+	if (thing == origin) return false;
+	if ((flags & TQF_SHOOTABLE) && !(thing->flags & MF_SHOOTABLE)) return false;
+	if (flags & (TQF_MONSTERS | TQF_PLAYERS))
+	{
+		bool match = ((flags & TQF_MONSTERS) && (thing->flags3 & MF3_ISMONSTER)) || ((flags & TQF_PLAYERS) && thing->player != nullptr);
+		if (!match) return false;
+	}
+	if ((flags & TQF_ALIVE) && thing->health <= 0) return false;
+	if (type != nullptr && !thing->IsKindOf(type)) return false;
+	return true;
+}
+
+// Calls 'test' for every candidate with the query center translated into
+// the thing's portal group. It returns the distance used for sorting, or a
+// negative value if the thing is outside the query shape.
+template<class Test>
+static int P_CollectThings(FLevelLocals *Level, const DVector3 &center, double checkradius, sector_t *sec, TArray<AActor*> &results, int flags, AActor *origin, PClassActor *type, Test test)
+{
+	static TArray<FThingQueryHit> hits;
+	hits.Clear();
+	results.Clear();
+
+	FPortalGroupArray check(FPortalGroupArray::PGA_Full3d);
+	FMultiBlockThingsIterator it(check, Level, center.X, center.Y, center.Z - checkradius, checkradius * 2, checkradius, false, sec);
+	FMultiBlockThingsIterator::CheckResult cres;
+
+	while (it.Next(&cres))
+	{
+		AActor *thing = cres.thing;
+		if (!P_ThingQueryFilter(thing, flags, origin, type)) continue;
+		double dist = test(thing, DVector3(cres.Position.XY(), center.Z));
+		if (dist >= 0) hits.Push({ thing, dist });
+	}
+
+	if ((flags & TQF_CHECKSIGHT) && origin != nullptr)
+	{
+		unsigned j = 0;
+		for (unsigned i = 0; i < hits.Size(); i++)
+		{
+			if (P_CheckSight(origin, hits[i].thing)) hits[j++] = hits[i];
+		}
+		hits.Clamp(j);
+	}
+
+	if (flags & TQF_SORT)
+	{
+		std::stable_sort(hits.begin(), hits.end(), [](const FThingQueryHit &a, const FThingQueryHit &b) { return a.dist < b.dist; });
+	}
+
+	results.Reserve(hits.Size());
+	for (unsigned i = 0; i < hits.Size(); i++) results[i] = hits[i].thing;
+	return results.Size();
+}
+
+int P_FindThingsInRadius(FLevelLocals *Level, const DVector3 &pos, double radius, TArray<AActor*> &results, int flags, AActor *origin, PClassActor *type)
+{
+	return P_CollectThings(Level, pos, radius, nullptr, results, flags, origin, type, [=](AActor *thing, const DVector3 &center) -> double
+	{
+		DVector3 delta(thing->X() - center.X, thing->Y() - center.Y, (flags & TQF_3D) ? thing->Center() - center.Z : 0.);
+		double dist = delta.Length();
+		return dist <= radius ? dist : -1;
+	});
+}
+
+int P_FindThingsInBox(FLevelLocals *Level, const DVector2 &mins, const DVector2 &maxs, TArray<AActor*> &results, int flags, AActor *origin, PClassActor *type)
+{
+	DVector2 half = (maxs - mins) / 2;
+	DVector3 pos((mins + maxs) / 2, 0.);
+	return P_CollectThings(Level, pos, max(fabs(half.X), fabs(half.Y)), nullptr, results, flags, origin, type, [=](AActor *thing, const DVector3 &center) -> double
+	{
+		DVector2 delta(thing->X() - center.X, thing->Y() - center.Y);
+		if (fabs(delta.X) >= fabs(half.X) + thing->radius || fabs(delta.Y) >= fabs(half.Y) + thing->radius) return -1;
+		return delta.Length();
+	});
+}
+
+int P_FindThingsInCone(AActor *origin, DAngle fov, double range, TArray<AActor*> &results, int flags, PClassActor *type)
+{
+	DAngle halffov = fov / 2;
+	DAngle facing = origin->Angles.Yaw;
+	DVector3 pos(origin->Pos().XY(), origin->Center());
+	return P_CollectThings(origin->Level, pos, range, origin->Sector, results, flags, origin, type, [=](AActor *thing, const DVector3 &center) -> double
+	{
+		DVector3 delta(thing->X() - center.X, thing->Y() - center.Y, (flags & TQF_3D) ? thing->Center() - center.Z : 0.);
+		double dist = delta.Length();
+		if (dist > range) return -1;
+		if (dist > 0 && absangle(delta.Angle(), facing) > halffov) return -1;
+		return dist;
+	});
+}
+
 //===========================================================================
 //
 // FPathTraverse :: Intercepts
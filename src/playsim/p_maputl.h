@@ -423,5 +423,22 @@ double P_InterceptVector(const divline_t *v2, const divline_t *v1);
 #define PT_DELTA		8		// x2,y2 is passed as a delta, not as an endpoint
 
 int BoxOnLineSide(const FBoundingBox& box, const line_t* ld);
+bool P_BlockThingsOverlap(FLevelLocals *Level, const DVector2 &pos, double radius, AActor *ignore);
+
+// Flags for the P_FindThings* queries
+enum EThingQueryFlags
+{
+	TQF_SHOOTABLE	= 1,		// only things with MF_SHOOTABLE
+	TQF_MONSTERS	= 2,		// only monsters (combines with TQF_PLAYERS as 'either')
+	TQF_PLAYERS		= 4,		// only player bodies
+	TQF_ALIVE		= 8,		// only things with health > 0
+	TQF_3D			= 16,		// use 3D distances for radius and cone queries
+	TQF_CHECKSIGHT	= 32,		// origin must be able to see the thing
+	TQF_SORT		= 64,		// sort results by distance, nearest first
+};
+
+int P_FindThingsInRadius(FLevelLocals *Level, const DVector3 &pos, double radius, TArray<AActor*> &results, int flags = 0, AActor *origin = nullptr, PClassActor *type = nullptr);
+int P_FindThingsInBox(FLevelLocals *Level, const DVector2 &mins, const DVector2 &maxs, TArray<AActor*> &results, int flags = 0, AActor *origin = nullptr, PClassActor *type = nullptr);
+int P_FindThingsInCone(AActor *origin, DAngle fov, double range, TArray<AActor*> &results, int flags = 0, PClassActor *type = nullptr);
 
 #endif
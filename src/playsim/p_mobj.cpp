@@ -1218,6 +1218,7 @@ static int Grind(AActor* actor, int items)
 			actor->flags3 |= MF3_DONTGIB;
 			actor->Height = 0;
 			actor->radius = 0;
+			actor->UpdateBlockThings();
 			actor->Vel.Zero();
 			return false;
 		}
@@ -1245,6 +1246,7 @@ static int Grind(AActor* actor, int items)
 			actor->flags3 |= MF3_DONTGIB;
 			actor->Height = 0;
 			actor->radius = 0;
+			actor->UpdateBlockThings();
 			actor->Vel.Zero();
 			actor->SetState (state);
 			if (isgeneric)	// Not a custom crush state, so colorize it appropriately.
@@ -1282,6 +1284,7 @@ static int Grind(AActor* actor, int items)
 				actor->flags3 |= MF3_DONTGIB;
 				actor->Height = 0;
 				actor->radius = 0;
+				actor->UpdateBlockThings();
 				actor->Vel.Zero();
 				return false;
 			}
@@ -1293,6 +1296,7 @@ static int Grind(AActor* actor, int items)
 				gib->Alpha = actor->Alpha;
 				gib->Height = 0;
 				gib->radius = 0;
+				gib->UpdateBlockThings();
 				gib->Translation = actor->BloodTranslation;
 			}
 			S_Sound (actor, CHAN_BODY, 0, "misc/fallingsplat", 1, ATTN_IDLE);
@@ -480,3 +480,58 @@ void FBlockNode::Release()
 	NextBlock = FreeBlocks;
 	FreeBlocks = this;
 }
+
+//===========================================================================
+//
+// FBlockmap :: AddBlockThing
+//
+//===========================================================================
+
+void FBlockmap::AddBlockThing(FBlockNode *node)
+{
+	auto &things = blockthings[node->BlockIndex];
+	node->ThingIndex = things.Size();
+
+	FBlockThing &entry = things[things.Reserve(1)];
+	entry.Me = node->Me;
+	entry.Node = node;
+	entry.X = node->Me->X();
+	entry.Y = node->Me->Y();
+	entry.Radius = node->Me->radius;
+}
+
+//===========================================================================
+//
+// FBlockmap :: RemoveBlockThing
+//
+//===========================================================================
+
+void FBlockmap::RemoveBlockThing(FBlockNode *node)
+{
+	auto &things = blockthings[node->BlockIndex];
+	unsigned index = node->ThingIndex;
+	unsigned last = things.Size() - 1;
+
+	if (index != last)
+	{
+		things[index] = things[last];
+		things[index].Node->ThingIndex = index;
+	}
+	things.Pop();
+}
+
+//===========================================================================
+//
+// FBlockmap :: UpdateBlockThing
+//
+// The actor moved or changed size without getting relinked.
+//
+//===========================================================================
+
+void FBlockmap::UpdateBlockThing(FBlockNode *node)
+{
+	FBlockThing &entry = blockthings[node->BlockIndex][node->ThingIndex];
+	entry.X = node->Me->X();
+	entry.Y = node->Me->Y();
+	entry.Radius = node->Me->radius;
+}
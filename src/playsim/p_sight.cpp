@@ -52,8 +52,66 @@ This uses specialized forms of the maputils routines for optimized performance
 
 // Performance meters
 static int sightcounts[6];
-static cycle_t SightCycles;
+cycle_t SightCycles;
 static cycle_t MaxSightCycles;
+static int sightcachehits, sightcachemisses;
+
+//==========================================================================
+//
+// Sight check cache
+//
+// Monster AI checks the same pairs of actors over and over during a tic.
+// The expensive part (the blockmap traversal) is remembered here until
+// either actor moves or the map geometry changes. All entries expire
+// at the start of each tic, so anything the invalidation hooks miss
+// (e.g. scripts writing plane heights directly) can be stale for at
+// most the remainder of the current tic.
+//
+// Entries are found through the actors' spawn order, not their addresses,
+// so which checks hit the cache only depends on the game state and is the
+// same for all players in a netgame and when playing back a demo.
+//
+//==========================================================================
+
+CVAR(Bool, sv_sightcache, true, CVAR_SERVERINFO)
+
+struct FSightCacheEntry
+{
+	FLevelLocals *level;
+	uint32_t order1, order2;
+	unsigned epoch;
+	int flags;
+	DVector3 pos1, pos2;
+	double height1, height2;
+	bool result;
+};
+
+enum
+{
+	SIGHTCACHE_SIZE = 4096,
+	SIGHTCACHE_FLAGS = SF_SEEPASTSHOOTABLELINES | SF_SEEPASTBLOCKEVERYTHING | SF_IGNOREWATERBOUNDARY,
+};
+
+static FSightCacheEntry SightCache[SIGHTCACHE_SIZE];
+static unsigned SightCacheEpoch = 1;
+
+void P_InvalidateSightCache()
+{
+	SightCacheEpoch++;
+}
+
+static FSightCacheEntry &SightCacheSlot(AActor *t1, AActor *t2, int flags)
+{
+	uint32_t hash = t1->SpawnOrder * 31 + t2->SpawnOrder * 17 + flags;
+	hash ^= hash >> 13;
+	return SightCache[hash & (SIGHTCACHE_SIZE - 1)];
+}
+
+static bool SightCacheValid(const FSightCacheEntry &entry, AActor *t1, AActor *t2, int flags)
+{
+	return entry.epoch == SightCacheEpoch && entry.level == t1->Level && entry.order1 == t1->SpawnOrder && entry.order2 == t2->SpawnOrder && entry.flags == flags &&
+		entry.pos1 == t1->Pos() && entry.pos2 == t2->Pos() && entry.height1 == t1->Height && entry.height2 == t2->Height;
+}
 
 enum
 {
@@ -906,10 +964,21 @@ sightcounts[0]++;
 
 	// An unobstructed LOS is possible.
 	// Now look from eyes of t1 to any part of t2.
-
-	validcount++;
-	portals.Clear();
 	{
+		// Everything above either depends on the random number generator or is cheap, so only the traversal gets cached.
+		int cacheflags = flags & SIGHTCACHE_FLAGS;
+		FSightCacheEntry &cached = SightCacheSlot(t1, t2, cacheflags);
+		if (sv_sightcache && SightCacheValid(cached, t1, t2, cacheflags))
+		{
+			sightcachehits++;
+			res = cached.result;
+			goto done;
+		}
+		sightcachemisses++;
+
+		validcount++;
+		portals.Clear();
+
 		sector_t *sec;
 		double lookheight = t1->Z() + t1->Height*0.75;
 		t1->GetPortalTransition(lookheight, &sec);
@@ -936,6 +1005,8 @@ sightcounts[0]++;
 				}
 			}
 		}
+
+		cached = { t1->Level, t1->SpawnOrder, t2->SpawnOrder, SightCacheEpoch, cacheflags, t1->Pos(), t2->Pos(), t1->Height, t2->Height, res };
 	}
 
 done:
@@ -946,9 +1017,10 @@ done:
 ADD_STAT (sight)
 {
 	FString out;
-	out.Format ("%04.1f ms (%04.1f max), %5d %2d%4d%4d%4d%4d\n",
+	out.Format ("%04.1f ms (%04.1f max), %5d %2d%4d%4d%4d%4d, cache %d hits %d misses\n",
 		SightCycles.TimeMS(), MaxSightCycles.TimeMS(),
-		sightcounts[3], sightcounts[0], sightcounts[1], sightcounts[2], sightcounts[4], sightcounts[5]);
+		sightcounts[3], sightcounts[0], sightcounts[1], sightcounts[2], sightcounts[4], sightcounts[5],
+		sightcachehits, sightcachemisses);
 	return out;
 }
 
@@ -964,4 +1036,6 @@ void P_ResetSightCounters (bool full)
 	}
 	SightCycles.Reset();
 	memset (sightcounts, 0, sizeof(sightcounts));
+	sightcachehits = sightcachemisses = 0;
+	P_InvalidateSightCache();
 }
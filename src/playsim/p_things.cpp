@@ -475,6 +475,7 @@ bool P_Thing_Raise(AActor *thing, AActor *raiser, int flags)
 		thing->Height = oldheight;
 		return false;
 	}
+	thing->UpdateBlockThings();
 
 	if (!P_CanResurrect(raiser, thing))
 		return false;
@@ -67,6 +67,8 @@ public:
 	float InterpolatedRoll(double ticFrac) const;
 
 	void Tick() override;
+	void TickParallel() override;
+	void TickParallelFinish() override;
 	void UpdateSpriteInfo();
 	void UpdateSector();
 	void Serialize(FSerializer& arc) override;
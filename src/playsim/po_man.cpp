@@ -861,6 +861,7 @@ void FPolyObj::CalcCenter()
 bool FPolyObj::MovePolyobj (const DVector2 &pos, bool force)
 {
 	FBoundingBox oldbounds = Bounds;
+	P_InvalidateSightCache();
 	UnLinkPolyobj ();
 	DoMovePolyobj (pos);
 
@@ -943,6 +944,7 @@ bool FPolyObj::RotatePolyobj (DAngle angle, bool fromsave)
 
 	an = Angle + angle;
 
+	P_InvalidateSightCache();
 	UnLinkPolyobj();
 
 	for(unsigned i=0;i < Vertices.Size(); i++)
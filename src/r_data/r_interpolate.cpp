@@ -70,6 +70,7 @@ public:
 	
 	virtual void Serialize(FSerializer &arc);
 	size_t PropagateMark();
+	int GetConcurrentMarkSlots(DObject **slots[]) { return -1; }
 };
 
 //==========================================================================
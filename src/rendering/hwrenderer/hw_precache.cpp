@@ -266,6 +266,20 @@ void hw_PrecacheTexture(uint8_t *texhitlist, TMap<PClassActor*, bool> &actorhitl
 		paira->Key->CleanUnused();
 	}
 
+	// Let the file system decompress the images' data in the background. This is queued in the opposite order
+	// than the images get created below so that the worker and this thread do not end up on the same lumps.
+	// Without gl_precache this makes the data ready for when the textures are first needed in the level.
+	for (int i = 0; i < cnt; i++)
+	{
+		auto tex = TexMan.GameByIndex(i);
+		if (tex != nullptr && tex->GetTexture() != nullptr && tex->GetTexture()->GetImage() != nullptr &&
+			((texhitlist[i] & (FTextureManager::HIT_Wall | FTextureManager::HIT_Flat | FTextureManager::HIT_Sky)) ||
+			(spritehitlist[i] != nullptr && (*spritehitlist[i]).CountUsed() > 0)))
+		{
+			tex->GetTexture()->GetImage()->PrefetchLumps();
+		}
+	}
+
 	if (gl_precache)
 	{
 		cycle_t precache;
@@ -284,4 +284,14 @@ namespace swrenderer
 		}
 	}
 
+	void SWPixelFormatDrawers::DrawSpanRows(const SpanDrawerArgs &args, const SpanRow *rows, int count)
+	{
+		SpanDrawerArgs rowargs = args;
+		for (int i = 0; i < count; i++)
+		{
+			rowargs.SetRow(rows[i]);
+			(this->*rowargs.spanfunc)(rowargs);
+		}
+	}
+
 }
@@ -28,6 +28,7 @@ namespace swrenderer
 	class SpanDrawerArgs;
 	class SpriteDrawerArgs;
 	class VoxelBlock;
+	struct SpanRow;
 
 	extern uint8_t shadetables[/*NUMCOLORMAPS*16*256*/];
 	extern FDynamicColormap ShadeFakeColormap[16];
@@ -88,6 +89,7 @@ namespace swrenderer
 		virtual void DrawSpanMaskedTranslucent(const SpanDrawerArgs &args) = 0;
 		virtual void DrawSpanAddClamp(const SpanDrawerArgs &args) = 0;
 		virtual void DrawSpanMaskedAddClamp(const SpanDrawerArgs &args) = 0;
+		virtual void DrawSpanRows(const SpanDrawerArgs &args, const SpanRow *rows, int count);
 		virtual void FillSpan(const SpanDrawerArgs &args) = 0;
 		virtual void DrawTiltedSpan(const SpanDrawerArgs &args, const FVector3 &plane_sz, const FVector3 &plane_su, const FVector3 &plane_sv, bool plane_shade, int planeshade, float planelightfloat, fixed_t pviewx, fixed_t pviewy, FDynamicColormap *basecolormap) = 0;
 		virtual void DrawColoredSpan(const SpanDrawerArgs &args) = 0;
@@ -59,11 +59,16 @@
 #include "r_draw_sprite32_sse2.h"
 #include "r_draw_span32_sse2.h"
 #include "r_draw_sky32_sse2.h"
+#include "r_draw_wall32_avx2.h"
+#include "r_draw_sprite32_avx2.h"
+#include "r_draw_span32_avx2.h"
 #endif
 
 #include "gi.h"
 #include "stats.h"
+#include "x86.h"
 #include <vector>
+#include <functional>
 
 ;
 // Use linear filtering when scaling up
@@ -78,6 +83,9 @@ CVAR(Bool, r_mipmap, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG);
 // Level of detail texture bias
 CVAR(Float, r_lod_bias, -1.5, 0); // To do: add CVAR_ARCHIVE | CVAR_GLOBALCONFIG when a good default has been decided
 
+// Use the AVX2 drawers if the CPU supports them
+CVAR(Bool, r_avx2drawers, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG);
+
 namespace swrenderer
 {
 	void SWTruecolorDrawers::DrawWall(const WallDrawerArgs &args)
@@ -234,6 +242,11 @@ namespace swrenderer
 		DrawSpanAddClamp32Command::DrawColumn(args);
 	}
 	
+	void SWTruecolorDrawers::DrawSpanRows(const SpanDrawerArgs &args, const SpanRow *rows, int count)
+	{
+		DrawSpanRowsT<DrawSpan32Command, DrawSpanMasked32Command, DrawSpanTranslucent32Command, DrawSpanAddClamp32Command>(args, rows, count);
+	}
+	
 	void SWTruecolorDrawers::DrawSingleSkyColumn(const SkyDrawerArgs &args)
 	{
 		DrawSkySingle32Command::DrawColumn(args);
@@ -246,6 +259,160 @@ namespace swrenderer
 
 	/////////////////////////////////////////////////////////////////////////////
 
+#ifndef NO_SSE
+	void SWTruecolorDrawersAVX2::DrawWall(const WallDrawerArgs &args)
+	{
+		DrawWallColumns<DrawWall32AVX2Command>(args);
+	}
+
+	void SWTruecolorDrawersAVX2::DrawWallMasked(const WallDrawerArgs &args)
+	{
+		DrawWallColumns<DrawWallMasked32AVX2Command>(args);
+	}
+
+	void SWTruecolorDrawersAVX2::DrawWallAdd(const WallDrawerArgs &args)
+	{
+		DrawWallColumns<DrawWallAddClamp32AVX2Command>(args);
+	}
+
+	void SWTruecolorDrawersAVX2::DrawWallAddClamp(const WallDrawerArgs &args)
+	{
+		DrawWallColumns<DrawWallAddClamp32AVX2Command>(args);
+	}
+
+	void SWTruecolorDrawersAVX2::DrawWallSubClamp(const WallDrawerArgs &args)
+	{
+		DrawWallColumns<DrawWallSubClamp32AVX2Command>(args);
+	}
+
+	void SWTruecolorDrawersAVX2::DrawWallRevSubClamp(const WallDrawerArgs &args)
+	{
+		DrawWallColumns<DrawWallRevSubClamp32AVX2Command>(args);
+	}
+
+	void SWTruecolorDrawersAVX2::DrawColumn(const SpriteDrawerArgs &args)
+	{
+		DrawSprite32AVX2Command::DrawColumn(args);
+	}
+
+	void SWTruecolorDrawersAVX2::FillColumn(const SpriteDrawerArgs &args)
+	{
+		FillSprite32AVX2Command::DrawColumn(args);
+	}
+
+	void SWTruecolorDrawersAVX2::FillAddColumn(const SpriteDrawerArgs &args)
+	{
+		FillSpriteAddClamp32AVX2Command::DrawColumn(args);
+	}
+
+	void SWTruecolorDrawersAVX2::FillAddClampColumn(const SpriteDrawerArgs &args)
+	{
+		FillSpriteAddClamp32AVX2Command::DrawColumn(args);
+	}
+
+	void SWTruecolorDrawersAVX2::FillSubClampColumn(const SpriteDrawerArgs &args)
+	{
+		FillSpriteSubClamp32AVX2Command::DrawColumn(args);
+	}
+
+	void SWTruecolorDrawersAVX2::FillRevSubClampColumn(const SpriteDrawerArgs &args)
+	{
+		FillSpriteRevSubClamp32AVX2Command::DrawColumn(args);
+	}
+
+	void SWTruecolorDrawersAVX2::DrawAddColumn(const SpriteDrawerArgs &args)
+	{
+		DrawSpriteAddClamp32AVX2Command::DrawColumn(args);
+	}
+
+	void SWTruecolorDrawersAVX2::DrawTranslatedColumn(const SpriteDrawerArgs &args)
+	{
+		DrawSpriteTranslated32AVX2Command::DrawColumn(args);
+	}
+
+	void SWTruecolorDrawersAVX2::DrawTranslatedAddColumn(const SpriteDrawerArgs &args)
+	{
+		DrawSpriteTranslatedAddClamp32AVX2Command::DrawColumn(args);
+	}
+
+	void SWTruecolorDrawersAVX2::DrawShadedColumn(const SpriteDrawerArgs &args)
+	{
+		DrawSpriteShaded32AVX2Command::DrawColumn(args);
+	}
+
+	void SWTruecolorDrawersAVX2::DrawAddClampShadedColumn(const SpriteDrawerArgs &args)
+	{
+		DrawSpriteAddClampShaded32AVX2Command::DrawColumn(args);
+	}
+
+	void SWTruecolorDrawersAVX2::DrawAddClampColumn(const SpriteDrawerArgs &args)
+	{
+		DrawSpriteAddClamp32AVX2Command::DrawColumn(args);
+	}
+
+	void SWTruecolorDrawersAVX2::DrawAddClampTranslatedColumn(const SpriteDrawerArgs &args)
+	{
+		DrawSpriteTranslatedAddClamp32AVX2Command::DrawColumn(args);
+	}
+
+	void SWTruecolorDrawersAVX2::DrawSubClampColumn(const SpriteDrawerArgs &args)
+	{
+		DrawSpriteSubClamp32AVX2Command::DrawColumn(args);
+	}
+
+	void SWTruecolorDrawersAVX2::DrawSubClampTranslatedColumn(const SpriteDrawerArgs &args)
+	{
+		DrawSpriteTranslatedSubClamp32AVX2Command::DrawColumn(args);
+	}
+
+	void SWTruecolorDrawersAVX2::DrawRevSubClampColumn(const SpriteDrawerArgs &args)
+	{
+		DrawSpriteRevSubClamp32AVX2Command::DrawColumn(args);
+	}
+
+	void SWTruecolorDrawersAVX2::DrawRevSubClampTranslatedColumn(const SpriteDrawerArgs &args)
+	{
+		DrawSpriteTranslatedRevSubClamp32AVX2Command::DrawColumn(args);
+	}
+
+	void SWTruecolorDrawersAVX2::DrawSpan(const SpanDrawerArgs &args)
+	{
+		DrawSpan32AVX2Command::DrawColumn(args);
+	}
+
+	void SWTruecolorDrawersAVX2::DrawSpanMasked(const SpanDrawerArgs &args)
+	{
+		DrawSpanMasked32AVX2Command::DrawColumn(args);
+	}
+
+	void SWTruecolorDrawersAVX2::DrawSpanTranslucent(const SpanDrawerArgs &args)
+	{
+		DrawSpanTranslucent32AVX2Command::DrawColumn(args);
+	}
+
+	void SWTruecolorDrawersAVX2::DrawSpanMaskedTranslucent(const SpanDrawerArgs &args)
+	{
+		DrawSpanAddClamp32AVX2Command::DrawColumn(args);
+	}
+
+	void SWTruecolorDrawersAVX2::DrawSpanAddClamp(const SpanDrawerArgs &args)
+	{
+		DrawSpanTranslucent32AVX2Command::DrawColumn(args);
+	}
+
+	void SWTruecolorDrawersAVX2::DrawSpanMaskedAddClamp(const SpanDrawerArgs &args)
+	{
+		DrawSpanAddClamp32AVX2Command::DrawColumn(args);
+	}
+
+	void SWTruecolorDrawersAVX2::DrawSpanRows(const SpanDrawerArgs &args, const SpanRow *rows, int count)
+	{
+		DrawSpanRowsT<DrawSpan32AVX2Command, DrawSpanMasked32AVX2Command, DrawSpanTranslucent32AVX2Command, DrawSpanAddClamp32AVX2Command>(args, rows, count);
+	}
+#endif
+
+	/////////////////////////////////////////////////////////////////////////////
+
 	void SWTruecolorDrawers::DrawScaledFuzzColumn(const SpriteDrawerArgs& drawerargs)
 	{
 		int _x = drawerargs.FuzzX();
@@ -1022,6 +1189,25 @@ namespace swrenderer
 
 	/////////////////////////////////////////////////////////////////////////////
 
+	// Same blend mapping as the single span functions above
+	template<typename OpaqueT, typename MaskedT, typename TranslucentT, typename AddClampT>
+	void SWTruecolorDrawers::DrawSpanRowsT(const SpanDrawerArgs& args, const SpanRow *rows, int count)
+	{
+		auto spanfunc = args.spanfunc;
+		if (spanfunc == &SWPixelFormatDrawers::DrawSpan)
+			OpaqueT::DrawRows(args, rows, count);
+		else if (spanfunc == &SWPixelFormatDrawers::DrawSpanMasked)
+			MaskedT::DrawRows(args, rows, count);
+		else if (spanfunc == &SWPixelFormatDrawers::DrawSpanTranslucent || spanfunc == &SWPixelFormatDrawers::DrawSpanAddClamp)
+			TranslucentT::DrawRows(args, rows, count);
+		else if (spanfunc == &SWPixelFormatDrawers::DrawSpanMaskedTranslucent || spanfunc == &SWPixelFormatDrawers::DrawSpanMaskedAddClamp)
+			AddClampT::DrawRows(args, rows, count);
+		else
+			SWPixelFormatDrawers::DrawSpanRows(args, rows, count);
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+
 	template<typename DrawerT>
 	void SWTruecolorDrawers::DrawWallColumns(const WallDrawerArgs& wallargs)
 	{
@@ -1170,4 +1356,228 @@ namespace swrenderer
 		drawerargs.SetTextureVStep(texelStepY);
 		DrawerT::DrawColumn(drawerargs);
 	}
+
+	//==========================================================================
+	//
+	// SWTruecolorDrawers::Benchmark
+	//
+	// Draws synthetic wall columns, sprite columns and spans with the drawers
+	// this build uses by default and, if the CPU supports them, the AVX2
+	// drawers. The C drawers share their class names with the SSE2 ones, so
+	// they can only be measured in a build with NO_SSE defined.
+	//
+	//==========================================================================
+
+	void SWTruecolorDrawers::Benchmark(int passes)
+	{
+		typedef void(SWPixelFormatDrawers::*WallDrawerFunc)(const WallDrawerArgs &args);
+		typedef void(SWPixelFormatDrawers::*SpriteDrawerFunc)(const SpriteDrawerArgs &args);
+		typedef void(SWPixelFormatDrawers::*SpanDrawerFunc)(const SpanDrawerArgs &args);
+
+		const int width = 640;
+		const int height = 400;
+		const int texsize = 128;
+		const int flatsize = 64;
+
+#ifdef NO_SSE
+		const char *basename = "C";
+#else
+		const char *basename = "SSE2";
+#endif
+
+		std::unique_ptr<SWPixelFormatDrawers> drawers[2];
+		drawers[0].reset(new SWTruecolorDrawers(nullptr));
+#ifndef NO_SSE
+		if (CPU.bAVX2)
+			drawers[1].reset(new SWTruecolorDrawersAVX2(nullptr));
+#endif
+
+		// Every eighth texel is transparent, so that the masked drawers have something to do.
+		TArray<uint32_t> texture(texsize * texsize, true);
+		uint32_t seed = 1;
+		for (uint32_t &texel : texture)
+		{
+			seed = seed * 1103515245 + 12345;
+			texel = (seed & 0x700) ? (seed >> 8) | 0xff000000 : 0;
+		}
+
+		DCanvas canvas(viewwindowx + width, viewwindowy + height, true);
+		auto viewport = std::make_unique<RenderViewport>();
+		viewport->RenderTarget = &canvas;
+
+		TArray<short> uwal(width, true), dwal(width, true);
+		for (int x = 0; x < width; x++)
+		{
+			uwal[x] = 0;
+			dwal[x] = height;
+		}
+
+		WallDrawerArgs wallargs;
+		wallargs.SetDest(viewport.get());
+		wallargs.SetStyle(false, false, OPAQUE / 2, true);
+		wallargs.x1 = 0;
+		wallargs.x2 = width;
+		wallargs.uwal = uwal.Data();
+		wallargs.dwal = dwal.Data();
+		wallargs.texcoords.upos = 0.0f;
+		wallargs.texcoords.ustepX = 1.0f / texsize;
+		wallargs.texcoords.ustepY = 0.0f;
+		wallargs.texcoords.vpos = 0.0f;
+		wallargs.texcoords.vstepX = 0.0f;
+		wallargs.texcoords.vstepY = 1.0f / texsize;
+		wallargs.texcoords.wpos = 1.0f;
+		wallargs.texcoords.wstepX = 0.0f;
+		wallargs.texcoords.wstepY = 0.0f;
+		wallargs.texcoords.startX = 0.0f;
+		wallargs.lightpos = 0.0f;
+		wallargs.lightstep = 0.0f;
+		wallargs.fixedlight = false;
+		wallargs.CenterY = height * 0.5f;
+		wallargs.texwidth = texsize;
+		wallargs.texheight = texsize;
+		wallargs.fracbits = 32 - FRACBITS;
+		wallargs.mipmapped = false;
+		wallargs.texpixels = texture.Data();
+
+		SpriteDrawerArgs spriteargs;
+		spriteargs.dc_textureheight = texsize;
+		spriteargs.dc_iscale = (1 << 30) / height;
+		spriteargs.dc_texturefrac = 0;
+		spriteargs.dc_srcalpha = OPAQUE / 2;
+		spriteargs.dc_destalpha = OPAQUE / 2;
+		spriteargs.dc_srccolor_bgra = 0xff804020;
+		spriteargs.SetCount(height);
+
+		SpanDrawerArgs spanargs;
+		spanargs.SetDestX1(0);
+		spanargs.SetDestX2(width - 1);
+		spanargs.ds_source = (const uint8_t*)texture.Data();
+		spanargs.ds_texwidth = flatsize;
+		spanargs.ds_texheight = flatsize;
+		spanargs.ds_source_mipmapped = false;
+		spanargs.dc_srcalpha = OPAQUE / 2;
+		spanargs.dc_destalpha = OPAQUE / 2;
+		spanargs.dc_viewpos = { 0.0f, 0.0f, 0.0f };
+		spanargs.dc_viewpos_step = { 0.0f, 0.0f, 0.0f };
+		spanargs.SetTextureUStep(1.0 / flatsize);
+		spanargs.SetTextureVStep(0.0);
+
+		auto wall = [&](WallDrawerFunc func)
+		{
+			return [&, func](SWPixelFormatDrawers *drawers)
+			{
+				(drawers->*func)(wallargs);
+			};
+		};
+
+		auto sprite = [&](SpriteDrawerFunc func, bool linear)
+		{
+			return [&, func, linear](SWPixelFormatDrawers *drawers)
+			{
+				for (int x = 0; x < width; x++)
+				{
+					spriteargs.SetDest(viewport.get(), x, 0);
+					spriteargs.dc_source = (const uint8_t*)(texture.Data() + (x % texsize) * texsize);
+					spriteargs.dc_source2 = linear ? (const uint8_t*)(texture.Data() + ((x + 1) % texsize) * texsize) : nullptr;
+					spriteargs.dc_texturefracx = linear ? 8 : 0;
+					(drawers->*func)(spriteargs);
+				}
+			};
+		};
+
+		// Magnified spans use nearest filtering and minified ones linear filtering, unless r_magfilter or r_minfilter say otherwise.
+		auto span = [&](SpanDrawerFunc func, double lod)
+		{
+			return [&, func, lod](SWPixelFormatDrawers *drawers)
+			{
+				spanargs.SetTextureLOD(lod);
+				for (int y = 0; y < height; y++)
+				{
+					spanargs.SetDestY(viewport.get(), y);
+					spanargs.SetTextureUPos(0.0);
+					spanargs.SetTextureVPos((double)y / flatsize);
+					(drawers->*func)(spanargs);
+				}
+			};
+		};
+
+		struct BenchCase
+		{
+			const char *name;
+			std::function<void(SWPixelFormatDrawers *drawers)> draw;
+		};
+
+		std::vector<BenchCase> cases =
+		{
+			{ "wall", wall(&SWPixelFormatDrawers::DrawWall) },
+			{ "wall masked", wall(&SWPixelFormatDrawers::DrawWallMasked) },
+			{ "wall addclamp", wall(&SWPixelFormatDrawers::DrawWallAddClamp) },
+			{ "sprite", sprite(&SWPixelFormatDrawers::DrawColumn, false) },
+			{ "sprite linear", sprite(&SWPixelFormatDrawers::DrawColumn, true) },
+			{ "sprite addclamp", sprite(&SWPixelFormatDrawers::DrawAddClampColumn, false) },
+			{ "sprite fill", sprite(&SWPixelFormatDrawers::FillColumn, false) },
+			{ "span", span(&SWPixelFormatDrawers::DrawSpan, -1.0) },
+			{ "span linear", span(&SWPixelFormatDrawers::DrawSpan, 1.0) },
+			{ "span masked", span(&SWPixelFormatDrawers::DrawSpanMasked, -1.0) },
+			{ "span translucent", span(&SWPixelFormatDrawers::DrawSpanTranslucent, -1.0) },
+		};
+
+		auto clearCanvas = [&]()
+		{
+			uint32_t *pixels = (uint32_t*)canvas.GetPixels();
+			for (int i = 0, count = canvas.GetPitch() * canvas.GetHeight(); i < count; i++)
+				pixels[i] = 0xff204060;
+		};
+
+		size_t canvasbytes = canvas.GetPitch() * canvas.GetHeight() * 4;
+		TArray<uint8_t> reference(canvasbytes, true);
+
+		Printf("Drawing %dx%d pixels, %d passes per drawer\n", width, height, passes);
+		if (!drawers[1])
+			Printf("AVX2 is not supported by this CPU\n");
+		Printf(TEXTCOLOR_YELLOW "Drawer            %6s, ms   AVX2, ms   Speedup\n", basename);
+		Printf(TEXTCOLOR_YELLOW "----------------  ----------  ---------  -------\n");
+
+		for (const BenchCase &bench : cases)
+		{
+			double ms[2] = { 0.0, 0.0 };
+			bool mismatch = false;
+			for (int i = 0; i < 2; i++)
+			{
+				if (!drawers[i])
+					continue;
+
+				// The first pass also warms the caches and is compared against the other drawer set.
+				clearCanvas();
+				bench.draw(drawers[i].get());
+				if (i == 0)
+					memcpy(reference.Data(), canvas.GetPixels(), canvasbytes);
+				else
+					mismatch = memcmp(reference.Data(), canvas.GetPixels(), canvasbytes) != 0;
+
+				cycle_t timer;
+				timer.Reset();
+				timer.Clock();
+				for (int pass = 0; pass < passes; pass++)
+					bench.draw(drawers[i].get());
+				timer.Unclock();
+				ms[i] = timer.TimeMS() / passes;
+			}
+
+			if (drawers[1])
+			{
+				Printf("%-16s  %10.4f  %9.4f  %6.2fx%s\n", bench.name, ms[0], ms[1], ms[1] > 0.0 ? ms[0] / ms[1] : 0.0,
+					mismatch ? TEXTCOLOR_RED " output differs" : "");
+			}
+			else
+			{
+				Printf("%-16s  %10.4f\n", bench.name, ms[0]);
+			}
+		}
+	}
+}
+
+void R_BenchmarkTruecolorDrawers(int passes)
+{
+	swrenderer::SWTruecolorDrawers::Benchmark(passes);
 }
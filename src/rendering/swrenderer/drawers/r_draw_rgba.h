@@ -71,6 +71,34 @@ namespace swrenderer
 	#define VECTORCALL
 	#endif
 
+#ifndef NO_SSE
+	// Compile a function with AVX2 enabled without requiring it for the whole file.
+	// Only call such functions after checking CPU.bAVX2.
+	#if defined(__GNUC__) && !defined(__AVX2__)
+	#define AVX2_TARGET __attribute__((target("avx2")))
+	#else
+	#define AVX2_TARGET
+	#endif
+
+	// Expands four 32-bit values to 16-bit lanes lining up with the channels of four unpacked pixels
+	AVX2_TARGET FORCEINLINE __m256i VECTORCALL SpreadPixelsAVX2(__m128i values)
+	{
+		values = _mm_packs_epi32(values, values);
+		values = _mm_unpacklo_epi16(values, values);
+		__m128i lo = _mm_unpacklo_epi32(values, values);
+		__m128i hi = _mm_unpackhi_epi32(values, values);
+		return _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+	}
+
+	// Packs four unpacked pixels back to BGRA8, in order and with full alpha
+	AVX2_TARGET FORCEINLINE __m128i VECTORCALL PackPixelsAVX2(__m256i color)
+	{
+		color = _mm256_packus_epi16(color, _mm256_setzero_si256());
+		color = _mm256_permute4x64_epi64(color, _MM_SHUFFLE(3, 1, 2, 0));
+		return _mm_or_si128(_mm256_castsi256_si128(color), _mm_set1_epi32(0xff000000));
+	}
+#endif
+
 	template<typename CommandType, typename BlendMode>
 	class DrawerBlendCommand : public CommandType
 	{
@@ -127,6 +155,7 @@ namespace swrenderer
 		void DrawSpanMaskedTranslucent(const SpanDrawerArgs &args) override;
 		void DrawSpanAddClamp(const SpanDrawerArgs &args) override;
 		void DrawSpanMaskedAddClamp(const SpanDrawerArgs &args) override;
+		void DrawSpanRows(const SpanDrawerArgs &args, const SpanRow *rows, int count) override;
 		void FillSpan(const SpanDrawerArgs& args) override;
 		void DrawTiltedSpan(const SpanDrawerArgs& args, const FVector3& plane_sz, const FVector3& plane_su, const FVector3& plane_sv, bool plane_shade, int planeshade, float planelightfloat, fixed_t pviewx, fixed_t pviewy, FDynamicColormap* basecolormap) override;
 		void DrawColoredSpan(const SpanDrawerArgs& args) override;
@@ -138,9 +167,53 @@ namespace swrenderer
 
 		template<typename DrawerT> void DrawWallColumns(const WallDrawerArgs& args);
 		template<typename DrawerT> void DrawWallColumn32(WallColumnDrawerArgs& drawerargs, int x, int y1, int y2, uint32_t texelX, uint32_t texelY, uint32_t texelStepX, uint32_t texelStepY);
+		template<typename OpaqueT, typename MaskedT, typename TranslucentT, typename AddClampT> void DrawSpanRowsT(const SpanDrawerArgs& args, const SpanRow *rows, int count);
 
 		WallColumnDrawerArgs wallcolargs;
+
+		// Times the wall, span and sprite drawers on synthetic columns and spans
+		static void Benchmark(int passes);
+	};
+
+#ifndef NO_SSE
+	// Wall, span and sprite drawers that work on four pixels at a time. Only created if the CPU supports AVX2.
+	class SWTruecolorDrawersAVX2 : public SWTruecolorDrawers
+	{
+	public:
+		using SWTruecolorDrawers::SWTruecolorDrawers;
+
+		void DrawWall(const WallDrawerArgs &args) override;
+		void DrawWallMasked(const WallDrawerArgs &args) override;
+		void DrawWallAdd(const WallDrawerArgs &args) override;
+		void DrawWallAddClamp(const WallDrawerArgs &args) override;
+		void DrawWallSubClamp(const WallDrawerArgs &args) override;
+		void DrawWallRevSubClamp(const WallDrawerArgs &args) override;
+		void DrawColumn(const SpriteDrawerArgs &args) override;
+		void FillColumn(const SpriteDrawerArgs &args) override;
+		void FillAddColumn(const SpriteDrawerArgs &args) override;
+		void FillAddClampColumn(const SpriteDrawerArgs &args) override;
+		void FillSubClampColumn(const SpriteDrawerArgs &args) override;
+		void FillRevSubClampColumn(const SpriteDrawerArgs &args) override;
+		void DrawAddColumn(const SpriteDrawerArgs &args) override;
+		void DrawTranslatedColumn(const SpriteDrawerArgs &args) override;
+		void DrawTranslatedAddColumn(const SpriteDrawerArgs &args) override;
+		void DrawShadedColumn(const SpriteDrawerArgs &args) override;
+		void DrawAddClampShadedColumn(const SpriteDrawerArgs &args) override;
+		void DrawAddClampColumn(const SpriteDrawerArgs &args) override;
+		void DrawAddClampTranslatedColumn(const SpriteDrawerArgs &args) override;
+		void DrawSubClampColumn(const SpriteDrawerArgs &args) override;
+		void DrawSubClampTranslatedColumn(const SpriteDrawerArgs &args) override;
+		void DrawRevSubClampColumn(const SpriteDrawerArgs &args) override;
+		void DrawRevSubClampTranslatedColumn(const SpriteDrawerArgs &args) override;
+		void DrawSpan(const SpanDrawerArgs &args) override;
+		void DrawSpanMasked(const SpanDrawerArgs &args) override;
+		void DrawSpanTranslucent(const SpanDrawerArgs &args) override;
+		void DrawSpanMaskedTranslucent(const SpanDrawerArgs &args) override;
+		void DrawSpanAddClamp(const SpanDrawerArgs &args) override;
+		void DrawSpanMaskedAddClamp(const SpanDrawerArgs &args) override;
+		void DrawSpanRows(const SpanDrawerArgs &args, const SpanRow *rows, int count) override;
 	};
+#endif
 
 	/////////////////////////////////////////////////////////////////////////////
 	// Pixel shading inline functions:
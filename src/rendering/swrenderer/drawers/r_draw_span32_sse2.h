@@ -68,6 +68,23 @@ namespace swrenderer
 		};
 
 		static void DrawColumn(const SpanDrawerArgs& args)
+		{
+			DrawRow(args, args.ColormapConstants());
+		}
+
+		// Draws all the rows of a flat. Only the per-row values of args change between them.
+		static void DrawRows(const SpanDrawerArgs& args, const SpanRow *rows, int count)
+		{
+			ShadeConstants shade_constants = args.ColormapConstants();
+			SpanDrawerArgs rowargs = args;
+			for (int i = 0; i < count; i++)
+			{
+				rowargs.SetRow(rows[i]);
+				DrawRow(rowargs, shade_constants);
+			}
+		}
+
+		static void DrawRow(const SpanDrawerArgs& args, ShadeConstants shade_constants)
 		{
 			using namespace DrawSpan32TModes;
 
@@ -106,7 +123,6 @@ namespace swrenderer
 			bool is_nearest_filter = (magnifying && !r_magfilter) || (!magnifying && !r_minfilter);
 			bool is_64x64 = texdata.width == 64 && texdata.height == 64;
 			
-			auto shade_constants = args.ColormapConstants();
 			if (shade_constants.simple_shade)
 			{
 				if (is_nearest_filter)
@@ -146,7 +146,16 @@ namespace swrenderer
 
 		light_list = pl->lights;
 
+		// The shade only depends on the light level. Only the light itself varies per row.
+		if (plane_shade)
+			drawerargs.SetLight(0.0f, lightlevel, foggy, Thread->Viewport.get());
+
+		invtexwidth = 1.0 / tex->GetWidth();
+		invtexheight = 1.0 / tex->GetHeight();
+
+		numrows = 0;
 		RenderLines(pl);
+		FlushRows();
 	}
 
 	void RenderFlatPlane::RenderLine(int y, int x1, int x2)
@@ -158,6 +167,19 @@ namespace swrenderer
 		}
 #endif
 
+		SetupRow(rows[numrows++], y, x1, x2);
+		if (numrows == MaxBatchRows)
+			FlushRows();
+	}
+
+	void RenderFlatPlane::FlushRows()
+	{
+		drawerargs.DrawSpanRows(Thread, rows, numrows);
+		numrows = 0;
+	}
+
+	void RenderFlatPlane::SetupRow(SpanRow &row, int y, int x1, int x2)
+	{
 		auto viewport = Thread->Viewport.get();
 
 		double curxfrac = basexfrac + xstepscale * (x1 - minx);
@@ -165,14 +187,15 @@ namespace swrenderer
 
 		double distance = viewport->PlaneDepth(y, planeheight);
 
-		float zbufferdepth = (float)(1.0 / fabs(planeheight / Thread->Viewport->ScreenToViewY(y, 1.0)));
-
-		drawerargs.SetTextureUStep(distance * xstepscale / tex->GetWidth());
-		drawerargs.SetTextureUPos((distance * curxfrac + pviewx) / tex->GetWidth());
+		row.y = y;
+		row.x1 = x1;
+		row.x2 = x2;
+		row.xstep = (uint32_t)(int64_t)(distance * xstepscale * invtexwidth * 4294967296.0);
+		row.xfrac = (uint32_t)(int64_t)((distance * curxfrac + pviewx) * invtexwidth * 4294967296.0);
+		row.ystep = (uint32_t)(int64_t)(distance * ystepscale * invtexheight * 4294967296.0);
+		row.yfrac = (uint32_t)(int64_t)((distance * curyfrac + pviewy) * invtexheight * 4294967296.0);
+		row.lod = 0.0;
 
-		drawerargs.SetTextureVStep(distance * ystepscale / tex->GetHeight());
-		drawerargs.SetTextureVPos((distance * curyfrac + pviewy) / tex->GetHeight());
-		
 		if (viewport->RenderTarget->IsBgra())
 		{
 			double distance2 = viewport->PlaneDepth(y + 1, planeheight);
@@ -180,14 +203,17 @@ namespace swrenderer
 			double ymagnitude = fabs(xstepscale * (distance2 - distance) * viewport->FocalLengthX);
 			double magnitude = max(ymagnitude, xmagnitude);
 			double min_lod = -1000.0;
-			drawerargs.SetTextureLOD(max(log2(magnitude) + r_lod_bias, min_lod));
+			row.lod = max(log2(magnitude) + r_lod_bias, min_lod);
 		}
 
-		if (plane_shade)
-		{
-			// Determine lighting based on the span's distance from the viewer.
-			drawerargs.SetLight((float)Thread->Light->FlatPlaneVis(y, planeheight, foggy, viewport), lightlevel, foggy, viewport);
-		}
+		// Determine lighting based on the span's distance from the viewer.
+		row.light = plane_shade ? (float)Thread->Light->FlatPlaneVis(y, planeheight, foggy, viewport) : drawerargs.FixedLight();
+
+		row.num_lights = 0;
+		row.lights = nullptr;
+		row.viewpos = { 0.0f, 0.0f, 0.0f };
+		row.viewpos_step_x = 0.0f;
+		row.normal_z = 0.0f;
 
 		if (r_dynlights)
 		{
@@ -198,18 +224,16 @@ namespace swrenderer
 
 			// Find row position in view space
 			float zspan = (float)(planeheight / (fabs(y + 0.5 - viewport->CenterY) / viewport->InvZtoScale));
-			drawerargs.dc_viewpos.X = (float)((tx + 0.5 - viewport->CenterX) / viewport->CenterX * zspan);
-			drawerargs.dc_viewpos.Y = zspan;
-			drawerargs.dc_viewpos.Z = (float)((viewport->CenterY - y - 0.5) / viewport->InvZtoScale * zspan);
-			drawerargs.dc_viewpos_step.X = (float)(zspan / viewport->CenterX);
+			row.viewpos.X = (float)((tx + 0.5 - viewport->CenterX) / viewport->CenterX * zspan);
+			row.viewpos.Y = zspan;
+			row.viewpos.Z = (float)((viewport->CenterY - y - 0.5) / viewport->InvZtoScale * zspan);
+			row.viewpos_step_x = (float)(zspan / viewport->CenterX);
 
 			if (mirror)
-				drawerargs.dc_viewpos_step.X = -drawerargs.dc_viewpos_step.X;
+				row.viewpos_step_x = -row.viewpos_step_x;
 
 			// Plane normal
-			drawerargs.dc_normal.X = 0.0f;
-			drawerargs.dc_normal.Y = 0.0f;
-			drawerargs.dc_normal.Z = (y >= viewport->CenterY) ? 1.0f : -1.0f;
+			row.normal_z = (y >= viewport->CenterY) ? 1.0f : -1.0f;
 
 			// Calculate max lights that can touch the row so we can allocate memory for the list
 			int max_lights = 0;
@@ -221,8 +245,7 @@ namespace swrenderer
 				cur_node = cur_node->next;
 			}
 
-			drawerargs.dc_num_lights = 0;
-			drawerargs.dc_lights = Thread->FrameMemory->AllocMemory<DrawerLight>(max_lights);
+			row.lights = Thread->FrameMemory->AllocMemory<DrawerLight>(max_lights);
 
 			// Setup lights for row
 			cur_node = light_list;
@@ -233,13 +256,13 @@ namespace swrenderer
 				double lightZ = cur_node->lightsource->Z() - Thread->Viewport->viewpoint.Pos.Z;
 
 				float lx = (float)(lightX * Thread->Viewport->viewpoint.Sin - lightY * Thread->Viewport->viewpoint.Cos);
-				float ly = (float)(lightX * Thread->Viewport->viewpoint.TanCos + lightY * Thread->Viewport->viewpoint.TanSin) - drawerargs.dc_viewpos.Y;
-				float lz = (float)lightZ - drawerargs.dc_viewpos.Z;
+				float ly = (float)(lightX * Thread->Viewport->viewpoint.TanCos + lightY * Thread->Viewport->viewpoint.TanSin) - row.viewpos.Y;
+				float lz = (float)lightZ - row.viewpos.Z;
 
 				// Precalculate the constant part of the dot here so the drawer doesn't have to.
 				bool is_point_light = cur_node->lightsource->IsAttenuated();
 				float lconstant = ly * ly + lz * lz;
-				float nlconstant = is_point_light ? lz * drawerargs.dc_normal.Z : 0.0f;
+				float nlconstant = is_point_light ? lz * row.normal_z : 0.0f;
 
 				// Include light only if it touches this row
 				float radius = cur_node->lightsource->GetRadius();
@@ -249,7 +272,7 @@ namespace swrenderer
 					uint32_t green = cur_node->lightsource->GetGreen();
 					uint32_t blue = cur_node->lightsource->GetBlue();
 
-					auto &light = drawerargs.dc_lights[drawerargs.dc_num_lights++];
+					auto &light = row.lights[row.num_lights++];
 					light.x = lx;
 					light.y = lconstant;
 					light.z = nlconstant;
@@ -260,16 +283,6 @@ namespace swrenderer
 				cur_node = cur_node->next;
 			}
 		}
-		else
-		{
-			drawerargs.dc_num_lights = 0;
-		}
-
-		drawerargs.SetDestY(viewport, y);
-		drawerargs.SetDestX1(x1);
-		drawerargs.SetDestX2(x2);
-
-		drawerargs.DrawSpan(Thread);
 	}
 
 	/////////////////////////////////////////////////////////////////////////
@@ -40,6 +40,8 @@ namespace swrenderer
 
 	private:
 		void RenderLine(int y, int x1, int x2) override;
+		void SetupRow(SpanRow &row, int y, int x1, int x2);
+		void FlushRows();
 
 		int minx;
 		double planeheight;
@@ -51,8 +53,14 @@ namespace swrenderer
 		double basexfrac, baseyfrac;
 		VisiblePlaneLight *light_list;
 		FSoftwareTexture *tex;
+		double invtexwidth, invtexheight;
 
 		SpanDrawerArgs drawerargs;
+
+		// Spans are collected and drawn in batches rather than one drawer call per span
+		enum { MaxBatchRows = 256 };
+		SpanRow rows[MaxBatchRows];
+		int numrows = 0;
 	};
 
 	class RenderColoredPlane : PlaneRenderer
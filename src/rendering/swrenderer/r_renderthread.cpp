@@ -53,9 +53,12 @@
 #include "swrenderer/drawers/r_draw_pal.h"
 #include "swrenderer/viewport/r_viewport.h"
 #include "r_memory.h"
+#include "x86.h"
 
 std::pair<PalEntry, PalEntry>& R_GetSkyCapColor(FGameTexture* tex);
 
+EXTERN_CVAR(Bool, r_avx2drawers)
+
 namespace swrenderer
 {
 	RenderThread::RenderThread(RenderScene *scene, bool mainThread)
@@ -75,6 +78,10 @@ namespace swrenderer
 		DrawSegments.reset(new DrawSegmentList(this));
 		ClipSegments.reset(new RenderClipSegment());
 		tc_drawers.reset(new SWTruecolorDrawers(this));
+#ifndef NO_SSE
+		if (CPU.bAVX2)
+			tc_avx2_drawers.reset(new SWTruecolorDrawersAVX2(this));
+#endif
 		pal_drawers.reset(new SWPalDrawers(this));
 	}
 
@@ -85,7 +92,7 @@ namespace swrenderer
 	SWPixelFormatDrawers *RenderThread::Drawers(RenderViewport *viewport)
 	{
 		if (viewport->RenderTarget->IsBgra())
-			return tc_drawers.get();
+			return (tc_avx2_drawers && r_avx2drawers) ? tc_avx2_drawers.get() : tc_drawers.get();
 		else
 			return pal_drawers.get();
 	}
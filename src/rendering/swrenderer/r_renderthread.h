@@ -59,6 +59,7 @@ namespace swrenderer
 		RenderScene *Scene;
 		int X1 = 0;
 		int X2 = MAXWIDTH;
+		double SliceTime = 0;	// time in ms this thread took for its slice of the last scene
 		bool MainThread = false;
 
 		std::unique_ptr<RenderMemory> FrameMemory;
@@ -92,6 +93,7 @@ namespace swrenderer
 		
 	private:
 		std::unique_ptr<SWTruecolorDrawers> tc_drawers;
+		std::unique_ptr<SWTruecolorDrawers> tc_avx2_drawers;
 		std::unique_ptr<SWPalDrawers> pal_drawers;
 	};
 }
@@ -171,6 +171,16 @@ void FSoftwareRenderer::Precache(uint8_t *texhitlist, TMap<PClassActor*, bool> &
 
 	int cnt = TexMan.NumTextures();
 
+	// Let the file system decompress the images' data in the background, in the opposite order than they get used below.
+	for (int i = 0; i < cnt; i++)
+	{
+		auto tex = TexMan.GameByIndex(i);
+		if (texhitlist[i] && tex != nullptr && tex->isValid() && !tex->isSoftwareCanvas() && tex->GetTexture() != nullptr && tex->GetTexture()->GetImage() != nullptr)
+		{
+			tex->GetTexture()->GetImage()->PrefetchLumps();
+		}
+	}
+
 	FImageSource::BeginPrecaching();
 	for (int i = cnt - 1; i >= 0; i--)
 	{
@@ -63,11 +63,21 @@ EXTERN_CVAR(Int, r_clearbuffer)
 EXTERN_CVAR(Int, r_debug_draw)
 
 CVAR(Int, r_scene_multithreaded, 1, 0);
+CVAR(Bool, r_scene_balance, true, 0);
 CVAR(Bool, r_models, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG);
 
 namespace swrenderer
 {
 	cycle_t WallCycles, PlaneCycles, MaskedCycles;
+
+	// How far the slice edges move towards the balanced position each frame.
+	// Moving only part of the way keeps them from oscillating when the view changes.
+	static const double SliceBalanceRate = 0.5;
+	static const int MinSliceWidth = 16;
+
+	// Per thread timings of the last frame for the swthreads stat
+	static std::vector<double> LastSliceTimes;
+	static std::vector<int> LastSliceWidths;
 	
 	RenderScene::RenderScene()
 	{
@@ -186,14 +196,29 @@ namespace swrenderer
 			StartThreads(numThreads);
 		}
 
+		// Camera textures have their own sizes and content, so only the main view gets balanced.
+		bool balance = r_scene_balance && numThreads > 1 && !MainThread()->Viewport->RenderingToCanvas;
+		if (balance)
+		{
+			UpdateSliceEdges(numThreads);
+		}
+
 		// Setup threads:
 		std::unique_lock<std::mutex> start_lock(start_mutex);
 		for (int i = 0; i < numThreads; i++)
 		{
 			*Threads[i]->Viewport = *MainThread()->Viewport;
 			*Threads[i]->Light = *MainThread()->Light;
-			Threads[i]->X1 = viewwidth * i / numThreads;
-			Threads[i]->X2 = viewwidth * (i + 1) / numThreads;
+			if (balance)
+			{
+				Threads[i]->X1 = SliceEdges[i];
+				Threads[i]->X2 = SliceEdges[i + 1];
+			}
+			else
+			{
+				Threads[i]->X1 = viewwidth * i / numThreads;
+				Threads[i]->X2 = viewwidth * (i + 1) / numThreads;
+			}
 		}
 		run_id++;
 		FSoftwareTexture::CurrentUpdate = run_id;
@@ -221,13 +246,77 @@ namespace swrenderer
 			finished_threads = 0;
 		}
 
+		if (!MainThread()->Viewport->RenderingToCanvas)
+		{
+			LastSliceTimes.resize(numThreads);
+			LastSliceWidths.resize(numThreads);
+			for (int i = 0; i < numThreads; i++)
+			{
+				LastSliceTimes[i] = Threads[i]->SliceTime;
+				LastSliceWidths[i] = Threads[i]->X2 - Threads[i]->X1;
+			}
+			if (!balance)
+			{
+				SliceEdges.clear();
+			}
+		}
+
 		// Change main thread back to covering the whole screen for player sprites
 		MainThread()->X1 = 0;
 		MainThread()->X2 = viewwidth;
 	}
 
+	// Moves the slice edges so that each thread gets an equal share of the time the previous frame took.
+	// Only frames rendered to the screen are counted, camera textures are left out.
+	// The time of a slice is assumed to be spread evenly over its columns.
+	void RenderScene::UpdateSliceEdges(int numThreads)
+	{
+		int minwidth = std::min(MinSliceWidth, viewwidth / numThreads);
+
+		if (SliceEdges.size() != (size_t)numThreads + 1 || SliceEdges.back() != viewwidth || LastSliceTimes.size() != (size_t)numThreads)
+		{
+			SliceEdges.resize(numThreads + 1);
+			for (int i = 0; i <= numThreads; i++)
+				SliceEdges[i] = viewwidth * i / numThreads;
+			return;
+		}
+
+		double total = 0;
+		for (int i = 0; i < numThreads; i++)
+			total += LastSliceTimes[i];
+		if (total <= 0)
+			return;
+
+		std::vector<int> edges(numThreads + 1);
+		edges[0] = 0;
+		edges[numThreads] = viewwidth;
+
+		int slice = 0;
+		double before = 0;
+		for (int i = 1; i < numThreads; i++)
+		{
+			double target = total * i / numThreads;
+			while (slice < numThreads - 1 && before + LastSliceTimes[slice] < target)
+			{
+				before += LastSliceTimes[slice];
+				slice++;
+			}
+
+			double time = LastSliceTimes[slice];
+			double frac = time > 0 ? clamp((target - before) / time, 0.0, 1.0) : 0.5;
+			double x = SliceEdges[slice] + frac * (SliceEdges[slice + 1] - SliceEdges[slice]);
+			int edge = xs_RoundToInt(SliceEdges[i] + (x - SliceEdges[i]) * SliceBalanceRate);
+			edges[i] = clamp(edge, edges[i - 1] + minwidth, viewwidth - (numThreads - i) * minwidth);
+		}
+		SliceEdges = std::move(edges);
+	}
+
 	void RenderScene::RenderThreadSlice(RenderThread *thread)
 	{
+		cycle_t slicetime;
+		slicetime.Reset();
+		slicetime.Clock();
+
 		thread->FrameMemory->Clear();
 		thread->Clip3D->Cleanup();
 		thread->Clip3D->ResetClip(); // reset clips (floor/ceiling)
@@ -260,6 +349,9 @@ namespace swrenderer
 			thread->TranslucentPass->Render();
 		}
 
+		slicetime.Unclock();
+		thread->SliceTime = slicetime.TimeMS();
+
 #if 0 // shows the render slice edges
 		if (thread->Viewport->RenderTarget->IsBgra())
 		{
@@ -396,6 +488,24 @@ namespace swrenderer
 		return out;
 	}
 
+	ADD_STAT(swthreads)
+	{
+		FString out;
+		double total = 0, longest = 0;
+		for (size_t i = 0; i < LastSliceTimes.size(); i++)
+		{
+			out.AppendFormat("%zu: %04.1f ms %4d px  ", i, LastSliceTimes[i], LastSliceWidths[i]);
+			total += LastSliceTimes[i];
+			longest = std::max(longest, LastSliceTimes[i]);
+		}
+		if (longest > 0)
+		{
+			// How much of the time the threads were busy, 100% meaning they all finished together.
+			out.AppendFormat("balance=%.0f%%", total / (longest * LastSliceTimes.size()) * 100.0);
+		}
+		return out;
+	}
+
 	static double f_acc, w_acc, p_acc, m_acc;
 	static int acc_c;
 
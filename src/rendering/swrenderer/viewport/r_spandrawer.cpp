@@ -126,6 +126,33 @@ namespace swrenderer
 		(thread->Drawers(ds_viewport)->*spanfunc)(*this);
 	}
 
+	void SpanDrawerArgs::DrawSpanRows(RenderThread *thread, const SpanRow *rows, int count)
+	{
+		ds_viewport = thread->Viewport.get();
+		if (count > 0)
+			thread->Drawers(ds_viewport)->DrawSpanRows(*this, rows, count);
+	}
+
+	void SpanDrawerArgs::SetRow(const SpanRow &row)
+	{
+		ds_y = row.y;
+		ds_x1 = row.x1;
+		ds_x2 = row.x2;
+		ds_xfrac = row.xfrac;
+		ds_yfrac = row.yfrac;
+		ds_xstep = row.xstep;
+		ds_ystep = row.ystep;
+		ds_lod = row.lod;
+		SetLight(row.light, Shade());
+		dc_viewpos = row.viewpos;
+		dc_viewpos_step.X = row.viewpos_step_x;
+		dc_normal.X = 0.0f;
+		dc_normal.Y = 0.0f;
+		dc_normal.Z = row.normal_z;
+		dc_lights = row.lights;
+		dc_num_lights = row.num_lights;
+	}
+
 	void SpanDrawerArgs::DrawTiltedSpan(RenderThread *thread, int y, int x1, int x2, const FVector3 &plane_sz, const FVector3 &plane_su, const FVector3 &plane_sv, bool plane_shade, int lightlevel, bool foggy, float planelightfloat, fixed_t pviewx, fixed_t pviewy, FDynamicColormap *basecolormap)
 	{
 		SetDestY(thread->Viewport.get(), y);
@@ -9,6 +9,21 @@ struct FLightNode;
 namespace swrenderer
 {
 	class RenderThread;
+
+	// Everything that changes from one span to the next when drawing a flat
+	struct SpanRow
+	{
+		int y, x1, x2;
+		uint32_t xfrac, yfrac;
+		uint32_t xstep, ystep;
+		double lod;
+		float light;
+		FVector3 viewpos;
+		float viewpos_step_x;
+		float normal_z;
+		DrawerLight *lights;
+		int num_lights;
+	};
 	
 	class SpanDrawerArgs : public DrawerArgs
 	{
@@ -29,6 +44,8 @@ namespace swrenderer
 
 		void DrawDepthSpan(RenderThread *thread, float idepth1, float idepth2);
 		void DrawSpan(RenderThread *thread);
+		void DrawSpanRows(RenderThread *thread, const SpanRow *rows, int count);
+		void SetRow(const SpanRow &row);
 		void DrawTiltedSpan(RenderThread *thread, int y, int x1, int x2, const FVector3 &plane_sz, const FVector3 &plane_su, const FVector3 &plane_sv, bool plane_shade, int lightlevel, bool foggy, float planelightfloat, fixed_t pviewx, fixed_t pviewy, FDynamicColormap *basecolormap);
 		void DrawColoredSpan(RenderThread *thread, int y, int x1, int x2);
 		void DrawFogBoundaryLine(RenderThread *thread, int y, int x1, int x2);
@@ -84,5 +101,8 @@ namespace swrenderer
 		int ds_color = 0;
 		double ds_lod;
 		RenderViewport *ds_viewport = nullptr;
+
+		friend class SWPixelFormatDrawers;
+		friend class SWTruecolorDrawers;
 	};
 }
@@ -35,6 +35,7 @@
 #include "gamedata/g_mapinfo.h"
 #include "s_sound.h"
 #include "p_local.h"
+#include "p_maputl.h"
 #include "v_font.h"
 #include "gstrings.h"
 #include "a_keys.h"
@@ -2571,6 +2572,66 @@ DEFINE_ACTION_FUNCTION_NATIVE(FLevelLocals, SphericalCoords, SphericalCoords)
 	ACTION_RETURN_VEC3(result);
 }
 
+static int FindThingsInRadius(FLevelLocals *self, TArray<AActor*> *results, double x, double y, double z, double radius, int flags, AActor *origin, PClassActor *type)
+{
+	return P_FindThingsInRadius(self, DVector3(x, y, z), radius, *results, flags, origin, type);
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FLevelLocals, FindThingsInRadius, FindThingsInRadius)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FLevelLocals);
+	PARAM_OUTPOINTER(results, TArray<AActor*>);
+	PARAM_FLOAT(x);
+	PARAM_FLOAT(y);
+	PARAM_FLOAT(z);
+	PARAM_FLOAT(radius);
+	PARAM_INT(flags);
+	PARAM_OBJECT(origin, AActor);
+	PARAM_CLASS(type, AActor);
+	ACTION_RETURN_INT(FindThingsInRadius(self, results, x, y, z, radius, flags, origin, type));
+}
+
+static int FindThingsInBox(FLevelLocals *self, TArray<AActor*> *results, double x1, double y1, double x2, double y2, int flags, AActor *origin, PClassActor *type)
+{
+	return P_FindThingsInBox(self, DVector2(x1, y1), DVector2(x2, y2), *results, flags, origin, type);
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FLevelLocals, FindThingsInBox, FindThingsInBox)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FLevelLocals);
+	PARAM_OUTPOINTER(results, TArray<AActor*>);
+	PARAM_FLOAT(x1);
+	PARAM_FLOAT(y1);
+	PARAM_FLOAT(x2);
+	PARAM_FLOAT(y2);
+	PARAM_INT(flags);
+	PARAM_OBJECT(origin, AActor);
+	PARAM_CLASS(type, AActor);
+	ACTION_RETURN_INT(FindThingsInBox(self, results, x1, y1, x2, y2, flags, origin, type));
+}
+
+static int FindThingsInCone(FLevelLocals *self, TArray<AActor*> *results, AActor *origin, double fov, double range, int flags, PClassActor *type)
+{
+	if (origin == nullptr)
+	{
+		results->Clear();
+		return 0;
+	}
+	return P_FindThingsInCone(origin, DAngle::fromDeg(fov), range, *results, flags, type);
+}
+
+DEFINE_ACTION_FUNCTION_NATIVE(FLevelLocals, FindThingsInCone, FindThingsInCone)
+{
+	PARAM_SELF_STRUCT_PROLOGUE(FLevelLocals);
+	PARAM_OUTPOINTER(results, TArray<AActor*>);
+	PARAM_OBJECT(origin, AActor);
+	PARAM_FLOAT(fov);
+	PARAM_FLOAT(range);
+	PARAM_INT(flags);
+	PARAM_CLASS(type, AActor);
+	ACTION_RETURN_INT(FindThingsInCone(self, results, origin, fov, range, flags, type));
+}
+
 static void LookupString(FLevelLocals *level, uint32_t index, FString *res)
 {
 	*res = level->Behaviors.LookupString(index);
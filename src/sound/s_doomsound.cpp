@@ -352,6 +352,12 @@ void S_PrecacheLevel(FLevelLocals* Level)
 		{
 			soundEngine->MarkUsed(snd);
 		}
+		// Let the file system decompress the sounds in the background, starting at the other end than CacheMarkedSounds.
+		auto& sfx = soundEngine->GetSounds();
+		for (int i = (int)sfx.Size() - 1; i > 0; i--)
+		{
+			if (sfx[i].bUsed && sfx[i].lumpnum >= 0) fileSystem.PrefetchFile(sfx[i].lumpnum);
+		}
 		soundEngine->CacheMarkedSounds();
 	}
 }
@@ -40,6 +40,12 @@
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
 
 #include "doomdata.h"
 #include "nodebuild.h"
@@ -48,12 +54,138 @@ const int MaxSegs = 64;
 const int SplitCost = 8;
 const int AAPreference = 16;
 
+// Splitter candidates are only scored in parallel when there are at least
+// this many candidate * seg pairs to classify. Smaller sets are done faster
+// than the workers can be woken up.
+const uint64_t MinParallelWork = 1 << 16;
+
 #if 0
 #define D(x) x
 #else
 #define D(x) do{}while(0)
 #endif
 
+// Runs a job over a range of items on all cores. The calling thread works
+// on the job too and Run only returns once every item has been processed.
+// Each thread is given its own slot number, with 0 being the caller, so the
+// job can keep per-thread working storage.
+
+class FSplitterWorkers
+{
+public:
+	typedef std::function<void(unsigned int start, unsigned int end, unsigned int slot)> Job;
+
+	FSplitterWorkers();
+	~FSplitterWorkers();
+
+	unsigned int NumSlots() const { return (unsigned int)Threads.size() + 1; }
+	void Run(unsigned int count, const Job &job);
+
+private:
+	void WorkerMain(unsigned int slot);
+	void RunBatches(unsigned int slot);
+
+	enum
+	{
+		BatchSize = 2
+	};
+
+	std::vector<std::thread> Threads;
+	std::mutex Mutex;
+	std::condition_variable WorkCondvar, DoneCondvar;
+	int Generation = 0;
+	int Busy = 0;
+	bool StopFlag = false;
+
+	const Job *CurrentJob = nullptr;
+	unsigned int NumItems = 0;
+	std::atomic<unsigned int> NextItem;
+};
+
+FSplitterWorkers::FSplitterWorkers()
+{
+	size_t threadCount = std::max((int)std::thread::hardware_concurrency() - 1, 0);
+	while (Threads.size() < threadCount)
+	{
+		unsigned int slot = (unsigned int)Threads.size() + 1;
+		Threads.push_back(std::thread([=]() { WorkerMain(slot); }));
+	}
+}
+
+FSplitterWorkers::~FSplitterWorkers()
+{
+	std::unique_lock lock(Mutex);
+	StopFlag = true;
+	lock.unlock();
+	WorkCondvar.notify_all();
+	for (auto &thread : Threads)
+		thread.join();
+}
+
+void FSplitterWorkers::Run(unsigned int count, const Job &job)
+{
+	if (Threads.size() == 0)
+	{
+		job(0, count, 0);
+		return;
+	}
+
+	CurrentJob = &job;
+	NumItems = count;
+	NextItem = 0;
+
+	std::unique_lock lock(Mutex);
+	Generation++;
+	Busy = (int)Threads.size();
+	lock.unlock();
+	WorkCondvar.notify_all();
+
+	RunBatches(0);
+
+	lock.lock();
+	DoneCondvar.wait(lock, [this]() { return Busy == 0; });
+	CurrentJob = nullptr;
+	NumItems = 0;
+}
+
+void FSplitterWorkers::RunBatches(unsigned int slot)
+{
+	while (true)
+	{
+		unsigned int start = NextItem.fetch_add(BatchSize);
+		if (start >= NumItems)
+			break;
+
+		(*CurrentJob)(start, std::min(start + (unsigned int)BatchSize, NumItems), slot);
+	}
+}
+
+void FSplitterWorkers::WorkerMain(unsigned int slot)
+{
+	int seen = 0;
+	std::unique_lock lock(Mutex);
+	while (true)
+	{
+		WorkCondvar.wait(lock, [&]() { return StopFlag || Generation != seen; });
+		if (StopFlag)
+			break;
+		seen = Generation;
+
+		lock.unlock();
+		RunBatches(slot);
+		lock.lock();
+
+		if (--Busy == 0)
+			DoneCondvar.notify_one();
+	}
+}
+
+static FSplitterWorkers &GetSplitterWorkers()
+{
+	static FSplitterWorkers workers;
+	return workers;
+}
+
 FNodeBuilder::FNodeBuilder(FLevel &lev)
 : Level(lev), GLNodes(false), SegsStuffed(0)
 {
@@ -104,8 +236,10 @@ void FNodeBuilder::Clear()
 	SegList.Clear();
 	PlaneChecked.Clear();
 	Planes.Clear();
-	Touched.Clear();
-	Colinear.Clear();
+	Scratch.Touched.clear();
+	Scratch.Colinear.clear();
+	Candidates.Clear();
+	CandidateScores.Clear();
 	SplitSharers.Clear();
 	if (VertexMap == NULL)
 	{
@@ -444,6 +578,7 @@ int FNodeBuilder::SelectSplitter (uint32_t set, node_t &node, uint32_t &splitseg
 	int bestvalue;
 	uint32_t bestseg;
 	uint32_t seg;
+	unsigned int numsegs;
 	bool nosplitters = false;
 
 	bestvalue = 0;
@@ -451,11 +586,15 @@ int FNodeBuilder::SelectSplitter (uint32_t set, node_t &node, uint32_t &splitseg
 
 	seg = set;
 	stepleft = 0;
+	numsegs = 0;
 
 	memset (&PlaneChecked[0], 0, PlaneChecked.Size());
+	Candidates.Clear();
 
 	D(Printf (PRINT_LOG, "Processing set %d\n", set));
 
+	// Which segs get tried as splitters does not depend on their scores, so
+	// all of them can be picked first and then scored independently.
 	while (seg != UINT_MAX)
 	{
 		FPrivSeg *pseg = &Segs[seg];
@@ -473,32 +612,46 @@ int FNodeBuilder::SelectSplitter (uint32_t set, node_t &node, uint32_t &splitseg
 				}
 
 				stepleft = step;
-				SetNodeFromSeg (node, pseg);
-
-				int value = Heuristic (node, set, nosplit);
-
-				D(Printf (PRINT_LOG, "Seg %5d, ld %d (%5d,%5d)-(%5d,%5d) scores %d\n", seg, Segs[seg].linedef, node.x>>16, node.y>>16,
-					(node.x+node.dx)>>16, (node.y+node.dy)>>16, value));
-
-				if (value > bestvalue)
-				{
-					bestvalue = value;
-					bestseg = seg;
-				}
-				else if (value < 0)
-				{
-					nosplitters = true;
-				}
+				Candidates.Push (seg);
 			}
 		}
 
+		numsegs++;
 		seg = pseg->next;
 	}
 
+	ScoreCandidates (set, nosplit, numsegs);
+
+	// Pick the best one in seg order, so ties are resolved exactly as they
+	// would be if every candidate had been scored one after the other.
+	for (unsigned int i = 0; i < Candidates.Size(); ++i)
+	{
+		int value = CandidateScores[i];
+
+		seg = Candidates[i];
+		D(Printf (PRINT_LOG, "Seg %5d, ld %d scores %d\n", seg, Segs[seg].linedef, value));
+
+		if (value > bestvalue)
+		{
+			bestvalue = value;
+			bestseg = seg;
+		}
+		else if (value < 0)
+		{
+			nosplitters = true;
+		}
+	}
+
 	if (bestseg == UINT_MAX)
 	{
 		// No lines split any others into two sets, so this is a convex region.
 		D(Printf (PRINT_LOG, "set %d, step %d, nosplit %d has no good splitter (%d)\n", set, step, nosplit, nosplitters));
+		// CreateNode can still split with the result of a -1, so leave node
+		// set from the last candidate, like scoring them one by one did.
+		if (Candidates.Size() > 0)
+		{
+			SetNodeFromSeg (node, &Segs[Candidates.Last()]);
+		}
 		return nosplitters ? -1 : 0;
 	}
 
@@ -509,13 +662,54 @@ int FNodeBuilder::SelectSplitter (uint32_t set, node_t &node, uint32_t &splitseg
 	return 1;
 }
 
+// Fills CandidateScores with the Heuristic's score for each seg in Candidates.
+// Scoring only reads the segs and vertices, so for large sets this is spread
+// across all cores.
+
+void FNodeBuilder::ScoreCandidates (uint32_t set, bool nosplit, unsigned int numsegs)
+{
+	unsigned int count = Candidates.Size();
+
+	CandidateScores.Resize (count);
+
+	if (count < 2 || (uint64_t)count * numsegs < MinParallelWork)
+	{
+		node_t node;
+
+		for (unsigned int i = 0; i < count; ++i)
+		{
+			SetNodeFromSeg (node, &Segs[Candidates[i]]);
+			CandidateScores[i] = Heuristic (node, set, nosplit, Scratch);
+		}
+		return;
+	}
+
+	FSplitterWorkers &workers = GetSplitterWorkers();
+
+	if (WorkerScratch.size() < workers.NumSlots())
+	{
+		WorkerScratch.resize (workers.NumSlots());
+	}
+
+	workers.Run (count, [=](unsigned int start, unsigned int end, unsigned int slot)
+	{
+		node_t node;
+
+		for (unsigned int i = start; i < end; ++i)
+		{
+			SetNodeFromSeg (node, &Segs[Candidates[i]]);
+			CandidateScores[i] = Heuristic (node, set, nosplit, WorkerScratch[slot]);
+		}
+	});
+}
+
 // Given a splitter (node), returns a score based on how "good" the resulting
 // split in a set of segs is. Higher scores are better. -1 means this splitter
 // splits something it shouldn't and will only be returned if honorNoSplit is
 // true. A score of 0 means that the splitter does not split any of the segs
 // in the set.
 
-int FNodeBuilder::Heuristic (node_t &node, uint32_t set, bool honorNoSplit)
+int FNodeBuilder::Heuristic (node_t &node, uint32_t set, bool honorNoSplit, FHeuristicScratch &scratch)
 {
 	// Set the initial score above 0 so that near vertex anti-weighting is less likely to produce a negative score.
 	int score = 1000000;
@@ -530,8 +724,11 @@ int FNodeBuilder::Heuristic (node_t &node, uint32_t set, bool honorNoSplit)
 	unsigned int max, m2, p, q;
 	double frac;
 
-	Touched.Clear ();
-	Colinear.Clear ();
+	std::vector<int> &Touched = scratch.Touched;
+	std::vector<int> &Colinear = scratch.Colinear;
+
+	Touched.clear ();
+	Colinear.clear ();
 
 	while (i != UINT_MAX)
 	{
@@ -557,7 +754,7 @@ int FNodeBuilder::Heuristic (node_t &node, uint32_t set, bool honorNoSplit)
 			{
 				if ((sidev[0] | sidev[1]) != 0)
 				{
-					max = Touched.Size();
+					max = (unsigned int)Touched.size();
 					for (p = 0; p < max; ++p)
 					{
 						if (Touched[p] == test->loopnum)
@@ -567,12 +764,12 @@ int FNodeBuilder::Heuristic (node_t &node, uint32_t set, bool honorNoSplit)
 					}
 					if (p == max)
 					{
-						Touched.Push (test->loopnum);
+						Touched.push_back (test->loopnum);
 					}
 				}
 				else
 				{
-					max = Colinear.Size();
+					max = (unsigned int)Colinear.size();
 					for (p = 0; p < max; ++p)
 					{
 						if (Colinear[p] == test->loopnum)
@@ -582,7 +779,7 @@ int FNodeBuilder::Heuristic (node_t &node, uint32_t set, bool honorNoSplit)
 					}
 					if (p == max)
 					{
-						Colinear.Push (test->loopnum);
+						Colinear.push_back (test->loopnum);
 					}
 				}
 			}
@@ -699,8 +896,8 @@ int FNodeBuilder::Heuristic (node_t &node, uint32_t set, bool honorNoSplit)
 	// seg of that sector must be crossing the container's corner and does not
 	// actually split the container.
 
-	max = Touched.Size ();
-	m2 = Colinear.Size ();
+	max = (unsigned int)Touched.size ();
+	m2 = (unsigned int)Colinear.size ();
 
 	// If honorNoSplit is false, then both these lists will be empty.
 
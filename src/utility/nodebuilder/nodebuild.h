@@ -40,6 +40,7 @@
 #include "tarray.h"
 #include "r_defs.h"
 #include "x86.h"
+#include <vector>
 
 struct FPolySeg;
 struct FMiniBSP;
@@ -145,6 +146,14 @@ class FNodeBuilder
 		uint32_t Partner;
 	};
 
+	// Working storage for Heuristic. Splitter candidates can be scored on
+	// several threads at once, so each of them needs its own.
+	struct FHeuristicScratch
+	{
+		std::vector<int> Touched;	// Loops a splitter touches on a vertex
+		std::vector<int> Colinear;	// Loops with edges colinear to a splitter
+	};
+
 
 	// Like a blockmap, but for vertices instead of lines
 	class IVertexMap
@@ -265,8 +274,10 @@ private:
 	TArray<uint8_t> PlaneChecked;
 	TArray<FSimpleLine> Planes;
 
-	TArray<int> Touched;	// Loops a splitter touches on a vertex
-	TArray<int> Colinear;	// Loops with edges colinear to a splitter
+	FHeuristicScratch Scratch;
+	std::vector<FHeuristicScratch> WorkerScratch;
+	TArray<uint32_t> Candidates;	// Splitter candidates for the current set
+	TArray<int> CandidateScores;
 	FEventTree Events;		// Vertices intersected by the current splitter
 
 	TArray<uint32_t> UnsetSegs;			// Segs with no definitive side in current splitter
@@ -300,7 +311,9 @@ private:
 	void DoGLSegSplit (uint32_t set, node_t &node, uint32_t splitseg, uint32_t &outset0, uint32_t &outset1, int side, int sidev0, int sidev1, bool hack);
 	void SplitSegs (uint32_t set, node_t &node, uint32_t splitseg, uint32_t &outset0, uint32_t &outset1, unsigned int &count0, unsigned int &count1);
 	uint32_t SplitSeg (uint32_t segnum, int splitvert, int v1InFront);
-	int Heuristic (node_t &node, uint32_t set, bool honorNoSplit);
+	void ScoreCandidates (uint32_t set, bool nosplit, unsigned int numsegs);
+	int Heuristic (node_t &node, uint32_t set, bool honorNoSplit, FHeuristicScratch &scratch);
+	int Heuristic (node_t &node, uint32_t set, bool honorNoSplit) { return Heuristic (node, set, honorNoSplit, Scratch); }
 
 	// Returns:
 	//	0 = seg is in front